@@ -0,0 +1,210 @@
+/**
+ * Benchmark: Decoder Speed/Quality Tuning
+ *
+ * decoderOptions trades picture quality for decode speed. Each setting is
+ * decoded against the same encoded clip and compared with an untuned
+ * decoder, so the speedup column is the fps gain of that setting alone.
+ * Settings the codec can't honour are reported as unsupported (configure()
+ * rejects them) rather than silently measured as no-ops.
+ *
+ *   lowres                     MJPEG / H.263-family decoders
+ *   skipLoopFilter, skipIdct   H.264 / HEVC
+ *   frameThreads, maxFrameDelay  libdav1d (AV1)
+ *   threads                    any
+ *
+ * Usage: npx ts-node benchmark/decoder-tuning.ts [codec] [width] [height]
+ *   e.g. avc1.42001f (default), hvc1.1.6.L93.B0, av01.0.04M.08
+ */
+
+import { VideoEncoder } from '../src/VideoEncoder';
+import { VideoDecoder, VideoDecoderOptions } from '../src/VideoDecoder';
+import { VideoFrame } from '../src/VideoFrame';
+import { EncodedVideoChunk } from '../src/EncodedVideoChunk';
+
+const CODEC = process.argv[2] || 'avc1.42001f';
+const WIDTH = parseInt(process.argv[3] || '1280', 10);
+const HEIGHT = parseInt(process.argv[4] || '720', 10);
+const FRAME_COUNT = 240;
+const RUNS = 3;
+
+interface Variant {
+  name: string;
+  options: VideoDecoderOptions;
+}
+
+const VARIANTS: Variant[] = [
+  { name: 'threads=1', options: { threads: 1 } },
+  { name: 'lowres=1', options: { lowres: 1 } },
+  { name: 'lowres=2', options: { lowres: 2 } },
+  { name: 'skipLoopFilter=nonref', options: { skipLoopFilter: 'nonref' } },
+  { name: 'skipLoopFilter=all', options: { skipLoopFilter: 'all' } },
+  { name: 'skipIdct=nonref', options: { skipIdct: 'nonref' } },
+  { name: 'skipLoopFilter+skipIdct=all', options: { skipLoopFilter: 'all', skipIdct: 'all' } },
+  { name: 'maxFrameDelay=1', options: { maxFrameDelay: 1 } },
+  { name: 'frameThreads=2', options: { frameThreads: 2 } },
+  { name: 'frameThreads=4', options: { frameThreads: 4 } },
+];
+
+function createTestFrame(index: number, timestamp: number): VideoFrame {
+  const ySize = WIDTH * HEIGHT;
+  const uvSize = (WIDTH / 2) * (HEIGHT / 2);
+  const buffer = Buffer.alloc(ySize + uvSize * 2);
+
+  // Moving diagonal texture: real motion and residual for the decoder
+  for (let y = 0; y < HEIGHT; y++) {
+    for (let x = 0; x < WIDTH; x++) {
+      buffer[y * WIDTH + x] = ((x + y + index * 3) * 7) & 0xff;
+    }
+  }
+  buffer.fill(128, ySize);
+
+  return new VideoFrame(buffer, {
+    format: 'I420',
+    codedWidth: WIDTH,
+    codedHeight: HEIGHT,
+    timestamp,
+  });
+}
+
+async function encodeClip(): Promise<{ chunks: EncodedVideoChunk[]; description?: Uint8Array }> {
+  const chunks: EncodedVideoChunk[] = [];
+  let description: Uint8Array | undefined;
+
+  const encoder = new VideoEncoder({
+    output: (chunk, metadata) => {
+      chunks.push(chunk);
+      if (metadata?.decoderConfig?.description) {
+        description = new Uint8Array(metadata.decoderConfig.description as ArrayBuffer);
+      }
+    },
+    error: (err) => {
+      throw err;
+    },
+  });
+
+  encoder.configure({
+    codec: CODEC,
+    width: WIDTH,
+    height: HEIGHT,
+    bitrate: 4_000_000,
+    framerate: 30,
+  });
+
+  for (let i = 0; i < FRAME_COUNT; i++) {
+    const frame = createTestFrame(i, i * 33333);
+    encoder.encode(frame, { keyFrame: i % 60 === 0 });
+    frame.close();
+  }
+  await encoder.flush();
+  encoder.close();
+
+  return { chunks, description };
+}
+
+/** Best-of-RUNS decode fps, or the configure() error for unsupported options */
+async function measure(
+  clip: { chunks: EncodedVideoChunk[]; description?: Uint8Array },
+  options?: VideoDecoderOptions
+): Promise<{ fps: number; width: number } | { error: string }> {
+  let best = 0;
+  let width = 0;
+
+  for (let run = 0; run < RUNS; run++) {
+    let frames = 0;
+    const decoder = new VideoDecoder({
+      output: (frame) => {
+        frames++;
+        width = frame.codedWidth;
+        frame.close();
+      },
+      error: (err) => {
+        throw err;
+      },
+    });
+
+    try {
+      decoder.configure({
+        codec: CODEC,
+        codedWidth: WIDTH,
+        codedHeight: HEIGHT,
+        description: clip.description,
+        decoderOptions: options,
+      });
+    } catch (e: any) {
+      decoder.close();
+      return { error: e.message };
+    }
+
+    const start = process.hrtime.bigint();
+    for (const chunk of clip.chunks) {
+      decoder.decode(chunk);
+    }
+    await decoder.flush();
+    const totalMs = Number(process.hrtime.bigint() - start) / 1_000_000;
+    decoder.close();
+
+    best = Math.max(best, (frames / totalMs) * 1000);
+  }
+
+  return { fps: best, width };
+}
+
+async function main() {
+  console.log('='.repeat(70));
+  console.log('Decoder Tuning Benchmark (decoderOptions)');
+  console.log('='.repeat(70));
+  console.log(`Codec: ${CODEC}`);
+  console.log(`Resolution: ${WIDTH}x${HEIGHT}`);
+  console.log(`Frames: ${FRAME_COUNT}, best of ${RUNS} runs`);
+  console.log('');
+
+  console.log('Encoding test clip...');
+  const clip = await encodeClip();
+  console.log(`  ${clip.chunks.length} chunks`);
+  console.log('');
+
+  const baseline = await measure(clip);
+  if ('error' in baseline) {
+    console.error(`Baseline decode failed: ${baseline.error}`);
+    process.exit(1);
+  }
+
+  console.log('Results:');
+  console.log('-'.repeat(70));
+  console.log(
+    'Setting'.padEnd(30) +
+    'FPS'.padStart(10) +
+    'Speedup'.padStart(10) +
+    'Output'.padStart(10)
+  );
+  console.log('-'.repeat(70));
+  console.log(
+    '(default)'.padEnd(30) +
+    baseline.fps.toFixed(1).padStart(10) +
+    '1.00x'.padStart(10) +
+    `${baseline.width}w`.padStart(10)
+  );
+
+  for (const variant of VARIANTS) {
+    const result = await measure(clip, variant.options);
+    if ('error' in result) {
+      console.log(variant.name.padEnd(30) + `  unsupported: ${result.error}`);
+      continue;
+    }
+    console.log(
+      variant.name.padEnd(30) +
+      result.fps.toFixed(1).padStart(10) +
+      `${(result.fps / baseline.fps).toFixed(2)}x`.padStart(10) +
+      `${result.width}w`.padStart(10)
+    );
+  }
+
+  console.log('');
+  console.log('skip* settings and lowres degrade the picture: use them for previews,');
+  console.log('thumbnails and analytics, not for frames that will be shown or re-encoded.');
+}
+
+main().catch((err) => {
+  console.error(err);
+  process.exit(1);
+});
@@ -0,0 +1,206 @@
+/**
+ * Benchmark: Realtime Encoding Thread Scaling
+ *
+ * latencyMode 'realtime' uses slice/row/tile threading sized from the frame
+ * height and the CPU budget. Unlike frame threading, it should raise
+ * throughput without holding frames back, so per-frame latency stays flat
+ * (or drops) as threads are added.
+ *
+ * The budget is read once at load, so each thread count runs in a child
+ * process with NODE_WEBCODECS_THREADS set.
+ *
+ * Usage: npx ts-node benchmark/realtime-threading.ts [codec] [width] [height]
+ */
+
+import { spawnSync } from 'child_process';
+import { VideoEncoder } from '../src/VideoEncoder';
+import { VideoFrame } from '../src/VideoFrame';
+import { getCpuInfo } from '../src/index';
+
+const CODEC = process.argv[2] || 'avc1.42001f';
+const WIDTH = parseInt(process.argv[3] || '1920', 10);
+const HEIGHT = parseInt(process.argv[4] || '1080', 10);
+const FRAME_COUNT = 120;
+const THREAD_COUNTS = [1, 2, 4, 8];
+const OUTPUT_TIMEOUT_MS = 5000;
+
+interface ChildResult {
+  threads: number;
+  fps: number;
+  p50LatencyMs: number;
+  p99LatencyMs: number;
+  framesEncoded: number;
+}
+
+function createTestFrame(index: number, timestamp: number): VideoFrame {
+  const ySize = WIDTH * HEIGHT;
+  const uvSize = (WIDTH / 2) * (HEIGHT / 2);
+  const buffer = Buffer.alloc(ySize + uvSize * 2);
+
+  // Moving gradient so every frame has real motion to encode
+  for (let y = 0; y < HEIGHT; y++) {
+    buffer.fill((y + index * 4) & 0xff, y * WIDTH, (y + 1) * WIDTH);
+  }
+  buffer.fill(128, ySize);
+
+  return new VideoFrame(buffer, {
+    format: 'I420',
+    codedWidth: WIDTH,
+    codedHeight: HEIGHT,
+    timestamp,
+  });
+}
+
+function percentile(sorted: number[], p: number): number {
+  return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+/**
+ * Encode frames one at a time, waiting for each chunk before submitting the
+ * next. Any frame delay in the encoder shows up as a timeout here rather
+ * than as a latency number, so this also checks realtime adds none.
+ */
+async function runChild(): Promise<ChildResult> {
+  const pending = new Map<number, { start: bigint; resolve: () => void }>();
+  const latencies: number[] = [];
+  let failure: Error | null = null;
+
+  const encoder = new VideoEncoder({
+    output: (chunk) => {
+      const entry = pending.get(chunk.timestamp);
+      if (!entry) return;
+      pending.delete(chunk.timestamp);
+      latencies.push(Number(process.hrtime.bigint() - entry.start) / 1_000_000);
+      entry.resolve();
+    },
+    error: (err) => {
+      failure = err;
+    },
+  });
+
+  encoder.configure({
+    codec: CODEC,
+    width: WIDTH,
+    height: HEIGHT,
+    bitrate: 6_000_000,
+    framerate: 60,
+    latencyMode: 'realtime',
+  });
+
+  const startTime = process.hrtime.bigint();
+
+  for (let i = 0; i < FRAME_COUNT; i++) {
+    const timestamp = i * 16667;
+    const frame = createTestFrame(i, timestamp);
+
+    await new Promise<void>((resolve, reject) => {
+      const timer = setTimeout(() => {
+        reject(new Error(`Frame ${i} produced no output within ${OUTPUT_TIMEOUT_MS}ms (encoder is buffering frames)`));
+      }, OUTPUT_TIMEOUT_MS);
+      pending.set(timestamp, {
+        start: process.hrtime.bigint(),
+        resolve: () => {
+          clearTimeout(timer);
+          resolve();
+        },
+      });
+      encoder.encode(frame, { keyFrame: i === 0 });
+    });
+
+    frame.close();
+    if (failure) throw failure;
+  }
+
+  const totalMs = Number(process.hrtime.bigint() - startTime) / 1_000_000;
+  await encoder.flush();
+  encoder.close();
+
+  // First frame includes encoder warm-up
+  const sorted = latencies.slice(1).sort((a, b) => a - b);
+
+  return {
+    threads: getCpuInfo()?.effectiveCores ?? 0,
+    fps: (latencies.length / totalMs) * 1000,
+    p50LatencyMs: percentile(sorted, 0.5),
+    p99LatencyMs: percentile(sorted, 0.99),
+    framesEncoded: latencies.length,
+  };
+}
+
+function spawnChild(threads: number): ChildResult | null {
+  const result = spawnSync(process.execPath, [...process.execArgv, __filename, ...process.argv.slice(2)], {
+    env: { ...process.env, NODE_WEBCODECS_THREADS: String(threads), REALTIME_BENCH_CHILD: '1' },
+    encoding: 'utf8',
+  });
+
+  const line = result.stdout.split('\n').find((l) => l.startsWith('RESULT '));
+  if (result.status !== 0 || !line) {
+    console.error(`  ${threads} thread(s) failed:`);
+    console.error(result.stderr || result.stdout);
+    return null;
+  }
+  return JSON.parse(line.slice('RESULT '.length));
+}
+
+async function main() {
+  if (process.env.REALTIME_BENCH_CHILD) {
+    const result = await runChild();
+    console.log(`RESULT ${JSON.stringify(result)}`);
+    return;
+  }
+
+  const cpu = getCpuInfo();
+
+  console.log('='.repeat(60));
+  console.log('Realtime Encoding Thread Scaling Benchmark');
+  console.log('='.repeat(60));
+  console.log(`Codec: ${CODEC}`);
+  console.log(`Resolution: ${WIDTH}x${HEIGHT}`);
+  console.log(`Frames: ${FRAME_COUNT} (submitted one at a time, latencyMode 'realtime')`);
+  if (cpu) {
+    console.log(`CPU: ${cpu.hostCores} host cores, ${cpu.effectiveCores} in budget`);
+  }
+  console.log('');
+
+  const results: ChildResult[] = [];
+  for (const threads of THREAD_COUNTS) {
+    console.log(`Testing NODE_WEBCODECS_THREADS=${threads}...`);
+    const result = spawnChild(threads);
+    if (result) results.push(result);
+  }
+
+  console.log('');
+  console.log('Results (slice threads = min(budget, height / 180)):');
+  console.log('-'.repeat(60));
+  console.log(
+    'Budget'.padEnd(10) +
+    'FPS'.padStart(10) +
+    'Speedup'.padStart(10) +
+    'P50 (ms)'.padStart(10) +
+    'P99 (ms)'.padStart(10) +
+    'Frames'.padStart(10)
+  );
+  console.log('-'.repeat(60));
+
+  const baseline = results[0];
+  for (const result of results) {
+    const speedup = baseline ? result.fps / baseline.fps : 1;
+    console.log(
+      result.threads.toString().padEnd(10) +
+      result.fps.toFixed(1).padStart(10) +
+      `${speedup.toFixed(2)}x`.padStart(10) +
+      result.p50LatencyMs.toFixed(2).padStart(10) +
+      result.p99LatencyMs.toFixed(2).padStart(10) +
+      result.framesEncoded.toString().padStart(10)
+    );
+  }
+
+  console.log('');
+  console.log('Every frame was returned before the next was submitted, so no');
+  console.log('configuration added frame delay; latency is pure encode time.');
+}
+
+main().catch((err) => {
+  console.error(err);
+  process.exit(1);
+});
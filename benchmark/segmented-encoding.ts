@@ -0,0 +1,219 @@
+/**
+ * Benchmark: GOP-Segmented Offline Encoding
+ *
+ * One encoder context stops scaling well before a many-core machine runs
+ * out of cores. VideoSegmentedEncoder instead encodes K keyframe-aligned
+ * segments at once on independent contexts, splitting the CPU budget
+ * between them. This compares it against a single VideoEncoder given the
+ * same budget.
+ *
+ * Scaling efficiency is fps / (single-core fps x cores in budget): 100%
+ * means every core in the budget does as much work as one core alone.
+ *
+ * Each run is a child process so the single-core reference can set
+ * NODE_WEBCODECS_THREADS=1 (the budget is read once at load).
+ *
+ * Usage: npx ts-node benchmark/segmented-encoding.ts [codec] [width] [height]
+ */
+
+import { spawnSync } from 'child_process';
+import { VideoEncoder } from '../src/VideoEncoder';
+import { VideoSegmentedEncoder } from '../src/VideoSegmentedEncoder';
+import { VideoFrame } from '../src/VideoFrame';
+import { getCpuInfo } from '../src/index';
+
+const CODEC = process.argv[2] || 'avc1.640028';
+const WIDTH = parseInt(process.argv[3] || '1920', 10);
+const HEIGHT = parseInt(process.argv[4] || '1080', 10);
+const FRAME_COUNT = 240;
+const FRAMERATE = 30;
+const SEGMENT_LENGTH = 30;
+const CONCURRENCY_LEVELS = [1, 2, 4, 8];
+
+interface RunSpec {
+  label: string;
+  mode: 'single' | 'segmented';
+  concurrency?: number;
+  threads?: number;
+}
+
+interface ChildResult {
+  cores: number;
+  fps: number;
+  chunks: number;
+  keyframes: number;
+  ordered: boolean;
+}
+
+function createTestFrame(index: number, timestamp: number): VideoFrame {
+  const ySize = WIDTH * HEIGHT;
+  const uvSize = (WIDTH / 2) * (HEIGHT / 2);
+  const buffer = Buffer.alloc(ySize + uvSize * 2);
+
+  // Moving gradient so every frame has real motion to encode
+  for (let y = 0; y < HEIGHT; y++) {
+    buffer.fill((y + index * 4) & 0xff, y * WIDTH, (y + 1) * WIDTH);
+  }
+  buffer.fill(128, ySize);
+
+  return new VideoFrame(buffer, {
+    format: 'I420',
+    codedWidth: WIDTH,
+    codedHeight: HEIGHT,
+    timestamp,
+  });
+}
+
+async function runChild(spec: RunSpec): Promise<ChildResult> {
+  const timestamps: number[] = [];
+  let keyframes = 0;
+  let failure: Error | null = null;
+
+  const output = (chunk: { timestamp: number; type: string }) => {
+    timestamps.push(chunk.timestamp);
+    if (chunk.type === 'key') keyframes++;
+  };
+  const error = (err: Error) => {
+    failure = err;
+  };
+
+  const config = {
+    codec: CODEC,
+    width: WIDTH,
+    height: HEIGHT,
+    bitrate: 6_000_000,
+    framerate: FRAMERATE,
+  };
+
+  let encoder: VideoEncoder | VideoSegmentedEncoder;
+  if (spec.mode === 'single') {
+    const single = new VideoEncoder({ output, error });
+    single.configure({ ...config, latencyMode: 'quality' });
+    encoder = single;
+  } else {
+    const segmented = new VideoSegmentedEncoder({ output, error });
+    segmented.configure({ ...config, segmentLength: SEGMENT_LENGTH, concurrency: spec.concurrency });
+    encoder = segmented;
+  }
+
+  // Keep a bounded number of raw frames in flight
+  const maxQueued = SEGMENT_LENGTH * (spec.concurrency ?? 1) * 2;
+  const startTime = process.hrtime.bigint();
+
+  for (let i = 0; i < FRAME_COUNT; i++) {
+    while (encoder.encodeQueueSize > maxQueued) {
+      await new Promise((resolve) => setTimeout(resolve, 1));
+    }
+    const frame = createTestFrame(i, Math.round((i * 1_000_000) / FRAMERATE));
+    encoder.encode(frame, { keyFrame: i % SEGMENT_LENGTH === 0 });
+    frame.close();
+    if (failure) throw failure;
+  }
+
+  await encoder.flush();
+  const totalMs = Number(process.hrtime.bigint() - startTime) / 1_000_000;
+  encoder.close();
+  if (failure) throw failure;
+
+  return {
+    cores: getCpuInfo()?.effectiveCores ?? 0,
+    fps: (timestamps.length / totalMs) * 1000,
+    chunks: timestamps.length,
+    keyframes,
+    ordered: timestamps.every((t, i) => i === 0 || t > timestamps[i - 1]),
+  };
+}
+
+function spawnChild(spec: RunSpec): ChildResult | null {
+  const env: NodeJS.ProcessEnv = { ...process.env, SEGMENTED_BENCH_CHILD: JSON.stringify(spec) };
+  if (spec.threads) env.NODE_WEBCODECS_THREADS = String(spec.threads);
+
+  const result = spawnSync(process.execPath, [...process.execArgv, __filename, ...process.argv.slice(2)], {
+    env,
+    encoding: 'utf8',
+    maxBuffer: 16 * 1024 * 1024,
+  });
+
+  const line = result.stdout.split('\n').find((l) => l.startsWith('RESULT '));
+  if (result.status !== 0 || !line) {
+    console.error(`  ${spec.label} failed:`);
+    console.error(result.stderr || result.stdout);
+    return null;
+  }
+  return JSON.parse(line.slice('RESULT '.length));
+}
+
+async function main() {
+  if (process.env.SEGMENTED_BENCH_CHILD) {
+    const result = await runChild(JSON.parse(process.env.SEGMENTED_BENCH_CHILD));
+    console.log(`RESULT ${JSON.stringify(result)}`);
+    return;
+  }
+
+  const cpu = getCpuInfo();
+  const cores = cpu?.effectiveCores ?? 1;
+
+  console.log('='.repeat(70));
+  console.log('GOP-Segmented Offline Encoding Benchmark');
+  console.log('='.repeat(70));
+  console.log(`Codec: ${CODEC}`);
+  console.log(`Resolution: ${WIDTH}x${HEIGHT}`);
+  console.log(`Frames: ${FRAME_COUNT}, segments of ${SEGMENT_LENGTH}`);
+  if (cpu) {
+    console.log(`CPU: ${cpu.hostCores} host cores, ${cpu.effectiveCores} in budget`);
+  }
+  console.log('');
+
+  const specs: RunSpec[] = [
+    { label: 'VideoEncoder, 1 core', mode: 'single', threads: 1 },
+    { label: 'VideoEncoder', mode: 'single' },
+    ...CONCURRENCY_LEVELS
+      .filter((k) => k <= cores)
+      .map((k): RunSpec => ({ label: `Segmented K=${k}`, mode: 'segmented', concurrency: k })),
+  ];
+
+  const results: { spec: RunSpec; result: ChildResult }[] = [];
+  for (const spec of specs) {
+    console.log(`Testing ${spec.label}...`);
+    const result = spawnChild(spec);
+    if (result) results.push({ spec, result });
+  }
+
+  const reference = results.find((r) => r.spec.threads === 1)?.result;
+  const single = results.find((r) => r.spec.mode === 'single' && !r.spec.threads)?.result;
+
+  console.log('');
+  console.log('Results:');
+  console.log('-'.repeat(70));
+  console.log(
+    'Configuration'.padEnd(24) +
+    'FPS'.padStart(10) +
+    'Speedup'.padStart(10) +
+    'Efficiency'.padStart(12) +
+    'Keyframes'.padStart(11) +
+    'Ordered'.padStart(9)
+  );
+  console.log('-'.repeat(70));
+
+  for (const { spec, result } of results) {
+    const speedup = single ? result.fps / single.fps : 1;
+    const efficiency = reference ? result.fps / (reference.fps * result.cores) : 0;
+    console.log(
+      spec.label.padEnd(24) +
+      result.fps.toFixed(1).padStart(10) +
+      `${speedup.toFixed(2)}x`.padStart(10) +
+      `${(efficiency * 100).toFixed(0)}%`.padStart(12) +
+      result.keyframes.toString().padStart(11) +
+      (result.ordered ? 'yes' : 'NO').padStart(9)
+    );
+  }
+
+  console.log('');
+  console.log('Speedup is against one VideoEncoder with the whole budget. Every run');
+  console.log(`forces a keyframe each ${SEGMENT_LENGTH} frames, so the bitstreams are comparable.`);
+}
+
+main().catch((err) => {
+  console.error(err);
+  process.exit(1);
+});
@@ -2,6 +2,9 @@
   "targets": [
     {
       "target_name": "webcodecs_node",
+      "variables": {
+        "has_avformat%": "<!(pkg-config --exists libavformat && echo 1 || echo 0)"
+      },
       "sources": [
         "native/binding.cpp",
         "native/frame.cpp",
@@ -15,7 +18,24 @@
         "native/hw_accel.cpp",
         "native/image_decoder.cpp",
         "native/color.cpp",
-        "native/svc.cpp"
+        "native/svc.cpp",
+        "native/svc_filter.cpp",
+        "native/threading.cpp",
+        "native/encoder_setup.cpp",
+        "native/scaler.cpp",
+        "native/ladder_encoder.cpp",
+        "native/segmented_encoder.cpp",
+        "native/decoder_setup.cpp",
+        "native/batch_decoder.cpp",
+        "native/transcoder.cpp",
+        "native/demuxer.cpp",
+        "native/muxer.cpp",
+        "native/bitstream.cpp",
+        "native/sprite_sheet.cpp",
+        "native/frame_cache.cpp",
+        "native/tensor.cpp",
+        "native/metrics.cpp",
+        "native/scene_detector.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -29,6 +49,15 @@
       "cflags_cc": ["-std=c++17"],
       "defines": ["NAPI_DISABLE_CPP_EXCEPTIONS"],
       "conditions": [
+        ["OS!='win' and has_avformat==1", {
+          "defines": ["NWC_HAVE_AVFORMAT"],
+          "include_dirs": [
+            "<!@(pkg-config --cflags-only-I libavformat | sed 's/-I//g')"
+          ],
+          "libraries": [
+            "<!@(pkg-config --libs libavformat)"
+          ]
+        }],
         ["OS=='mac'", {
           "defines": ["__APPLE__"],
           "xcode_settings": {
@@ -1,9 +1,28 @@
 #include "async_decoder.h"
 #include "env_state.h"
 #include "frame.h"
+#include "decoder_setup.h"
+#include "threading.h"
+#include "frame_cache.h"
+#include <algorithm>
+#include <iterator>
 
 Napi::FunctionReference VideoDecoderAsync::constructor;
 
+namespace {
+
+// Resolve a seek that was dropped from the queue by reset() or close()
+void AbortSeek(DecodeJob& job) {
+    if (!job.seek || !job.seek->onDone) return;
+    job.seek->onDone.NonBlockingCall([](Napi::Env env, Napi::Function fn) {
+        fn.Call({ Napi::Error::New(env, "Seek aborted").Value(), Napi::Boolean::New(env, false) });
+    });
+    job.seek->onDone.Release();
+    job.seek->onDone = Napi::ThreadSafeFunction();
+}
+
+} // namespace
+
 Napi::Object VideoDecoderAsync::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "VideoDecoderAsync", {
         InstanceMethod("configure", &VideoDecoderAsync::Configure),
@@ -11,6 +30,9 @@ Napi::Object VideoDecoderAsync::Init(Napi::Env env, Napi::Object exports) {
         InstanceMethod("flush", &VideoDecoderAsync::Flush),
         InstanceMethod("reset", &VideoDecoderAsync::Reset),
         InstanceMethod("close", &VideoDecoderAsync::Close),
+        InstanceMethod("seek", &VideoDecoderAsync::Seek),
+        InstanceMethod("attachCache", &VideoDecoderAsync::AttachCache),
+        InstanceMethod("getDropStats", &VideoDecoderAsync::GetDropStats),
     });
 
     constructor = Napi::Persistent(func);
@@ -87,6 +109,7 @@ VideoDecoderAsync::~VideoDecoderAsync() {
     // Signal worker to stop
     running_ = false;
     queueCV_.notify_all();
+    spaceCV_.notify_all();
 
     // Wait for worker thread to finish
     if (workerThread_.joinable()) {
@@ -118,36 +141,7 @@ void VideoDecoderAsync::Configure(const Napi::CallbackInfo& info) {
     Napi::Object config = info[0].As<Napi::Object>();
     std::string codecName = config.Get("codec").As<Napi::String>().Utf8Value();
 
-    // For H.264 decoding, use the decoder not encoder
-    if (codecName == "libx264") {
-        codecName = "h264";
-    }
-
-    // For AV1, prefer libdav1d
-    if (codecName == "av1") {
-        codec_ = avcodec_find_decoder_by_name("libdav1d");
-        if (!codec_) {
-            codec_ = avcodec_find_decoder_by_name("libaom-av1");
-        }
-        if (!codec_) {
-            codec_ = avcodec_find_decoder(AV_CODEC_ID_AV1);
-        }
-    } else {
-        codec_ = avcodec_find_decoder_by_name(codecName.c_str());
-    }
-
-    if (!codec_) {
-        // Try by codec ID
-        if (codecName == "h264") {
-            codec_ = avcodec_find_decoder(AV_CODEC_ID_H264);
-        } else if (codecName == "vp8") {
-            codec_ = avcodec_find_decoder(AV_CODEC_ID_VP8);
-        } else if (codecName == "vp9") {
-            codec_ = avcodec_find_decoder(AV_CODEC_ID_VP9);
-        } else if (codecName == "hevc") {
-            codec_ = avcodec_find_decoder(AV_CODEC_ID_HEVC);
-        }
-    }
+    codec_ = DecoderSetup::findDecoder(codecName);
 
     if (!codec_) {
         Napi::Error::New(env, "Codec not found: " + codecName).ThrowAsJavaScriptException();
@@ -171,14 +165,22 @@ void VideoDecoderAsync::Configure(const Napi::CallbackInfo& info) {
     // Set extradata
     if (config.Has("extradata")) {
         Napi::Buffer<uint8_t> extradata = config.Get("extradata").As<Napi::Buffer<uint8_t>>();
-        codecCtx_->extradata_size = extradata.Length();
-        codecCtx_->extradata = (uint8_t*)av_malloc(extradata.Length() + AV_INPUT_BUFFER_PADDING_SIZE);
-        memcpy(codecCtx_->extradata, extradata.Data(), extradata.Length());
-        memset(codecCtx_->extradata + extradata.Length(), 0, AV_INPUT_BUFFER_PADDING_SIZE);
+        DecoderSetup::setExtradata(codecCtx_, extradata.Data(), extradata.Length());
     }
 
-    // 0 = auto-detect core count; default of 1 leaves multicore decode on the table
-    codecCtx_->thread_count = 0;
+    // Auto-detect (0) unless a cgroup quota/cpuset caps us below the host
+    // core count; default of 1 leaves multicore decode on the table
+    codecCtx_->thread_count = Threading::codecThreadCount();
+
+    // Per-instance speed/quality trades (lowres, skip_*, dav1d threading)
+    if (config.Has("decoderOptions") && config.Get("decoderOptions").IsObject()) {
+        std::string err = DecoderSetup::applyOptions(codecCtx_, config.Get("decoderOptions").As<Napi::Object>());
+        if (!err.empty()) {
+            avcodec_free_context(&codecCtx_);
+            DecoderSetup::throwOptionsError(env, err);
+            return;
+        }
+    }
 
     // Frame threading buffers ~thread_count frames before output; for
     // latency-sensitive use (seeking, realtime) restrict to slice threading
@@ -188,6 +190,54 @@ void VideoDecoderAsync::Configure(const Napi::CallbackInfo& info) {
         codecCtx_->flags |= AV_CODEC_FLAG_LOW_DELAY;
     }
 
+    // Motion vectors and QP tables, essentially free from the codec
+    if (config.Has("exportCodecAnalysis") && config.Get("exportCodecAnalysis").ToBoolean().Value()) {
+        DecoderSetup::enableCodecAnalysis(codecCtx_);
+    }
+
+    // Thumbnails: delta chunks are dropped before they are queued, and the
+    // codec discards anything non-key that still gets through (e.g. a
+    // keyframe-flagged chunk holding a non-IDR picture)
+    keyframesOnly_ = config.Has("keyframesOnly") && config.Get("keyframesOnly").ToBoolean().Value();
+    if (keyframesOnly_) {
+        codecCtx_->skip_frame = AVDISCARD_NONKEY;
+    }
+
+    // Hand JS frames it can use directly (e.g. RGBA thumbnails) instead of
+    // converting each one on the event loop
+    outputFormat_ = AV_PIX_FMT_NONE;
+    outputWidth_ = 0;
+    outputHeight_ = 0;
+    if (config.Has("outputFormat")) {
+        std::string format = config.Get("outputFormat").As<Napi::String>().Utf8Value();
+        outputFormat_ = StringToPixelFormat(format);
+        if (outputFormat_ == AV_PIX_FMT_NONE) {
+            avcodec_free_context(&codecCtx_);
+            codecCtx_ = nullptr;
+            Napi::TypeError::New(env, "Unsupported output format: " + format).ThrowAsJavaScriptException();
+            return;
+        }
+    }
+    if (config.Has("outputWidth") && config.Has("outputHeight")) {
+        outputWidth_ = config.Get("outputWidth").As<Napi::Number>().Int32Value();
+        outputHeight_ = config.Get("outputHeight").As<Napi::Number>().Int32Value();
+    }
+    outputScaler_.reset();
+
+    // Realtime: rather drop non-reference frames than build latency.
+    // Fixed keyframesOnly skipping takes precedence.
+    dropQueueDepth_ = 0;
+    dropMaxLag_ = 0;
+    if (!keyframesOnly_ && config.Has("adaptiveDrop") && config.Get("adaptiveDrop").IsObject()) {
+        Napi::Object drop = config.Get("adaptiveDrop").As<Napi::Object>();
+        if (drop.Has("queueDepth")) {
+            dropQueueDepth_ = static_cast<size_t>(drop.Get("queueDepth").As<Napi::Number>().Int64Value());
+        }
+        if (drop.Has("maxLag")) {
+            dropMaxLag_ = drop.Get("maxLag").As<Napi::Number>().Int64Value();
+        }
+    }
+
     // Open codec
     int ret = avcodec_open2(codecCtx_, codec_, nullptr);
     if (ret < 0) {
@@ -226,10 +276,14 @@ void VideoDecoderAsync::WorkerThread() {
 
             job = std::move(jobQueue_.front());
             jobQueue_.pop();
+            queueDepth_ = jobQueue_.size();
         }
+        spaceCV_.notify_one();
 
         if (job.isFlush) {
             ProcessFlush();
+        } else if (job.seek) {
+            ProcessSeek(*job.seek);
         } else {
             ProcessDecode(job);
         }
@@ -245,16 +299,33 @@ void VideoDecoderAsync::ProcessDecode(DecodeJob& job) {
         return;
     }
 
-    // Create packet
-    AVPacket* packet = av_packet_alloc();
-    packet->data = job.data.data();
-    packet->size = static_cast<int>(job.data.size());
-    packet->pts = job.timestamp;
-    packet->dts = job.timestamp;
-    packet->duration = job.duration;
+    bool adaptive = dropQueueDepth_ > 0 || dropMaxLag_ > 0;
+    if (adaptive) {
+        UpdateDropLevel(job.isKeyframe);
 
-    if (job.isKeyframe) {
-        packet->flags |= AV_PKT_FLAG_KEY;
+        // Nothing after a skipped delta frame could be reconstructed anyway;
+        // drop it before the codec even parses it
+        if (dropLevel_ == 2 && !job.isKeyframe) {
+            droppedFrames_++;
+            return;
+        }
+    }
+
+    // Create packet; submitted packets are already padded and timestamped
+    AVPacket* packet;
+    if (job.packet) {
+        packet = job.packet.release();
+    } else {
+        packet = av_packet_alloc();
+        packet->data = job.data.data();
+        packet->size = static_cast<int>(job.data.size());
+        packet->pts = job.timestamp;
+        packet->dts = job.timestamp;
+        packet->duration = job.duration;
+
+        if (job.isKeyframe) {
+            packet->flags |= AV_PKT_FLAG_KEY;
+        }
     }
 
     // Send packet to decoder
@@ -275,6 +346,9 @@ void VideoDecoderAsync::ProcessDecode(DecodeJob& job) {
         av_packet_free(&packet);
         return;
     }
+    if (adaptive && packet->pts != AV_NOPTS_VALUE) {
+        pendingPts_.insert(packet->pts);
+    }
 
     // Receive decoded frames
     AVFrame* frame = av_frame_alloc();
@@ -297,8 +371,17 @@ void VideoDecoderAsync::ProcessDecode(DecodeJob& job) {
             break;
         }
 
+        CacheFrame(frame);
+        if (adaptive) {
+            TrackOutput(frame);
+        }
+
         // Clone frame for output
-        AVFrame* outputFrame = av_frame_clone(frame);
+        AVFrame* outputFrame = ConvertOutput(av_frame_clone(frame));
+        if (!outputFrame) {
+            av_frame_unref(frame);
+            continue;
+        }
 
         DecodeResult* result = new DecodeResult();
         result->frame = outputFrame;
@@ -339,7 +422,13 @@ void VideoDecoderAsync::ProcessFlush() {
     AVFrame* frame = av_frame_alloc();
     int ret;
     while ((ret = avcodec_receive_frame(codecCtx_, frame)) >= 0) {
-        AVFrame* outputFrame = av_frame_clone(frame);
+        CacheFrame(frame);
+        TrackOutput(frame);
+        AVFrame* outputFrame = ConvertOutput(av_frame_clone(frame));
+        if (!outputFrame) {
+            av_frame_unref(frame);
+            continue;
+        }
 
         DecodeResult* result = new DecodeResult();
         result->frame = outputFrame;
@@ -365,6 +454,7 @@ void VideoDecoderAsync::ProcessFlush() {
         av_frame_unref(frame);
     }
     av_frame_free(&frame);
+    TrackDrain();
 
     // Draining puts the codec in EOF state; per WebCodecs spec the decoder
     // must accept new chunks after flush(), so reset it
@@ -383,6 +473,183 @@ void VideoDecoderAsync::ProcessFlush() {
     flushPending_ = false;
 }
 
+void VideoDecoderAsync::EmitFrame(AVFrame* frame, int64_t timestamp, int64_t duration) {
+    frame = ConvertOutput(frame);
+    if (!frame) {
+        return;
+    }
+
+    DecodeResult* result = new DecodeResult();
+    result->frame = frame;
+    result->timestamp = timestamp;
+    result->duration = duration;
+    result->isError = false;
+    result->isFlushComplete = false;
+
+    napi_status status = tsfnOutput_.NonBlockingCall(result,
+        [](Napi::Env env, Napi::Function fn, DecodeResult* res) {
+            Napi::Object nativeFrame = VideoFrameNative::NewInstance(env, res->frame);
+
+            fn.Call({
+                nativeFrame,
+                Napi::Number::New(env, static_cast<double>(res->timestamp)),
+                Napi::Number::New(env, static_cast<double>(res->duration))
+            });
+
+            delete res;
+        });
+    if (status != napi_ok) {
+        av_frame_free(&result->frame);
+        delete result;
+    }
+}
+
+// Convert to the configured output format/size through the cached scaler.
+// Frames that already match pass through untouched. Failures are reported
+// through the error callback and the frame is dropped.
+AVFrame* VideoDecoderAsync::ConvertOutput(AVFrame* frame) {
+    if (!frame) {
+        return nullptr;
+    }
+
+    int format = outputFormat_ != AV_PIX_FMT_NONE ? outputFormat_ : frame->format;
+    int width = outputWidth_ > 0 ? outputWidth_ : frame->width;
+    int height = outputHeight_ > 0 ? outputHeight_ : frame->height;
+    if (format == frame->format && width == frame->width && height == frame->height) {
+        return frame;
+    }
+
+    AVFrame* converted = av_frame_alloc();
+    int ret = AVERROR(ENOMEM);
+    if (converted) {
+        converted->format = format;
+        converted->width = width;
+        converted->height = height;
+        ret = outputScaler_.scale(frame, converted);
+    }
+    av_frame_free(&frame);
+
+    if (ret < 0) {
+        av_frame_free(&converted);
+
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        std::string* message = new std::string(std::string("Output conversion failed: ") + errBuf);
+        napi_status status = tsfnError_.NonBlockingCall(message,
+            [](Napi::Env env, Napi::Function fn, std::string* m) {
+                fn.Call({ Napi::String::New(env, *m) });
+                delete m;
+            });
+        if (status != napi_ok) {
+            delete message;
+        }
+        return nullptr;
+    }
+    return converted;
+}
+
+// Decode from the keyframe, keeping only the latest frame presented at or
+// before the target. Frames come out in presentation order, so the first
+// one past the target ends the search without decoding the rest.
+void VideoDecoderAsync::ProcessSeek(SeekRequest& seek) {
+    std::string error;
+    AVFrame* best = nullptr;
+    bool found = false;
+
+    if (!codecCtx_) {
+        error = "Decoder not configured";
+    } else if ((best = LookupCache(seek.target)) != nullptr) {
+        found = true;
+        EmitFrame(best, seek.target, NWC_FRAME_DURATION(best));
+        best = nullptr;
+    } else {
+        // Whatever was in flight belongs to the old position
+        avcodec_flush_buffers(codecCtx_);
+
+        // The target must be reconstructed exactly; load shedding restarts
+        // from full decoding at the new position
+        if (dropLevel_ != 0) {
+            dropLevel_ = 0;
+            codecCtx_->skip_frame = AVDISCARD_DEFAULT;
+        }
+        pendingPts_.clear();
+
+        AVFrame* frame = av_frame_alloc();
+        AVPacket* packet = av_packet_alloc();
+        bool done = false;
+
+        // Returns false once a frame past the target shows up
+        auto consume = [&]() {
+            while (avcodec_receive_frame(codecCtx_, frame) >= 0) {
+                int64_t pts = frame->best_effort_timestamp != AV_NOPTS_VALUE
+                    ? frame->best_effort_timestamp : frame->pts;
+                CacheFrame(frame);  // Neighbours of the target, for the next scrub
+                if (pts > seek.target && best) {
+                    av_frame_unref(frame);
+                    return false;
+                }
+                if (!best) best = av_frame_alloc();
+                av_frame_unref(best);
+                av_frame_move_ref(best, frame);
+                best->pts = pts;
+                if (pts >= seek.target) return false;
+            }
+            return true;
+        };
+
+        for (size_t i = 0; i < seek.chunks.size() && !done; i++) {
+            DecodeJob& chunk = seek.chunks[i];
+            packet->data = chunk.data.data();
+            packet->size = static_cast<int>(chunk.data.size());
+            packet->pts = chunk.timestamp;
+            packet->dts = chunk.timestamp;
+            packet->duration = chunk.duration;
+            packet->flags = chunk.isKeyframe ? AV_PKT_FLAG_KEY : 0;
+
+            int ret = avcodec_send_packet(codecCtx_, packet);
+            if (ret < 0 && ret != AVERROR(EAGAIN)) {
+                char errBuf[256];
+                av_strerror(ret, errBuf, sizeof(errBuf));
+                error = std::string("Decode error: ") + errBuf;
+                break;
+            }
+            done = !consume();
+        }
+        if (!done && error.empty()) {
+            // Target is among the frames the codec still holds back
+            avcodec_send_packet(codecCtx_, nullptr);
+            consume();
+        }
+
+        av_packet_free(&packet);
+        av_frame_free(&frame);
+        avcodec_flush_buffers(codecCtx_);
+
+        if (best && error.empty()) {
+            found = true;
+            EmitFrame(best, best->pts, NWC_FRAME_DURATION(best));
+            best = nullptr;
+        }
+        if (best) av_frame_free(&best);
+    }
+
+    std::string* message = error.empty() ? nullptr : new std::string(error);
+    napi_status status = seek.onDone.NonBlockingCall(message,
+        [found](Napi::Env env, Napi::Function fn, std::string* m) {
+            if (m) {
+                fn.Call({ Napi::Error::New(env, *m).Value(), Napi::Boolean::New(env, false) });
+                delete m;
+            } else {
+                fn.Call({ env.Null(), Napi::Boolean::New(env, found) });
+            }
+        });
+    if (status != napi_ok) {
+        delete message;
+    }
+    seek.onDone.Release();
+    seek.onDone = Napi::ThreadSafeFunction();
+}
+
 void VideoDecoderAsync::Decode(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
@@ -396,6 +663,11 @@ void VideoDecoderAsync::Decode(const Napi::CallbackInfo& info) {
     int64_t timestamp = info[2].As<Napi::Number>().Int64Value();
     int64_t duration = info[3].As<Napi::Number>().Int64Value();
 
+    if (keyframesOnly_ && !isKeyframe) {
+        return;
+    }
+    newestQueued_ = timestamp;
+
     // Copy data for async processing
     DecodeJob job;
     job.data.assign(data.Data(), data.Data() + data.Length());
@@ -412,6 +684,46 @@ void VideoDecoderAsync::Decode(const Napi::CallbackInfo& info) {
     JobSubmitted(env);
 }
 
+bool VideoDecoderAsync::SubmitPacket(AVPacket* packet) {
+    if (keyframesOnly_ && !(packet->flags & AV_PKT_FLAG_KEY)) {
+        av_packet_free(&packet);
+        return true;  // Consumed; the producer keeps reading
+    }
+
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    spaceCV_.wait(lock, [this] {
+        return jobQueue_.size() < kMaxSubmitted || !running_;
+    });
+
+    if (!running_ || !configured_) {
+        av_packet_free(&packet);
+        return false;
+    }
+
+    if (packet->pts != AV_NOPTS_VALUE) {
+        newestQueued_ = packet->pts;
+    }
+
+    DecodeJob job;
+    job.isKeyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+    job.timestamp = packet->pts;
+    job.duration = packet->duration;
+    job.isFlush = false;
+    job.packet.reset(packet);
+
+    // JobSubmitted must run on the JS thread. Queued on the same TSFN as
+    // the worker's JobFinished, so it always runs first. Close() takes the
+    // queue lock before releasing the TSFN, so it's still valid here.
+    tsfnJobDone_.NonBlockingCall([this](Napi::Env env, Napi::Function) {
+        if (running_) JobSubmitted(env);
+    });
+    jobQueue_.push(std::move(job));
+    lock.unlock();
+
+    queueCV_.notify_one();
+    return true;
+}
+
 Napi::Value VideoDecoderAsync::Flush(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
@@ -448,24 +760,177 @@ Napi::Value VideoDecoderAsync::Flush(const Napi::CallbackInfo& info) {
     return env.Undefined();
 }
 
+// attachCache(frameCache | null): cache every decoded frame, including the
+// ones seek() decodes and discards, and let seek() hit it first
+void VideoDecoderAsync::AttachCache(const Napi::CallbackInfo& info) {
+    FrameCache* cache = nullptr;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        cache = FrameCache::Unwrap(info[0].As<Napi::Object>());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        cache_ = cache;
+    }
+
+    if (cache) {
+        cacheRef_ = Napi::Persistent(info[0].As<Napi::Object>());
+    } else {
+        cacheRef_.Reset();
+    }
+}
+
+// Keyed by the frame's own timestamp: with frame threading and reordering
+// the frame coming out is usually not the packet just sent
+void VideoDecoderAsync::CacheFrame(const AVFrame* frame) {
+    int64_t pts = frame->best_effort_timestamp != AV_NOPTS_VALUE
+        ? frame->best_effort_timestamp : frame->pts;
+    if (pts == AV_NOPTS_VALUE) return;
+
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    if (cache_) {
+        cache_->Put(frame, pts);
+    }
+}
+
+AVFrame* VideoDecoderAsync::LookupCache(int64_t timestamp) {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    return cache_ ? cache_->Lookup(timestamp) : nullptr;
+}
+
+// Escalate straight to the level the current pressure calls for; step back
+// down only once it has clearly eased (below 1x for NONKEY, 0.5x for
+// NONREF) so the mode doesn't flap around a threshold. Leaving NONKEY
+// waits for a keyframe: the delta frames after a skipped one have lost
+// their references. NONREF skips nothing another frame depends on.
+void VideoDecoderAsync::UpdateDropLevel(bool keyframe) {
+    if (dropTrackReset_.exchange(false)) {
+        pendingPts_.clear();
+        lastOutput_ = AV_NOPTS_VALUE;
+    }
+
+    double pressure = 0;
+    if (dropQueueDepth_ > 0) {
+        pressure = static_cast<double>(queueDepth_) / dropQueueDepth_;
+    }
+    int64_t newest = newestQueued_;
+    if (dropMaxLag_ > 0 && newest != AV_NOPTS_VALUE && lastOutput_ != AV_NOPTS_VALUE) {
+        pressure = std::max(pressure, static_cast<double>(newest - lastOutput_) / dropMaxLag_);
+    }
+
+    int level = dropLevel_;
+    if (pressure >= 2) {
+        level = 2;
+    } else if (pressure >= 1) {
+        level = std::max(level, 1);
+        if (level == 2 && keyframe) level = 1;
+    } else if (level == 2) {
+        if (keyframe) level = pressure < 0.5 ? 0 : 1;
+    } else if (pressure < 0.5) {
+        level = 0;
+    }
+
+    if (level != dropLevel_) {
+        dropLevel_ = level;
+        codecCtx_->skip_frame = level == 2 ? AVDISCARD_NONKEY
+                              : level == 1 ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    }
+}
+
+// Frames come out in presentation order, so once a frame is output every
+// earlier timestamp still pending was skipped by the codec
+void VideoDecoderAsync::TrackOutput(const AVFrame* frame) {
+    int64_t pts = frame->best_effort_timestamp != AV_NOPTS_VALUE
+        ? frame->best_effort_timestamp : frame->pts;
+    if (pts == AV_NOPTS_VALUE) return;
+
+    lastOutput_ = pts;
+    if (pendingPts_.empty()) return;
+
+    auto passed = pendingPts_.lower_bound(pts);
+    droppedFrames_ += static_cast<uint64_t>(std::distance(pendingPts_.begin(), passed));
+    if (passed != pendingPts_.end() && *passed == pts) ++passed;
+    pendingPts_.erase(pendingPts_.begin(), passed);
+}
+
+// After a drain the codec holds nothing back; whatever is pending was skipped
+void VideoDecoderAsync::TrackDrain() {
+    droppedFrames_ += pendingPts_.size();
+    pendingPts_.clear();
+}
+
+// getDropStats(): { level, droppedFrames } for adaptiveDrop
+Napi::Value VideoDecoderAsync::GetDropStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("level", Napi::Number::New(env, dropLevel_.load()));
+    stats.Set("droppedFrames", Napi::Number::New(env, static_cast<double>(droppedFrames_.load())));
+    return stats;
+}
+
+// seek(target, chunks: [{ data, key, timestamp, duration }], callback(err, found))
+// chunks start at the keyframe at or before target, in decode order
+void VideoDecoderAsync::Seek(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Function callback = info[2].As<Napi::Function>();
+
+    if (!configured_) {
+        callback.Call({ Napi::Error::New(env, "Decoder not configured").Value(), Napi::Boolean::New(env, false) });
+        return;
+    }
+
+    auto seek = std::make_unique<SeekRequest>();
+    seek->target = info[0].As<Napi::Number>().Int64Value();
+
+    Napi::Array chunks = info[1].As<Napi::Array>();
+    seek->chunks.resize(chunks.Length());
+    for (uint32_t i = 0; i < chunks.Length(); i++) {
+        Napi::Object chunk = chunks.Get(i).As<Napi::Object>();
+        Napi::Buffer<uint8_t> data = chunk.Get("data").As<Napi::Buffer<uint8_t>>();
+        DecodeJob& job = seek->chunks[i];
+        job.data.assign(data.Data(), data.Data() + data.Length());
+        job.isKeyframe = chunk.Get("key").ToBoolean().Value();
+        job.timestamp = chunk.Get("timestamp").As<Napi::Number>().Int64Value();
+        job.duration = chunk.Get("duration").As<Napi::Number>().Int64Value();
+        job.isFlush = false;
+    }
+    seek->onDone = Napi::ThreadSafeFunction::New(env, callback, "VideoDecoderAsyncSeek", 0, 1);
+
+    DecodeJob job;
+    job.isFlush = false;
+    job.seek = std::move(seek);
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        jobQueue_.push(std::move(job));
+    }
+    queueCV_.notify_one();
+    JobSubmitted(env);
+}
+
 void VideoDecoderAsync::Reset(const Napi::CallbackInfo& info) {
     // Clear queue
     {
         std::lock_guard<std::mutex> lock(queueMutex_);
         while (!jobQueue_.empty()) {
+            AbortSeek(jobQueue_.front());
             jobQueue_.pop();
         }
     }
+    spaceCV_.notify_all();
 
     if (codecCtx_) {
         avcodec_flush_buffers(codecCtx_);
     }
+    newestQueued_ = AV_NOPTS_VALUE;
+    dropTrackReset_ = true;
 }
 
 void VideoDecoderAsync::Close(const Napi::CallbackInfo& info) {
     // Stop worker thread
     running_ = false;
     queueCV_.notify_all();
+    spaceCV_.notify_all();
 
     if (workerThread_.joinable()) {
         workerThread_.join();
@@ -475,6 +940,7 @@ void VideoDecoderAsync::Close(const Napi::CallbackInfo& info) {
     {
         std::lock_guard<std::mutex> lock(queueMutex_);
         while (!jobQueue_.empty()) {
+            AbortSeek(jobQueue_.front());
             jobQueue_.pop();
         }
     }
@@ -496,5 +962,11 @@ void VideoDecoderAsync::Close(const Napi::CallbackInfo& info) {
         Unref();  // balance the in-flight pin; queued JobFinished sees 0 and skips
     }
 
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        cache_ = nullptr;
+    }
+    cacheRef_.Reset();
+
     configured_ = false;
 }
@@ -7,6 +7,9 @@
 #include <condition_variable>
 #include <thread>
 #include <atomic>
+#include <memory>
+#include <set>
+#include "scaler.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -14,13 +17,30 @@ extern "C" {
 #include <libavutil/imgutils.h>
 }
 
+struct PacketDeleter {
+    void operator()(AVPacket* packet) const { av_packet_free(&packet); }
+};
+
+struct SeekRequest;
+class FrameCache;
+
 // Job to be processed by worker thread
 struct DecodeJob {
     std::vector<uint8_t> data;
+    std::unique_ptr<AVPacket, PacketDeleter> packet;  // Instead of data, from SubmitPacket
     bool isKeyframe;
     int64_t timestamp;
     int64_t duration;
     bool isFlush;
+    std::unique_ptr<SeekRequest> seek;  // Seek job instead of a chunk
+};
+
+// seek(): decode chunks (keyframe first) and output only the frame shown
+// at target
+struct SeekRequest {
+    int64_t target;
+    std::vector<DecodeJob> chunks;
+    Napi::ThreadSafeFunction onDone;  // (err, found)
 };
 
 // Result from worker thread back to JS
@@ -39,7 +59,17 @@ public:
     VideoDecoderAsync(const Napi::CallbackInfo& info);
     ~VideoDecoderAsync();
 
+    /**
+     * Queue a packet from a native producer thread (Demuxer) instead of
+     * decode(). Takes ownership; pts/duration must be in microseconds.
+     * Blocks while kMaxSubmitted jobs are queued so a fast producer can't
+     * read a whole file ahead of the decoder. Returns false once closed.
+     */
+    bool SubmitPacket(AVPacket* packet);
+
 private:
+    static constexpr size_t kMaxSubmitted = 16;
+
     static Napi::FunctionReference constructor;
 
     // JavaScript-facing methods
@@ -48,6 +78,9 @@ private:
     Napi::Value Flush(const Napi::CallbackInfo& info);
     void Reset(const Napi::CallbackInfo& info);
     void Close(const Napi::CallbackInfo& info);
+    void Seek(const Napi::CallbackInfo& info);
+    void AttachCache(const Napi::CallbackInfo& info);
+    Napi::Value GetDropStats(const Napi::CallbackInfo& info);
 
     // Worker thread entry point
     void WorkerThread();
@@ -55,6 +88,16 @@ private:
     // Process a single decode job (runs on worker thread)
     void ProcessDecode(DecodeJob& job);
     void ProcessFlush();
+    void ProcessSeek(SeekRequest& seek);
+    void EmitFrame(AVFrame* frame, int64_t timestamp, int64_t duration);  // Takes ownership
+    AVFrame* ConvertOutput(AVFrame* frame);  // Takes ownership; nullptr on failure
+    void CacheFrame(const AVFrame* frame);  // Under its best-effort timestamp
+    AVFrame* LookupCache(int64_t timestamp);
+
+    // Adaptive dropping (worker thread)
+    void UpdateDropLevel(bool keyframe);
+    void TrackOutput(const AVFrame* frame);
+    void TrackDrain();
 
     // Thread-safe functions for callbacks to JS
     Napi::ThreadSafeFunction tsfnOutput_;
@@ -75,6 +118,7 @@ private:
     std::queue<DecodeJob> jobQueue_;
     std::mutex queueMutex_;
     std::condition_variable queueCV_;
+    std::condition_variable spaceCV_;  // SubmitPacket waits for queue room
 
     // Flush synchronization
     std::atomic<bool> flushPending_{false};
@@ -82,6 +126,36 @@ private:
     // FFmpeg context (owned/accessed by worker thread after configure)
     AVCodecContext* codecCtx_;
     const AVCodec* codec_;
+
+    // Configuration (set on main thread before the worker starts)
+    std::atomic<bool> keyframesOnly_{false};  // Delta chunks are never queued
+
+    // Output conversion (outputFormat/outputWidth/outputHeight): frames are
+    // converted and scaled on the worker before they reach JS
+    AVPixelFormat outputFormat_ = AV_PIX_FMT_NONE;  // NONE = decoder's format
+    int outputWidth_ = 0;                            // 0 = decoded size
+    int outputHeight_ = 0;
+    FrameScaler outputScaler_;                       // Worker thread only
+
+    // Adaptive dropping (adaptiveDrop): under load the codec skips
+    // non-reference pictures, then everything but keyframes. Pressure is the
+    // larger of queue depth / dropQueueDepth_ and lag / dropMaxLag_; 0
+    // disables that trigger. Both 0 disables the mode.
+    size_t dropQueueDepth_ = 0;
+    int64_t dropMaxLag_ = 0;           // Microseconds
+    std::atomic<int> dropLevel_{0};    // 0 full, 1 AVDISCARD_NONREF, 2 AVDISCARD_NONKEY
+    std::atomic<uint64_t> droppedFrames_{0};
+    std::atomic<int64_t> newestQueued_{AV_NOPTS_VALUE};  // Latest timestamp decode() queued
+    std::atomic<bool> dropTrackReset_{false};            // reset(): forget pendingPts_
+    size_t queueDepth_ = 0;            // Jobs behind the current one, at pop
+    int64_t lastOutput_ = AV_NOPTS_VALUE;
+    std::set<int64_t> pendingPts_;     // Sent, not yet output or passed
+
+    // Attached frame cache (attachCache); cacheRef_ keeps it alive,
+    // cacheMutex_ guards swapping it under a running worker
+    FrameCache* cache_ = nullptr;
+    Napi::ObjectReference cacheRef_;
+    std::mutex cacheMutex_;
 };
 
 #endif // ASYNC_DECODER_H
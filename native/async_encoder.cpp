@@ -3,6 +3,9 @@
 #include "frame.h"
 #include "color.h"
 #include "svc.h"
+#include "encoder_setup.h"
+#include "threading.h"
+#include "muxer.h"
 
 Napi::FunctionReference VideoEncoderAsync::constructor;
 
@@ -13,6 +16,8 @@ Napi::Object VideoEncoderAsync::Init(Napi::Env env, Napi::Object exports) {
         InstanceMethod("flush", &VideoEncoderAsync::Flush),
         InstanceMethod("reset", &VideoEncoderAsync::Reset),
         InstanceMethod("close", &VideoEncoderAsync::Close),
+        InstanceMethod("attachMuxer", &VideoEncoderAsync::AttachMuxer),
+        InstanceMethod("getSceneStats", &VideoEncoderAsync::GetSceneStats),
     });
 
     constructor = Napi::Persistent(func);
@@ -40,7 +45,10 @@ VideoEncoderAsync::VideoEncoderAsync(const Napi::CallbackInfo& info)
     , alpha_(false)
     , scalabilityMode_("")
     , temporalLayers_(1)
-    , latencyMode_("quality") {
+    , temporalLayered_(false)
+    , svcFrameIndex_(0)
+    , latencyMode_("quality")
+    , latencyBudgetUs_(0) {
 
     Napi::Env env = info.Env();
 
@@ -71,6 +79,17 @@ VideoEncoderAsync::VideoEncoderAsync(const Napi::CallbackInfo& info)
     tsfnOutput_.Unref(env);
     tsfnError_.Unref(env);
 
+    if (info.Length() > 2 && info[2].IsFunction()) {
+        tsfnDrop_ = Napi::ThreadSafeFunction::New(
+            env,
+            info[2].As<Napi::Function>(),
+            "VideoEncoderAsyncDrop",
+            0,
+            1
+        );
+        tsfnDrop_.Unref(env);
+    }
+
     // Fires on the JS thread after the worker finishes each job, so the
     // in-flight ref count and event-loop ref are only touched on one thread
     tsfnJobDone_ = Napi::ThreadSafeFunction::New(
@@ -129,118 +148,11 @@ VideoEncoderAsync::~VideoEncoderAsync() {
         if (tsfnOutput_) tsfnOutput_.Release();
         if (tsfnError_) tsfnError_.Release();
         if (tsfnFlush_) tsfnFlush_.Release();
+        if (tsfnDrop_) tsfnDrop_.Release();
         if (tsfnJobDone_) tsfnJobDone_.Release();
     }
 }
 
-void VideoEncoderAsync::configureEncoderOptions(const std::string& encoderName, const std::string& latencyMode) {
-    bool isRealtime = (latencyMode == "realtime");
-
-    // Global realtime optimizations
-    if (isRealtime) {
-        codecCtx_->thread_count = 1;
-        codecCtx_->thread_type = 0;
-        codecCtx_->delay = 0;
-        codecCtx_->max_b_frames = 0;
-        codecCtx_->refs = 1;
-    } else {
-        // 0 = auto-detect core count; default of 1 leaves multicore encode on the table
-        codecCtx_->thread_count = 0;
-    }
-
-    if (encoderName == "libx264") {
-        if (isRealtime) {
-            av_opt_set(codecCtx_->priv_data, "preset", "ultrafast", 0);
-            av_opt_set(codecCtx_->priv_data, "tune", "zerolatency", 0);
-            av_opt_set(codecCtx_->priv_data, "rc-lookahead", "0", 0);
-            av_opt_set(codecCtx_->priv_data, "sync-lookahead", "0", 0);
-            av_opt_set(codecCtx_->priv_data, "intra-refresh", "1", 0);
-        } else {
-            // OPTIMIZATION: Use faster presets for smaller resolutions
-            // This maintains quality for large frames while speeding up small ones
-            int pixels = width_ * height_;
-            const char* preset;
-            if (pixels <= 320 * 240) {           // QVGA or smaller
-                preset = "ultrafast";
-            } else if (pixels <= 640 * 480) {    // VGA or smaller
-                preset = "superfast";
-            } else if (pixels <= 1280 * 720) {   // 720p or smaller
-                preset = "veryfast";
-            } else {
-                preset = "medium";                // HD and above: quality matters
-            }
-            av_opt_set(codecCtx_->priv_data, "preset", preset, 0);
-        }
-    }
-    else if (encoderName == "h264_videotoolbox" || encoderName == "hevc_videotoolbox") {
-        av_opt_set(codecCtx_->priv_data, "realtime", isRealtime ? "1" : "0", 0);
-        av_opt_set(codecCtx_->priv_data, "allow_sw", "1", 0);
-    }
-    else if (encoderName == "h264_nvenc" || encoderName == "hevc_nvenc") {
-        if (isRealtime) {
-            av_opt_set(codecCtx_->priv_data, "preset", "p1", 0);
-            av_opt_set(codecCtx_->priv_data, "tune", "ll", 0);
-            av_opt_set(codecCtx_->priv_data, "zerolatency", "1", 0);
-            av_opt_set(codecCtx_->priv_data, "rc-lookahead", "0", 0);
-        } else {
-            av_opt_set(codecCtx_->priv_data, "preset", "p4", 0);
-        }
-        av_opt_set(codecCtx_->priv_data, "rc", "cbr", 0);
-    }
-    else if (encoderName == "h264_qsv" || encoderName == "hevc_qsv") {
-        if (isRealtime) {
-            av_opt_set(codecCtx_->priv_data, "preset", "veryfast", 0);
-            av_opt_set(codecCtx_->priv_data, "low_delay_brc", "1", 0);
-            av_opt_set(codecCtx_->priv_data, "look_ahead", "0", 0);
-        }
-    }
-    else if (encoderName == "libvpx" || encoderName == "libvpx-vp9") {
-        if (codecCtx_->bit_rate > 0) {
-            av_opt_set_int(codecCtx_->priv_data, "crf", 10, 0);
-            av_opt_set_int(codecCtx_->priv_data, "b", codecCtx_->bit_rate, 0);
-        }
-        // libvpx only parallelizes with row-mt and, for VP9, tiles
-        av_opt_set_int(codecCtx_->priv_data, "row-mt", 1, 0);
-        if (encoderName == "libvpx-vp9" && width_ >= 1280) {
-            av_opt_set_int(codecCtx_->priv_data, "tile-columns", 2, 0);
-        }
-        if (isRealtime) {
-            av_opt_set_int(codecCtx_->priv_data, "cpu-used", 8, 0);
-            av_opt_set_int(codecCtx_->priv_data, "lag-in-frames", 0, 0);
-            av_opt_set(codecCtx_->priv_data, "deadline", "realtime", 0);
-        } else {
-            av_opt_set_int(codecCtx_->priv_data, "cpu-used", 4, 0);
-        }
-    }
-    else if (encoderName == "libx265") {
-        if (isRealtime) {
-            av_opt_set(codecCtx_->priv_data, "preset", "ultrafast", 0);
-            av_opt_set(codecCtx_->priv_data, "tune", "zerolatency", 0);
-        } else {
-            // OPTIMIZATION: Use faster presets for smaller resolutions
-            int pixels = width_ * height_;
-            const char* preset;
-            if (pixels <= 640 * 480) {
-                preset = "ultrafast";
-            } else if (pixels <= 1280 * 720) {
-                preset = "veryfast";
-            } else {
-                preset = "medium";
-            }
-            av_opt_set(codecCtx_->priv_data, "preset", preset, 0);
-        }
-    }
-    else if (encoderName == "libaom-av1" || encoderName == "libsvtav1") {
-        if (isRealtime) {
-            av_opt_set_int(codecCtx_->priv_data, "cpu-used", 10, 0);
-            av_opt_set_int(codecCtx_->priv_data, "lag-in-frames", 0, 0);
-            av_opt_set(codecCtx_->priv_data, "usage", "realtime", 0);
-        } else {
-            av_opt_set_int(codecCtx_->priv_data, "cpu-used", 6, 0);
-        }
-    }
-}
-
 void VideoEncoderAsync::Configure(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
@@ -306,35 +218,7 @@ void VideoEncoderAsync::Configure(const Napi::CallbackInfo& info) {
     }
 
     // Configure rate control
-    if (bitrateMode_ == "constant") {
-        codecCtx_->bit_rate = bitrate_;
-        codecCtx_->rc_min_rate = bitrate_;
-        codecCtx_->rc_max_rate = bitrate_;
-        codecCtx_->rc_buffer_size = static_cast<int>(bitrate_);
-
-        if (codecName_.find("libx264") != std::string::npos) {
-            av_opt_set(codecCtx_->priv_data, "nal-hrd", "cbr", 0);
-        } else if (codecName_.find("libvpx") != std::string::npos) {
-            av_opt_set_int(codecCtx_->priv_data, "minrate", bitrate_, 0);
-            av_opt_set_int(codecCtx_->priv_data, "maxrate", bitrate_, 0);
-        }
-    } else if (bitrateMode_ == "quantizer") {
-        codecCtx_->bit_rate = 0;
-        codecCtx_->rc_max_rate = 0;
-
-        if (codecName_.find("libx264") != std::string::npos ||
-            codecName_.find("libx265") != std::string::npos) {
-            av_opt_set_int(codecCtx_->priv_data, "crf", 23, 0);
-        } else if (codecName_.find("libvpx") != std::string::npos) {
-            av_opt_set_int(codecCtx_->priv_data, "crf", 30, 0);
-            codecCtx_->qmin = 0;
-            codecCtx_->qmax = 63;
-        } else if (codecName_.find("av1") != std::string::npos) {
-            av_opt_set_int(codecCtx_->priv_data, "crf", 30, 0);
-        }
-    } else {
-        codecCtx_->bit_rate = bitrate_;
-    }
+    EncoderSetup::applyRateControl(codecCtx_, bitrateMode_, bitrate_);
 
     // Framerate
     int fps = 30;
@@ -351,13 +235,25 @@ void VideoEncoderAsync::Configure(const Napi::CallbackInfo& info) {
         alpha_ = (alphaMode == "keep");
     }
 
+    // Codec-string profile (H.264 profile_idc, HEVC/VP9/AV1 profile), -1 if none
+    int profile = -1;
+    if (config.Has("profile") && config.Get("profile").IsNumber()) {
+        profile = config.Get("profile").As<Napi::Number>().Int32Value();
+    }
+
+    // Expected input format hint; lets software encoders take it as-is
+    AVPixelFormat inputFormat = AV_PIX_FMT_NONE;
+    if (config.Has("inputFormat") && config.Get("inputFormat").IsString()) {
+        inputFormat = StringToPixelFormat(config.Get("inputFormat").As<Napi::String>().Utf8Value());
+    }
+
     // Pixel format
     if (hwType_ != HWAccel::Type::None && hwInputFormat_ != AV_PIX_FMT_NONE) {
         codecCtx_->pix_fmt = hwInputFormat_;
     } else if (alpha_ && (codecName_.find("libvpx") != std::string::npos)) {
         codecCtx_->pix_fmt = AV_PIX_FMT_YUVA420P;
     } else {
-        codecCtx_->pix_fmt = AV_PIX_FMT_YUV420P;
+        codecCtx_->pix_fmt = NegotiateEncoderPixelFormat(codec_, inputFormat, profile);
     }
 
     // Color space
@@ -408,80 +304,74 @@ void VideoEncoderAsync::Configure(const Napi::CallbackInfo& info) {
 
     // Profile for H.264
     std::string encoderName = codec_->name;
-    if (encoderName == "libx264" && config.Has("profile")) {
-        int profile = config.Get("profile").As<Napi::Number>().Int32Value();
-        switch (profile) {
-            case 66: av_opt_set(codecCtx_->priv_data, "profile", "baseline", 0); break;
-            case 77: av_opt_set(codecCtx_->priv_data, "profile", "main", 0); break;
-            case 100: av_opt_set(codecCtx_->priv_data, "profile", "high", 0); break;
-            default: av_opt_set(codecCtx_->priv_data, "profile", "main", 0); break;
-        }
-    }
+    EncoderSetup::applyH264Profile(codecCtx_, profile);
 
-    // AVC format
+    // AVC format; length-prefixed output keeps parameter sets out of band
+    avcAnnexB_ = true;
     if (config.Has("avcFormat")) {
         std::string format = config.Get("avcFormat").As<Napi::String>().Utf8Value();
         avcAnnexB_ = (format == "annexb");
     }
+    if (!avcAnnexB_) {
+        codecCtx_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
 
     // Latency mode
     if (config.Has("latencyMode")) {
         latencyMode_ = config.Get("latencyMode").As<Napi::String>().Utf8Value();
     }
-    configureEncoderOptions(encoderName, latencyMode_);
+    EncoderSetup::applyTuning(codecCtx_, latencyMode_);
+
+    // Realtime overload policy: shed frames that waited longer than this
+    latencyBudgetUs_ = 0;
+    if (latencyMode_ == "realtime" && config.Has("latencyBudget") &&
+        config.Get("latencyBudget").IsNumber()) {
+        double budgetMs = config.Get("latencyBudget").As<Napi::Number>().DoubleValue();
+        if (budgetMs > 0) {
+            latencyBudgetUs_ = static_cast<int64_t>(budgetMs * 1000);
+        }
+    }
+
+    // Scene detection, evaluated per frame on the worker
+    sceneKeyframes_ = false;
+    skipDuplicates_ = false;
+    if (config.Has("sceneDetection") && config.Get("sceneDetection").IsObject()) {
+        Napi::Object scene = config.Get("sceneDetection").As<Napi::Object>();
+        scene_.thresholds = ParseSceneThresholds(scene);
+        sceneKeyframes_ = scene.Has("keyframeOnSceneChange") &&
+            scene.Get("keyframeOnSceneChange").ToBoolean().Value();
+        skipDuplicates_ = scene.Has("skipDuplicates") &&
+            scene.Get("skipDuplicates").ToBoolean().Value();
+    }
+    sceneReset_ = true;
 
     // Scalability mode (SVC)
+    scalabilityMode_.clear();
+    temporalLayers_ = 1;
+    temporalLayered_ = false;
     if (config.Has("scalabilityMode") && config.Get("scalabilityMode").IsString()) {
         std::string svcMode = config.Get("scalabilityMode").As<Napi::String>().Utf8Value();
 
         if (!isScalabilityModeSupported(svcMode)) {
-            Napi::Error::New(env, "Unsupported scalabilityMode: " + svcMode)
+            Napi::Error::New(env, unsupportedScalabilityModeMessage(svcMode))
                 .ThrowAsJavaScriptException();
             return;
         }
 
         ScalabilityConfig svcConfig = parseScalabilityMode(svcMode);
 
-        if (svcConfig.temporalLayers > 1) {
-            temporalLayers_ = svcConfig.temporalLayers;
-
-            if (encoderName.find("libvpx") != std::string::npos) {
-                av_opt_set(codecCtx_->priv_data, "lag-in-frames", "0", 0);
-                av_opt_set(codecCtx_->priv_data, "error-resilient", "1", 0);
-                av_opt_set_int(codecCtx_->priv_data, "auto-alt-ref", 0, 0);
-
-                char tsParams[256];
-                int layers = svcConfig.temporalLayers;
-
-                if (layers == 2) {
-                    int br0 = static_cast<int>(bitrate_ * 0.6 / 1000);
-                    int br1 = static_cast<int>(bitrate_ / 1000);
-                    snprintf(tsParams, sizeof(tsParams),
-                        "ts_number_layers=2:ts_target_bitrate=%d,%d:ts_rate_decimator=2,1:ts_periodicity=2:ts_layer_id=0,1",
-                        br0, br1);
-                } else if (layers == 3) {
-                    int br0 = static_cast<int>(bitrate_ * 0.25 / 1000);
-                    int br1 = static_cast<int>(bitrate_ * 0.5 / 1000);
-                    int br2 = static_cast<int>(bitrate_ / 1000);
-                    snprintf(tsParams, sizeof(tsParams),
-                        "ts_number_layers=3:ts_target_bitrate=%d,%d,%d:ts_rate_decimator=4,2,1:ts_periodicity=4:ts_layer_id=0,2,1,2",
-                        br0, br1, br2);
-                }
-
-                av_opt_set(codecCtx_->priv_data, "ts-parameters", tsParams, 0);
-            }
-            else if (encoderName.find("libaom") != std::string::npos ||
-                     encoderName.find("av1") != std::string::npos) {
-                av_opt_set(codecCtx_->priv_data, "lag-in-frames", "0", 0);
-                av_opt_set(codecCtx_->priv_data, "usage", "realtime", 0);
-            }
-            else if (encoderName.find("libsvtav1") != std::string::npos) {
-                char hierLevels[8];
-                snprintf(hierLevels, sizeof(hierLevels), "%d", svcConfig.temporalLayers - 1);
-                av_opt_set(codecCtx_->priv_data, "hierarchical-levels", hierLevels, 0);
-            }
+        if (svcConfig.isSimulcast && svcConfig.spatialLayers > 1) {
+            // VideoEncoder runs simulcast on VideoLadderEncoder; one codec
+            // context can't produce independent streams
+            Napi::Error::New(env, "Simulcast needs one context per stream: " + svcMode)
+                .ThrowAsJavaScriptException();
+            return;
         }
 
+        temporalLayers_ = svcConfig.temporalLayers;
+        temporalLayered_ = EncoderSetup::applyTemporalLayers(codecCtx_, svcConfig.temporalLayers, bitrate_);
+        svcFrameIndex_ = 0;
+
         scalabilityMode_ = svcMode;
     }
 
@@ -495,6 +385,10 @@ void VideoEncoderAsync::Configure(const Napi::CallbackInfo& info) {
     if (ret < 0) {
         char errBuf[256];
         av_strerror(ret, errBuf, sizeof(errBuf));
+        AVColorPrimaries primaries = codecCtx_->color_primaries;
+        AVColorTransferCharacteristic transfer = codecCtx_->color_trc;
+        AVColorSpace matrix = codecCtx_->colorspace;
+        AVColorRange range = codecCtx_->color_range;
         avcodec_free_context(&codecCtx_);
         codecCtx_ = nullptr;
 
@@ -519,13 +413,26 @@ void VideoEncoderAsync::Configure(const Napi::CallbackInfo& info) {
                 codecCtx_->width = width_;
                 codecCtx_->height = height_;
                 codecCtx_->time_base = { 1, 1000000 };
-                codecCtx_->bit_rate = bitrate_;
                 codecCtx_->gop_size = fps;
                 codecCtx_->framerate = { fps, 1 };
                 codecCtx_->max_b_frames = 0;
-                codecCtx_->pix_fmt = AV_PIX_FMT_YUV420P;
+                codecCtx_->pix_fmt = NegotiateEncoderPixelFormat(codec_, inputFormat, profile);
+                codecCtx_->color_primaries = primaries;
+                codecCtx_->color_trc = transfer;
+                codecCtx_->colorspace = matrix;
+                codecCtx_->color_range = range;
+                if (!avcAnnexB_) {
+                    codecCtx_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+                }
 
-                configureEncoderOptions(codec_->name, latencyMode_);
+                // Everything set up above was on the hardware context
+                EncoderSetup::applyRateControl(codecCtx_, bitrateMode_, bitrate_);
+                EncoderSetup::applyH264Profile(codecCtx_, profile);
+                EncoderSetup::applyTuning(codecCtx_, latencyMode_);
+                if (!scalabilityMode_.empty()) {
+                    temporalLayered_ = EncoderSetup::applyTemporalLayers(codecCtx_, temporalLayers_, bitrate_);
+                    svcFrameIndex_ = 0;
+                }
 
                 ret = avcodec_open2(codecCtx_, codec_, nullptr);
                 if (ret < 0) {
@@ -545,6 +452,7 @@ void VideoEncoderAsync::Configure(const Napi::CallbackInfo& info) {
         }
     }
 
+    bitstream_.configure(codecCtx_, avcAnnexB_);
     configured_ = true;
 
     // Start worker thread
@@ -555,6 +463,7 @@ void VideoEncoderAsync::Configure(const Napi::CallbackInfo& info) {
 void VideoEncoderAsync::WorkerThread() {
     while (running_) {
         EncodeJob job;
+        std::vector<int64_t> dropped;
 
         {
             std::unique_lock<std::mutex> lock(queueMutex_);
@@ -570,8 +479,16 @@ void VideoEncoderAsync::WorkerThread() {
                 continue;
             }
 
+            if (latencyBudgetUs_ > 0) {
+                DropStaleFrames(dropped);
+            }
+
             job = std::move(jobQueue_.front());
-            jobQueue_.pop();
+            jobQueue_.pop_front();
+        }
+
+        if (!dropped.empty()) {
+            ReportDrops(std::move(dropped));
         }
 
         if (job.isFlush) {
@@ -586,6 +503,103 @@ void VideoEncoderAsync::WorkerThread() {
     }
 }
 
+// Once the oldest queued frame has waited past the latency budget, skip
+// ahead: keep only the freshest frame before the next flush, plus any frame
+// the caller asked to be a keyframe. A backlog then costs one stale frame
+// instead of growing glass-to-glass latency without bound.
+void VideoEncoderAsync::DropStaleFrames(std::vector<int64_t>& dropped) {
+    if (jobQueue_.empty() || jobQueue_.front().isFlush) {
+        return;
+    }
+
+    auto age = std::chrono::steady_clock::now() - jobQueue_.front().enqueued;
+    if (std::chrono::duration_cast<std::chrono::microseconds>(age).count() <= latencyBudgetUs_) {
+        return;
+    }
+
+    size_t barrier = 0;
+    while (barrier < jobQueue_.size() && !jobQueue_[barrier].isFlush) {
+        barrier++;
+    }
+    size_t freshest = barrier - 1;
+
+    std::deque<EncodeJob> kept;
+    for (size_t i = 0; i < jobQueue_.size(); i++) {
+        EncodeJob& job = jobQueue_[i];
+        if (i < freshest && !job.forceKeyframe) {
+            dropped.push_back(job.timestamp);
+            av_frame_free(&job.frame);
+        } else {
+            kept.push_back(std::move(job));
+        }
+    }
+    jobQueue_.swap(kept);
+}
+
+void VideoEncoderAsync::ReportDrops(std::vector<int64_t> dropped) {
+    size_t count = dropped.size();
+
+    if (tsfnDrop_) {
+        auto* timestamps = new std::vector<int64_t>(std::move(dropped));
+        napi_status status = tsfnDrop_.NonBlockingCall(timestamps,
+            [](Napi::Env env, Napi::Function fn, std::vector<int64_t>* ts) {
+                Napi::Array arr = Napi::Array::New(env, ts->size());
+                for (size_t i = 0; i < ts->size(); i++) {
+                    arr.Set(i, Napi::Number::New(env, static_cast<double>((*ts)[i])));
+                }
+                fn.Call({ arr });
+                delete ts;
+            });
+        if (status != napi_ok) {
+            delete timestamps;
+        }
+    }
+
+    // Dropped jobs never reach the per-job completion in WorkerThread
+    tsfnJobDone_.NonBlockingCall([this, count](Napi::Env env, Napi::Function) {
+        for (size_t i = 0; i < count; i++) {
+            JobFinished(env);
+        }
+    });
+}
+
+// metadata.svc.temporalLayerId for the next output packet, -1 without a
+// scalabilityMode. No B-frames or lag with SVC, so packets come out in
+// input order and the encoder's layer pattern can be followed by count.
+int VideoEncoderAsync::NextTemporalLayerId() {
+    if (scalabilityMode_.empty()) {
+        return -1;
+    }
+    return temporalLayered_ ? temporalLayerId(temporalLayers_, svcFrameIndex_++) : 0;
+}
+
+// Score the source frame against the last one encoded, before conversion.
+// A skipped duplicate doesn't become the reference, so a slow fade is still
+// measured against what the decoder last showed. Frames the caller asked to
+// be keyframes are always encoded.
+bool VideoEncoderAsync::ApplySceneDetection(EncodeJob& job) {
+    if (sceneReset_.exchange(false)) {
+        scene_.reset();
+    }
+
+    SceneScore score;
+    if (!scene_.analyze(job.frame, score)) {
+        return true;
+    }
+
+    if (skipDuplicates_ && score.duplicate && !job.forceKeyframe) {
+        duplicatesSkipped_++;
+        return false;
+    }
+    scene_.commit();
+
+    if (sceneKeyframes_ && score.sceneChange && !score.first) {
+        job.forceKeyframe = true;
+        sceneChanges_++;
+    }
+    return true;
+}
+
 void VideoEncoderAsync::ProcessEncode(EncodeJob& job) {
     if (!codecCtx_) {
         if (job.frame) {
@@ -594,6 +608,11 @@ void VideoEncoderAsync::ProcessEncode(EncodeJob& job) {
         return;
     }
 
+    if ((sceneKeyframes_ || skipDuplicates_) && !ApplySceneDetection(job)) {
+        av_frame_free(&job.frame);
+        return;
+    }
+
     AVFrame* srcFrame = job.frame;
 
     // Determine target pixel format
@@ -603,9 +622,8 @@ void VideoEncoderAsync::ProcessEncode(EncodeJob& job) {
     }
 
     // Check for alpha
-    bool inputHasAlpha = (srcFrame->format == AV_PIX_FMT_RGBA ||
-                          srcFrame->format == AV_PIX_FMT_BGRA ||
-                          srcFrame->format == AV_PIX_FMT_YUVA420P);
+    const AVPixFmtDescriptor* srcDesc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(srcFrame->format));
+    bool inputHasAlpha = srcDesc && (srcDesc->flags & AV_PIX_FMT_FLAG_ALPHA);
 
     if (alpha_ && inputHasAlpha && targetFormat == AV_PIX_FMT_YUV420P) {
         targetFormat = AV_PIX_FMT_YUVA420P;
@@ -649,7 +667,7 @@ void VideoEncoderAsync::ProcessEncode(EncodeJob& job) {
             av_opt_set_int(swsCtx_, "dsth", height_, 0);
             av_opt_set_int(swsCtx_, "dst_format", targetFormat, 0);
             av_opt_set_int(swsCtx_, "sws_flags", SWS_BILINEAR, 0);
-            av_opt_set_int(swsCtx_, "threads", 0, 0);
+            av_opt_set_int(swsCtx_, "threads", Threading::swsThreadCount(), 0);
             if (sws_init_context(swsCtx_, nullptr, nullptr) < 0) {
                 sws_freeContext(swsCtx_);
                 swsCtx_ = nullptr;
@@ -724,18 +742,25 @@ void VideoEncoderAsync::ProcessEncode(EncodeJob& job) {
             break;
         }
 
+        if (SendToMuxer(packet)) {
+            NextTemporalLayerId();
+            av_packet_unref(packet);
+            continue;
+        }
+
         // Create result
         EncodeResult* result = new EncodeResult();
-        result->data.assign(packet->data, packet->data + packet->size);
+        bitstream_.convert(packet, result->data);
         result->isKeyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
         result->pts = packet->pts;
         result->duration = packet->duration;
         result->isError = false;
         result->isFlushComplete = false;
+        result->temporalLayerId = NextTemporalLayerId();
 
-        // Include extradata for keyframes
-        if (result->isKeyframe && codecCtx_->extradata && codecCtx_->extradata_size > 0) {
-            result->extradata.assign(codecCtx_->extradata, codecCtx_->extradata + codecCtx_->extradata_size);
+        // Include the decoder description (avcC/hvcC for avcFormat "avc") for keyframes
+        if (result->isKeyframe && !bitstream_.description().empty()) {
+            result->extradata = bitstream_.description();
             result->hasExtradata = true;
         } else {
             result->hasExtradata = false;
@@ -758,7 +783,9 @@ void VideoEncoderAsync::ProcessEncode(EncodeJob& job) {
                 Napi::Number::New(env, static_cast<double>(res->pts)),
                 Napi::Number::New(env, static_cast<double>(res->duration)),
                 extradataValue,
-                env.Undefined()  // alphaSideData (not supported in async yet)
+                env.Undefined(),  // alphaSideData (not supported in async yet)
+                res->temporalLayerId >= 0
+                    ? Napi::Number::New(env, res->temporalLayerId) : env.Undefined()
             });
 
             delete res;
@@ -782,14 +809,29 @@ void VideoEncoderAsync::ProcessFlush() {
     AVPacket* packet = av_packet_alloc();
     int ret;
     while ((ret = avcodec_receive_packet(codecCtx_, packet)) >= 0) {
+        if (SendToMuxer(packet)) {
+            NextTemporalLayerId();
+            av_packet_unref(packet);
+            continue;
+        }
+
         EncodeResult* result = new EncodeResult();
-        result->data.assign(packet->data, packet->data + packet->size);
+        bitstream_.convert(packet, result->data);
         result->isKeyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
         result->pts = packet->pts;
         result->duration = packet->duration;
         result->isError = false;
         result->isFlushComplete = false;
-        result->hasExtradata = false;
+        result->temporalLayerId = NextTemporalLayerId();
+
+        // With frame threading the first keyframe may only come out here;
+        // it needs the description as much as one from ProcessEncode
+        if (result->isKeyframe && !bitstream_.description().empty()) {
+            result->extradata = bitstream_.description();
+            result->hasExtradata = true;
+        } else {
+            result->hasExtradata = false;
+        }
 
         // Use NonBlockingCall to prevent deadlock in resource-constrained environments
         // (CI, serverless, containers) where the JS event loop may be starved
@@ -797,13 +839,21 @@ void VideoEncoderAsync::ProcessFlush() {
             Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::Copy(
                 env, res->data.data(), res->data.size());
 
+            Napi::Value extradataValue = env.Undefined();
+            if (res->hasExtradata) {
+                extradataValue = Napi::Buffer<uint8_t>::Copy(
+                    env, res->extradata.data(), res->extradata.size());
+            }
+
             fn.Call({
                 buffer,
                 Napi::Boolean::New(env, res->isKeyframe),
                 Napi::Number::New(env, static_cast<double>(res->pts)),
                 Napi::Number::New(env, static_cast<double>(res->duration)),
+                extradataValue,
                 env.Undefined(),
-                env.Undefined()
+                res->temporalLayerId >= 0
+                    ? Napi::Number::New(env, res->temporalLayerId) : env.Undefined()
             });
 
             delete res;
@@ -858,11 +908,11 @@ void VideoEncoderAsync::Encode(const Napi::CallbackInfo& info) {
         return;
     }
 
-    EncodeJob job{frameCopy, timestamp, forceKeyframe, false};
+    EncodeJob job{frameCopy, timestamp, forceKeyframe, false, std::chrono::steady_clock::now()};
 
     {
         std::lock_guard<std::mutex> lock(queueMutex_);
-        jobQueue_.push(std::move(job));
+        jobQueue_.push_back(std::move(job));
     }
     queueCV_.notify_one();
     JobSubmitted(env);
@@ -891,11 +941,11 @@ Napi::Value VideoEncoderAsync::Flush(const Napi::CallbackInfo& info) {
     flushPending_ = true;
 
     // Queue flush job
-    EncodeJob job{nullptr, 0, false, true};
+    EncodeJob job{nullptr, 0, false, true, std::chrono::steady_clock::now()};
 
     {
         std::lock_guard<std::mutex> lock(queueMutex_);
-        jobQueue_.push(std::move(job));
+        jobQueue_.push_back(std::move(job));
     }
     queueCV_.notify_one();
     JobSubmitted(env);
@@ -913,13 +963,14 @@ void VideoEncoderAsync::Reset(const Napi::CallbackInfo& info) {
             if (job.frame) {
                 av_frame_free(&job.frame);
             }
-            jobQueue_.pop();
+            jobQueue_.pop_front();
         }
     }
 
     if (codecCtx_) {
         avcodec_flush_buffers(codecCtx_);
     }
+    sceneReset_ = true;
 }
 
 void VideoEncoderAsync::Close(const Napi::CallbackInfo& info) {
@@ -939,7 +990,7 @@ void VideoEncoderAsync::Close(const Napi::CallbackInfo& info) {
             if (job.frame) {
                 av_frame_free(&job.frame);
             }
-            jobQueue_.pop();
+            jobQueue_.pop_front();
         }
     }
 
@@ -963,17 +1014,81 @@ void VideoEncoderAsync::Close(const Napi::CallbackInfo& info) {
         avcodec_free_context(&codecCtx_);
         codecCtx_ = nullptr;
     }
+    bitstream_.reset();
 
     // Worker is joined, so no more calls are queued; release now and null the
     // handles so the destructor doesn't touch already-finalized functions
     if (tsfnOutput_) { tsfnOutput_.Release(); tsfnOutput_ = Napi::ThreadSafeFunction(); }
     if (tsfnError_) { tsfnError_.Release(); tsfnError_ = Napi::ThreadSafeFunction(); }
     if (tsfnFlush_) { tsfnFlush_.Release(); tsfnFlush_ = Napi::ThreadSafeFunction(); }
+    if (tsfnDrop_) { tsfnDrop_.Release(); tsfnDrop_ = Napi::ThreadSafeFunction(); }
     if (tsfnJobDone_) { tsfnJobDone_.Release(); tsfnJobDone_ = Napi::ThreadSafeFunction(); }
     if (activeJobs_ > 0) {
         activeJobs_ = 0;
         Unref();  // balance the in-flight pin; queued JobFinished sees 0 and skips
     }
 
+    {
+        std::lock_guard<std::mutex> lock(muxerMutex_);
+        muxer_ = nullptr;
+    }
+    muxerRef_.Reset();
+
     configured_ = false;
 }
+
+// getSceneStats() -> { sceneChanges, duplicatesSkipped } since creation
+Napi::Value VideoEncoderAsync::GetSceneStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("sceneChanges", Napi::Number::New(env, static_cast<double>(sceneChanges_.load())));
+    stats.Set("duplicatesSkipped", Napi::Number::New(env, static_cast<double>(duplicatesSkipped_.load())));
+    return stats;
+}
+
+// attachMuxer(muxer | null, trackIndex): route output packets to a native
+// Muxer on the worker thread; the output callback no longer sees them
+void VideoEncoderAsync::AttachMuxer(const Napi::CallbackInfo& info) {
+#ifdef NWC_HAVE_AVFORMAT
+    Muxer* muxer = nullptr;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        muxer = Muxer::Unwrap(info[0].As<Napi::Object>());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(muxerMutex_);
+        muxer_ = muxer;
+        muxerTrack_ = info.Length() > 1 && info[1].IsNumber()
+            ? info[1].As<Napi::Number>().Int32Value() : 0;
+    }
+
+    if (muxer) {
+        muxerRef_ = Napi::Persistent(info[0].As<Napi::Object>());
+    } else {
+        muxerRef_.Reset();
+    }
+#else
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Error::New(info.Env(), "Native addon was built without libavformat").ThrowAsJavaScriptException();
+    }
+#endif
+}
+
+bool VideoEncoderAsync::SendToMuxer(AVPacket* packet) {
+#ifdef NWC_HAVE_AVFORMAT
+    std::lock_guard<std::mutex> lock(muxerMutex_);
+    if (!muxer_) {
+        return false;
+    }
+
+    bool isKey = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+    bool withConfig = isKey && codecCtx_->extradata && codecCtx_->extradata_size > 0;
+    // A finalized muxer drops the packet; it still doesn't go to JS
+    muxer_->SubmitPacket(muxerTrack_, packet,
+                         withConfig ? codecCtx_->extradata : nullptr,
+                         withConfig ? codecCtx_->extradata_size : 0);
+    return true;
+#else
+    return false;
+#endif
+}
@@ -2,12 +2,15 @@
 #define ASYNC_ENCODER_H
 
 #include <napi.h>
-#include <queue>
+#include <deque>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <atomic>
 #include "hw_accel.h"
+#include "bitstream.h"
+#include "scene_detector.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -17,12 +20,15 @@ extern "C" {
 #include <libswscale/swscale.h>
 }
 
+class Muxer;
+
 // Job to be processed by worker thread
 struct EncodeJob {
     AVFrame* frame;
     int64_t timestamp;
     bool forceKeyframe;
     bool isFlush;  // True if this is a flush signal
+    std::chrono::steady_clock::time_point enqueued;  // For the latency budget
 };
 
 // Result from worker thread back to JS
@@ -36,6 +42,7 @@ struct EncodeResult {
     bool isError;
     std::string errorMessage;
     bool isFlushComplete;
+    int temporalLayerId;  // -1 without a scalabilityMode
 };
 
 class VideoEncoderAsync : public Napi::ObjectWrap<VideoEncoderAsync> {
@@ -53,6 +60,8 @@ private:
     Napi::Value Flush(const Napi::CallbackInfo& info);
     void Reset(const Napi::CallbackInfo& info);
     void Close(const Napi::CallbackInfo& info);
+    void AttachMuxer(const Napi::CallbackInfo& info);
+    Napi::Value GetSceneStats(const Napi::CallbackInfo& info);
 
     // Worker thread entry point
     void WorkerThread();
@@ -61,13 +70,22 @@ private:
     void ProcessEncode(EncodeJob& job);
     void ProcessFlush();
 
-    // Helper to configure encoder options
-    void configureEncoderOptions(const std::string& encoderName, const std::string& latencyMode);
+    // Realtime overload policy; DropStaleFrames runs with queueMutex_ held
+    void DropStaleFrames(std::vector<int64_t>& dropped);
+    void ReportDrops(std::vector<int64_t> dropped);
+    int NextTemporalLayerId();
+
+    // sceneDetection: false if the frame is a duplicate to skip (worker thread)
+    bool ApplySceneDetection(EncodeJob& job);
+
+    // Hand a packet to the attached muxer instead of JS; false if none
+    bool SendToMuxer(AVPacket* packet);
 
     // Thread-safe functions for callbacks to JS
     Napi::ThreadSafeFunction tsfnOutput_;
     Napi::ThreadSafeFunction tsfnError_;
     Napi::ThreadSafeFunction tsfnFlush_;
+    Napi::ThreadSafeFunction tsfnDrop_;  // Optional; frames shed under the latency budget
 
     // Worker thread
     std::thread workerThread_;
@@ -80,7 +98,7 @@ private:
     std::atomic<bool> configured_{false};
 
     // Job queue with synchronization
-    std::queue<EncodeJob> jobQueue_;
+    std::deque<EncodeJob> jobQueue_;
     std::mutex queueMutex_;
     std::condition_variable queueCV_;
 
@@ -101,6 +119,9 @@ private:
     AVBufferRef* hwFramesCtx_;
     AVPixelFormat hwInputFormat_;
 
+    // H.264/HEVC framing for avcFormat (worker thread after configure)
+    BitstreamConverter bitstream_;
+
     // Configuration (set on main thread, read on worker)
     bool avcAnnexB_;
     int width_;
@@ -111,7 +132,26 @@ private:
     bool alpha_;
     std::string scalabilityMode_;
     int temporalLayers_;
+    bool temporalLayered_;    // Encoder follows temporalLayerId()'s pattern
+    int64_t svcFrameIndex_;   // Worker thread only
     std::string latencyMode_;
+    int64_t latencyBudgetUs_;  // 0 = never drop
+
+    // Scene-cut keyframes and duplicate skipping (sceneDetection); the
+    // analyzer is worker-thread only, sceneReset_ asks it to start over
+    SceneAnalyzer scene_;
+    bool sceneKeyframes_ = false;
+    bool skipDuplicates_ = false;
+    std::atomic<bool> sceneReset_{false};
+    std::atomic<int64_t> sceneChanges_{0};
+    std::atomic<int64_t> duplicatesSkipped_{0};
+
+    // Attached muxer (attachMuxer); muxerRef_ keeps it alive, muxerMutex_
+    // guards swapping it under a running worker
+    Muxer* muxer_ = nullptr;
+    int muxerTrack_ = 0;
+    Napi::ObjectReference muxerRef_;
+    std::mutex muxerMutex_;
 };
 
 #endif // ASYNC_ENCODER_H
@@ -0,0 +1,494 @@
+#include "batch_decoder.h"
+#include "env_state.h"
+#include "frame.h"
+#include "decoder_setup.h"
+#include "threading.h"
+#include <algorithm>
+#include <cstring>
+
+Napi::FunctionReference VideoBatchDecoder::constructor;
+
+Napi::Object VideoBatchDecoder::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "VideoBatchDecoder", {
+        InstanceMethod("configure", &VideoBatchDecoder::Configure),
+        InstanceMethod("decode", &VideoBatchDecoder::Decode),
+        InstanceMethod("reset", &VideoBatchDecoder::Reset),
+        InstanceMethod("close", &VideoBatchDecoder::Close),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("VideoBatchDecoder", func);
+    return exports;
+}
+
+VideoBatchDecoder::VideoBatchDecoder(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<VideoBatchDecoder>(info)
+    , width_(0)
+    , height_(0)
+    , concurrency_(1)
+    , reorderWindow_(2)
+    , threadBudget_(0) {
+
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2) {
+        Napi::TypeError::New(env, "Expected 2 callbacks").ThrowAsJavaScriptException();
+        return;
+    }
+
+    tsfnOutput_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[0].As<Napi::Function>(),
+        "VideoBatchDecoderOutput",
+        0,
+        1
+    );
+
+    tsfnError_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[1].As<Napi::Function>(),
+        "VideoBatchDecoderError",
+        0,
+        1
+    );
+
+    // Idle decoders don't hold the event loop; in-flight jobs do (JobSubmitted)
+    tsfnOutput_.Unref(env);
+    tsfnError_.Unref(env);
+
+    tsfnJobDone_ = Napi::ThreadSafeFunction::New(
+        env,
+        Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+        "VideoBatchDecoderJobDone",
+        0,
+        1
+    );
+    tsfnJobDone_.Unref(env);
+}
+
+VideoBatchDecoder::~VideoBatchDecoder() {
+    StopWorkers();
+
+    if (!nwc_env_teardown.load()) {
+        if (tsfnOutput_) tsfnOutput_.Release();
+        if (tsfnError_) tsfnError_.Release();
+        if (tsfnJobDone_) tsfnJobDone_.Release();
+    }
+}
+
+// Hold the event loop open while jobs are in flight (JS thread only)
+void VideoBatchDecoder::JobSubmitted(Napi::Env env) {
+    if (activeJobs_++ == 0) {
+        tsfnOutput_.Ref(env);
+        Ref();
+    }
+}
+
+void VideoBatchDecoder::JobFinished(Napi::Env env) {
+    if (activeJobs_ > 0 && --activeJobs_ == 0) {
+        tsfnOutput_.Unref(env);
+        Unref();
+    }
+}
+
+void VideoBatchDecoder::Configure(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!info[0].IsObject()) {
+        Napi::TypeError::New(env, "Config must be an object").ThrowAsJavaScriptException();
+        return;
+    }
+
+    StopWorkers();
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    codecName_ = config.Get("codec").As<Napi::String>().Utf8Value();
+
+    width_ = 0;
+    height_ = 0;
+    if (config.Has("width")) {
+        width_ = config.Get("width").As<Napi::Number>().Int32Value();
+    }
+    if (config.Has("height")) {
+        height_ = config.Get("height").As<Napi::Number>().Int32Value();
+    }
+
+    extradata_.clear();
+    if (config.Has("extradata")) {
+        Napi::Buffer<uint8_t> extradata = config.Get("extradata").As<Napi::Buffer<uint8_t>>();
+        extradata_.assign(extradata.Data(), extradata.Data() + extradata.Length());
+    }
+
+    // Frame-threaded decoders scale to a few threads each; past that,
+    // more ranges in flight beat wider decoders
+    int cores = Threading::budget().effectiveCores;
+    concurrency_ = std::max(1, cores / 2);
+    if (config.Has("concurrency") && config.Get("concurrency").IsNumber()) {
+        concurrency_ = config.Get("concurrency").As<Napi::Number>().Int32Value();
+    }
+
+    reorderWindow_ = concurrency_ * 2;
+    if (config.Has("reorderWindow") && config.Get("reorderWindow").IsNumber()) {
+        reorderWindow_ = config.Get("reorderWindow").As<Napi::Number>().Int32Value();
+    }
+
+    if (concurrency_ <= 0 || reorderWindow_ <= 0) {
+        Napi::TypeError::New(env, "concurrency and reorderWindow must be positive").ThrowAsJavaScriptException();
+        return;
+    }
+    threadBudget_ = std::max(1, cores / concurrency_);
+
+    // Open one context up front so a bad config throws here, not on a worker
+    std::string error;
+    AVCodecContext* probe = OpenContext(error);
+    if (!probe) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return;
+    }
+    avcodec_free_context(&probe);
+
+    configured_ = true;
+    for (int i = 0; i < concurrency_; i++) {
+        workers_.emplace_back(&VideoBatchDecoder::WorkerThread, this);
+    }
+}
+
+AVCodecContext* VideoBatchDecoder::OpenContext(std::string& error) {
+    const AVCodec* codec = DecoderSetup::findDecoder(codecName_);
+    if (!codec) {
+        error = "Codec not found: " + codecName_;
+        return nullptr;
+    }
+
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    if (!ctx) {
+        error = "Failed to allocate codec context";
+        return nullptr;
+    }
+
+    ctx->width = width_;
+    ctx->height = height_;
+    DecoderSetup::setExtradata(ctx, extradata_.data(), extradata_.size());
+    ctx->thread_count = threadBudget_;
+
+    int ret = avcodec_open2(ctx, codec, nullptr);
+    if (ret < 0) {
+        avcodec_free_context(&ctx);
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        error = std::string("Failed to open codec: ") + errBuf;
+        return nullptr;
+    }
+
+    return ctx;
+}
+
+void VideoBatchDecoder::WorkerThread() {
+    std::string error;
+    AVCodecContext* ctx = OpenContext(error);
+    if (!ctx) {
+        ReportError(error);
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+    GopRange* range = nullptr;
+
+    while (rangeQueue_.pop(range)) {
+        {
+            // Reorder window: don't run too far ahead of the range being emitted
+            std::unique_lock<std::mutex> lock(emitMutex_);
+            emitCv_.wait(lock, [this, range] {
+                return stopping_ || range->index < nextToEmit_ + reorderWindow_;
+            });
+            if (stopping_) {
+                FreeRange(range);
+                break;
+            }
+        }
+
+        DecodedRange* out = new DecodedRange();
+        if (ctx) {
+            DecodeRange(ctx, packet, frame, *range, *out);
+        }
+
+        int64_t index = range->index;
+        FreeRange(range);
+        range = nullptr;
+
+        // A failed range still completes, so later ones aren't held back
+        CompleteRange(index, out);
+    }
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    if (ctx) avcodec_free_context(&ctx);
+}
+
+void VideoBatchDecoder::DecodeRange(AVCodecContext* ctx, AVPacket* packet, AVFrame* frame,
+                                    GopRange& range, DecodedRange& out) {
+    auto drain = [&]() {
+        int ret;
+        while ((ret = avcodec_receive_frame(ctx, frame)) >= 0) {
+            out.frames.push_back(av_frame_clone(frame));
+            av_frame_unref(frame);
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+            char errBuf[256];
+            av_strerror(ret, errBuf, sizeof(errBuf));
+            ReportError(std::string("Decode error: ") + errBuf);
+        }
+    };
+
+    for (BatchPacket& p : range.packets) {
+        packet->data = p.data.data();
+        packet->size = p.size;
+        packet->pts = p.timestamp;
+        packet->dts = p.timestamp;
+        packet->duration = p.duration;
+        packet->flags = p.isKeyframe ? AV_PKT_FLAG_KEY : 0;
+
+        int ret = avcodec_send_packet(ctx, packet);
+        if (ret < 0) {
+            char errBuf[256];
+            av_strerror(ret, errBuf, sizeof(errBuf));
+            ReportError(std::string("Decode error: ") + errBuf);
+            continue;
+        }
+        drain();
+    }
+
+    // Drain the range's tail, then back out of EOF for the next range
+    avcodec_send_packet(ctx, nullptr);
+    drain();
+    avcodec_flush_buffers(ctx);
+
+    // Null slots from a failed clone are skipped at emit
+    out.frames.erase(std::remove(out.frames.begin(), out.frames.end(), nullptr), out.frames.end());
+}
+
+void VideoBatchDecoder::CompleteRange(int64_t index, DecodedRange* out) {
+    std::lock_guard<std::mutex> lock(emitMutex_);
+    completed_[index] = out;
+
+    // Emit every range that is now contiguous with what's been emitted
+    auto it = completed_.find(nextToEmit_);
+    while (it != completed_.end()) {
+        DecodedRange* ready = it->second;
+        completed_.erase(it);
+
+        napi_status status = tsfnOutput_.BlockingCall(ready,
+            [](Napi::Env env, Napi::Function fn, DecodedRange* r) {
+                for (AVFrame*& f : r->frames) {
+                    int64_t timestamp = f->pts;
+                    int64_t duration = NWC_FRAME_DURATION(f);
+                    // The wrapper takes ownership of the frame
+                    Napi::Object nativeFrame = VideoFrameNative::NewInstance(env, f);
+                    f = nullptr;
+
+                    fn.Call({
+                        nativeFrame,
+                        Napi::Number::New(env, static_cast<double>(timestamp)),
+                        Napi::Number::New(env, static_cast<double>(duration))
+                    });
+                }
+                FreeDecoded(r);
+            });
+        if (status != napi_ok) {
+            FreeDecoded(ready);
+        }
+
+        tsfnJobDone_.NonBlockingCall([this](Napi::Env env, Napi::Function) {
+            JobFinished(env);
+        });
+
+        nextToEmit_++;
+        it = completed_.find(nextToEmit_);
+    }
+    emitCv_.notify_all();
+
+    // Resolve decode() calls whose ranges are all out
+    for (auto b = batches_.begin(); b != batches_.end();) {
+        if (b->target > nextToEmit_) {
+            ++b;
+            continue;
+        }
+        b->callback.NonBlockingCall([](Napi::Env env, Napi::Function fn) {
+            fn.Call({ env.Null() });
+        });
+        b->callback.Release();
+        tsfnJobDone_.NonBlockingCall([this](Napi::Env env, Napi::Function) {
+            JobFinished(env);
+        });
+        b = batches_.erase(b);
+    }
+}
+
+void VideoBatchDecoder::ReportError(const std::string& message) {
+    auto* msg = new std::string(message);
+    napi_status status = tsfnError_.NonBlockingCall(msg,
+        [](Napi::Env env, Napi::Function fn, std::string* m) {
+            fn.Call({ Napi::String::New(env, *m) });
+            delete m;
+        });
+    if (status != napi_ok) {
+        delete msg;
+    }
+}
+
+// decode(chunks: Array<{ data, key, timestamp, duration }>, callback)
+// Chunks before the first keyframe can't be decoded on their own and are
+// skipped.
+Napi::Value VideoBatchDecoder::Decode(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!configured_) {
+        Napi::Error::New(env, "Decoder not configured").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsFunction()) {
+        Napi::TypeError::New(env, "Expected (chunks, callback)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Array chunks = info[0].As<Napi::Array>();
+    Napi::Function callback = info[1].As<Napi::Function>();
+
+    // Split at keyframes; every range starts on one
+    std::vector<GopRange*> ranges;
+    for (uint32_t i = 0; i < chunks.Length(); i++) {
+        Napi::Object chunk = chunks.Get(i).As<Napi::Object>();
+        bool isKeyframe = chunk.Get("key").ToBoolean().Value();
+        if (isKeyframe) {
+            GopRange* range = new GopRange();
+            range->index = rangesDispatched_ + static_cast<int64_t>(ranges.size());
+            ranges.push_back(range);
+        }
+        if (ranges.empty()) {
+            continue;
+        }
+
+        Napi::Buffer<uint8_t> data = chunk.Get("data").As<Napi::Buffer<uint8_t>>();
+        BatchPacket p;
+        p.size = static_cast<int>(data.Length());
+        p.data.resize(data.Length() + AV_INPUT_BUFFER_PADDING_SIZE, 0);
+        memcpy(p.data.data(), data.Data(), data.Length());
+        p.timestamp = chunk.Get("timestamp").As<Napi::Number>().Int64Value();
+        p.duration = chunk.Has("duration") && chunk.Get("duration").IsNumber()
+            ? chunk.Get("duration").As<Napi::Number>().Int64Value()
+            : 0;
+        p.isKeyframe = isKeyframe;
+        ranges.back()->packets.push_back(std::move(p));
+    }
+
+    for (GopRange* range : ranges) {
+        if (!rangeQueue_.push(range)) {
+            FreeRange(range);
+            continue;
+        }
+        rangesDispatched_++;
+        JobSubmitted(env);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(emitMutex_);
+        if (nextToEmit_ < rangesDispatched_) {
+            PendingBatch batch;
+            batch.target = rangesDispatched_;
+            batch.callback = Napi::ThreadSafeFunction::New(
+                env,
+                callback,
+                "VideoBatchDecoderDone",
+                0,
+                1
+            );
+            batches_.push_back(std::move(batch));
+            JobSubmitted(env);
+            return env.Undefined();
+        }
+    }
+
+    callback.Call({ env.Null() });
+    return env.Undefined();
+}
+
+void VideoBatchDecoder::FreeRange(GopRange* range) {
+    delete range;
+}
+
+void VideoBatchDecoder::FreeDecoded(DecodedRange* decoded) {
+    if (!decoded) {
+        return;
+    }
+    for (AVFrame*& frame : decoded->frames) {
+        if (frame) av_frame_free(&frame);
+    }
+    delete decoded;
+}
+
+// Stop and join every worker, dropping queued ranges, undelivered frames and
+// unresolved batches. Safe to call when not configured.
+void VideoBatchDecoder::StopWorkers() {
+    configured_ = false;
+
+    {
+        std::lock_guard<std::mutex> lock(emitMutex_);
+        stopping_ = true;
+    }
+    emitCv_.notify_all();
+
+    rangeQueue_.close();
+    rangeQueue_.drain(FreeRange);
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    rangeQueue_.drain(FreeRange);
+    rangeQueue_.reopen();
+
+    std::lock_guard<std::mutex> lock(emitMutex_);
+    for (auto& entry : completed_) {
+        FreeDecoded(entry.second);
+    }
+    completed_.clear();
+    for (PendingBatch& batch : batches_) {
+        // Dropped by close()/reset(); never resolves
+        if (!nwc_env_teardown.load()) {
+            batch.callback.Release();
+        }
+    }
+    batches_.clear();
+
+    nextToEmit_ = 0;
+    rangesDispatched_ = 0;
+    stopping_ = false;
+}
+
+void VideoBatchDecoder::Reset(const Napi::CallbackInfo& info) {
+    StopWorkers();
+
+    if (activeJobs_ > 0) {
+        activeJobs_ = 0;
+        tsfnOutput_.Unref(info.Env());
+        Unref();  // balance the in-flight pin; queued JobFinished sees 0 and skips
+    }
+}
+
+void VideoBatchDecoder::Close(const Napi::CallbackInfo& info) {
+    StopWorkers();
+
+    // Workers are joined, so no more calls are queued; release now and null
+    // the handles so the destructor doesn't touch finalized functions
+    if (tsfnOutput_) { tsfnOutput_.Release(); tsfnOutput_ = Napi::ThreadSafeFunction(); }
+    if (tsfnError_) { tsfnError_.Release(); tsfnError_ = Napi::ThreadSafeFunction(); }
+    if (tsfnJobDone_) { tsfnJobDone_.Release(); tsfnJobDone_ = Napi::ThreadSafeFunction(); }
+    if (activeJobs_ > 0) {
+        activeJobs_ = 0;
+        Unref();
+    }
+}
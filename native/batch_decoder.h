@@ -0,0 +1,110 @@
+#ifndef BATCH_DECODER_H
+#define BATCH_DECODER_H
+
+#include <napi.h>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "work_queue.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+/**
+ * GOP-parallel batch decoder for offline analysis.
+ *
+ * Each decode() call takes a list of chunks, splits it at keyframes into
+ * independent ranges, and decodes the ranges concurrently, one codec
+ * context per worker thread. Frames are emitted strictly in range order,
+ * so output is in presentation order for closed-GOP streams.
+ *
+ * reorderWindow bounds memory: a worker won't start range i until range
+ * i - reorderWindow has been emitted, so at most that many ranges of
+ * decoded frames are held while waiting on a slow earlier range.
+ */
+class VideoBatchDecoder : public Napi::ObjectWrap<VideoBatchDecoder> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    VideoBatchDecoder(const Napi::CallbackInfo& info);
+    ~VideoBatchDecoder();
+
+private:
+    static Napi::FunctionReference constructor;
+
+    struct BatchPacket {
+        std::vector<uint8_t> data;  // Padded with AV_INPUT_BUFFER_PADDING_SIZE zeros
+        int size;
+        int64_t timestamp;
+        int64_t duration;
+        bool isKeyframe;
+    };
+
+    struct GopRange {
+        int64_t index;
+        std::vector<BatchPacket> packets;
+    };
+
+    struct DecodedRange {
+        std::vector<AVFrame*> frames;
+    };
+
+    struct PendingBatch {
+        int64_t target;  // Resolves once this many ranges have been emitted
+        Napi::ThreadSafeFunction callback;
+    };
+
+    // JavaScript-facing methods
+    void Configure(const Napi::CallbackInfo& info);
+    Napi::Value Decode(const Napi::CallbackInfo& info);
+    void Reset(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    void StopWorkers();
+    static void FreeRange(GopRange* range);
+    static void FreeDecoded(DecodedRange* decoded);
+
+    // Worker threads
+    AVCodecContext* OpenContext(std::string& error);
+    void WorkerThread();
+    void DecodeRange(AVCodecContext* ctx, AVPacket* packet, AVFrame* frame,
+                     GopRange& range, DecodedRange& out);
+    void CompleteRange(int64_t index, DecodedRange* out);
+    void ReportError(const std::string& message);
+
+    Napi::ThreadSafeFunction tsfnOutput_;
+    Napi::ThreadSafeFunction tsfnError_;
+    Napi::ThreadSafeFunction tsfnJobDone_;
+    int activeJobs_ = 0;
+    void JobSubmitted(Napi::Env env);
+    void JobFinished(Napi::Env env);
+    std::atomic<bool> configured_{false};
+
+    WorkQueue<GopRange*> rangeQueue_;
+    std::vector<std::thread> workers_;
+    int64_t rangesDispatched_ = 0;  // JS thread only
+
+    // Ordered emission and the reorder window
+    std::mutex emitMutex_;
+    std::condition_variable emitCv_;
+    std::map<int64_t, DecodedRange*> completed_;
+    int64_t nextToEmit_ = 0;
+    bool stopping_ = false;
+    std::vector<PendingBatch> batches_;
+
+    // Configuration shared by all contexts
+    std::string codecName_;
+    int width_;
+    int height_;
+    std::vector<uint8_t> extradata_;
+    int concurrency_;
+    int reorderWindow_;
+    int threadBudget_;
+};
+
+#endif // BATCH_DECODER_H
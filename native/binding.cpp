@@ -7,7 +7,20 @@
 #include "image_decoder.h"
 #include "async_encoder.h"
 #include "async_decoder.h"
+#include "ladder_encoder.h"
+#include "segmented_encoder.h"
+#include "batch_decoder.h"
+#include "transcoder.h"
+#include "demuxer.h"
+#include "muxer.h"
+#include "sprite_sheet.h"
+#include "frame_cache.h"
+#include "scene_detector.h"
+#include "tensor.h"
+#include "metrics.h"
+#include "svc_filter.h"
 #include "capability_probe.h"
+#include "threading.h"
 
 // Forward declaration
 void InitUtil(Napi::Env env, Napi::Object exports);
@@ -20,6 +33,9 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     env.AddCleanupHook([](std::atomic<bool>* flag) { flag->store(true); },
                        &nwc_env_teardown);
 
+    // Read the CPU budget (affinity + cgroup quota) once, on the main thread
+    Threading::budget();
+
     // Initialize frame classes
     VideoFrameNative::Init(env, exports);
 
@@ -36,6 +52,36 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     VideoEncoderAsync::Init(env, exports);
     VideoDecoderAsync::Init(env, exports);
 
+    // Initialize ABR ladder encoder (one input, N renditions)
+    VideoLadderEncoder::Init(env, exports);
+
+    // Initialize GOP-parallel offline encoder
+    VideoSegmentedEncoder::Init(env, exports);
+
+    // Initialize GOP-parallel batch decoder
+    VideoBatchDecoder::Init(env, exports);
+
+    // Initialize native transcode pipeline
+    VideoTranscoder::Init(env, exports);
+
+    // Initialize container demuxer (only with libavformat)
+    Demuxer::Init(env, exports);
+
+    // Initialize fragmented MP4 muxer (only with libavformat)
+    Muxer::Init(env, exports);
+
+    // Initialize sprite sheet tiler for thumbnails
+    SpriteSheet::Init(env, exports);
+
+    // Initialize decoded-frame cache
+    FrameCache::Init(env, exports);
+
+    // Initialize scene-change / duplicate-frame detector
+    SceneDetector::Init(env, exports);
+
+    // Initialize SVC temporal-layer filter for relays
+    SvcLayerFilter::Init(env, exports);
+
     // Initialize image decoder
     ImageDecoderNative::Init(env, exports);
 
@@ -49,6 +95,12 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     // Initialize utilities
     InitUtil(env, exports);
 
+    // ML preprocessing (toTensor)
+    InitTensor(env, exports);
+
+    // Frame quality metrics (compareFrames)
+    InitMetrics(env, exports);
+
     return exports;
 }
 
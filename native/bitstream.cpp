@@ -0,0 +1,343 @@
+#include "bitstream.h"
+#include <cstring>
+
+namespace {
+
+// NAL unit types carrying parameter sets
+constexpr int kH264Sps = 7;
+constexpr int kH264Pps = 8;
+constexpr int kHevcVps = 32;
+constexpr int kHevcSps = 33;
+constexpr int kHevcPps = 34;
+
+struct Nal {
+    const uint8_t* data;
+    size_t size;
+};
+
+// Offset of the next 00 00 01 at or after from; size if none
+size_t findStartCode(const uint8_t* data, size_t size, size_t from) {
+    for (size_t i = from; i + 3 <= size; i++) {
+        if (data[i + 2] > 1) {
+            i += 2;  // No start code can end in the next two bytes either
+        } else if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            return i;
+        }
+    }
+    return size;
+}
+
+// Calls fn(nal, size) for each NAL unit of an Annex B buffer, without the
+// start codes and trailing zero bytes
+template <typename Fn>
+void forEachNal(const uint8_t* data, size_t size, Fn fn) {
+    size_t start = findStartCode(data, size, 0);
+    while (start < size) {
+        size_t nal = start + 3;
+        size_t next = findStartCode(data, size, nal);
+        size_t end = next;
+        while (end > nal && data[end - 1] == 0) end--;
+        if (end > nal) fn(data + nal, end - nal);
+        start = next;
+    }
+}
+
+// A 00 00 01 prefix could also be a 4-byte length of 256..511, so only
+// count it as a start code when that length doesn't fit the packet
+bool isAnnexB(const uint8_t* data, size_t size) {
+    if (size < 4 || data[0] != 0 || data[1] != 0) return false;
+    if (data[2] == 0 && data[3] == 1) return true;
+    if (data[2] != 1) return false;
+    uint32_t length = (1u << 8) | data[3];
+    return length + 4 != size;
+}
+
+int nalType(AVCodecID codecId, const uint8_t* nal) {
+    return codecId == AV_CODEC_ID_HEVC ? (nal[0] >> 1) & 0x3f : nal[0] & 0x1f;
+}
+
+bool isParameterSet(AVCodecID codecId, int type) {
+    return codecId == AV_CODEC_ID_HEVC
+        ? type == kHevcVps || type == kHevcSps || type == kHevcPps
+        : type == kH264Sps || type == kH264Pps;
+}
+
+// RBSP reader for the few SPS fields the records need
+class BitReader {
+public:
+    // Strips emulation prevention bytes from the NAL payload
+    BitReader(const uint8_t* data, size_t size) {
+        int zeros = 0;
+        for (size_t i = 0; i < size; i++) {
+            if (zeros >= 2 && data[i] == 3) {
+                zeros = 0;
+                continue;
+            }
+            zeros = data[i] == 0 ? zeros + 1 : 0;
+            rbsp_.push_back(data[i]);
+        }
+    }
+
+    const std::vector<uint8_t>& bytes() const { return rbsp_; }
+    void seekByte(size_t byte) { pos_ = byte * 8; }
+
+    uint32_t bits(int n) {
+        uint32_t value = 0;
+        for (int i = 0; i < n; i++) {
+            size_t byte = pos_ >> 3;
+            uint32_t bit = byte < rbsp_.size() ? (rbsp_[byte] >> (7 - (pos_ & 7))) & 1 : 0;
+            value = (value << 1) | bit;
+            pos_++;
+        }
+        return value;
+    }
+
+    uint32_t ue() {
+        int leadingZeros = 0;
+        while (bits(1) == 0 && leadingZeros < 32) leadingZeros++;
+        return leadingZeros ? ((1u << leadingZeros) - 1) + bits(leadingZeros) : 0;
+    }
+
+private:
+    std::vector<uint8_t> rbsp_;
+    size_t pos_ = 0;
+};
+
+void put16(std::vector<uint8_t>& out, size_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// AVCDecoderConfigurationRecord (ISO/IEC 14496-15 5.3.3.1)
+std::vector<uint8_t> buildAvcC(const std::vector<Nal>& sps, const std::vector<Nal>& pps) {
+    std::vector<uint8_t> out;
+    if (sps.empty() || pps.empty() || sps[0].size < 4) return out;
+
+    const uint8_t* first = sps[0].data;
+    out.push_back(1);         // configurationVersion
+    out.push_back(first[1]);  // AVCProfileIndication
+    out.push_back(first[2]);  // profile_compatibility
+    out.push_back(first[3]);  // AVCLevelIndication
+    out.push_back(0xff);      // lengthSizeMinusOne = 3
+
+    out.push_back(static_cast<uint8_t>(0xe0 | sps.size()));
+    for (const Nal& nal : sps) {
+        put16(out, nal.size);
+        out.insert(out.end(), nal.data, nal.data + nal.size);
+    }
+    out.push_back(static_cast<uint8_t>(pps.size()));
+    for (const Nal& nal : pps) {
+        put16(out, nal.size);
+        out.insert(out.end(), nal.data, nal.data + nal.size);
+    }
+
+    // High profiles also carry chroma format and bit depths
+    int profile = first[1];
+    if (profile == 100 || profile == 110 || profile == 122 || profile == 244) {
+        BitReader reader(first + 1, sps[0].size - 1);
+        reader.seekByte(3);
+        reader.ue();  // seq_parameter_set_id
+        uint32_t chromaFormat = reader.ue();
+        if (chromaFormat == 3) reader.bits(1);  // separate_colour_plane_flag
+        uint32_t lumaDepth = reader.ue();
+        uint32_t chromaDepth = reader.ue();
+
+        out.push_back(static_cast<uint8_t>(0xfc | (chromaFormat & 3)));
+        out.push_back(static_cast<uint8_t>(0xf8 | (lumaDepth & 7)));
+        out.push_back(static_cast<uint8_t>(0xf8 | (chromaDepth & 7)));
+        out.push_back(0);  // numOfSequenceParameterSetExt
+    }
+    return out;
+}
+
+// HEVCDecoderConfigurationRecord (ISO/IEC 14496-15 8.3.3.1)
+std::vector<uint8_t> buildHvcC(const std::vector<Nal>& vps, const std::vector<Nal>& sps,
+                               const std::vector<Nal>& pps) {
+    std::vector<uint8_t> out;
+    if (sps.empty() || pps.empty() || sps[0].size < 16) return out;
+
+    // profile_tier_level's general part is byte aligned right after the
+    // 2-byte NAL header and one byte of SPS fields
+    BitReader reader(sps[0].data + 2, sps[0].size - 2);
+    const std::vector<uint8_t>& rbsp = reader.bytes();
+    if (rbsp.size() < 13) return out;
+
+    int maxSubLayersMinus1 = (rbsp[0] >> 1) & 7;
+    bool temporalIdNested = rbsp[0] & 1;
+
+    reader.seekByte(13);
+    std::vector<bool> profilePresent(maxSubLayersMinus1), levelPresent(maxSubLayersMinus1);
+    for (int i = 0; i < maxSubLayersMinus1; i++) {
+        profilePresent[i] = reader.bits(1);
+        levelPresent[i] = reader.bits(1);
+    }
+    if (maxSubLayersMinus1 > 0) {
+        for (int i = maxSubLayersMinus1; i < 8; i++) reader.bits(2);
+    }
+    for (int i = 0; i < maxSubLayersMinus1; i++) {
+        if (profilePresent[i]) { reader.bits(32); reader.bits(32); reader.bits(24); }
+        if (levelPresent[i]) reader.bits(8);
+    }
+    reader.ue();  // sps_seq_parameter_set_id
+    uint32_t chromaFormat = reader.ue();
+    if (chromaFormat == 3) reader.bits(1);
+    reader.ue();  // pic_width_in_luma_samples
+    reader.ue();  // pic_height_in_luma_samples
+    if (reader.bits(1)) {  // conformance_window_flag
+        reader.ue(); reader.ue(); reader.ue(); reader.ue();
+    }
+    uint32_t lumaDepth = reader.ue();
+    uint32_t chromaDepth = reader.ue();
+
+    out.push_back(1);  // configurationVersion
+    // general_profile_space/tier/idc, compatibility flags, constraint
+    // flags, level_idc: copied as-is
+    out.insert(out.end(), rbsp.begin() + 1, rbsp.begin() + 13);
+    put16(out, 0xf000);  // min_spatial_segmentation_idc = 0
+    out.push_back(0xfc);  // parallelismType = 0 (unknown)
+    out.push_back(static_cast<uint8_t>(0xfc | (chromaFormat & 3)));
+    out.push_back(static_cast<uint8_t>(0xf8 | (lumaDepth & 7)));
+    out.push_back(static_cast<uint8_t>(0xf8 | (chromaDepth & 7)));
+    put16(out, 0);  // avgFrameRate
+    out.push_back(static_cast<uint8_t>(((maxSubLayersMinus1 + 1) << 3) |
+                                       (temporalIdNested << 2) | 3));
+
+    const std::vector<Nal>* arrays[] = { &vps, &sps, &pps };
+    const int types[] = { kHevcVps, kHevcSps, kHevcPps };
+    out.push_back(vps.empty() ? 2 : 3);  // numOfArrays
+    for (int a = 0; a < 3; a++) {
+        if (arrays[a]->empty()) continue;
+        out.push_back(static_cast<uint8_t>(0x80 | types[a]));  // array_completeness
+        put16(out, arrays[a]->size());
+        for (const Nal& nal : *arrays[a]) {
+            put16(out, nal.size);
+            out.insert(out.end(), nal.data, nal.data + nal.size);
+        }
+    }
+    return out;
+}
+
+// avcC/hvcC from the parameter sets in an Annex B buffer; empty if missing
+std::vector<uint8_t> buildDescription(AVCodecID codecId, const std::vector<Nal>& nals) {
+    std::vector<Nal> vps, sps, pps;
+    for (const Nal& nal : nals) {
+        int type = nalType(codecId, nal.data);
+        if (type == kHevcVps && codecId == AV_CODEC_ID_HEVC) vps.push_back(nal);
+        else if (type == (codecId == AV_CODEC_ID_HEVC ? kHevcSps : kH264Sps)) sps.push_back(nal);
+        else if (type == (codecId == AV_CODEC_ID_HEVC ? kHevcPps : kH264Pps)) pps.push_back(nal);
+    }
+    return codecId == AV_CODEC_ID_HEVC ? buildHvcC(vps, sps, pps) : buildAvcC(sps, pps);
+}
+
+} // namespace
+
+BitstreamConverter::~BitstreamConverter() {
+    reset();
+}
+
+void BitstreamConverter::reset() {
+    if (bsf_) av_bsf_free(&bsf_);
+    if (bsfPacket_) av_packet_free(&bsfPacket_);
+    if (params_) avcodec_parameters_free(&params_);
+    bsfFailed_ = false;
+    description_.clear();
+    codecId_ = AV_CODEC_ID_NONE;
+}
+
+void BitstreamConverter::configure(const AVCodecContext* ctx, bool annexB) {
+    reset();
+    annexB_ = annexB;
+
+    const uint8_t* extradata = ctx->extradata;
+    size_t extradataSize = ctx->extradata && ctx->extradata_size > 0 ? ctx->extradata_size : 0;
+
+    if (ctx->codec_id != AV_CODEC_ID_H264 && ctx->codec_id != AV_CODEC_ID_HEVC) {
+        // Not ours to reframe; the description is the extradata as before
+        description_.assign(extradata, extradata + extradataSize);
+        return;
+    }
+    codecId_ = ctx->codec_id;
+
+    if (annexB_) {
+        description_.assign(extradata, extradata + extradataSize);
+        params_ = avcodec_parameters_alloc();
+        if (params_) avcodec_parameters_from_context(params_, ctx);
+        return;
+    }
+
+    if (extradataSize > 0 && extradata[0] == 1) {
+        description_.assign(extradata, extradata + extradataSize);  // Already avcC/hvcC
+    } else if (extradataSize > 0) {
+        std::vector<Nal> nals;
+        forEachNal(extradata, extradataSize, [&](const uint8_t* nal, size_t size) {
+            nals.push_back({ nal, size });
+        });
+        description_ = buildDescription(codecId_, nals);
+    }
+}
+
+void BitstreamConverter::convert(const AVPacket* packet, std::vector<uint8_t>& out) {
+    const uint8_t* data = packet->data;
+    size_t size = packet->size;
+
+    if (codecId_ == AV_CODEC_ID_NONE || (annexB_ && isAnnexB(data, size)) ||
+        (!annexB_ && !isAnnexB(data, size))) {
+        out.assign(data, data + size);
+        return;
+    }
+
+    if (annexB_) {
+        if (!convertToAnnexB(packet, out)) {
+            out.assign(data, data + size);
+        }
+        return;
+    }
+
+    // Start codes become 4-byte lengths in the single copy out of the
+    // packet. Parameter sets stay in band; without a global header the
+    // first keyframe's become the description.
+    out.clear();
+    out.reserve(size + 16);
+    std::vector<Nal> paramSets;
+    bool wantParams = description_.empty();
+    forEachNal(data, size, [&](const uint8_t* nal, size_t nalSize) {
+        out.push_back(static_cast<uint8_t>(nalSize >> 24));
+        out.push_back(static_cast<uint8_t>(nalSize >> 16));
+        out.push_back(static_cast<uint8_t>(nalSize >> 8));
+        out.push_back(static_cast<uint8_t>(nalSize));
+        out.insert(out.end(), nal, nal + nalSize);
+        if (wantParams && isParameterSet(codecId_, nalType(codecId_, nal))) {
+            paramSets.push_back({ nal, nalSize });
+        }
+    });
+    if (wantParams && !paramSets.empty()) {
+        description_ = buildDescription(codecId_, paramSets);
+    }
+}
+
+bool BitstreamConverter::convertToAnnexB(const AVPacket* packet, std::vector<uint8_t>& out) {
+    if (bsfFailed_) return false;
+
+    if (!bsf_) {
+        const AVBitStreamFilter* filter = av_bsf_get_by_name(
+            codecId_ == AV_CODEC_ID_HEVC ? "hevc_mp4toannexb" : "h264_mp4toannexb");
+        bsfPacket_ = av_packet_alloc();
+        if (!filter || !params_ || !bsfPacket_ || av_bsf_alloc(filter, &bsf_) < 0 ||
+            avcodec_parameters_copy(bsf_->par_in, params_) < 0 || av_bsf_init(bsf_) < 0) {
+            if (bsf_) av_bsf_free(&bsf_);
+            bsfFailed_ = true;
+            return false;
+        }
+    }
+
+    if (av_packet_ref(bsfPacket_, packet) < 0) return false;
+    if (av_bsf_send_packet(bsf_, bsfPacket_) < 0) {
+        av_packet_unref(bsfPacket_);
+        return false;
+    }
+    // mp4toannexb is one packet in, one packet out
+    if (av_bsf_receive_packet(bsf_, bsfPacket_) < 0) return false;
+    out.assign(bsfPacket_->data, bsfPacket_->data + bsfPacket_->size);
+    av_packet_unref(bsfPacket_);
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavcodec/bsf.h>
+}
+
+/**
+ * H.264/HEVC output framing for avcFormat (VideoEncoderNative,
+ * VideoEncoderAsync). Other codecs pass through untouched.
+ *
+ * "avc" (length-prefixed): Annex B packets are rewritten with 4-byte NAL
+ * lengths while being copied out, so no extra pass over the packet, and the
+ * description is an avcC/hvcC record built from the encoder's parameter
+ * sets (global header, or the first keyframe's in-band SPS/PPS).
+ *
+ * "annexb": packets that already use start codes are copied as-is; an
+ * encoder emitting length-prefixed packets goes through FFmpeg's
+ * h264_mp4toannexb/hevc_mp4toannexb.
+ */
+class BitstreamConverter {
+public:
+    BitstreamConverter() = default;
+    ~BitstreamConverter();
+
+    BitstreamConverter(const BitstreamConverter&) = delete;
+    BitstreamConverter& operator=(const BitstreamConverter&) = delete;
+
+    /**
+     * Set up for an opened encoder. Length-prefixed output needs
+     * AV_CODEC_FLAG_GLOBAL_HEADER set before avcodec_open2 so parameter sets
+     * stay out of the packets.
+     */
+    void configure(const AVCodecContext* ctx, bool annexB);
+    void reset();
+
+    /** Replace out with packet's payload in the configured format */
+    void convert(const AVPacket* packet, std::vector<uint8_t>& out);
+
+    /** Decoder description for keyframe metadata; empty if none */
+    const std::vector<uint8_t>& description() const { return description_; }
+
+private:
+    bool convertToAnnexB(const AVPacket* packet, std::vector<uint8_t>& out);
+
+    AVCodecID codecId_ = AV_CODEC_ID_NONE;
+    bool annexB_ = true;
+    std::vector<uint8_t> description_;
+    AVCodecParameters* params_ = nullptr;  // For the lazily created BSF
+    AVBSFContext* bsf_ = nullptr;
+    AVPacket* bsfPacket_ = nullptr;
+    bool bsfFailed_ = false;
+};
+
+#endif // BITSTREAM_H
@@ -1,5 +1,7 @@
 #include "decoder.h"
 #include "frame.h"
+#include "decoder_setup.h"
+#include "threading.h"
 
 Napi::FunctionReference VideoDecoderNative::constructor;
 
@@ -54,39 +56,7 @@ void VideoDecoderNative::Configure(const Napi::CallbackInfo& info) {
     Napi::Object config = info[0].As<Napi::Object>();
     std::string codecName = config.Get("codec").As<Napi::String>().Utf8Value();
 
-    // For H.264 decoding, use the decoder not encoder
-    if (codecName == "libx264") {
-        codecName = "h264";
-    }
-
-    // For AV1, prefer libdav1d (software decoder) over hardware decoder
-    // since hardware AV1 decoding may not be available on all platforms
-    if (codecName == "av1") {
-        codec_ = avcodec_find_decoder_by_name("libdav1d");
-        if (!codec_) {
-            // Fallback to libaom-av1 software decoder
-            codec_ = avcodec_find_decoder_by_name("libaom-av1");
-        }
-        if (!codec_) {
-            // Last resort: try generic AV1 decoder
-            codec_ = avcodec_find_decoder(AV_CODEC_ID_AV1);
-        }
-    } else {
-        codec_ = avcodec_find_decoder_by_name(codecName.c_str());
-    }
-
-    if (!codec_) {
-        // Try by codec ID
-        if (codecName == "h264") {
-            codec_ = avcodec_find_decoder(AV_CODEC_ID_H264);
-        } else if (codecName == "vp8") {
-            codec_ = avcodec_find_decoder(AV_CODEC_ID_VP8);
-        } else if (codecName == "vp9") {
-            codec_ = avcodec_find_decoder(AV_CODEC_ID_VP9);
-        } else if (codecName == "hevc") {
-            codec_ = avcodec_find_decoder(AV_CODEC_ID_HEVC);
-        }
-    }
+    codec_ = DecoderSetup::findDecoder(codecName);
 
     if (!codec_) {
         Napi::Error::New(env, "Codec not found: " + codecName).ThrowAsJavaScriptException();
@@ -110,14 +80,27 @@ void VideoDecoderNative::Configure(const Napi::CallbackInfo& info) {
     // Set extradata (AVCC format for H.264)
     if (config.Has("extradata")) {
         Napi::Buffer<uint8_t> extradata = config.Get("extradata").As<Napi::Buffer<uint8_t>>();
-        codecCtx_->extradata_size = extradata.Length();
-        codecCtx_->extradata = (uint8_t*)av_malloc(extradata.Length() + AV_INPUT_BUFFER_PADDING_SIZE);
-        memcpy(codecCtx_->extradata, extradata.Data(), extradata.Length());
-        memset(codecCtx_->extradata + extradata.Length(), 0, AV_INPUT_BUFFER_PADDING_SIZE);
+        DecoderSetup::setExtradata(codecCtx_, extradata.Data(), extradata.Length());
     }
 
-    // 0 = auto-detect core count; default of 1 leaves multicore decode on the table
-    codecCtx_->thread_count = 0;
+    // Auto-detect (0) unless a cgroup quota/cpuset caps us below the host
+    // core count; default of 1 leaves multicore decode on the table
+    codecCtx_->thread_count = Threading::codecThreadCount();
+
+    // Motion vectors and QP tables, essentially free from the codec
+    if (config.Has("exportCodecAnalysis") && config.Get("exportCodecAnalysis").ToBoolean().Value()) {
+        DecoderSetup::enableCodecAnalysis(codecCtx_);
+    }
+
+    // Per-instance speed/quality trades (lowres, skip_*, dav1d threading)
+    if (config.Has("decoderOptions") && config.Get("decoderOptions").IsObject()) {
+        std::string err = DecoderSetup::applyOptions(codecCtx_, config.Get("decoderOptions").As<Napi::Object>());
+        if (!err.empty()) {
+            avcodec_free_context(&codecCtx_);
+            DecoderSetup::throwOptionsError(env, err);
+            return;
+        }
+    }
 
     // Open codec
     int ret = avcodec_open2(codecCtx_, codec_, nullptr);
@@ -0,0 +1,155 @@
+#include "decoder_setup.h"
+#include <cstring>
+
+extern "C" {
+#include <libavutil/mem.h>
+#include <libavutil/opt.h>
+}
+
+namespace DecoderSetup {
+
+const AVCodec* findDecoder(std::string codecName) {
+    // For H.264 decoding, use the decoder not encoder
+    if (codecName == "libx264") {
+        codecName = "h264";
+    }
+
+    const AVCodec* codec = nullptr;
+
+    // For AV1, prefer libdav1d (software decoder) over hardware decoder
+    // since hardware AV1 decoding may not be available on all platforms
+    if (codecName == "av1") {
+        codec = avcodec_find_decoder_by_name("libdav1d");
+        if (!codec) {
+            // Fallback to libaom-av1 software decoder
+            codec = avcodec_find_decoder_by_name("libaom-av1");
+        }
+        if (!codec) {
+            // Last resort: try generic AV1 decoder
+            codec = avcodec_find_decoder(AV_CODEC_ID_AV1);
+        }
+    } else {
+        codec = avcodec_find_decoder_by_name(codecName.c_str());
+    }
+
+    if (!codec) {
+        // Try by codec ID
+        if (codecName == "h264") {
+            codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+        } else if (codecName == "vp8") {
+            codec = avcodec_find_decoder(AV_CODEC_ID_VP8);
+        } else if (codecName == "vp9") {
+            codec = avcodec_find_decoder(AV_CODEC_ID_VP9);
+        } else if (codecName == "hevc") {
+            codec = avcodec_find_decoder(AV_CODEC_ID_HEVC);
+        }
+    }
+
+    return codec;
+}
+
+void setExtradata(AVCodecContext* ctx, const uint8_t* data, size_t size) {
+    av_freep(&ctx->extradata);
+    ctx->extradata_size = 0;
+    if (!data || size == 0) {
+        return;
+    }
+
+    ctx->extradata = (uint8_t*)av_malloc(size + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!ctx->extradata) {
+        return;
+    }
+    memcpy(ctx->extradata, data, size);
+    memset(ctx->extradata + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    ctx->extradata_size = static_cast<int>(size);
+}
+
+namespace {
+
+bool parseDiscard(const std::string& name, AVDiscard* out) {
+    static const struct { const char* name; AVDiscard value; } kDiscards[] = {
+        { "none", AVDISCARD_NONE },
+        { "default", AVDISCARD_DEFAULT },
+        { "nonref", AVDISCARD_NONREF },
+        { "bidir", AVDISCARD_BIDIR },
+        { "nonintra", AVDISCARD_NONINTRA },
+        { "nonkey", AVDISCARD_NONKEY },
+        { "all", AVDISCARD_ALL },
+    };
+    for (const auto& d : kDiscards) {
+        if (name == d.name) {
+            *out = d.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Which decoders implement the skip_loop_filter / skip_idct hooks
+bool honoursSkip(const AVCodec* codec) {
+    return codec->id == AV_CODEC_ID_H264 || codec->id == AV_CODEC_ID_HEVC;
+}
+
+} // namespace
+
+std::string applyOptions(AVCodecContext* ctx, const Napi::Object& options) {
+    const AVCodec* codec = ctx->codec;
+
+    if (options.Has("lowres")) {
+        int lowres = options.Get("lowres").As<Napi::Number>().Int32Value();
+        // FFmpeg would clamp this with a log warning; the caller asked for
+        // a smaller decode and should know it isn't getting one
+        if (lowres > codec->max_lowres) {
+            return std::string("lowres ") + std::to_string(lowres) + " exceeds the maximum of " +
+                   std::to_string(codec->max_lowres) + " for " + codec->name;
+        }
+        ctx->lowres = lowres;
+    }
+
+    const char* skipKeys[] = { "skipLoopFilter", "skipIdct" };
+    AVDiscard* skipFields[] = { &ctx->skip_loop_filter, &ctx->skip_idct };
+    for (int i = 0; i < 2; i++) {
+        if (!options.Has(skipKeys[i])) continue;
+
+        std::string name = options.Get(skipKeys[i]).As<Napi::String>().Utf8Value();
+        if (!parseDiscard(name, skipFields[i])) {
+            return std::string("Invalid ") + skipKeys[i] + ": " + name;
+        }
+        if (*skipFields[i] != AVDISCARD_DEFAULT && !honoursSkip(codec)) {
+            return std::string(skipKeys[i]) + " is not supported by " + codec->name;
+        }
+    }
+
+    if (options.Has("threads")) {
+        ctx->thread_count = options.Get("threads").As<Napi::Number>().Int32Value();
+    }
+
+    // libdav1d private options; "framethreads" is deprecated upstream in
+    // favour of max_frame_delay but still sizes the frame-thread pool
+    const char* dav1dKeys[][2] = { { "frameThreads", "framethreads" }, { "maxFrameDelay", "max_frame_delay" } };
+    for (const auto& key : dav1dKeys) {
+        if (!options.Has(key[0])) continue;
+
+        int64_t value = options.Get(key[0]).As<Napi::Number>().Int64Value();
+        if (!ctx->priv_data || av_opt_set_int(ctx->priv_data, key[1], value, 0) < 0) {
+            return std::string(key[0]) + " is not supported by " + codec->name;
+        }
+    }
+
+    return std::string();
+}
+
+void throwOptionsError(Napi::Env env, const std::string& message) {
+    Napi::Error error = Napi::Error::New(env, message);
+    error.Set("code", Napi::String::New(env, "ERR_DECODER_OPTIONS"));
+    error.ThrowAsJavaScriptException();
+}
+
+void enableCodecAnalysis(AVCodecContext* ctx) {
+    ctx->flags2 |= AV_CODEC_FLAG2_EXPORT_MVS;
+#ifdef AV_CODEC_EXPORT_DATA_VIDEO_ENC_PARAMS
+    ctx->export_side_data |= AV_CODEC_EXPORT_DATA_VIDEO_ENC_PARAMS;
+#endif
+}
+
+} // namespace DecoderSetup
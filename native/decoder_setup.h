@@ -0,0 +1,59 @@
+#ifndef DECODER_SETUP_H
+#define DECODER_SETUP_H
+
+#include <napi.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * Codec-context setup shared by every decoder that opens an AVCodecContext
+ * (VideoDecoderNative, VideoDecoderAsync, VideoBatchDecoder).
+ */
+namespace DecoderSetup {
+
+/**
+ * Decoder for an FFmpeg codec name from the registry. Encoder names map to
+ * their decoder (libx264 -> h264) and AV1 prefers libdav1d, then libaom.
+ * nullptr if nothing can decode it.
+ */
+const AVCodec* findDecoder(std::string codecName);
+
+/**
+ * Copy codec-specific extradata (avcC, hvcC, ...) into ctx with the padding
+ * FFmpeg's parsers expect. Runs before avcodec_open2.
+ */
+void setExtradata(AVCodecContext* ctx, const uint8_t* data, size_t size);
+
+/**
+ * Apply a decoderOptions object ({ lowres, skipLoopFilter, skipIdct,
+ * threads, frameThreads, maxFrameDelay }) to ctx before avcodec_open2.
+ * Quality-for-speed trades for previews and analytics. Options the codec
+ * can't honour are rejected rather than silently ignored. Returns an error
+ * message, empty on success.
+ */
+std::string applyOptions(AVCodecContext* ctx, const Napi::Object& options);
+
+/**
+ * Throw an applyOptions() failure as an Error with code
+ * ERR_DECODER_OPTIONS, so the JS layer can report it as NotSupportedError
+ * without catching unrelated configure() errors.
+ */
+void throwOptionsError(Napi::Env env, const std::string& message);
+
+/**
+ * Have the codec attach what it already knows about each picture: motion
+ * vectors (AV_FRAME_DATA_MOTION_VECTORS) and per-block QP
+ * (AV_FRAME_DATA_VIDEO_ENC_PARAMS). H.264, HEVC (QP only) and the MPEG
+ * family export them; other decoders leave frames without. Before
+ * avcodec_open2.
+ */
+void enableCodecAnalysis(AVCodecContext* ctx);
+
+} // namespace DecoderSetup
+
+#endif // DECODER_SETUP_H
@@ -0,0 +1,504 @@
+#include "demuxer.h"
+
+#ifdef NWC_HAVE_AVFORMAT
+
+#include "async_decoder.h"
+#include "env_state.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+namespace {
+
+const AVRational kMicroseconds = { 1, 1000000 };
+
+struct DemuxTrack {
+    int index;
+    bool isVideo;
+    std::string codecName;
+    int profile;
+    int level;
+    int width;
+    int height;
+    int bitDepth;
+    int sampleRate;
+    int channels;
+    int64_t duration;  // Microseconds, -1 if unknown
+    std::vector<uint8_t> extradata;
+};
+
+} // namespace
+
+struct DemuxJob {
+    enum class Kind { Open, Read, Pipe, Seek };
+
+    ~DemuxJob() {
+        for (AVPacket* packet : packets) {
+            av_packet_free(&packet);
+        }
+    }
+
+    Kind kind;
+    Napi::ThreadSafeFunction callback;  // (err, result)
+
+    std::string path;                 // Open, when not opening an fd
+    int fd = -1;                      // Open
+    int maxPackets = 0;               // Read
+    int trackIndex = -1;              // Read (-1 = all tracks), Pipe
+    VideoDecoderAsync* decoder = nullptr;  // Pipe
+    Napi::ObjectReference decoderRef;      // Keeps the decoder alive while piping
+    int64_t timestamp = 0;            // Seek, microseconds
+
+    std::string error;
+    std::vector<DemuxTrack> tracks;   // Open result
+    std::vector<AVPacket*> packets;   // Read result, timestamps in microseconds
+    int64_t submitted = 0;            // Pipe result
+    bool counted = false;             // In pendingJobs_
+};
+
+Napi::FunctionReference Demuxer::constructor;
+
+Napi::Object Demuxer::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "Demuxer", {
+        InstanceMethod("open", &Demuxer::Open),
+        InstanceMethod("read", &Demuxer::Read),
+        InstanceMethod("pipeTo", &Demuxer::PipeTo),
+        InstanceMethod("seek", &Demuxer::Seek),
+        InstanceMethod("close", &Demuxer::Close),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("Demuxer", func);
+    return exports;
+}
+
+Demuxer::Demuxer(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<Demuxer>(info) {
+    worker_ = std::thread(&Demuxer::WorkerThread, this);
+}
+
+Demuxer::~Demuxer() {
+    StopWorker();
+    CloseInput();
+}
+
+// open(path | fd, callback(err, tracks))
+void Demuxer::Open(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    DemuxJob* job = new DemuxJob();
+    job->kind = DemuxJob::Kind::Open;
+    if (info[0].IsString()) {
+        job->path = info[0].As<Napi::String>().Utf8Value();
+    } else if (info[0].IsNumber()) {
+        job->fd = info[0].As<Napi::Number>().Int32Value();
+    } else {
+        delete job;
+        Napi::TypeError::New(env, "Expected a path or file descriptor").ThrowAsJavaScriptException();
+        return;
+    }
+    job->callback = Napi::ThreadSafeFunction::New(env, info[1].As<Napi::Function>(), "DemuxerOpen", 0, 1);
+    Submit(job);
+}
+
+// read(maxPackets, trackIndex, callback(err, packets)); [] at end of stream
+void Demuxer::Read(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    DemuxJob* job = new DemuxJob();
+    job->kind = DemuxJob::Kind::Read;
+    job->maxPackets = info[0].As<Napi::Number>().Int32Value();
+    job->trackIndex = info[1].As<Napi::Number>().Int32Value();
+    job->callback = Napi::ThreadSafeFunction::New(env, info[2].As<Napi::Function>(), "DemuxerRead", 0, 1);
+    Submit(job);
+}
+
+// pipeTo(trackIndex, VideoDecoderAsync, callback(err, packetsSubmitted))
+void Demuxer::PipeTo(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    DemuxJob* job = new DemuxJob();
+    job->kind = DemuxJob::Kind::Pipe;
+    job->trackIndex = info[0].As<Napi::Number>().Int32Value();
+    Napi::Object decoder = info[1].As<Napi::Object>();
+    job->decoder = Napi::ObjectWrap<VideoDecoderAsync>::Unwrap(decoder);
+    job->decoderRef = Napi::Persistent(decoder);
+    job->callback = Napi::ThreadSafeFunction::New(env, info[2].As<Napi::Function>(), "DemuxerPipe", 0, 1);
+    Submit(job);
+}
+
+// seek(timestampUs, callback(err)): to the keyframe at or before timestamp
+void Demuxer::Seek(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    DemuxJob* job = new DemuxJob();
+    job->kind = DemuxJob::Kind::Seek;
+    job->timestamp = info[0].As<Napi::Number>().Int64Value();
+    job->callback = Napi::ThreadSafeFunction::New(env, info[1].As<Napi::Function>(), "DemuxerSeek", 0, 1);
+    Submit(job);
+}
+
+void Demuxer::Close(const Napi::CallbackInfo& info) {
+    StopWorker();
+    CloseInput();
+}
+
+void Demuxer::Submit(DemuxJob* job) {
+    job->counted = true;
+    if (stopping_ || !jobs_.push(job)) {
+        job->counted = false;
+        job->error = "Demuxer is closed";
+        Complete(job);
+        return;
+    }
+    // Pin the wrapper so completions (which capture this) can't outlive it
+    if (pendingJobs_++ == 0) {
+        Ref();
+    }
+}
+
+// Fail queued jobs, then join the worker. Safe to call twice.
+void Demuxer::StopWorker() {
+    stopping_ = true;
+    jobs_.close();
+    jobs_.drain([this](DemuxJob* job) {
+        job->error = "Demuxer is closed";
+        Complete(job);
+    });
+
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void Demuxer::CloseInput() {
+    if (formatCtx_) {
+        avformat_close_input(&formatCtx_);
+    }
+    if (ioCtx_) {
+        // Custom I/O: avformat doesn't own the context or its buffer
+        av_freep(&ioCtx_->buffer);
+        avio_context_free(&ioCtx_);
+    }
+    if (ownsFd_ && fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = -1;
+    ownsFd_ = false;
+}
+
+void Demuxer::WorkerThread() {
+    DemuxJob* job = nullptr;
+    while (jobs_.pop(job)) {
+        switch (job->kind) {
+            case DemuxJob::Kind::Open: RunOpen(job); break;
+            case DemuxJob::Kind::Read: RunRead(job); break;
+            case DemuxJob::Kind::Pipe: RunPipe(job); break;
+            case DemuxJob::Kind::Seek: RunSeek(job); break;
+        }
+        Complete(job);
+    }
+}
+
+int Demuxer::IORead(void* opaque, uint8_t* buf, int size) {
+    Demuxer* self = static_cast<Demuxer*>(opaque);
+
+    // pread leaves the fd's own offset alone, so a caller's fd can be
+    // shared; pipes and sockets fall back to read()
+    ssize_t n = self->seekable_
+        ? pread(self->fd_, buf, size, self->position_)
+        : ::read(self->fd_, buf, size);
+    if (n < 0) {
+        return AVERROR(errno);
+    }
+    if (n == 0) {
+        return AVERROR_EOF;
+    }
+    self->position_ += n;
+    return static_cast<int>(n);
+}
+
+int64_t Demuxer::IOSeek(void* opaque, int64_t offset, int whence) {
+    Demuxer* self = static_cast<Demuxer*>(opaque);
+
+    switch (whence & ~AVSEEK_FORCE) {
+        case AVSEEK_SIZE: return self->fileSize_;
+        case SEEK_SET: self->position_ = offset; break;
+        case SEEK_CUR: self->position_ += offset; break;
+        case SEEK_END: self->position_ = self->fileSize_ + offset; break;
+        default: return AVERROR(EINVAL);
+    }
+    return self->position_;
+}
+
+void Demuxer::RunOpen(DemuxJob* job) {
+    if (formatCtx_) {
+        job->error = "Demuxer is already open";
+        return;
+    }
+
+    if (!job->path.empty()) {
+        fd_ = ::open(job->path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            job->error = "Failed to open " + job->path + ": " + strerror(errno);
+            return;
+        }
+        ownsFd_ = true;
+    } else {
+        fd_ = job->fd;
+        ownsFd_ = false;
+    }
+
+    struct stat st;
+    seekable_ = fstat(fd_, &st) == 0 && S_ISREG(st.st_mode);
+    fileSize_ = seekable_ ? st.st_size : AVERROR(ENOSYS);
+    position_ = 0;
+
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(kIOBufferSize));
+    ioCtx_ = buffer ? avio_alloc_context(buffer, kIOBufferSize, 0, this, &Demuxer::IORead,
+                                         nullptr, seekable_ ? &Demuxer::IOSeek : nullptr)
+                    : nullptr;
+    formatCtx_ = ioCtx_ ? avformat_alloc_context() : nullptr;
+    if (!formatCtx_) {
+        if (!ioCtx_) av_free(buffer);
+        job->error = "Failed to allocate demuxer";
+        CloseInput();
+        return;
+    }
+    ioCtx_->seekable = seekable_ ? AVIO_SEEKABLE_NORMAL : 0;
+    formatCtx_->pb = ioCtx_;
+    formatCtx_->flags |= AVFMT_FLAG_CUSTOM_IO;
+
+    int ret = avformat_open_input(&formatCtx_, nullptr, nullptr, nullptr);
+    if (ret >= 0) {
+        ret = avformat_find_stream_info(formatCtx_, nullptr);
+    }
+    if (ret < 0) {
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        job->error = std::string("Failed to read container: ") + errBuf;
+        CloseInput();
+        return;
+    }
+
+    for (unsigned i = 0; i < formatCtx_->nb_streams; i++) {
+        AVStream* stream = formatCtx_->streams[i];
+        AVCodecParameters* par = stream->codecpar;
+        bool isVideo = par->codec_type == AVMEDIA_TYPE_VIDEO &&
+                       !(stream->disposition & AV_DISPOSITION_ATTACHED_PIC);
+        if (!isVideo && par->codec_type != AVMEDIA_TYPE_AUDIO) {
+            // Never read subtitle/data streams or cover art
+            stream->discard = AVDISCARD_ALL;
+            continue;
+        }
+
+        DemuxTrack track;
+        track.index = static_cast<int>(i);
+        track.isVideo = isVideo;
+        track.codecName = avcodec_get_name(par->codec_id);
+        track.profile = par->profile;
+        track.level = par->level;
+        track.width = par->width;
+        track.height = par->height;
+        track.bitDepth = 8;
+        if (isVideo) {
+            const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(par->format));
+            if (desc) track.bitDepth = desc->comp[0].depth;
+        }
+        track.sampleRate = par->sample_rate;
+        track.channels = par->ch_layout.nb_channels;
+        track.duration = stream->duration != AV_NOPTS_VALUE
+            ? av_rescale_q(stream->duration, stream->time_base, kMicroseconds)
+            : (formatCtx_->duration != AV_NOPTS_VALUE ? formatCtx_->duration : -1);
+        if (par->extradata && par->extradata_size > 0) {
+            track.extradata.assign(par->extradata, par->extradata + par->extradata_size);
+        }
+        job->tracks.push_back(std::move(track));
+    }
+}
+
+// Next packet of any non-discarded stream, timestamps in microseconds
+int Demuxer::ReadPacket(AVPacket* packet) {
+    int ret = av_read_frame(formatCtx_, packet);
+    if (ret < 0) {
+        return ret;
+    }
+
+    AVRational timeBase = formatCtx_->streams[packet->stream_index]->time_base;
+    if (packet->pts == AV_NOPTS_VALUE) {
+        packet->pts = packet->dts;
+    }
+    if (packet->pts != AV_NOPTS_VALUE) {
+        packet->pts = av_rescale_q(packet->pts, timeBase, kMicroseconds);
+    }
+    if (packet->dts != AV_NOPTS_VALUE) {
+        packet->dts = av_rescale_q(packet->dts, timeBase, kMicroseconds);
+    }
+    packet->duration = av_rescale_q(packet->duration, timeBase, kMicroseconds);
+    packet->time_base = kMicroseconds;
+    return 0;
+}
+
+void Demuxer::RunRead(DemuxJob* job) {
+    if (!formatCtx_) {
+        job->error = "Demuxer is not open";
+        return;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    while (static_cast<int>(job->packets.size()) < job->maxPackets && !stopping_) {
+        int ret = ReadPacket(packet);
+        if (ret == AVERROR_EOF) {
+            break;
+        }
+        if (ret < 0) {
+            char errBuf[256];
+            av_strerror(ret, errBuf, sizeof(errBuf));
+            job->error = std::string("Demux error: ") + errBuf;
+            break;
+        }
+        if (job->trackIndex >= 0 && packet->stream_index != job->trackIndex) {
+            av_packet_unref(packet);
+            continue;
+        }
+        job->packets.push_back(packet);
+        packet = av_packet_alloc();
+    }
+    av_packet_free(&packet);
+}
+
+void Demuxer::RunPipe(DemuxJob* job) {
+    if (!formatCtx_) {
+        job->error = "Demuxer is not open";
+        return;
+    }
+    if (job->trackIndex < 0 || job->trackIndex >= static_cast<int>(formatCtx_->nb_streams) ||
+        formatCtx_->streams[job->trackIndex]->codecpar->codec_type != AVMEDIA_TYPE_VIDEO) {
+        job->error = "Not a video track: " + std::to_string(job->trackIndex);
+        return;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    while (!stopping_) {
+        int ret = ReadPacket(packet);
+        if (ret == AVERROR_EOF) {
+            break;
+        }
+        if (ret < 0) {
+            char errBuf[256];
+            av_strerror(ret, errBuf, sizeof(errBuf));
+            job->error = std::string("Demux error: ") + errBuf;
+            break;
+        }
+        if (packet->stream_index != job->trackIndex) {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        // Hand the payload over by reference; blocks while the decoder is full
+        AVPacket* out = av_packet_alloc();
+        av_packet_move_ref(out, packet);
+        if (!job->decoder->SubmitPacket(out)) {
+            job->error = "Decoder is closed";
+            break;
+        }
+        job->submitted++;
+    }
+    av_packet_free(&packet);
+}
+
+void Demuxer::RunSeek(DemuxJob* job) {
+    if (!formatCtx_) {
+        job->error = "Demuxer is not open";
+        return;
+    }
+    if (!seekable_) {
+        job->error = "Input is not seekable";
+        return;
+    }
+
+    // Stream -1 takes AV_TIME_BASE (microsecond) timestamps
+    int ret = av_seek_frame(formatCtx_, -1, job->timestamp, AVSEEK_FLAG_BACKWARD);
+    if (ret < 0) {
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        job->error = std::string("Seek failed: ") + errBuf;
+    }
+}
+
+// Deliver a job's result on the JS thread and free it there (the job may
+// hold JS references). Called from the worker, or from the JS thread for
+// jobs that never ran.
+void Demuxer::Complete(DemuxJob* job) {
+    Napi::ThreadSafeFunction callback = job->callback;
+    napi_status status = callback.NonBlockingCall(job,
+        [this](Napi::Env env, Napi::Function fn, DemuxJob* j) {
+            if (!j->error.empty()) {
+                fn.Call({ Napi::Error::New(env, j->error).Value() });
+            } else if (j->kind == DemuxJob::Kind::Open) {
+                Napi::Array tracks = Napi::Array::New(env, j->tracks.size());
+                for (size_t i = 0; i < j->tracks.size(); i++) {
+                    const DemuxTrack& t = j->tracks[i];
+                    Napi::Object track = Napi::Object::New(env);
+                    track.Set("index", t.index);
+                    track.Set("type", t.isVideo ? "video" : "audio");
+                    track.Set("codecName", t.codecName);
+                    track.Set("profile", t.profile);
+                    track.Set("level", t.level);
+                    track.Set("duration", static_cast<double>(t.duration));
+                    if (t.isVideo) {
+                        track.Set("width", t.width);
+                        track.Set("height", t.height);
+                        track.Set("bitDepth", t.bitDepth);
+                    } else {
+                        track.Set("sampleRate", t.sampleRate);
+                        track.Set("numberOfChannels", t.channels);
+                    }
+                    if (!t.extradata.empty()) {
+                        track.Set("extradata", Napi::Buffer<uint8_t>::Copy(env, t.extradata.data(), t.extradata.size()));
+                    }
+                    tracks.Set(static_cast<uint32_t>(i), track);
+                }
+                fn.Call({ env.Null(), tracks });
+            } else if (j->kind == DemuxJob::Kind::Read) {
+                Napi::Array packets = Napi::Array::New(env, j->packets.size());
+                for (size_t i = 0; i < j->packets.size(); i++) {
+                    const AVPacket* p = j->packets[i];
+                    Napi::Object packet = Napi::Object::New(env);
+                    packet.Set("track", p->stream_index);
+                    packet.Set("data", Napi::Buffer<uint8_t>::Copy(env, p->data, p->size));
+                    packet.Set("key", (p->flags & AV_PKT_FLAG_KEY) != 0);
+                    packet.Set("timestamp", static_cast<double>(p->pts));
+                    packet.Set("duration", static_cast<double>(p->duration));
+                    packets.Set(static_cast<uint32_t>(i), packet);
+                }
+                fn.Call({ env.Null(), packets });
+            } else if (j->kind == DemuxJob::Kind::Pipe) {
+                fn.Call({ env.Null(), Napi::Number::New(env, static_cast<double>(j->submitted)) });
+            } else {
+                fn.Call({ env.Null() });
+            }
+
+            bool counted = j->counted;
+            delete j;
+            if (counted && --pendingJobs_ == 0) {
+                Unref();
+            }
+        });
+    if (status != napi_ok && job->decoderRef.IsEmpty()) {
+        // Only at teardown; a job holding a JS reference is leaked instead,
+        // since the reference can't be dropped off the JS thread
+        delete job;
+    }
+    callback.Release();
+}
+
+#endif // NWC_HAVE_AVFORMAT
@@ -0,0 +1,91 @@
+#ifndef DEMUXER_H
+#define DEMUXER_H
+
+#include <napi.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "work_queue.h"
+
+#ifdef NWC_HAVE_AVFORMAT
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+struct DemuxJob;
+
+/**
+ * Container demuxer on libavformat (MP4/MOV, WebM/MKV, MPEG-TS, IVF).
+ *
+ * Reads from a path or an already-open file descriptor through pread, so
+ * the caller's fd offset is never moved and nothing else buffers the file.
+ * All I/O runs on one worker thread, in call order. Packets either come
+ * back to JS in batches (read) or go straight into a VideoDecoderAsync's
+ * queue (pipeTo) without becoming JS objects at all.
+ *
+ * Only built when libavformat is available (NWC_HAVE_AVFORMAT); otherwise
+ * the Demuxer export is absent.
+ */
+class Demuxer : public Napi::ObjectWrap<Demuxer> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    Demuxer(const Napi::CallbackInfo& info);
+    ~Demuxer();
+
+private:
+    static Napi::FunctionReference constructor;
+
+    // AVIO read buffer
+    static constexpr int kIOBufferSize = 64 * 1024;
+
+    // JavaScript-facing methods (all but close complete via callback)
+    void Open(const Napi::CallbackInfo& info);
+    void Read(const Napi::CallbackInfo& info);
+    void PipeTo(const Napi::CallbackInfo& info);
+    void Seek(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    void Submit(DemuxJob* job);
+    void StopWorker();
+    void CloseInput();
+
+    // Worker thread
+    void WorkerThread();
+    void RunOpen(DemuxJob* job);
+    void RunRead(DemuxJob* job);
+    void RunPipe(DemuxJob* job);
+    void RunSeek(DemuxJob* job);
+    void Complete(DemuxJob* job);
+    int ReadPacket(AVPacket* packet);
+
+    // AVIOContext callbacks over pread/fstat
+    static int IORead(void* opaque, uint8_t* buf, int size);
+    static int64_t IOSeek(void* opaque, int64_t offset, int whence);
+
+    WorkQueue<DemuxJob*> jobs_;
+    std::thread worker_;
+    std::atomic<bool> stopping_{false};
+    int pendingJobs_ = 0;  // JS thread only; pins the wrapper while > 0
+
+    // Worker thread only, once open
+    AVFormatContext* formatCtx_ = nullptr;
+    AVIOContext* ioCtx_ = nullptr;
+    int fd_ = -1;
+    bool ownsFd_ = false;
+    bool seekable_ = false;  // Regular file: pread and seeking; else read()
+    int64_t fileSize_ = 0;
+    int64_t position_ = 0;
+};
+
+#else
+
+// Stub without libavformat: registers nothing
+class Demuxer {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) { return exports; }
+};
+
+#endif // NWC_HAVE_AVFORMAT
+
+#endif // DEMUXER_H
@@ -3,6 +3,8 @@
 #include "hw_accel.h"
 #include "color.h"
 #include "svc.h"
+#include "encoder_setup.h"
+#include "threading.h"
 
 Napi::FunctionReference VideoEncoderNative::constructor;
 
@@ -40,7 +42,9 @@ VideoEncoderNative::VideoEncoderNative(const Napi::CallbackInfo& info)
     , bitrate_(2000000)
     , alpha_(false)
     , scalabilityMode_("")
-    , temporalLayers_(1) {
+    , temporalLayers_(1)
+    , temporalLayered_(false)
+    , svcFrameIndex_(0) {
 
     Napi::Env env = info.Env();
 
@@ -77,8 +81,10 @@ void VideoEncoderNative::configureEncoderOptions(const std::string& encoderName,
 
     // Global realtime optimizations - threading and delay
     if (isRealtime) {
-        codecCtx_->thread_count = 1;  // Single thread for lowest latency
-        codecCtx_->thread_type = 0;   // Disable threading
+        // Slice/row threading splits each frame instead of pipelining
+        // frames, so it scales across cores without adding frame delay
+        codecCtx_->thread_count = Threading::realtimeThreadCount(height_);
+        codecCtx_->thread_type = FF_THREAD_SLICE;
         codecCtx_->delay = 0;         // No delay
         codecCtx_->max_b_frames = 0;  // No B-frames for lowest latency
         codecCtx_->refs = 1;          // Single reference frame
@@ -91,6 +97,7 @@ void VideoEncoderNative::configureEncoderOptions(const std::string& encoderName,
             av_opt_set(codecCtx_->priv_data, "rc-lookahead", "0", 0);
             av_opt_set(codecCtx_->priv_data, "sync-lookahead", "0", 0);
             av_opt_set(codecCtx_->priv_data, "intra-refresh", "1", 0);
+            // thread_type SLICE selects sliced-threads: one slice per thread
         } else {
             // OPTIMIZATION: Use faster presets for smaller resolutions
             // This maintains quality for large frames while speeding up small ones
@@ -123,6 +130,12 @@ void VideoEncoderNative::configureEncoderOptions(const std::string& encoderName,
         }
         av_opt_set(codecCtx_->priv_data, "rc", "cbr", 0);
     }
+    else if (encoderName == "libopenh264") {
+        if (isRealtime) {
+            // openh264 threads across slices, so give each thread one
+            codecCtx_->slices = codecCtx_->thread_count;
+        }
+    }
     else if (encoderName == "h264_qsv" || encoderName == "hevc_qsv") {
         if (isRealtime) {
             av_opt_set(codecCtx_->priv_data, "preset", "veryfast", 0);
@@ -137,6 +150,14 @@ void VideoEncoderNative::configureEncoderOptions(const std::string& encoderName,
             av_opt_set_int(codecCtx_->priv_data, "b", codecCtx_->bit_rate, 0);
         }
         if (isRealtime) {
+            if (encoderName == "libvpx-vp9") {
+                av_opt_set_int(codecCtx_->priv_data, "row-mt", 1, 0);
+                av_opt_set_int(codecCtx_->priv_data, "tile-columns",
+                    Threading::tileColumnsLog2(width_, codecCtx_->thread_count), 0);
+            } else {
+                // VP8 has no row-mt; token partitions are its slice threading
+                codecCtx_->slices = codecCtx_->thread_count;
+            }
             av_opt_set_int(codecCtx_->priv_data, "cpu-used", 8, 0);  // Fastest
             av_opt_set_int(codecCtx_->priv_data, "lag-in-frames", 0, 0);
             av_opt_set(codecCtx_->priv_data, "deadline", "realtime", 0);
@@ -148,6 +169,9 @@ void VideoEncoderNative::configureEncoderOptions(const std::string& encoderName,
         if (isRealtime) {
             av_opt_set(codecCtx_->priv_data, "preset", "ultrafast", 0);
             av_opt_set(codecCtx_->priv_data, "tune", "zerolatency", 0);
+            // zerolatency disables frame threads; bound the WPP pool instead
+            std::string params = "pools=" + std::to_string(codecCtx_->thread_count);
+            av_opt_set(codecCtx_->priv_data, "x265-params", params.c_str(), 0);
         } else {
             // OPTIMIZATION: Use faster presets for smaller resolutions
             int pixels = width_ * height_;
@@ -167,6 +191,15 @@ void VideoEncoderNative::configureEncoderOptions(const std::string& encoderName,
             av_opt_set_int(codecCtx_->priv_data, "cpu-used", 10, 0);  // Max speed
             av_opt_set_int(codecCtx_->priv_data, "lag-in-frames", 0, 0);
             av_opt_set(codecCtx_->priv_data, "usage", "realtime", 0);
+            if (encoderName == "libaom-av1") {
+                av_opt_set_int(codecCtx_->priv_data, "row-mt", 1, 0);
+                av_opt_set_int(codecCtx_->priv_data, "tile-columns",
+                    Threading::tileColumnsLog2(width_, codecCtx_->thread_count), 0);
+            } else {
+                // SVT-AV1 sizes its own pools from the host core count
+                std::string params = "lp=" + std::to_string(codecCtx_->thread_count);
+                av_opt_set(codecCtx_->priv_data, "svtav1-params", params.c_str(), 0);
+            }
         } else {
             av_opt_set_int(codecCtx_->priv_data, "cpu-used", 6, 0);
         }
@@ -300,6 +333,18 @@ void VideoEncoderNative::Configure(const Napi::CallbackInfo& info) {
         alpha_ = (alphaMode == "keep");
     }
 
+    // Codec-string profile (H.264 profile_idc, HEVC/VP9/AV1 profile), -1 if none
+    int profile = -1;
+    if (config.Has("profile") && config.Get("profile").IsNumber()) {
+        profile = config.Get("profile").As<Napi::Number>().Int32Value();
+    }
+
+    // Expected input format hint; lets software encoders take it as-is
+    AVPixelFormat inputFormat = AV_PIX_FMT_NONE;
+    if (config.Has("inputFormat") && config.Get("inputFormat").IsString()) {
+        inputFormat = StringToPixelFormat(config.Get("inputFormat").As<Napi::String>().Utf8Value());
+    }
+
     // Set pixel format based on encoder type and alpha mode
     if (hwType_ != HWAccel::Type::None && hwInputFormat_ != AV_PIX_FMT_NONE) {
         codecCtx_->pix_fmt = hwInputFormat_;
@@ -307,7 +352,8 @@ void VideoEncoderNative::Configure(const Napi::CallbackInfo& info) {
         // VP8/VP9 with alpha - use YUVA420P
         codecCtx_->pix_fmt = AV_PIX_FMT_YUVA420P;
     } else {
-        codecCtx_->pix_fmt = AV_PIX_FMT_YUV420P;
+        // Input format if the encoder and profile take it, so no conversion
+        codecCtx_->pix_fmt = NegotiateEncoderPixelFormat(codec_, inputFormat, profile);
     }
 
     // Color space configuration (HDR support)
@@ -360,21 +406,27 @@ void VideoEncoderNative::Configure(const Napi::CallbackInfo& info) {
 
     // Profile (for H.264)
     std::string encoderName = codec_->name;
-    if (encoderName == "libx264" && config.Has("profile")) {
-        int profile = config.Get("profile").As<Napi::Number>().Int32Value();
+    if (encoderName == "libx264" && profile >= 0) {
         switch (profile) {
             case 66: av_opt_set(codecCtx_->priv_data, "profile", "baseline", 0); break;
             case 77: av_opt_set(codecCtx_->priv_data, "profile", "main", 0); break;
             case 100: av_opt_set(codecCtx_->priv_data, "profile", "high", 0); break;
+            case 110: av_opt_set(codecCtx_->priv_data, "profile", "high10", 0); break;
+            case 122: av_opt_set(codecCtx_->priv_data, "profile", "high422", 0); break;
+            case 244: av_opt_set(codecCtx_->priv_data, "profile", "high444", 0); break;
             default: av_opt_set(codecCtx_->priv_data, "profile", "main", 0); break;
         }
     }
 
-    // AVC format (Annex B vs AVCC)
+    // AVC format (Annex B vs AVCC); AVCC keeps parameter sets out of band
+    avcAnnexB_ = true;
     if (config.Has("avcFormat")) {
         std::string format = config.Get("avcFormat").As<Napi::String>().Utf8Value();
         avcAnnexB_ = (format == "annexb");
     }
+    if (!avcAnnexB_) {
+        codecCtx_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
 
     // Configure encoder-specific options
     std::string latencyMode = "quality";
@@ -384,72 +436,30 @@ void VideoEncoderNative::Configure(const Napi::CallbackInfo& info) {
     configureEncoderOptions(encoderName, latencyMode);
 
     // Scalability mode (SVC) for temporal layers
+    scalabilityMode_.clear();
+    temporalLayers_ = 1;
+    temporalLayered_ = false;
     if (config.Has("scalabilityMode") && config.Get("scalabilityMode").IsString()) {
         std::string svcMode = config.Get("scalabilityMode").As<Napi::String>().Utf8Value();
 
         if (!isScalabilityModeSupported(svcMode)) {
-            Napi::Error::New(env, "Unsupported scalabilityMode: " + svcMode +
-                ". Only L1T1, L1T2, L1T3 are currently supported.")
+            Napi::Error::New(env, unsupportedScalabilityModeMessage(svcMode))
                 .ThrowAsJavaScriptException();
             return;
         }
 
         ScalabilityConfig svcConfig = parseScalabilityMode(svcMode);
 
-        if (svcConfig.temporalLayers > 1) {
-            temporalLayers_ = svcConfig.temporalLayers;
-
-            if (encoderName.find("libvpx") != std::string::npos) {
-                // VP8/VP9 temporal layer configuration
-                av_opt_set(codecCtx_->priv_data, "lag-in-frames", "0", 0);
-                av_opt_set(codecCtx_->priv_data, "error-resilient", "1", 0);
-                av_opt_set_int(codecCtx_->priv_data, "auto-alt-ref", 0, 0);
-
-                // Build complete ts-parameters string for libvpx
-                // Format: ts_number_layers=N:ts_target_bitrate=B1,B2,...:ts_rate_decimator=D1,D2,...
-                char tsParams[256];
-                int layers = svcConfig.temporalLayers;
-
-                if (layers == 2) {
-                    // L1T2: 2 temporal layers
-                    // Layer 0: 60% bitrate, show every 2nd frame (decimator=2)
-                    // Layer 1: 100% bitrate, show every frame (decimator=1)
-                    int br0 = static_cast<int>(bitrate_ * 0.6 / 1000);  // Convert to kbps
-                    int br1 = static_cast<int>(bitrate_ / 1000);
-                    snprintf(tsParams, sizeof(tsParams),
-                        "ts_number_layers=2:ts_target_bitrate=%d,%d:ts_rate_decimator=2,1:ts_periodicity=2:ts_layer_id=0,1",
-                        br0, br1);
-                } else if (layers == 3) {
-                    // L1T3: 3 temporal layers
-                    // Layer 0: 25% bitrate, decimator 4
-                    // Layer 1: 50% bitrate, decimator 2
-                    // Layer 2: 100% bitrate, decimator 1
-                    int br0 = static_cast<int>(bitrate_ * 0.25 / 1000);
-                    int br1 = static_cast<int>(bitrate_ * 0.5 / 1000);
-                    int br2 = static_cast<int>(bitrate_ / 1000);
-                    snprintf(tsParams, sizeof(tsParams),
-                        "ts_number_layers=3:ts_target_bitrate=%d,%d,%d:ts_rate_decimator=4,2,1:ts_periodicity=4:ts_layer_id=0,2,1,2",
-                        br0, br1, br2);
-                }
-
-                av_opt_set(codecCtx_->priv_data, "ts-parameters", tsParams, 0);
-            }
-            else if (encoderName.find("libaom") != std::string::npos ||
-                     encoderName.find("av1") != std::string::npos) {
-                // AV1 temporal layer configuration
-                av_opt_set(codecCtx_->priv_data, "lag-in-frames", "0", 0);
-
-                // Use usage=realtime for SVC
-                av_opt_set(codecCtx_->priv_data, "usage", "realtime", 0);
-            }
-            else if (encoderName.find("libsvtav1") != std::string::npos) {
-                // SVT-AV1 temporal layer configuration
-                char hierLevels[8];
-                snprintf(hierLevels, sizeof(hierLevels), "%d", svcConfig.temporalLayers - 1);
-                av_opt_set(codecCtx_->priv_data, "hierarchical-levels", hierLevels, 0);
-            }
+        if (svcConfig.isSimulcast && svcConfig.spatialLayers > 1) {
+            Napi::Error::New(env, "Simulcast requires the worker-thread encoder (useWorkerThread: true)")
+                .ThrowAsJavaScriptException();
+            return;
         }
 
+        temporalLayers_ = svcConfig.temporalLayers;
+        temporalLayered_ = EncoderSetup::applyTemporalLayers(codecCtx_, svcConfig.temporalLayers, bitrate_);
+        svcFrameIndex_ = 0;
+
         scalabilityMode_ = svcMode;
     }
 
@@ -493,7 +503,10 @@ void VideoEncoderNative::Configure(const Napi::CallbackInfo& info) {
                 codecCtx_->gop_size = fps;
                 codecCtx_->framerate = { fps, 1 };
                 codecCtx_->max_b_frames = 0;
-                codecCtx_->pix_fmt = AV_PIX_FMT_YUV420P;
+                codecCtx_->pix_fmt = NegotiateEncoderPixelFormat(codec_, inputFormat, profile);
+                if (!avcAnnexB_) {
+                    codecCtx_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+                }
 
                 configureEncoderOptions(codec_->name, latencyMode);
 
@@ -514,6 +527,7 @@ void VideoEncoderNative::Configure(const Napi::CallbackInfo& info) {
         }
     }
 
+    bitstream_.configure(codecCtx_, avcAnnexB_);
     configured_ = true;
 }
 
@@ -544,9 +558,8 @@ void VideoEncoderNative::Encode(const Napi::CallbackInfo& info) {
     }
 
     // Check if input has alpha and we want to preserve it
-    bool inputHasAlpha = (srcFrame->format == AV_PIX_FMT_RGBA ||
-                          srcFrame->format == AV_PIX_FMT_BGRA ||
-                          srcFrame->format == AV_PIX_FMT_YUVA420P);
+    const AVPixFmtDescriptor* srcDesc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(srcFrame->format));
+    bool inputHasAlpha = srcDesc && (srcDesc->flags & AV_PIX_FMT_FLAG_ALPHA);
 
     // If alpha mode is 'keep' and input has alpha, ensure we use YUVA420P
     if (alpha_ && inputHasAlpha && targetFormat == AV_PIX_FMT_YUV420P) {
@@ -585,7 +598,7 @@ void VideoEncoderNative::Encode(const Napi::CallbackInfo& info) {
             av_opt_set_int(swsCtx_, "dsth", height_, 0);
             av_opt_set_int(swsCtx_, "dst_format", targetFormat, 0);
             av_opt_set_int(swsCtx_, "sws_flags", SWS_BILINEAR, 0);
-            av_opt_set_int(swsCtx_, "threads", 0, 0);
+            av_opt_set_int(swsCtx_, "threads", Threading::swsThreadCount(), 0);
             if (sws_init_context(swsCtx_, nullptr, nullptr) < 0) {
                 sws_freeContext(swsCtx_);
                 swsCtx_ = nullptr;
@@ -656,11 +669,13 @@ void VideoEncoderNative::Encode(const Napi::CallbackInfo& info) {
 }
 
 void VideoEncoderNative::EmitChunk(Napi::Env env, AVPacket* packet, bool isKeyframe) {
-    Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::Copy(env, packet->data, packet->size);
+    bitstream_.convert(packet, chunkData_);
+    Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::Copy(env, chunkData_.data(), chunkData_.size());
 
     Napi::Value extradataValue = env.Undefined();
-    if (isKeyframe && codecCtx_->extradata && codecCtx_->extradata_size > 0) {
-        extradataValue = Napi::Buffer<uint8_t>::Copy(env, codecCtx_->extradata, codecCtx_->extradata_size);
+    const std::vector<uint8_t>& description = bitstream_.description();
+    if (isKeyframe && !description.empty()) {
+        extradataValue = Napi::Buffer<uint8_t>::Copy(env, description.data(), description.size());
     }
 
     // Check for alpha side data (VP9 with alpha stores alpha plane here)
@@ -674,13 +689,21 @@ void VideoEncoderNative::EmitChunk(Napi::Env env, AVPacket* packet, bool isKeyfr
         }
     }
 
+    // No B-frames or lag with SVC, so packets follow the layer pattern in order
+    Napi::Value temporalLayerValue = env.Undefined();
+    if (!scalabilityMode_.empty()) {
+        temporalLayerValue = Napi::Number::New(env,
+            temporalLayered_ ? temporalLayerId(temporalLayers_, svcFrameIndex_++) : 0);
+    }
+
     outputCallback_.Value().Call({
         buffer,
         Napi::Boolean::New(env, isKeyframe),
         Napi::Number::New(env, packet->pts),
         Napi::Number::New(env, packet->duration),
         extradataValue,
-        alphaSideDataValue
+        alphaSideDataValue,
+        temporalLayerValue
     });
 }
 
@@ -738,6 +761,7 @@ void VideoEncoderNative::Close(const Napi::CallbackInfo& info) {
         avcodec_free_context(&codecCtx_);
         codecCtx_ = nullptr;
     }
+    bitstream_.reset();
 
     configured_ = false;
 }
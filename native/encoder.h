@@ -3,6 +3,7 @@
 
 #include <napi.h>
 #include "hw_accel.h"
+#include "bitstream.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -46,6 +47,8 @@ private:
 
     bool configured_;
     bool avcAnnexB_;
+    BitstreamConverter bitstream_;  // H.264/HEVC framing for avcFormat
+    std::vector<uint8_t> chunkData_;  // Reused output buffer for EmitChunk
     int width_;
     int height_;
 
@@ -60,6 +63,8 @@ private:
     // Scalability mode (SVC)
     std::string scalabilityMode_;
     int temporalLayers_;
+    bool temporalLayered_;    // Encoder follows temporalLayerId()'s pattern
+    int64_t svcFrameIndex_;
 };
 
 #endif
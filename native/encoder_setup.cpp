@@ -0,0 +1,251 @@
+#include "encoder_setup.h"
+#include "svc.h"
+#include "threading.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+namespace EncoderSetup {
+
+void applyRateControl(AVCodecContext* ctx, const std::string& bitrateMode, int64_t bitrate) {
+    std::string codecName = ctx->codec ? ctx->codec->name : "";
+
+    if (bitrateMode == "constant") {
+        ctx->bit_rate = bitrate;
+        ctx->rc_min_rate = bitrate;
+        ctx->rc_max_rate = bitrate;
+        ctx->rc_buffer_size = static_cast<int>(bitrate);
+
+        if (codecName.find("libx264") != std::string::npos) {
+            av_opt_set(ctx->priv_data, "nal-hrd", "cbr", 0);
+        } else if (codecName.find("libvpx") != std::string::npos) {
+            av_opt_set_int(ctx->priv_data, "minrate", bitrate, 0);
+            av_opt_set_int(ctx->priv_data, "maxrate", bitrate, 0);
+        }
+    } else if (bitrateMode == "quantizer") {
+        ctx->bit_rate = 0;
+        ctx->rc_max_rate = 0;
+
+        if (codecName.find("libx264") != std::string::npos ||
+            codecName.find("libx265") != std::string::npos) {
+            av_opt_set_int(ctx->priv_data, "crf", 23, 0);
+        } else if (codecName.find("libvpx") != std::string::npos) {
+            av_opt_set_int(ctx->priv_data, "crf", 30, 0);
+            ctx->qmin = 0;
+            ctx->qmax = 63;
+        } else if (codecName.find("av1") != std::string::npos) {
+            av_opt_set_int(ctx->priv_data, "crf", 30, 0);
+        }
+    } else {
+        ctx->bit_rate = bitrate;
+    }
+}
+
+void applyH264Profile(AVCodecContext* ctx, int profile) {
+    if (!ctx->codec || std::string(ctx->codec->name) != "libx264" || profile < 0) {
+        return;
+    }
+
+    switch (profile) {
+        case 66: av_opt_set(ctx->priv_data, "profile", "baseline", 0); break;
+        case 77: av_opt_set(ctx->priv_data, "profile", "main", 0); break;
+        case 100: av_opt_set(ctx->priv_data, "profile", "high", 0); break;
+        case 110: av_opt_set(ctx->priv_data, "profile", "high10", 0); break;
+        case 122: av_opt_set(ctx->priv_data, "profile", "high422", 0); break;
+        case 244: av_opt_set(ctx->priv_data, "profile", "high444", 0); break;
+        default: av_opt_set(ctx->priv_data, "profile", "main", 0); break;
+    }
+}
+
+void applyTuning(AVCodecContext* ctx, const std::string& latencyMode, int threadBudget) {
+    std::string encoderName = ctx->codec ? ctx->codec->name : "";
+    bool isRealtime = (latencyMode == "realtime");
+    int width = ctx->width;
+    int height = ctx->height;
+
+    // Global realtime optimizations
+    if (isRealtime) {
+        // Slice/row threading splits each frame instead of pipelining
+        // frames, so it scales across cores without adding frame delay
+        ctx->thread_count = Threading::realtimeThreadCount(height);
+        if (threadBudget > 0) {
+            ctx->thread_count = std::min(ctx->thread_count, threadBudget);
+        }
+        ctx->thread_type = FF_THREAD_SLICE;
+        ctx->delay = 0;
+        ctx->max_b_frames = 0;
+        ctx->refs = 1;
+    } else {
+        // Auto-detect (0) unless a cgroup quota/cpuset caps us below the host
+        // core count; default of 1 leaves multicore encode on the table
+        ctx->thread_count = threadBudget > 0 ? threadBudget : Threading::codecThreadCount();
+    }
+
+    if (encoderName == "libx264") {
+        if (isRealtime) {
+            av_opt_set(ctx->priv_data, "preset", "ultrafast", 0);
+            av_opt_set(ctx->priv_data, "tune", "zerolatency", 0);
+            av_opt_set(ctx->priv_data, "rc-lookahead", "0", 0);
+            av_opt_set(ctx->priv_data, "sync-lookahead", "0", 0);
+            av_opt_set(ctx->priv_data, "intra-refresh", "1", 0);
+            // thread_type SLICE selects sliced-threads: one slice per thread
+        } else {
+            // OPTIMIZATION: Use faster presets for smaller resolutions
+            // This maintains quality for large frames while speeding up small ones
+            int pixels = width * height;
+            const char* preset;
+            if (pixels <= 320 * 240) {           // QVGA or smaller
+                preset = "ultrafast";
+            } else if (pixels <= 640 * 480) {    // VGA or smaller
+                preset = "superfast";
+            } else if (pixels <= 1280 * 720) {   // 720p or smaller
+                preset = "veryfast";
+            } else {
+                preset = "medium";                // HD and above: quality matters
+            }
+            av_opt_set(ctx->priv_data, "preset", preset, 0);
+        }
+    }
+    else if (encoderName == "h264_videotoolbox" || encoderName == "hevc_videotoolbox") {
+        av_opt_set(ctx->priv_data, "realtime", isRealtime ? "1" : "0", 0);
+        av_opt_set(ctx->priv_data, "allow_sw", "1", 0);
+    }
+    else if (encoderName == "h264_nvenc" || encoderName == "hevc_nvenc") {
+        if (isRealtime) {
+            av_opt_set(ctx->priv_data, "preset", "p1", 0);
+            av_opt_set(ctx->priv_data, "tune", "ll", 0);
+            av_opt_set(ctx->priv_data, "zerolatency", "1", 0);
+            av_opt_set(ctx->priv_data, "rc-lookahead", "0", 0);
+        } else {
+            av_opt_set(ctx->priv_data, "preset", "p4", 0);
+        }
+        av_opt_set(ctx->priv_data, "rc", "cbr", 0);
+    }
+    else if (encoderName == "libopenh264") {
+        if (isRealtime) {
+            // openh264 threads across slices, so give each thread one
+            ctx->slices = ctx->thread_count;
+        }
+    }
+    else if (encoderName == "h264_qsv" || encoderName == "hevc_qsv") {
+        if (isRealtime) {
+            av_opt_set(ctx->priv_data, "preset", "veryfast", 0);
+            av_opt_set(ctx->priv_data, "low_delay_brc", "1", 0);
+            av_opt_set(ctx->priv_data, "look_ahead", "0", 0);
+        }
+    }
+    else if (encoderName == "libvpx" || encoderName == "libvpx-vp9") {
+        if (ctx->bit_rate > 0) {
+            av_opt_set_int(ctx->priv_data, "crf", 10, 0);
+            av_opt_set_int(ctx->priv_data, "b", ctx->bit_rate, 0);
+        }
+        // libvpx only parallelizes with row-mt and, for VP9, tiles
+        av_opt_set_int(ctx->priv_data, "row-mt", 1, 0);
+        if (isRealtime) {
+            if (encoderName == "libvpx-vp9") {
+                av_opt_set_int(ctx->priv_data, "tile-columns",
+                    Threading::tileColumnsLog2(width, ctx->thread_count), 0);
+            } else {
+                // VP8 has no row-mt; token partitions are its slice threading
+                ctx->slices = ctx->thread_count;
+            }
+        } else if (encoderName == "libvpx-vp9" && width >= 1280) {
+            av_opt_set_int(ctx->priv_data, "tile-columns", 2, 0);
+        }
+        if (isRealtime) {
+            av_opt_set_int(ctx->priv_data, "cpu-used", 8, 0);
+            av_opt_set_int(ctx->priv_data, "lag-in-frames", 0, 0);
+            av_opt_set(ctx->priv_data, "deadline", "realtime", 0);
+        } else {
+            av_opt_set_int(ctx->priv_data, "cpu-used", 4, 0);
+        }
+    }
+    else if (encoderName == "libx265") {
+        if (isRealtime) {
+            av_opt_set(ctx->priv_data, "preset", "ultrafast", 0);
+            av_opt_set(ctx->priv_data, "tune", "zerolatency", 0);
+            // zerolatency disables frame threads; bound the WPP pool instead
+            std::string params = "pools=" + std::to_string(ctx->thread_count);
+            av_opt_set(ctx->priv_data, "x265-params", params.c_str(), 0);
+        } else {
+            // OPTIMIZATION: Use faster presets for smaller resolutions
+            int pixels = width * height;
+            const char* preset;
+            if (pixels <= 640 * 480) {
+                preset = "ultrafast";
+            } else if (pixels <= 1280 * 720) {
+                preset = "veryfast";
+            } else {
+                preset = "medium";
+            }
+            av_opt_set(ctx->priv_data, "preset", preset, 0);
+        }
+    }
+    else if (encoderName == "libaom-av1" || encoderName == "libsvtav1") {
+        if (isRealtime) {
+            av_opt_set_int(ctx->priv_data, "cpu-used", 10, 0);
+            av_opt_set_int(ctx->priv_data, "lag-in-frames", 0, 0);
+            av_opt_set(ctx->priv_data, "usage", "realtime", 0);
+            if (encoderName == "libaom-av1") {
+                av_opt_set_int(ctx->priv_data, "row-mt", 1, 0);
+                av_opt_set_int(ctx->priv_data, "tile-columns",
+                    Threading::tileColumnsLog2(width, ctx->thread_count), 0);
+            } else {
+                // SVT-AV1 sizes its own pools from the host core count
+                std::string params = "lp=" + std::to_string(ctx->thread_count);
+                av_opt_set(ctx->priv_data, "svtav1-params", params.c_str(), 0);
+            }
+        } else {
+            av_opt_set_int(ctx->priv_data, "cpu-used", 6, 0);
+        }
+    }
+}
+
+bool applyTemporalLayers(AVCodecContext* ctx, int layers, int64_t bitrate) {
+    std::string encoderName = ctx->codec ? ctx->codec->name : "";
+    if (layers < 2 || layers > 3) {
+        return false;
+    }
+
+    if (encoderName.find("libvpx") != std::string::npos) {
+        av_opt_set(ctx->priv_data, "lag-in-frames", "0", 0);
+        av_opt_set(ctx->priv_data, "error-resilient", "1", 0);
+        av_opt_set_int(ctx->priv_data, "auto-alt-ref", 0, 0);
+
+        // ts_target_bitrate is cumulative per layer, in kbps
+        std::vector<int64_t> bitrates = temporalLayerBitrates(layers, bitrate);
+        std::string targets;
+        for (size_t i = 0; i < bitrates.size(); i++) {
+            if (i > 0) targets += ",";
+            targets += std::to_string(bitrates[i] / 1000);
+        }
+
+        std::string tsParams = "ts_number_layers=" + std::to_string(layers) +
+            ":ts_target_bitrate=" + targets +
+            (layers == 2
+                ? ":ts_rate_decimator=2,1:ts_periodicity=2:ts_layer_id=0,1"
+                : ":ts_rate_decimator=4,2,1:ts_periodicity=4:ts_layer_id=0,2,1,2") +
+            // Per-layer reference/update flags, so upper layers never refresh
+            // the base layer's buffer and can be dropped (SvcLayerFilter)
+            ":ts_layering_mode=" + std::to_string(layers);
+
+        av_opt_set(ctx->priv_data, "ts-parameters", tsParams.c_str(), 0);
+        return true;
+    }
+    else if (encoderName == "libsvtav1") {
+        char hierLevels[8];
+        snprintf(hierLevels, sizeof(hierLevels), "%d", layers - 1);
+        av_opt_set(ctx->priv_data, "hierarchical-levels", hierLevels, 0);
+    }
+    else if (encoderName.find("av1") != std::string::npos) {
+        av_opt_set(ctx->priv_data, "lag-in-frames", "0", 0);
+        av_opt_set(ctx->priv_data, "usage", "realtime", 0);
+    }
+    return false;
+}
+
+} // namespace EncoderSetup
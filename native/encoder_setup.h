@@ -0,0 +1,47 @@
+#ifndef ENCODER_SETUP_H
+#define ENCODER_SETUP_H
+
+#include <string>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * Codec-context tuning shared by every encoder that opens an AVCodecContext
+ * (VideoEncoderAsync, VideoLadderEncoder). The context must be allocated for
+ * its codec with width/height set; these run before avcodec_open2.
+ */
+namespace EncoderSetup {
+
+/**
+ * Rate control for a WebCodecs bitrateMode ("constant", "variable",
+ * "quantizer").
+ */
+void applyRateControl(AVCodecContext* ctx, const std::string& bitrateMode, int64_t bitrate);
+
+/**
+ * libx264 profile from an H.264 profile_idc; no-op for other encoders or
+ * profile < 0.
+ */
+void applyH264Profile(AVCodecContext* ctx, int profile);
+
+/**
+ * Threading, preset and latency options for latencyMode ("quality" or
+ * "realtime"). threadBudget caps the codec's threads when several encoders
+ * share the process budget; 0 uses the whole budget.
+ */
+void applyTuning(AVCodecContext* ctx, const std::string& latencyMode, int threadBudget = 0);
+
+/**
+ * Temporal scalability (the T in L1T3): libvpx ts-parameters with the
+ * 0,1 / 0,2,1,2 layer patterns, AV1 realtime low-delay settings. bitrate
+ * is the total across layers. Returns true if the encoder follows the
+ * fixed pattern, so temporalLayerId() (svc.h) gives each frame's layer;
+ * false for layers < 2 or encoders that don't layer.
+ */
+bool applyTemporalLayers(AVCodecContext* ctx, int layers, int64_t bitrate);
+
+} // namespace EncoderSetup
+
+#endif // ENCODER_SETUP_H
@@ -1,5 +1,17 @@
 #include "frame.h"
+#include "scaler.h"
+#include "threading.h"
+#include <cmath>
 #include <cstring>
+#include <vector>
+
+extern "C" {
+#include <libavutil/motion_vector.h>
+#if __has_include(<libavutil/video_enc_params.h>)
+#include <libavutil/video_enc_params.h>
+#define NWC_HAVE_VIDEO_ENC_PARAMS 1
+#endif
+}
 
 Napi::FunctionReference VideoFrameNative::constructor;
 
@@ -9,6 +21,8 @@ Napi::Object VideoFrameNative::Init(Napi::Env env, Napi::Object exports) {
         InstanceMethod("copyTo", &VideoFrameNative::CopyTo),
         InstanceMethod("clone", &VideoFrameNative::Clone),
         InstanceMethod("scale", &VideoFrameNative::Scale),
+        InstanceMethod("codecAnalysis", &VideoFrameNative::CodecAnalysis),
+        InstanceMethod("motionGrid", &VideoFrameNative::MotionGrid),
         InstanceMethod("close", &VideoFrameNative::Close),
         InstanceAccessor("width", &VideoFrameNative::GetWidth, nullptr),
         InstanceAccessor("height", &VideoFrameNative::GetHeight, nullptr),
@@ -198,6 +212,20 @@ VideoFrameNative::VideoFrameNative(const Napi::CallbackInfo& info)
                        width);
             }
         }
+    } else {
+        // Alpha and high bit depth planar formats: planes packed back to
+        // back in WebCodecs order (Y, U, V, A), i.e. align-1 FFmpeg layout
+        uint8_t* srcData[4] = {nullptr, nullptr, nullptr, nullptr};
+        int srcLinesize[4] = {0, 0, 0, 0};
+        int needed = av_image_fill_arrays(srcData, srcLinesize, src, pixFmt, width, height, 1);
+        if (needed < 0 || srcLen < static_cast<size_t>(needed)) {
+            av_frame_free(&frame_);
+            Napi::TypeError::New(env, "Buffer too small for " + format + " frame").ThrowAsJavaScriptException();
+            return;
+        }
+        av_image_copy(frame_->data, frame_->linesize,
+                      const_cast<const uint8_t**>(srcData), srcLinesize,
+                      pixFmt, width, height);
     }
 }
 
@@ -324,46 +352,18 @@ Napi::Value VideoFrameNative::CopyTo(const Napi::CallbackInfo& info) {
 
         AVPixelFormat srcFmt = static_cast<AVPixelFormat>(frame_->format);
 
-        // Calculate byte offset for the crop region
-        if (srcFmt == AV_PIX_FMT_YUV420P || srcFmt == AV_PIX_FMT_YUVA420P) {
-            // YUV420P: Y is full res, U/V are half res
-            srcSlice[0] = frame_->data[0] + rectY * frame_->linesize[0] + rectX;
-            srcSlice[1] = frame_->data[1] + (rectY / 2) * frame_->linesize[1] + (rectX / 2);
-            srcSlice[2] = frame_->data[2] + (rectY / 2) * frame_->linesize[2] + (rectX / 2);
-            if (srcFmt == AV_PIX_FMT_YUVA420P && frame_->data[3]) {
-                srcSlice[3] = frame_->data[3] + rectY * frame_->linesize[3] + rectX;
-            }
-            srcStride[0] = frame_->linesize[0];
-            srcStride[1] = frame_->linesize[1];
-            srcStride[2] = frame_->linesize[2];
-            srcStride[3] = frame_->linesize[3];
-        } else if (srcFmt == AV_PIX_FMT_YUV422P) {
-            // YUV422P: Y is full res, U/V are half width, full height
-            srcSlice[0] = frame_->data[0] + rectY * frame_->linesize[0] + rectX;
-            srcSlice[1] = frame_->data[1] + rectY * frame_->linesize[1] + (rectX / 2);
-            srcSlice[2] = frame_->data[2] + rectY * frame_->linesize[2] + (rectX / 2);
-            srcStride[0] = frame_->linesize[0];
-            srcStride[1] = frame_->linesize[1];
-            srcStride[2] = frame_->linesize[2];
-        } else if (srcFmt == AV_PIX_FMT_YUV444P) {
-            // YUV444P: all planes are full res
-            srcSlice[0] = frame_->data[0] + rectY * frame_->linesize[0] + rectX;
-            srcSlice[1] = frame_->data[1] + rectY * frame_->linesize[1] + rectX;
-            srcSlice[2] = frame_->data[2] + rectY * frame_->linesize[2] + rectX;
-            srcStride[0] = frame_->linesize[0];
-            srcStride[1] = frame_->linesize[1];
-            srcStride[2] = frame_->linesize[2];
-        } else if (srcFmt == AV_PIX_FMT_NV12) {
-            // NV12: Y plane, interleaved UV plane (half res)
-            srcSlice[0] = frame_->data[0] + rectY * frame_->linesize[0] + rectX;
-            srcSlice[1] = frame_->data[1] + (rectY / 2) * frame_->linesize[1] + (rectX & ~1);
-            srcStride[0] = frame_->linesize[0];
-            srcStride[1] = frame_->linesize[1];
-        } else {
-            // Packed formats (RGBA, BGRA, etc.) - 4 bytes per pixel
-            int bytesPerPixel = 4;
-            srcSlice[0] = frame_->data[0] + rectY * frame_->linesize[0] + rectX * bytesPerPixel;
-            srcStride[0] = frame_->linesize[0];
+        // Byte offset of the crop origin in each plane: chroma planes (1, 2)
+        // are subsampled, and each plane's pixel step covers packed, semi-
+        // planar and 16-bit layouts alike
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(srcFmt);
+        int pixSteps[4] = {0, 0, 0, 0};
+        av_image_fill_max_pixsteps(pixSteps, nullptr, desc);
+        for (int i = 0; i < av_pix_fmt_count_planes(srcFmt) && i < 4; i++) {
+            bool chroma = (i == 1 || i == 2);
+            int x = chroma ? (rectX >> desc->log2_chroma_w) : rectX;
+            int y = chroma ? (rectY >> desc->log2_chroma_h) : rectY;
+            srcSlice[i] = frame_->data[i] + y * frame_->linesize[i] + x * pixSteps[i];
+            srcStride[i] = frame_->linesize[i];
         }
 
         // Perform the conversion
@@ -503,7 +503,7 @@ Napi::Value VideoFrameNative::Scale(const Napi::CallbackInfo& info) {
     av_opt_set_int(sws, "dsth", dstH, 0);
     av_opt_set_int(sws, "dst_format", frame_->format, 0);
     av_opt_set_int(sws, "sws_flags", SWS_BILINEAR, 0);
-    av_opt_set_int(sws, "threads", 0, 0);
+    av_opt_set_int(sws, "threads", Threading::swsThreadCount(), 0);
     if (sws_init_context(sws, nullptr, nullptr) < 0) {
         sws_freeContext(sws);
         av_frame_free(&out);
@@ -519,10 +519,131 @@ Napi::Value VideoFrameNative::Scale(const Napi::CallbackInfo& info) {
         return env.Undefined();
     }
 
-    av_frame_copy_props(out, frame_);
+    CopyScaledFrameProps(out, frame_);
     return NewInstance(env, out);
 }
 
+// Codec side data for decoders configured with exportCodecAnalysis:
+// { pictType, motionVectors?: Int16Array, qp?: { base, blocks: Int16Array } }
+// motionVectors holds 8 values per vector: source (-1 past, 1 future),
+// w, h, dstX, dstY (block centre), motionX, motionY, motionScale (motion
+// is in 1/motionScale pixels). qp blocks hold x, y, w, h, deltaQp.
+Napi::Value VideoFrameNative::CodecAnalysis(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!frame_) {
+        Napi::Error::New(env, "Frame is closed").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    char pictType = av_get_picture_type_char(frame_->pict_type);
+    result.Set("pictType", Napi::String::New(env, std::string(1, pictType)));
+
+    const AVFrameSideData* mvData = av_frame_get_side_data(frame_, AV_FRAME_DATA_MOTION_VECTORS);
+    if (mvData) {
+        const AVMotionVector* mvs = reinterpret_cast<const AVMotionVector*>(mvData->data);
+        size_t count = mvData->size / sizeof(AVMotionVector);
+
+        Napi::Int16Array packed = Napi::Int16Array::New(env, count * 8);
+        int16_t* out = packed.Data();
+        for (size_t i = 0; i < count; i++, out += 8) {
+            const AVMotionVector& mv = mvs[i];
+            out[0] = static_cast<int16_t>(mv.source);
+            out[1] = mv.w;
+            out[2] = mv.h;
+            out[3] = mv.dst_x;
+            out[4] = mv.dst_y;
+            out[5] = static_cast<int16_t>(av_clip_int16(mv.motion_x));
+            out[6] = static_cast<int16_t>(av_clip_int16(mv.motion_y));
+            out[7] = static_cast<int16_t>(mv.motion_scale);
+        }
+        result.Set("motionVectors", packed);
+    }
+
+#ifdef NWC_HAVE_VIDEO_ENC_PARAMS
+    const AVFrameSideData* qpData = av_frame_get_side_data(frame_, AV_FRAME_DATA_VIDEO_ENC_PARAMS);
+    if (qpData) {
+        AVVideoEncParams* params = reinterpret_cast<AVVideoEncParams*>(qpData->data);
+
+        Napi::Int16Array blocks = Napi::Int16Array::New(env, static_cast<size_t>(params->nb_blocks) * 5);
+        int16_t* out = blocks.Data();
+        for (unsigned i = 0; i < params->nb_blocks; i++, out += 5) {
+            const AVVideoBlockParams* block = av_video_enc_params_block(params, i);
+            out[0] = static_cast<int16_t>(block->src_x);
+            out[1] = static_cast<int16_t>(block->src_y);
+            out[2] = static_cast<int16_t>(block->w);
+            out[3] = static_cast<int16_t>(block->h);
+            out[4] = static_cast<int16_t>(block->delta_qp);
+        }
+
+        Napi::Object qp = Napi::Object::New(env);
+        qp.Set("base", Napi::Number::New(env, params->qp));
+        qp.Set("blocks", blocks);
+        result.Set("qp", qp);
+    }
+#endif
+
+    return result;
+}
+
+// motionGrid(blockSize): mean motion magnitude in pixels per blockSize cell,
+// weighted by the area of the vectors' blocks. Each vector lands in the cell
+// holding its block centre; B-frames average both directions. Cells with
+// no vectors (intra) are 0. null if the frame carries no motion vectors.
+Napi::Value VideoFrameNative::MotionGrid(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!frame_) {
+        Napi::Error::New(env, "Frame is closed").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    int blockSize = info.Length() > 0 && info[0].IsNumber() ? info[0].As<Napi::Number>().Int32Value() : 16;
+    if (blockSize <= 0) {
+        Napi::TypeError::New(env, "blockSize must be positive").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    const AVFrameSideData* mvData = av_frame_get_side_data(frame_, AV_FRAME_DATA_MOTION_VECTORS);
+    if (!mvData) {
+        return env.Null();
+    }
+
+    int columns = (frame_->width + blockSize - 1) / blockSize;
+    int rows = (frame_->height + blockSize - 1) / blockSize;
+    std::vector<float> weighted(static_cast<size_t>(columns) * rows, 0.0f);
+    std::vector<float> area(weighted.size(), 0.0f);
+
+    const AVMotionVector* mvs = reinterpret_cast<const AVMotionVector*>(mvData->data);
+    size_t count = mvData->size / sizeof(AVMotionVector);
+    for (size_t i = 0; i < count; i++) {
+        const AVMotionVector& mv = mvs[i];
+        int column = mv.dst_x / blockSize;
+        int row = mv.dst_y / blockSize;
+        if (mv.dst_x < 0 || mv.dst_y < 0 || column >= columns || row >= rows) continue;
+
+        float scale = mv.motion_scale > 0 ? mv.motion_scale : 1.0f;
+        float magnitude = std::hypot(static_cast<float>(mv.motion_x), static_cast<float>(mv.motion_y)) / scale;
+        float blockArea = static_cast<float>(mv.w) * mv.h;
+        size_t cell = static_cast<size_t>(row) * columns + column;
+        weighted[cell] += magnitude * blockArea;
+        area[cell] += blockArea;
+    }
+
+    Napi::Float32Array magnitudes = Napi::Float32Array::New(env, weighted.size());
+    for (size_t i = 0; i < weighted.size(); i++) {
+        magnitudes[i] = area[i] > 0 ? weighted[i] / area[i] : 0.0f;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("columns", Napi::Number::New(env, columns));
+    result.Set("rows", Napi::Number::New(env, rows));
+    result.Set("blockSize", Napi::Number::New(env, blockSize));
+    result.Set("magnitudes", magnitudes);
+    return result;
+}
+
 Napi::Object VideoFrameNative::NewInstance(Napi::Env env, AVFrame* frame) {
     Napi::Object obj = constructor.New({});
     VideoFrameNative* instance = Napi::ObjectWrap<VideoFrameNative>::Unwrap(obj);
@@ -531,11 +652,26 @@ Napi::Object VideoFrameNative::NewInstance(Napi::Env env, AVFrame* frame) {
     return obj;
 }
 
+// High bit depth formats are native-endian 16-bit samples, matching how
+// WebCodecs (and a Uint16Array over the buffer) lays them out
 AVPixelFormat StringToPixelFormat(const std::string& format) {
     if (format == "I420") return AV_PIX_FMT_YUV420P;
+    if (format == "I420P10") return AV_PIX_FMT_YUV420P10;
+    if (format == "I420P12") return AV_PIX_FMT_YUV420P12;
     if (format == "I420A") return AV_PIX_FMT_YUVA420P;
+    if (format == "I420AP10") return AV_PIX_FMT_YUVA420P10;
     if (format == "I422") return AV_PIX_FMT_YUV422P;
+    if (format == "I422P10") return AV_PIX_FMT_YUV422P10;
+    if (format == "I422P12") return AV_PIX_FMT_YUV422P12;
+    if (format == "I422A") return AV_PIX_FMT_YUVA422P;
+    if (format == "I422AP10") return AV_PIX_FMT_YUVA422P10;
+    if (format == "I422AP12") return AV_PIX_FMT_YUVA422P12;
     if (format == "I444") return AV_PIX_FMT_YUV444P;
+    if (format == "I444P10") return AV_PIX_FMT_YUV444P10;
+    if (format == "I444P12") return AV_PIX_FMT_YUV444P12;
+    if (format == "I444A") return AV_PIX_FMT_YUVA444P;
+    if (format == "I444AP10") return AV_PIX_FMT_YUVA444P10;
+    if (format == "I444AP12") return AV_PIX_FMT_YUVA444P12;
     if (format == "NV12") return AV_PIX_FMT_NV12;
     if (format == "RGBA") return AV_PIX_FMT_RGBA;
     if (format == "RGBX") return AV_PIX_FMT_RGB0;
@@ -547,9 +683,22 @@ AVPixelFormat StringToPixelFormat(const std::string& format) {
 std::string PixelFormatToString(AVPixelFormat format) {
     switch (format) {
         case AV_PIX_FMT_YUV420P: return "I420";
+        case AV_PIX_FMT_YUV420P10: return "I420P10";
+        case AV_PIX_FMT_YUV420P12: return "I420P12";
         case AV_PIX_FMT_YUVA420P: return "I420A";
+        case AV_PIX_FMT_YUVA420P10: return "I420AP10";
         case AV_PIX_FMT_YUV422P: return "I422";
+        case AV_PIX_FMT_YUV422P10: return "I422P10";
+        case AV_PIX_FMT_YUV422P12: return "I422P12";
+        case AV_PIX_FMT_YUVA422P: return "I422A";
+        case AV_PIX_FMT_YUVA422P10: return "I422AP10";
+        case AV_PIX_FMT_YUVA422P12: return "I422AP12";
         case AV_PIX_FMT_YUV444P: return "I444";
+        case AV_PIX_FMT_YUV444P10: return "I444P10";
+        case AV_PIX_FMT_YUV444P12: return "I444P12";
+        case AV_PIX_FMT_YUVA444P: return "I444A";
+        case AV_PIX_FMT_YUVA444P10: return "I444AP10";
+        case AV_PIX_FMT_YUVA444P12: return "I444AP12";
         case AV_PIX_FMT_NV12: return "NV12";
         case AV_PIX_FMT_RGBA: return "RGBA";
         case AV_PIX_FMT_RGB0: return "RGBX";
@@ -559,6 +708,120 @@ std::string PixelFormatToString(AVPixelFormat format) {
     }
 }
 
+static const AVPixelFormat* EncoderPixelFormats(const AVCodec* codec) {
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61, 13, 100)
+    const void* fmts = nullptr;
+    int count = 0;
+    if (avcodec_get_supported_config(nullptr, codec, AV_CODEC_CONFIG_PIX_FORMAT, 0, &fmts, &count) < 0) {
+        return nullptr;
+    }
+    return static_cast<const AVPixelFormat*>(fmts);
+#else
+    return codec->pix_fmts;
+#endif
+}
+
+// Whether the codec-string profile can carry this chroma subsampling and
+// bit depth; encoders would otherwise silently emit a higher profile than
+// the codec string (and decoderConfig) advertises
+static bool ProfileAllowsPixelFormat(AVCodecID codecId, int profile, const AVPixFmtDescriptor* desc) {
+    if (profile < 0) return true;
+
+    bool is420 = desc->log2_chroma_w == 1 && desc->log2_chroma_h == 1;
+    bool is422 = desc->log2_chroma_w == 1 && desc->log2_chroma_h == 0;
+    bool is444 = desc->log2_chroma_w == 0 && desc->log2_chroma_h == 0;
+    int depth = desc->comp[0].depth;
+
+    switch (codecId) {
+        case AV_CODEC_ID_H264:
+            switch (profile) {
+                case 110: return is420 && depth <= 10;              // High 10
+                case 122: return (is420 || is422) && depth <= 10;   // High 4:2:2
+                case 244: return depth <= 14;                       // High 4:4:4 Predictive
+                default: return is420 && depth == 8;
+            }
+        case AV_CODEC_ID_HEVC:
+            switch (profile) {
+                case 1: return is420 && depth == 8;                 // Main
+                case 2: return is420 && depth <= 10;                // Main 10
+                default: return true;                               // Range extensions
+            }
+        case AV_CODEC_ID_VP9:
+            // Odd profiles are non-4:2:0, profiles 2/3 are high bit depth
+            return ((profile & 1) ? !is420 : is420) && ((profile & 2) ? depth > 8 : depth == 8);
+        case AV_CODEC_ID_AV1:
+            switch (profile) {
+                case 0: return is420 && depth <= 10;                // Main
+                case 1: return (is420 || is444) && depth <= 10;     // High
+                default: return true;                               // Professional
+            }
+        default:
+            return true;
+    }
+}
+
+static bool IsEncoderCandidate(AVPixelFormat fmt, const AVPixFmtDescriptor* desc) {
+    // Alpha goes through the explicit alpha: 'keep' path; JPEG-range aliases
+    // are deprecated in favour of color_range
+    if (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_HWACCEL |
+                       AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_ALPHA)) {
+        return false;
+    }
+    return desc->nb_components >= 3 &&
+           fmt != AV_PIX_FMT_YUVJ420P && fmt != AV_PIX_FMT_YUVJ422P && fmt != AV_PIX_FMT_YUVJ444P;
+}
+
+AVPixelFormat NegotiateEncoderPixelFormat(const AVCodec* codec, AVPixelFormat input, int profile) {
+    const AVPixelFormat* fmts = EncoderPixelFormats(codec);
+    const AVPixFmtDescriptor* inDesc = av_pix_fmt_desc_get(input);
+    if (!fmts || !inDesc || (inDesc->flags & AV_PIX_FMT_FLAG_RGB)) {
+        // RGB input needs a matrix conversion whatever we pick
+        return AV_PIX_FMT_YUV420P;
+    }
+
+    for (const AVPixelFormat* p = fmts; *p != AV_PIX_FMT_NONE; p++) {
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(*p);
+        if (*p == input && desc && IsEncoderCandidate(*p, desc) &&
+            ProfileAllowsPixelFormat(codec->id, profile, desc)) {
+            return input;
+        }
+    }
+
+    // Same layout class (e.g. I420A -> I420, NV12 -> I420 for encoders
+    // without NV12): conversion is a plane copy, no resampling or rounding
+    for (const AVPixelFormat* p = fmts; *p != AV_PIX_FMT_NONE; p++) {
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(*p);
+        if (desc && IsEncoderCandidate(*p, desc) &&
+            desc->log2_chroma_w == inDesc->log2_chroma_w &&
+            desc->log2_chroma_h == inDesc->log2_chroma_h &&
+            desc->comp[0].depth == inDesc->comp[0].depth &&
+            ProfileAllowsPixelFormat(codec->id, profile, desc)) {
+            return *p;
+        }
+    }
+
+    return AV_PIX_FMT_YUV420P;
+}
+
+bool CloneFrames(Napi::Env env, const Napi::Array& values, std::vector<AVFrame*>& frames) {
+    size_t start = frames.size();
+    frames.reserve(start + values.Length());
+    for (uint32_t i = 0; i < values.Length(); i++) {
+        Napi::Value value = values.Get(i);
+        VideoFrameNative* native = value.IsObject()
+            ? Napi::ObjectWrap<VideoFrameNative>::Unwrap(value.As<Napi::Object>()) : nullptr;
+        AVFrame* frame = native && native->GetFrame() ? av_frame_clone(native->GetFrame()) : nullptr;
+        if (!frame) {
+            for (size_t j = start; j < frames.size(); j++) av_frame_free(&frames[j]);
+            frames.resize(start);
+            Napi::TypeError::New(env, "Frame " + std::to_string(i) + " is closed").ThrowAsJavaScriptException();
+            return false;
+        }
+        frames.push_back(frame);
+    }
+    return true;
+}
+
 Napi::Value CreateVideoFrame(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
 
@@ -2,10 +2,13 @@
 #define FRAME_H
 
 #include <napi.h>
+#include <vector>
 
 extern "C" {
+#include <libavcodec/avcodec.h>
 #include <libavutil/frame.h>
 #include <libavutil/pixfmt.h>
+#include <libavutil/pixdesc.h>
 #include <libavutil/imgutils.h>
 #include <libswscale/swscale.h>
 #include <libavutil/opt.h>
@@ -36,6 +39,8 @@ private:
     Napi::Value CopyTo(const Napi::CallbackInfo& info);
     Napi::Value Clone(const Napi::CallbackInfo& info);
     Napi::Value Scale(const Napi::CallbackInfo& info);
+    Napi::Value CodecAnalysis(const Napi::CallbackInfo& info);
+    Napi::Value MotionGrid(const Napi::CallbackInfo& info);
     void Close(const Napi::CallbackInfo& info);
 
     Napi::Value GetWidth(const Napi::CallbackInfo& info);
@@ -51,6 +56,17 @@ private:
 AVPixelFormat StringToPixelFormat(const std::string& format);
 std::string PixelFormatToString(AVPixelFormat format);
 
+// Encoder pix_fmt for frames expected in `input`: the input format itself if
+// the encoder and profile (codec-string profile number, -1 if none) accept
+// it, so frames are passed by reference; else a supported format with the
+// same chroma subsampling and bit depth; else YUV420P.
+AVPixelFormat NegotiateEncoderPixelFormat(const AVCodec* codec, AVPixelFormat input, int profile);
+
+// Appends a new reference to the AVFrame behind each VideoFrameNative in
+// `values`, so frames closed while a worker runs stay valid. On a closed or
+// foreign entry throws a TypeError, drops what it appended and returns false.
+bool CloneFrames(Napi::Env env, const Napi::Array& values, std::vector<AVFrame*>& frames);
+
 // Factory function for creating VideoFrame from JS
 Napi::Value CreateVideoFrame(const Napi::CallbackInfo& info);
 
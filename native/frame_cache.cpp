@@ -0,0 +1,156 @@
+#include "frame_cache.h"
+#include "frame.h"
+
+Napi::FunctionReference FrameCache::constructor;
+
+namespace {
+
+size_t frameBytes(const AVFrame* frame) {
+    size_t bytes = 0;
+    for (int i = 0; i < AV_NUM_DATA_POINTERS && frame->buf[i]; i++) {
+        bytes += frame->buf[i]->size;
+    }
+    return bytes;
+}
+
+} // namespace
+
+Napi::Object FrameCache::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "FrameCache", {
+        InstanceMethod("get", &FrameCache::Get),
+        InstanceMethod("has", &FrameCache::Has),
+        InstanceMethod("stats", &FrameCache::GetStats),
+        InstanceMethod("clear", &FrameCache::Clear),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("FrameCache", func);
+    return exports;
+}
+
+// new FrameCache({ maxBytes, width?, height? })
+FrameCache::FrameCache(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<FrameCache>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Config must be an object").ThrowAsJavaScriptException();
+        return;
+    }
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    maxBytes_ = static_cast<size_t>(config.Get("maxBytes").As<Napi::Number>().Int64Value());
+    if (config.Has("width") && config.Get("width").IsNumber()) {
+        width_ = config.Get("width").As<Napi::Number>().Int32Value();
+    }
+    if (config.Has("height") && config.Get("height").IsNumber()) {
+        height_ = config.Get("height").As<Napi::Number>().Int32Value();
+    }
+}
+
+FrameCache::~FrameCache() {
+    ClearLocked();
+}
+
+void FrameCache::Put(const AVFrame* frame, int64_t timestamp) {
+    AVFrame* copy = av_frame_alloc();
+    if (!copy) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int ret;
+    if (width_ > 0 && height_ > 0 && (frame->width != width_ || frame->height != height_)) {
+        copy->format = frame->format;
+        copy->width = width_;
+        copy->height = height_;
+        ret = scaler_.scale(frame, copy);
+    } else {
+        ret = av_frame_ref(copy, frame);
+    }
+
+    size_t bytes = ret >= 0 ? frameBytes(copy) : 0;
+    if (ret < 0 || bytes > maxBytes_) {
+        av_frame_free(&copy);
+        return;
+    }
+
+    auto existing = entries_.find(timestamp);
+    if (existing != entries_.end()) {
+        Erase(existing);
+    }
+    while (bytes_ + bytes > maxBytes_ && !lru_.empty()) {
+        Erase(entries_.find(lru_.back()));
+    }
+
+    lru_.push_front(timestamp);
+    entries_[timestamp] = Entry{ copy, bytes, lru_.begin() };
+    bytes_ += bytes;
+}
+
+AVFrame* FrameCache::Lookup(int64_t timestamp) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = entries_.find(timestamp);
+    if (it == entries_.end()) {
+        misses_++;
+        return nullptr;
+    }
+
+    hits_++;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return av_frame_clone(it->second.frame);
+}
+
+void FrameCache::Erase(std::unordered_map<int64_t, Entry>::iterator it) {
+    av_frame_free(&it->second.frame);
+    bytes_ -= it->second.bytes;
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+}
+
+void FrameCache::ClearLocked() {
+    for (auto& entry : entries_) {
+        av_frame_free(&entry.second.frame);
+    }
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+// get(timestamp): VideoFrameNative sharing the cached buffers, or undefined
+Napi::Value FrameCache::Get(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    AVFrame* frame = Lookup(info[0].As<Napi::Number>().Int64Value());
+    if (!frame) {
+        return env.Undefined();
+    }
+    return VideoFrameNative::NewInstance(env, frame);
+}
+
+// has(timestamp): no effect on recency or the hit rate
+Napi::Value FrameCache::Has(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t timestamp = info[0].As<Napi::Number>().Int64Value();
+    return Napi::Boolean::New(info.Env(), entries_.count(timestamp) > 0);
+}
+
+Napi::Value FrameCache::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("frames", Napi::Number::New(env, static_cast<double>(entries_.size())));
+    stats.Set("bytes", Napi::Number::New(env, static_cast<double>(bytes_)));
+    stats.Set("maxBytes", Napi::Number::New(env, static_cast<double>(maxBytes_)));
+    stats.Set("hits", Napi::Number::New(env, static_cast<double>(hits_)));
+    stats.Set("misses", Napi::Number::New(env, static_cast<double>(misses_)));
+    return stats;
+}
+
+void FrameCache::Clear(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ClearLocked();
+}
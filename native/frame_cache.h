@@ -0,0 +1,66 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <napi.h>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "scaler.h"
+
+/**
+ * FrameCache - LRU cache of decoded frames keyed by timestamp
+ *
+ * Holds refcounted AVFrames, so a cached frame shares its buffers with the
+ * VideoFrame that was output for it. Bounded by the bytes of those buffers;
+ * the least recently used frames are evicted first. With a target size,
+ * frames are downscaled on insertion and hold their own, smaller buffers.
+ *
+ * Filled from a VideoDecoderAsync worker (attachCache) and consulted by its
+ * seek() before decoding; both sides may run on any thread.
+ */
+class FrameCache : public Napi::ObjectWrap<FrameCache> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    FrameCache(const Napi::CallbackInfo& info);
+    ~FrameCache();
+
+    /** Store frame under timestamp, replacing any previous one */
+    void Put(const AVFrame* frame, int64_t timestamp);
+
+    /** New reference to the cached frame, or nullptr; counts a hit or miss */
+    AVFrame* Lookup(int64_t timestamp);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    struct Entry {
+        AVFrame* frame;
+        size_t bytes;
+        std::list<int64_t>::iterator lru;
+    };
+
+    // JavaScript-facing methods
+    Napi::Value Get(const Napi::CallbackInfo& info);
+    Napi::Value Has(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+    void Clear(const Napi::CallbackInfo& info);
+
+    void Erase(std::unordered_map<int64_t, Entry>::iterator it);  // mutex_ held
+    void ClearLocked();
+
+    std::mutex mutex_;
+    std::unordered_map<int64_t, Entry> entries_;
+    std::list<int64_t> lru_;  // Most recently used first
+    size_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    FrameScaler scaler_;
+
+    // Configuration
+    size_t maxBytes_ = 0;
+    int width_ = 0;   // 0 = store frames at their decoded size
+    int height_ = 0;
+};
+
+#endif // FRAME_CACHE_H
@@ -0,0 +1,594 @@
+#include "ladder_encoder.h"
+#include "env_state.h"
+#include "frame.h"
+#include "encoder_setup.h"
+#include "svc.h"
+#include "threading.h"
+#include <algorithm>
+#include <cmath>
+
+LadderJobState::~LadderJobState() {
+    // A flush dropped by close()/reset() never resolves; release its handle
+    // so it stops holding the event loop
+    if (onFlush && !nwc_env_teardown.load()) {
+        onFlush.Release();
+    }
+}
+
+namespace {
+
+struct LadderChunk {
+    int rendition;
+    std::vector<uint8_t> data;
+    bool isKeyframe;
+    int64_t pts;
+    int64_t duration;
+    std::vector<uint8_t> extradata;
+    bool hasExtradata;
+    int temporalLayerId;
+};
+
+void FreeJobFrame(LadderJob& job) {
+    if (job.frame) {
+        av_frame_free(&job.frame);
+    }
+}
+
+} // namespace
+
+Napi::FunctionReference VideoLadderEncoder::constructor;
+
+Napi::Object VideoLadderEncoder::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "VideoLadderEncoder", {
+        InstanceMethod("configure", &VideoLadderEncoder::Configure),
+        InstanceMethod("encode", &VideoLadderEncoder::Encode),
+        InstanceMethod("flush", &VideoLadderEncoder::Flush),
+        InstanceMethod("reset", &VideoLadderEncoder::Reset),
+        InstanceMethod("close", &VideoLadderEncoder::Close),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("VideoLadderEncoder", func);
+    return exports;
+}
+
+VideoLadderEncoder::VideoLadderEncoder(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<VideoLadderEncoder>(info)
+    , bitrateMode_("variable")
+    , latencyMode_("quality")
+    , framerate_(30)
+    , profile_(-1)
+    , temporalLayers_(1)
+    , inputFormat_(AV_PIX_FMT_NONE) {
+
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2) {
+        Napi::TypeError::New(env, "Expected 2 callbacks").ThrowAsJavaScriptException();
+        return;
+    }
+
+    tsfnOutput_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[0].As<Napi::Function>(),
+        "VideoLadderEncoderOutput",
+        0,
+        1
+    );
+
+    tsfnError_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[1].As<Napi::Function>(),
+        "VideoLadderEncoderError",
+        0,
+        1
+    );
+
+    // Idle encoders don't hold the event loop; in-flight jobs do (JobSubmitted)
+    tsfnOutput_.Unref(env);
+    tsfnError_.Unref(env);
+
+    tsfnJobDone_ = Napi::ThreadSafeFunction::New(
+        env,
+        Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+        "VideoLadderEncoderJobDone",
+        0,
+        1
+    );
+    tsfnJobDone_.Unref(env);
+}
+
+VideoLadderEncoder::~VideoLadderEncoder() {
+    StopWorkers();
+
+    if (!nwc_env_teardown.load()) {
+        if (tsfnOutput_) tsfnOutput_.Release();
+        if (tsfnError_) tsfnError_.Release();
+        if (tsfnJobDone_) tsfnJobDone_.Release();
+    }
+}
+
+// Hold the event loop open while jobs are in flight (JS thread only)
+void VideoLadderEncoder::JobSubmitted(Napi::Env env) {
+    if (activeJobs_++ == 0) {
+        tsfnOutput_.Ref(env);
+        Ref();
+    }
+}
+
+void VideoLadderEncoder::JobFinished(Napi::Env env) {
+    if (activeJobs_ > 0 && --activeJobs_ == 0) {
+        tsfnOutput_.Unref(env);
+        Unref();
+    }
+}
+
+bool VideoLadderEncoder::OpenRendition(Rendition& r, HWAccel::Preference pref, int threadBudget, std::string& error) {
+    HWAccel::EncoderInfo encInfo = HWAccel::selectEncoder(codecName_, pref, r.width, r.height);
+    if (encInfo.codec && encInfo.requiresHWFrames) {
+        // The cascade produces system-memory frames and has no upload path
+        encInfo = HWAccel::selectEncoder(codecName_, HWAccel::Preference::PreferSoftware, r.width, r.height);
+    }
+
+    const AVCodec* codec = encInfo.codec;
+    bool isHardware = codec && encInfo.hwType != HWAccel::Type::None;
+    if (!codec) {
+        codec = avcodec_find_encoder_by_name(codecName_.c_str());
+    }
+    if (!codec) {
+        error = "No suitable encoder found for: " + codecName_;
+        return false;
+    }
+
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    if (!ctx) {
+        error = "Failed to allocate codec context";
+        return false;
+    }
+
+    ctx->width = r.width;
+    ctx->height = r.height;
+    ctx->time_base = { 1, 1000000 };
+    ctx->gop_size = framerate_;
+    ctx->framerate = { framerate_, 1 };
+    ctx->max_b_frames = 0;
+
+    if (isHardware && encInfo.inputFormat != AV_PIX_FMT_NONE) {
+        ctx->pix_fmt = encInfo.inputFormat;
+    } else {
+        ctx->pix_fmt = NegotiateEncoderPixelFormat(codec, inputFormat_, profile_);
+    }
+
+    EncoderSetup::applyRateControl(ctx, bitrateMode_, r.bitrate);
+    EncoderSetup::applyH264Profile(ctx, profile_);
+    EncoderSetup::applyTuning(ctx, latencyMode_, threadBudget);
+    r.temporalLayered = EncoderSetup::applyTemporalLayers(ctx, temporalLayers_, r.bitrate);
+    r.frameIndex = 0;
+
+    int ret = avcodec_open2(ctx, codec, nullptr);
+    if (ret < 0) {
+        avcodec_free_context(&ctx);
+
+        if (isHardware && pref != HWAccel::Preference::PreferHardware) {
+            return OpenRendition(r, HWAccel::Preference::PreferSoftware, threadBudget, error);
+        }
+
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        error = std::string("Failed to open codec: ") + errBuf;
+        return false;
+    }
+
+    r.codecCtx = ctx;
+    return true;
+}
+
+void VideoLadderEncoder::Configure(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!info[0].IsObject()) {
+        Napi::TypeError::New(env, "Config must be an object").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // Reconfigure replaces the whole ladder
+    StopWorkers();
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    codecName_ = config.Get("codec").As<Napi::String>().Utf8Value();
+
+    HWAccel::Preference hwPref = HWAccel::Preference::NoPreference;
+    if (config.Has("hardwareAcceleration")) {
+        std::string pref = config.Get("hardwareAcceleration").As<Napi::String>().Utf8Value();
+        hwPref = HWAccel::parsePreference(pref);
+    }
+
+    framerate_ = 30;
+    if (config.Has("framerate") && config.Get("framerate").IsNumber()) {
+        framerate_ = config.Get("framerate").As<Napi::Number>().Int32Value();
+    }
+
+    bitrateMode_ = "variable";
+    if (config.Has("bitrateMode") && config.Get("bitrateMode").IsString()) {
+        bitrateMode_ = config.Get("bitrateMode").As<Napi::String>().Utf8Value();
+    }
+
+    latencyMode_ = "quality";
+    if (config.Has("latencyMode") && config.Get("latencyMode").IsString()) {
+        latencyMode_ = config.Get("latencyMode").As<Napi::String>().Utf8Value();
+    }
+
+    profile_ = -1;
+    if (config.Has("profile") && config.Get("profile").IsNumber()) {
+        profile_ = config.Get("profile").As<Napi::Number>().Int32Value();
+    }
+
+    // Applied to every rendition (simulcast SxTy)
+    temporalLayers_ = 1;
+    if (config.Has("temporalLayers") && config.Get("temporalLayers").IsNumber()) {
+        temporalLayers_ = config.Get("temporalLayers").As<Napi::Number>().Int32Value();
+    }
+
+    inputFormat_ = AV_PIX_FMT_NONE;
+    if (config.Has("inputFormat") && config.Get("inputFormat").IsString()) {
+        inputFormat_ = StringToPixelFormat(config.Get("inputFormat").As<Napi::String>().Utf8Value());
+    }
+
+    if (!config.Has("renditions") || !config.Get("renditions").IsArray()) {
+        Napi::TypeError::New(env, "renditions must be an array").ThrowAsJavaScriptException();
+        return;
+    }
+
+    Napi::Array list = config.Get("renditions").As<Napi::Array>();
+    if (list.Length() == 0) {
+        Napi::TypeError::New(env, "renditions must not be empty").ThrowAsJavaScriptException();
+        return;
+    }
+
+    std::vector<std::unique_ptr<Rendition>> renditions;
+    for (uint32_t i = 0; i < list.Length(); i++) {
+        Napi::Object entry = list.Get(i).As<Napi::Object>();
+        auto r = std::make_unique<Rendition>();
+        r->index = static_cast<int>(i);
+        r->width = entry.Get("width").As<Napi::Number>().Int32Value();
+        r->height = entry.Get("height").As<Napi::Number>().Int32Value();
+        r->bitrate = entry.Has("bitrate") && entry.Get("bitrate").IsNumber()
+            ? entry.Get("bitrate").As<Napi::Number>().Int64Value()
+            : 2000000;
+        if (r->width <= 0 || r->height <= 0) {
+            Napi::TypeError::New(env, "Invalid rendition dimensions").ThrowAsJavaScriptException();
+            return;
+        }
+        renditions.push_back(std::move(r));
+    }
+
+    // Cascade order: largest first; each level scales from the nearest
+    // earlier level that covers it, so downscales stay small steps
+    std::stable_sort(renditions.begin(), renditions.end(),
+        [](const std::unique_ptr<Rendition>& a, const std::unique_ptr<Rendition>& b) {
+            return static_cast<int64_t>(a->width) * a->height > static_cast<int64_t>(b->width) * b->height;
+        });
+
+    int64_t totalArea = 0;
+    for (size_t i = 0; i < renditions.size(); i++) {
+        Rendition& r = *renditions[i];
+        r.parent = -1;
+        for (int j = static_cast<int>(i) - 1; j >= 0; j--) {
+            if (renditions[j]->width >= r.width && renditions[j]->height >= r.height) {
+                r.parent = j;
+                break;
+            }
+        }
+        totalArea += static_cast<int64_t>(r.width) * r.height;
+    }
+
+    // Renditions encode concurrently, so split the CPU budget by pixel
+    // count instead of letting every context auto-size to the whole machine
+    int cores = Threading::budget().effectiveCores;
+    for (auto& r : renditions) {
+        double share = static_cast<double>(r->width) * r->height / static_cast<double>(totalArea);
+        int threadBudget = std::max(1, static_cast<int>(std::lround(cores * share)));
+
+        std::string error;
+        if (!OpenRendition(*r, hwPref, threadBudget, error)) {
+            for (auto& opened : renditions) {
+                if (opened->codecCtx) avcodec_free_context(&opened->codecCtx);
+            }
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return;
+        }
+    }
+
+    renditions_ = std::move(renditions);
+    configured_ = true;
+
+    for (auto& r : renditions_) {
+        r->thread = std::thread(&VideoLadderEncoder::RenditionThread, this, r.get());
+    }
+    cascadeThread_ = std::thread(&VideoLadderEncoder::CascadeThread, this);
+}
+
+void VideoLadderEncoder::CascadeThread() {
+    LadderJob job;
+    while (inputQueue_.pop(job)) {
+        if (job.isFlush) {
+            for (auto& r : renditions_) {
+                LadderJob copy = job;
+                r->queue.push(copy);
+            }
+            job = LadderJob();
+            continue;
+        }
+
+        std::vector<AVFrame*> levels(renditions_.size(), nullptr);
+
+        for (size_t i = 0; i < renditions_.size(); i++) {
+            Rendition& r = *renditions_[i];
+            const AVFrame* src = (r.parent >= 0 && levels[r.parent]) ? levels[r.parent] : job.frame;
+
+            AVFrame* level = av_frame_alloc();
+            int ret;
+            if (!level) {
+                ret = AVERROR(ENOMEM);
+            } else if (src->width == r.width && src->height == r.height &&
+                       src->format == r.codecCtx->pix_fmt) {
+                // Rendition matches its source: pass by reference
+                ret = av_frame_ref(level, src);
+            } else {
+                level->format = r.codecCtx->pix_fmt;
+                level->width = r.width;
+                level->height = r.height;
+                ret = r.scaler.scale(src, level);
+            }
+
+            if (ret < 0) {
+                av_frame_free(&level);
+                char errBuf[256];
+                av_strerror(ret, errBuf, sizeof(errBuf));
+                ReportError(std::string("Scale error: ") + errBuf);
+                LadderJob skipped{nullptr, job.timestamp, false, false, job.state};
+                FinishJob(skipped);
+                continue;
+            }
+
+            level->pts = job.timestamp;
+            levels[i] = level;
+
+            // The encoder gets its own reference; ours stays valid as the
+            // source for the next level down
+            LadderJob encodeJob{av_frame_clone(level), job.timestamp, job.forceKeyframe, false, job.state};
+            if (!encodeJob.frame || !r.queue.push(encodeJob)) {
+                FreeJobFrame(encodeJob);
+            }
+        }
+
+        for (AVFrame*& level : levels) {
+            if (level) av_frame_free(&level);
+        }
+        FreeJobFrame(job);
+        job = LadderJob();
+    }
+}
+
+void VideoLadderEncoder::RenditionThread(Rendition* r) {
+    AVPacket* packet = av_packet_alloc();
+    LadderJob job;
+
+    while (r->queue.pop(job)) {
+        if (job.isFlush) {
+            avcodec_send_frame(r->codecCtx, nullptr);
+            DrainPackets(r, packet);
+            // Back out of EOF so encoding can continue after flush()
+            avcodec_flush_buffers(r->codecCtx);
+        } else if (job.frame) {
+            if (job.forceKeyframe) {
+                job.frame->pict_type = AV_PICTURE_TYPE_I;
+            }
+            int ret = avcodec_send_frame(r->codecCtx, job.frame);
+            FreeJobFrame(job);
+
+            if (ret < 0) {
+                char errBuf[256];
+                av_strerror(ret, errBuf, sizeof(errBuf));
+                ReportError(std::string("Encode error: ") + errBuf);
+            } else {
+                DrainPackets(r, packet);
+            }
+        }
+
+        FinishJob(job);
+        job = LadderJob();
+    }
+
+    av_packet_free(&packet);
+}
+
+void VideoLadderEncoder::DrainPackets(Rendition* r, AVPacket* packet) {
+    while (avcodec_receive_packet(r->codecCtx, packet) >= 0) {
+        LadderChunk* chunk = new LadderChunk();
+        chunk->rendition = r->index;
+        chunk->data.assign(packet->data, packet->data + packet->size);
+        chunk->isKeyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+        chunk->pts = packet->pts;
+        chunk->duration = packet->duration;
+        chunk->temporalLayerId = r->temporalLayered ? temporalLayerId(temporalLayers_, r->frameIndex++) : 0;
+        chunk->hasExtradata = chunk->isKeyframe && r->codecCtx->extradata && r->codecCtx->extradata_size > 0;
+        if (chunk->hasExtradata) {
+            chunk->extradata.assign(r->codecCtx->extradata,
+                                    r->codecCtx->extradata + r->codecCtx->extradata_size);
+        }
+        av_packet_unref(packet);
+
+        napi_status status = tsfnOutput_.BlockingCall(chunk,
+            [](Napi::Env env, Napi::Function fn, LadderChunk* c) {
+                Napi::Value extradataValue = env.Undefined();
+                if (c->hasExtradata) {
+                    extradataValue = Napi::Buffer<uint8_t>::Copy(env, c->extradata.data(), c->extradata.size());
+                }
+
+                fn.Call({
+                    Napi::Number::New(env, c->rendition),
+                    Napi::Buffer<uint8_t>::Copy(env, c->data.data(), c->data.size()),
+                    Napi::Boolean::New(env, c->isKeyframe),
+                    Napi::Number::New(env, static_cast<double>(c->pts)),
+                    Napi::Number::New(env, static_cast<double>(c->duration)),
+                    extradataValue,
+                    Napi::Number::New(env, c->temporalLayerId)
+                });
+
+                delete c;
+            });
+        if (status != napi_ok) {
+            delete chunk;
+        }
+    }
+}
+
+// Called once per rendition copy of a job (and for levels the cascade
+// failed to produce); the last one resolves flush and releases the job
+void VideoLadderEncoder::FinishJob(LadderJob& job) {
+    if (!job.state || --job.state->remaining > 0) {
+        return;
+    }
+
+    if (job.state->onFlush) {
+        job.state->onFlush.NonBlockingCall([](Napi::Env env, Napi::Function fn) {
+            fn.Call({ env.Null() });
+        });
+        job.state->onFlush.Release();
+        job.state->onFlush = Napi::ThreadSafeFunction();
+    }
+
+    tsfnJobDone_.NonBlockingCall([this](Napi::Env env, Napi::Function) {
+        JobFinished(env);
+    });
+}
+
+void VideoLadderEncoder::ReportError(const std::string& message) {
+    auto* msg = new std::string(message);
+    napi_status status = tsfnError_.NonBlockingCall(msg,
+        [](Napi::Env env, Napi::Function fn, std::string* m) {
+            fn.Call({ Napi::String::New(env, *m) });
+            delete m;
+        });
+    if (status != napi_ok) {
+        delete msg;
+    }
+}
+
+void VideoLadderEncoder::Encode(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!configured_) {
+        Napi::Error::New(env, "Encoder not configured").ThrowAsJavaScriptException();
+        return;
+    }
+
+    VideoFrameNative* frameWrapper = Napi::ObjectWrap<VideoFrameNative>::Unwrap(info[0].As<Napi::Object>());
+    AVFrame* srcFrame = frameWrapper->GetFrame();
+    if (!srcFrame) {
+        Napi::Error::New(env, "Invalid frame").ThrowAsJavaScriptException();
+        return;
+    }
+
+    LadderJob job;
+    job.frame = av_frame_clone(srcFrame);
+    if (!job.frame) {
+        Napi::Error::New(env, "Failed to clone frame").ThrowAsJavaScriptException();
+        return;
+    }
+    job.timestamp = info[1].As<Napi::Number>().Int64Value();
+    job.forceKeyframe = info[2].As<Napi::Boolean>().Value();
+    job.state = std::make_shared<LadderJobState>(static_cast<int>(renditions_.size()));
+
+    if (!inputQueue_.push(job)) {
+        FreeJobFrame(job);
+        return;
+    }
+    JobSubmitted(env);
+}
+
+Napi::Value VideoLadderEncoder::Flush(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Function callback = info[0].As<Napi::Function>();
+
+    if (!configured_) {
+        callback.Call({ env.Null() });
+        return env.Undefined();
+    }
+
+    LadderJob job;
+    job.isFlush = true;
+    job.state = std::make_shared<LadderJobState>(static_cast<int>(renditions_.size()));
+    job.state->onFlush = Napi::ThreadSafeFunction::New(
+        env,
+        callback,
+        "VideoLadderEncoderFlush",
+        0,
+        1
+    );
+
+    if (inputQueue_.push(job)) {
+        JobSubmitted(env);
+    }
+    return env.Undefined();
+}
+
+// Stop and join every worker, dropping queued jobs, and free the ladder.
+// Safe to call when not configured.
+void VideoLadderEncoder::StopWorkers() {
+    configured_ = false;
+
+    inputQueue_.close();
+    for (auto& r : renditions_) {
+        r->queue.close();
+    }
+
+    inputQueue_.drain(FreeJobFrame);
+    for (auto& r : renditions_) {
+        r->queue.drain(FreeJobFrame);
+    }
+
+    if (cascadeThread_.joinable()) {
+        cascadeThread_.join();
+    }
+    for (auto& r : renditions_) {
+        if (r->thread.joinable()) {
+            r->thread.join();
+        }
+        r->queue.drain(FreeJobFrame);
+        if (r->codecCtx) {
+            avcodec_free_context(&r->codecCtx);
+        }
+    }
+    renditions_.clear();
+
+    inputQueue_.drain(FreeJobFrame);
+    inputQueue_.reopen();
+}
+
+void VideoLadderEncoder::Reset(const Napi::CallbackInfo& info) {
+    StopWorkers();
+
+    if (activeJobs_ > 0) {
+        activeJobs_ = 0;
+        tsfnOutput_.Unref(info.Env());
+        Unref();  // balance the in-flight pin; queued JobFinished sees 0 and skips
+    }
+}
+
+void VideoLadderEncoder::Close(const Napi::CallbackInfo& info) {
+    StopWorkers();
+
+    // Workers are joined, so no more calls are queued; release now and null
+    // the handles so the destructor doesn't touch finalized functions
+    if (tsfnOutput_) { tsfnOutput_.Release(); tsfnOutput_ = Napi::ThreadSafeFunction(); }
+    if (tsfnError_) { tsfnError_.Release(); tsfnError_ = Napi::ThreadSafeFunction(); }
+    if (tsfnJobDone_) { tsfnJobDone_.Release(); tsfnJobDone_ = Napi::ThreadSafeFunction(); }
+    if (activeJobs_ > 0) {
+        activeJobs_ = 0;
+        Unref();
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef LADDER_ENCODER_H
+#define LADDER_ENCODER_H
+
+#include <napi.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "hw_accel.h"
+#include "scaler.h"
+#include "work_queue.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+// Shared by the per-rendition copies of one input job; the rendition that
+// brings remaining to zero completes it
+struct LadderJobState {
+    explicit LadderJobState(int renditions) : remaining(renditions) {}
+    ~LadderJobState();
+
+    std::atomic<int> remaining;
+    Napi::ThreadSafeFunction onFlush;  // Flush jobs only
+};
+
+struct LadderJob {
+    AVFrame* frame = nullptr;
+    int64_t timestamp = 0;
+    bool forceKeyframe = false;
+    bool isFlush = false;
+    std::shared_ptr<LadderJobState> state;
+};
+
+/**
+ * ABR ladder encoder: one input frame, N renditions.
+ *
+ * A cascade thread scales each input once per rendition, largest first,
+ * with every level scaled from the smallest larger level already produced
+ * (1080 -> 720 -> 480 -> 360) rather than from the source. Each rendition
+ * has its own codec context and encoder thread, fed through a bounded
+ * queue, so renditions encode in parallel and a slow one back-pressures
+ * the cascade instead of buffering frames.
+ */
+class VideoLadderEncoder : public Napi::ObjectWrap<VideoLadderEncoder> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    VideoLadderEncoder(const Napi::CallbackInfo& info);
+    ~VideoLadderEncoder();
+
+private:
+    static Napi::FunctionReference constructor;
+
+    // Frames buffered per rendition before the cascade waits on it
+    static constexpr size_t kQueueDepth = 4;
+
+    struct Rendition {
+        int index;           // Position in config.renditions
+        int width;
+        int height;
+        int64_t bitrate;
+        int parent;          // Cascade slot this level is scaled from, -1 = input
+        AVCodecContext* codecCtx = nullptr;
+        bool temporalLayered = false;  // Follows temporalLayerId()'s pattern
+        int64_t frameIndex = 0;        // Output packets, for the layer pattern
+        FrameScaler scaler;  // Cascade thread only
+        WorkQueue<LadderJob> queue;
+        std::thread thread;
+
+        Rendition() : queue(kQueueDepth) {}
+    };
+
+    // JavaScript-facing methods
+    void Configure(const Napi::CallbackInfo& info);
+    void Encode(const Napi::CallbackInfo& info);
+    Napi::Value Flush(const Napi::CallbackInfo& info);
+    void Reset(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    bool OpenRendition(Rendition& r, HWAccel::Preference pref, int threadBudget, std::string& error);
+    void StopWorkers();
+
+    // Worker threads
+    void CascadeThread();
+    void RenditionThread(Rendition* r);
+    void DrainPackets(Rendition* r, AVPacket* packet);
+    void FinishJob(LadderJob& job);
+    void ReportError(const std::string& message);
+
+    Napi::ThreadSafeFunction tsfnOutput_;
+    Napi::ThreadSafeFunction tsfnError_;
+    Napi::ThreadSafeFunction tsfnJobDone_;
+    int activeJobs_ = 0;
+    void JobSubmitted(Napi::Env env);
+    void JobFinished(Napi::Env env);
+    std::atomic<bool> configured_{false};
+
+    // Renditions in cascade order (largest first)
+    std::vector<std::unique_ptr<Rendition>> renditions_;
+    WorkQueue<LadderJob> inputQueue_;
+    std::thread cascadeThread_;
+
+    // Configuration shared by all renditions
+    std::string codecName_;
+    std::string bitrateMode_;
+    std::string latencyMode_;
+    int framerate_;
+    int profile_;
+    int temporalLayers_;
+    AVPixelFormat inputFormat_;
+};
+
+#endif // LADDER_ENCODER_H
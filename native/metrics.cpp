@@ -0,0 +1,376 @@
+#include "metrics.h"
+#include "frame.h"
+#include "scaler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct PlaneQuality {
+    double mse;
+    double psnr;
+    double ssim;
+    int64_t pixels;
+};
+
+struct FrameQuality {
+    std::vector<PlaneQuality> planes;
+    double psnr;
+    double ssim;
+    double msssim;
+    double peak;  // Largest sample value, for PSNR
+};
+
+struct MetricOptions {
+    bool ssim = true;
+    bool msssim = false;
+};
+
+// Format both frames are compared in: the reference's own if every
+// component sits in its own plane, else the nearest one that does
+AVPixelFormat comparableFormat(AVPixelFormat format) {
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    if (!desc || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+        return AV_PIX_FMT_NONE;
+    }
+
+    bool separate = (desc->flags & AV_PIX_FMT_FLAG_PLANAR) && !(desc->flags & AV_PIX_FMT_FLAG_BE);
+    for (int c = 0; c < desc->nb_components && separate; c++) {
+        int bytes = desc->comp[c].depth > 8 ? 2 : 1;
+        separate = desc->comp[c].step == bytes && desc->comp[c].shift == 0;
+        for (int other = 0; other < c; other++) {
+            separate = separate && desc->comp[other].plane != desc->comp[c].plane;
+        }
+    }
+    if (separate) {
+        return format;
+    }
+
+    bool highDepth = desc->comp[0].depth > 8;
+    if (desc->flags & AV_PIX_FMT_FLAG_RGB) {
+        return highDepth ? AV_PIX_FMT_GBRP16 : AV_PIX_FMT_GBRP;
+    }
+    return highDepth ? AV_PIX_FMT_YUV420P16 : AV_PIX_FMT_YUV420P;
+}
+
+void toFloatPlane(const AVFrame* frame, int plane, int width, int height, bool wide, std::vector<float>& out) {
+    out.resize(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = frame->data[plane] + static_cast<ptrdiff_t>(y) * frame->linesize[plane];
+        float* dst = out.data() + static_cast<size_t>(y) * width;
+        if (wide) {
+            const uint16_t* src = reinterpret_cast<const uint16_t*>(row);
+            for (int x = 0; x < width; x++) dst[x] = src[x];
+        } else {
+            for (int x = 0; x < width; x++) dst[x] = row[x];
+        }
+    }
+}
+
+double meanSquaredError(const std::vector<float>& a, const std::vector<float>& b) {
+    double sum = 0;
+    const size_t n = a.size();
+    for (size_t i = 0; i < n; i++) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return n ? sum / n : 0;
+}
+
+double psnrFromMse(double mse, double peak) {
+    return mse > 0 ? 10.0 * std::log10(peak * peak / mse) : std::numeric_limits<double>::infinity();
+}
+
+struct SsimTerms {
+    double ssim;
+    double cs;  // Contrast-structure term alone, for MS-SSIM
+};
+
+// x264/libvpx-style SSIM: sums over 4x4 blocks, combined into overlapping
+// 8x8 windows on a 4-pixel stride. The per-pixel pass is a unit-stride
+// float loop; the per-window maths runs on 1/16th of the pixels.
+SsimTerms ssimPlane(const float* a, const float* b, int width, int height, double peak) {
+    const int bw = width / 4;
+    const int bh = height / 4;
+    if (bw < 2 || bh < 2) {
+        return { std::nan(""), std::nan("") };
+    }
+
+    // s1, s2, ss (a^2 + b^2), s12 per block
+    std::vector<float> sums(static_cast<size_t>(bw) * bh * 4, 0.0f);
+    for (int y = 0; y < bh * 4; y++) {
+        const float* ra = a + static_cast<size_t>(y) * width;
+        const float* rb = b + static_cast<size_t>(y) * width;
+        float* rowSums = sums.data() + static_cast<size_t>(y / 4) * bw * 4;
+        for (int bx = 0; bx < bw; bx++) {
+            float s1 = 0, s2 = 0, ss = 0, s12 = 0;
+            for (int x = bx * 4; x < bx * 4 + 4; x++) {
+                s1 += ra[x];
+                s2 += rb[x];
+                ss += ra[x] * ra[x] + rb[x] * rb[x];
+                s12 += ra[x] * rb[x];
+            }
+            float* s = rowSums + bx * 4;
+            s[0] += s1;
+            s[1] += s2;
+            s[2] += ss;
+            s[3] += s12;
+        }
+    }
+
+    const double c1 = .01 * .01 * peak * peak * 64;
+    const double c2 = .03 * .03 * peak * peak * 64 * 63;
+    double ssim = 0;
+    double cs = 0;
+    for (int by = 0; by < bh - 1; by++) {
+        for (int bx = 0; bx < bw - 1; bx++) {
+            double s[4] = { 0, 0, 0, 0 };
+            for (int dy = 0; dy < 2; dy++) {
+                const float* block = sums.data() + (static_cast<size_t>(by + dy) * bw + bx) * 4;
+                for (int k = 0; k < 4; k++) {
+                    s[k] += block[k] + block[k + 4];
+                }
+            }
+            double vars = s[2] * 64 - s[0] * s[0] - s[1] * s[1];
+            double covar = s[3] * 64 - s[0] * s[1];
+            double luminance = (2 * s[0] * s[1] + c1) / (s[0] * s[0] + s[1] * s[1] + c1);
+            double structure = (2 * covar + c2) / (vars + c2);
+            ssim += luminance * structure;
+            cs += structure;
+        }
+    }
+
+    double windows = static_cast<double>(bw - 1) * (bh - 1);
+    return { ssim / windows, cs / windows };
+}
+
+void downsample2x(std::vector<float>& plane, int& width, int& height) {
+    int w = width / 2;
+    int h = height / 2;
+    std::vector<float> out(static_cast<size_t>(w) * h);
+    for (int y = 0; y < h; y++) {
+        const float* r0 = plane.data() + static_cast<size_t>(2 * y) * width;
+        const float* r1 = r0 + width;
+        for (int x = 0; x < w; x++) {
+            out[static_cast<size_t>(y) * w + x] = (r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1]) * 0.25f;
+        }
+    }
+    plane.swap(out);
+    width = w;
+    height = h;
+}
+
+// Wang et al. 2003: contrast-structure at each of 5 dyadic scales, full
+// SSIM at the coarsest. Frames too small for 5 scales use as many as fit,
+// with the exponents renormalized.
+double msssimPlane(std::vector<float> a, std::vector<float> b, int width, int height, double peak) {
+    static const double kWeights[5] = { 0.0448, 0.2856, 0.3001, 0.2363, 0.1333 };
+
+    double product = 1;
+    double weightSum = 0;
+    for (int scale = 0; scale < 5; scale++) {
+        SsimTerms terms = ssimPlane(a.data(), b.data(), width, height, peak);
+        if (std::isnan(terms.ssim)) break;
+
+        bool last = scale == 4 || width / 2 < 8 || height / 2 < 8;
+        product *= std::pow(std::max(last ? terms.ssim : terms.cs, 0.0), kWeights[scale]);
+        weightSum += kWeights[scale];
+        if (last) break;
+
+        int w = width, h = height;
+        downsample2x(a, w, h);
+        downsample2x(b, width, height);
+    }
+    return weightSum > 0 ? std::pow(product, 1.0 / weightSum) : std::nan("");
+}
+
+class MetricsWorker : public Napi::AsyncWorker {
+public:
+    MetricsWorker(Napi::Function callback, std::vector<AVFrame*> references,
+                  std::vector<AVFrame*> distorted, const MetricOptions& options)
+        : Napi::AsyncWorker(callback, "compareFrames"),
+          references_(std::move(references)),
+          distorted_(std::move(distorted)),
+          options_(options) {}
+
+    ~MetricsWorker() override {
+        for (AVFrame*& frame : references_) av_frame_free(&frame);
+        for (AVFrame*& frame : distorted_) av_frame_free(&frame);
+    }
+
+    void Execute() override {
+        results_.resize(references_.size());
+        for (size_t i = 0; i < references_.size(); i++) {
+            std::string error = Compare(references_[i], distorted_[i], results_[i]);
+            if (!error.empty()) {
+                SetError("Frame " + std::to_string(i) + ": " + error);
+                return;
+            }
+        }
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Array results = Napi::Array::New(env, results_.size());
+
+        for (size_t i = 0; i < results_.size(); i++) {
+            const FrameQuality& q = results_[i];
+            Napi::Array planes = Napi::Array::New(env, q.planes.size());
+            for (size_t p = 0; p < q.planes.size(); p++) {
+                Napi::Object plane = Napi::Object::New(env);
+                plane.Set("mse", Napi::Number::New(env, q.planes[p].mse));
+                plane.Set("psnr", Napi::Number::New(env, q.planes[p].psnr));
+                plane.Set("pixels", Napi::Number::New(env, static_cast<double>(q.planes[p].pixels)));
+                if (options_.ssim) plane.Set("ssim", Napi::Number::New(env, q.planes[p].ssim));
+                planes.Set(static_cast<uint32_t>(p), plane);
+            }
+
+            Napi::Object result = Napi::Object::New(env);
+            result.Set("planes", planes);
+            result.Set("psnr", Napi::Number::New(env, q.psnr));
+            result.Set("peak", Napi::Number::New(env, q.peak));
+            if (options_.ssim) result.Set("ssim", Napi::Number::New(env, q.ssim));
+            if (options_.msssim) result.Set("msssim", Napi::Number::New(env, q.msssim));
+            results.Set(static_cast<uint32_t>(i), result);
+        }
+
+        Callback().Call({ env.Null(), results });
+    }
+
+    void OnError(const Napi::Error& e) override {
+        Callback().Call({ e.Value() });
+    }
+
+private:
+    std::string Compare(const AVFrame* reference, const AVFrame* distorted, FrameQuality& out) {
+        AVPixelFormat format = comparableFormat(static_cast<AVPixelFormat>(reference->format));
+        if (format == AV_PIX_FMT_NONE) {
+            return "unsupported pixel format";
+        }
+
+        // Bring both into the comparison format at the reference's size
+        AVFrame* ref = Prepare(reference, format, reference->width, reference->height, refScaler_);
+        AVFrame* dist = Prepare(distorted, format, reference->width, reference->height, distScaler_);
+        if (!ref || !dist) {
+            if (ref != reference) av_frame_free(&ref);
+            if (dist != distorted) av_frame_free(&dist);
+            return "failed to convert frame";
+        }
+
+        const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+        const bool wide = desc->comp[0].depth > 8;
+        const double peak = static_cast<double>((1 << desc->comp[0].depth) - 1);
+        const int planes = av_pix_fmt_count_planes(format);
+        const bool rgb = (desc->flags & AV_PIX_FMT_FLAG_RGB) != 0;
+
+        out.peak = peak;
+        double totalSquared = 0;
+        double weightedSsim = 0;
+        int64_t totalPixels = 0;
+        out.planes.clear();
+
+        for (int p = 0; p < planes; p++) {
+            bool chroma = !rgb && (p == 1 || p == 2);
+            int w = chroma ? AV_CEIL_RSHIFT(ref->width, desc->log2_chroma_w) : ref->width;
+            int h = chroma ? AV_CEIL_RSHIFT(ref->height, desc->log2_chroma_h) : ref->height;
+
+            toFloatPlane(ref, p, w, h, wide, planeA_);
+            toFloatPlane(dist, p, w, h, wide, planeB_);
+
+            PlaneQuality q;
+            q.pixels = static_cast<int64_t>(w) * h;
+            q.mse = meanSquaredError(planeA_, planeB_);
+            q.psnr = psnrFromMse(q.mse, peak);
+            q.ssim = options_.ssim ? ssimPlane(planeA_.data(), planeB_.data(), w, h, peak).ssim : 0;
+            out.planes.push_back(q);
+
+            totalSquared += q.mse * q.pixels;
+            weightedSsim += q.ssim * q.pixels;
+            totalPixels += q.pixels;
+
+            if (p == 0 && options_.msssim) {
+                out.msssim = msssimPlane(planeA_, planeB_, w, h, peak);
+            }
+        }
+
+        // Whole-frame figures weight each plane by its pixel count
+        out.psnr = psnrFromMse(totalPixels ? totalSquared / totalPixels : 0, peak);
+        out.ssim = totalPixels ? weightedSsim / totalPixels : 0;
+
+        if (ref != reference) av_frame_free(&ref);
+        if (dist != distorted) av_frame_free(&dist);
+        return std::string();
+    }
+
+    // frame itself if it already matches, else a converted copy (nullptr on failure)
+    AVFrame* Prepare(const AVFrame* frame, AVPixelFormat format, int width, int height, FrameScaler& scaler) {
+        if (frame->format == format && frame->width == width && frame->height == height) {
+            return const_cast<AVFrame*>(frame);
+        }
+        AVFrame* converted = av_frame_alloc();
+        if (!converted) return nullptr;
+        converted->format = format;
+        converted->width = width;
+        converted->height = height;
+        if (scaler.scale(frame, converted, SWS_BICUBIC) < 0) {
+            av_frame_free(&converted);
+        }
+        return converted;
+    }
+
+    std::vector<AVFrame*> references_;
+    std::vector<AVFrame*> distorted_;
+    MetricOptions options_;
+    std::vector<FrameQuality> results_;
+    std::vector<float> planeA_;
+    std::vector<float> planeB_;
+    FrameScaler refScaler_;
+    FrameScaler distScaler_;
+};
+
+} // namespace
+
+// compareFrames(references, distorted, { ssim, msssim }, callback(err, results))
+Napi::Value CompareFrames(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 4 || !info[0].IsArray() || !info[1].IsArray() ||
+        !info[2].IsObject() || !info[3].IsFunction()) {
+        Napi::TypeError::New(env, "compareFrames(references, distorted, options, callback)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Array refArray = info[0].As<Napi::Array>();
+    Napi::Array distArray = info[1].As<Napi::Array>();
+    if (refArray.Length() != distArray.Length()) {
+        Napi::TypeError::New(env, "references and distorted must be the same length").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object opts = info[2].As<Napi::Object>();
+    MetricOptions options;
+    options.ssim = opts.Get("ssim").ToBoolean().Value();
+    options.msssim = opts.Get("msssim").ToBoolean().Value();
+
+    std::vector<AVFrame*> references;
+    std::vector<AVFrame*> distorted;
+    if (!CloneFrames(env, refArray, references)) {
+        return env.Undefined();
+    }
+    if (!CloneFrames(env, distArray, distorted)) {
+        for (AVFrame*& frame : references) av_frame_free(&frame);
+        return env.Undefined();
+    }
+
+    MetricsWorker* worker = new MetricsWorker(info[3].As<Napi::Function>(),
+                                              std::move(references), std::move(distorted), options);
+    worker->Queue();
+    return env.Undefined();
+}
+
+void InitMetrics(Napi::Env env, Napi::Object exports) {
+    exports.Set("compareFrames", Napi::Function::New(env, CompareFrames));
+}
@@ -0,0 +1,17 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <napi.h>
+
+/**
+ * Frame quality metrics: compareFrames(references, distorted, options, callback)
+ *
+ * Per-plane MSE/PSNR and SSIM plus luma MS-SSIM between pairs of
+ * VideoFrameNative frames, computed straight from their AVFrame planes on
+ * the libuv thread pool. Distorted frames in another size or format are
+ * converted to the reference's first; formats without separate planes
+ * (NV12, packed RGB) are compared as YUV420P / GBRP.
+ */
+void InitMetrics(Napi::Env env, Napi::Object exports);
+
+#endif // METRICS_H
@@ -0,0 +1,511 @@
+#include "muxer.h"
+
+#ifdef NWC_HAVE_AVFORMAT
+
+#include "env_state.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+}
+
+namespace {
+
+const AVRational kMicroseconds = { 1, 1000000 };
+
+struct MuxSegment {
+    bool isInit;
+    int64_t timestamp;
+    int64_t duration;
+    size_t byteLength;
+    std::vector<uint8_t> data;  // Empty when written to the fd
+};
+
+} // namespace
+
+Napi::FunctionReference Muxer::constructor;
+
+Napi::Object Muxer::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "Muxer", {
+        InstanceMethod("configure", &Muxer::Configure),
+        InstanceMethod("write", &Muxer::Write),
+        InstanceMethod("finalize", &Muxer::Finalize),
+        InstanceMethod("close", &Muxer::Close),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("Muxer", func);
+    return exports;
+}
+
+Muxer::Muxer(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<Muxer>(info) {
+
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2) {
+        Napi::TypeError::New(env, "Expected 2 callbacks").ThrowAsJavaScriptException();
+        return;
+    }
+
+    tsfnSegment_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[0].As<Napi::Function>(),
+        "MuxerSegment",
+        0,
+        1
+    );
+
+    tsfnError_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[1].As<Napi::Function>(),
+        "MuxerError",
+        0,
+        1
+    );
+
+    // A pending finalize() holds the event loop instead
+    tsfnSegment_.Unref(env);
+    tsfnError_.Unref(env);
+}
+
+Muxer::~Muxer() {
+    StopWorker();
+    FreeContext();
+
+    if (!nwc_env_teardown.load()) {
+        if (tsfnSegment_) tsfnSegment_.Release();
+        if (tsfnError_) tsfnError_.Release();
+    }
+}
+
+// configure({ tracks: [{ type, codec, width?, height?, sampleRate?,
+//             numberOfChannels?, extradata? }], fd?, minFragmentDuration? })
+// codec is an FFmpeg codec name (h264, hevc, vp9, av1, aac, opus, ...)
+void Muxer::Configure(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!info[0].IsObject()) {
+        Napi::TypeError::New(env, "Config must be an object").ThrowAsJavaScriptException();
+        return;
+    }
+
+    StopWorker();
+    FreeContext();
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    Napi::Array tracks = config.Get("tracks").As<Napi::Array>();
+
+    fd_ = -1;
+    if (config.Has("fd") && config.Get("fd").IsNumber()) {
+        fd_ = config.Get("fd").As<Napi::Number>().Int32Value();
+    }
+    minFragmentDuration_ = 0;
+    if (config.Has("minFragmentDuration") && config.Get("minFragmentDuration").IsNumber()) {
+        minFragmentDuration_ = config.Get("minFragmentDuration").As<Napi::Number>().Int64Value();
+    }
+
+    if (avformat_alloc_output_context2(&formatCtx_, nullptr, "mp4", nullptr) < 0 || !formatCtx_) {
+        Napi::Error::New(env, "MP4 muxer not available").ThrowAsJavaScriptException();
+        return;
+    }
+
+    for (uint32_t i = 0; i < tracks.Length(); i++) {
+        Napi::Object track = tracks.Get(i).As<Napi::Object>();
+        std::string codecName = track.Get("codec").As<Napi::String>().Utf8Value();
+        const AVCodecDescriptor* desc = avcodec_descriptor_get_by_name(codecName.c_str());
+        if (!desc) {
+            // Implementation names such as libopus
+            const AVCodec* codec = avcodec_find_decoder_by_name(codecName.c_str());
+            desc = codec ? avcodec_descriptor_get(codec->id) : nullptr;
+        }
+        if (!desc) {
+            FreeContext();
+            Napi::Error::New(env, "Unknown codec: " + codecName).ThrowAsJavaScriptException();
+            return;
+        }
+
+        AVStream* stream = avformat_new_stream(formatCtx_, nullptr);
+        AVCodecParameters* par = stream->codecpar;
+        par->codec_type = desc->type;
+        par->codec_id = desc->id;
+        stream->time_base = kMicroseconds;
+
+        if (desc->type == AVMEDIA_TYPE_VIDEO) {
+            par->width = track.Get("width").As<Napi::Number>().Int32Value();
+            par->height = track.Get("height").As<Napi::Number>().Int32Value();
+        } else {
+            par->sample_rate = track.Get("sampleRate").As<Napi::Number>().Int32Value();
+            av_channel_layout_default(&par->ch_layout,
+                track.Get("numberOfChannels").As<Napi::Number>().Int32Value());
+            if (par->codec_id == AV_CODEC_ID_AAC) {
+                par->frame_size = 1024;
+            }
+        }
+
+        if (track.Has("extradata") && track.Get("extradata").IsBuffer()) {
+            Napi::Buffer<uint8_t> extradata = track.Get("extradata").As<Napi::Buffer<uint8_t>>();
+            par->extradata = static_cast<uint8_t*>(av_mallocz(extradata.Length() + AV_INPUT_BUFFER_PADDING_SIZE));
+            if (par->extradata) {
+                memcpy(par->extradata, extradata.Data(), extradata.Length());
+                par->extradata_size = static_cast<int>(extradata.Length());
+            }
+        }
+    }
+
+    if (formatCtx_->nb_streams == 0) {
+        FreeContext();
+        Napi::TypeError::New(env, "At least one track is required").ThrowAsJavaScriptException();
+        return;
+    }
+
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(kIOBufferSize));
+    formatCtx_->pb = buffer ? avio_alloc_context(buffer, kIOBufferSize, 1, this, nullptr,
+                                                 &Muxer::IOWrite, nullptr)
+                            : nullptr;
+    if (!formatCtx_->pb) {
+        av_free(buffer);
+        FreeContext();
+        Napi::Error::New(env, "Failed to allocate muxer output").ThrowAsJavaScriptException();
+        return;
+    }
+    formatCtx_->pb->seekable = 0;
+
+    trackSeen_.assign(formatCtx_->nb_streams, false);
+    headerWritten_ = false;
+    segment_.clear();
+    fragmentPackets_ = 0;
+
+    jobs_.reopen();
+    accepting_ = true;
+    worker_ = std::thread(&Muxer::WorkerThread, this);
+}
+
+bool Muxer::SubmitPacket(int track, const AVPacket* packet, const uint8_t* extradata, int extradataSize) {
+    if (!accepting_) {
+        return false;
+    }
+
+    MuxJob job;
+    job.track = track;
+    job.packet = av_packet_clone(packet);
+    if (!job.packet) {
+        return false;
+    }
+    if (extradata && extradataSize > 0) {
+        job.extradata.assign(extradata, extradata + extradataSize);
+    }
+
+    if (!jobs_.push(job)) {
+        FreeJob(job);
+        return false;
+    }
+    return true;
+}
+
+// write(track, data: Buffer, isKeyframe, timestamp, duration, extradata?)
+void Muxer::Write(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!accepting_) {
+        Napi::Error::New(env, "Muxer not configured").ThrowAsJavaScriptException();
+        return;
+    }
+
+    Napi::Buffer<uint8_t> data = info[1].As<Napi::Buffer<uint8_t>>();
+
+    AVPacket* packet = av_packet_alloc();
+    if (!packet || av_new_packet(packet, static_cast<int>(data.Length())) < 0) {
+        av_packet_free(&packet);
+        Napi::Error::New(env, "Failed to allocate packet").ThrowAsJavaScriptException();
+        return;
+    }
+    memcpy(packet->data, data.Data(), data.Length());
+    if (info[2].As<Napi::Boolean>().Value()) {
+        packet->flags |= AV_PKT_FLAG_KEY;
+    }
+    packet->pts = info[3].As<Napi::Number>().Int64Value();
+    packet->dts = packet->pts;
+    packet->duration = info[4].As<Napi::Number>().Int64Value();
+
+    const uint8_t* extradata = nullptr;
+    int extradataSize = 0;
+    if (info.Length() > 5 && info[5].IsBuffer()) {
+        Napi::Buffer<uint8_t> buf = info[5].As<Napi::Buffer<uint8_t>>();
+        extradata = buf.Data();
+        extradataSize = static_cast<int>(buf.Length());
+    }
+
+    SubmitPacket(info[0].As<Napi::Number>().Int32Value(), packet, extradata, extradataSize);
+    av_packet_free(&packet);
+}
+
+// finalize(callback(err)): write the last fragment once everything queued
+// before the call has been muxed. No more packets are accepted afterwards.
+void Muxer::Finalize(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Function callback = info[0].As<Napi::Function>();
+
+    if (!accepting_) {
+        callback.Call({ Napi::Error::New(env, "Muxer not configured").Value() });
+        return;
+    }
+
+    MuxJob job;
+    job.onFinalize = Napi::ThreadSafeFunction::New(env, callback, "MuxerFinalize", 0, 1);
+    accepting_ = false;
+    if (!jobs_.push(job)) {
+        job.onFinalize.Release();
+    }
+}
+
+void Muxer::Close(const Napi::CallbackInfo& info) {
+    StopWorker();
+    FreeContext();
+
+    if (tsfnSegment_) { tsfnSegment_.Release(); tsfnSegment_ = Napi::ThreadSafeFunction(); }
+    if (tsfnError_) { tsfnError_.Release(); tsfnError_ = Napi::ThreadSafeFunction(); }
+}
+
+void Muxer::FreeJob(MuxJob& job) {
+    if (job.packet) av_packet_free(&job.packet);
+    if (job.onFinalize && !nwc_env_teardown.load()) {
+        // Dropped before it ran: resolve rather than leave it hanging
+        job.onFinalize.NonBlockingCall([](Napi::Env env, Napi::Function fn) {
+            fn.Call({ Napi::Error::New(env, "Muxer closed").Value() });
+        });
+        job.onFinalize.Release();
+    }
+    job.onFinalize = Napi::ThreadSafeFunction();
+}
+
+// Drop queued packets and join the worker; safe when not configured
+void Muxer::StopWorker() {
+    accepting_ = false;
+    jobs_.close();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    jobs_.drain(FreeJob);
+}
+
+void Muxer::FreeContext() {
+    for (MuxJob& job : pending_) {
+        FreeJob(job);
+    }
+    pending_.clear();
+
+    if (formatCtx_) {
+        if (formatCtx_->pb) {
+            // Custom output: avformat leaves the AVIOContext and buffer to us
+            av_freep(&formatCtx_->pb->buffer);
+            avio_context_free(&formatCtx_->pb);
+        }
+        avformat_free_context(formatCtx_);
+        formatCtx_ = nullptr;
+    }
+}
+
+int Muxer::IOWrite(void* opaque,
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+                   const
+#endif
+                   uint8_t* buf, int size) {
+    Muxer* self = static_cast<Muxer*>(opaque);
+    self->segment_.insert(self->segment_.end(), buf, buf + size);
+    return size;
+}
+
+void Muxer::WorkerThread() {
+    MuxJob job;
+    while (jobs_.pop(job)) {
+        if (job.onFinalize) {
+            if (!headerWritten_ && !pending_.empty()) {
+                WriteHeader();
+            }
+            if (fragmentPackets_ > 0) {
+                CutFragment(fragmentEnd_);
+            }
+            if (headerWritten_) {
+                av_write_trailer(formatCtx_);  // skip_trailer: frees muxer state only
+            }
+
+            job.onFinalize.NonBlockingCall([](Napi::Env env, Napi::Function fn) {
+                fn.Call({ env.Null() });
+            });
+            job.onFinalize.Release();
+            job.onFinalize = Napi::ThreadSafeFunction();
+            // Later packets are dropped: accepting_ is already false
+            continue;
+        }
+
+        if (job.track < 0 || job.track >= static_cast<int>(trackSeen_.size())) {
+            FreeJob(job);
+            ReportError("Invalid track: " + std::to_string(job.track));
+            continue;
+        }
+
+        if (!headerWritten_) {
+            // Hold packets until every track has shown up, so each one's
+            // decoder config can go into moov
+            trackSeen_[job.track] = true;
+            AVCodecParameters* par = formatCtx_->streams[job.track]->codecpar;
+            if (!job.extradata.empty() && !par->extradata) {
+                par->extradata = static_cast<uint8_t*>(av_mallocz(job.extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+                if (par->extradata) {
+                    memcpy(par->extradata, job.extradata.data(), job.extradata.size());
+                    par->extradata_size = static_cast<int>(job.extradata.size());
+                }
+            }
+            pending_.push_back(std::move(job));
+            job = MuxJob();
+
+            bool allSeen = true;
+            for (bool seen : trackSeen_) allSeen = allSeen && seen;
+            if (!allSeen && pending_.size() < kMaxPendingPackets) {
+                continue;
+            }
+            WriteHeader();
+            continue;
+        }
+
+        MuxPacket(job);
+    }
+}
+
+bool Muxer::WriteHeader() {
+    AVDictionary* opts = nullptr;
+    // frag_custom: fragments are cut only by CutFragment; skip_trailer: no
+    // mfra index at the end, the stream is complete after each fragment
+    av_dict_set(&opts, "movflags", "cmaf+frag_custom+empty_moov+default_base_moof+skip_trailer", 0);
+    int ret = avformat_write_header(formatCtx_, &opts);
+    av_dict_free(&opts);
+
+    std::vector<MuxJob> pending;
+    pending.swap(pending_);
+
+    if (ret < 0) {
+        for (MuxJob& job : pending) FreeJob(job);
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        ReportError(std::string("Failed to write init segment: ") + errBuf);
+        accepting_ = false;
+        return false;
+    }
+
+    headerWritten_ = true;
+    avio_flush(formatCtx_->pb);
+    EmitSegment(true, 0, 0);
+
+    for (MuxJob& job : pending) {
+        MuxPacket(job);
+    }
+    return true;
+}
+
+void Muxer::MuxPacket(MuxJob& job) {
+    AVPacket* packet = job.packet;
+    bool isKey = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+    if (packet->dts == AV_NOPTS_VALUE) {
+        packet->dts = packet->pts;
+    }
+
+    // Fragments start on track 0's keyframes
+    if (job.track == 0 && isKey && fragmentPackets_ > 0 &&
+        packet->pts - fragmentStart_ >= minFragmentDuration_) {
+        CutFragment(packet->pts);
+    }
+    if (fragmentPackets_ == 0) {
+        fragmentStart_ = packet->pts;
+        fragmentEnd_ = packet->pts;
+    }
+    if (job.track == 0) {
+        fragmentEnd_ = std::max(fragmentEnd_, packet->pts + packet->duration);
+    }
+
+    packet->stream_index = job.track;
+    av_packet_rescale_ts(packet, kMicroseconds, formatCtx_->streams[job.track]->time_base);
+    int ret = av_write_frame(formatCtx_, packet);
+    FreeJob(job);
+
+    if (ret < 0) {
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        ReportError(std::string("Mux error: ") + errBuf);
+        return;
+    }
+    fragmentPackets_++;
+}
+
+void Muxer::CutFragment(int64_t end) {
+    // A null packet flushes the buffered samples as one moof+mdat
+    av_write_frame(formatCtx_, nullptr);
+    avio_flush(formatCtx_->pb);
+    EmitSegment(false, fragmentStart_, end - fragmentStart_);
+    fragmentPackets_ = 0;
+}
+
+void Muxer::EmitSegment(bool isInit, int64_t timestamp, int64_t duration) {
+    if (segment_.empty()) {
+        return;
+    }
+
+    MuxSegment* seg = new MuxSegment();
+    seg->isInit = isInit;
+    seg->timestamp = timestamp;
+    seg->duration = duration;
+    seg->byteLength = segment_.size();
+
+    if (fd_ >= 0) {
+        const uint8_t* p = segment_.data();
+        size_t left = segment_.size();
+        while (left > 0) {
+            ssize_t n = ::write(fd_, p, left);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                ReportError(std::string("Write failed: ") + strerror(errno));
+                break;
+            }
+            p += n;
+            left -= static_cast<size_t>(n);
+        }
+        segment_.clear();
+    } else {
+        seg->data.swap(segment_);
+    }
+
+    napi_status status = tsfnSegment_.NonBlockingCall(seg,
+        [](Napi::Env env, Napi::Function fn, MuxSegment* s) {
+            fn.Call({
+                Napi::String::New(env, s->isInit ? "init" : "fragment"),
+                Napi::Number::New(env, static_cast<double>(s->timestamp)),
+                Napi::Number::New(env, static_cast<double>(s->duration)),
+                Napi::Number::New(env, static_cast<double>(s->byteLength)),
+                s->data.empty() ? env.Undefined()
+                    : Napi::Buffer<uint8_t>::Copy(env, s->data.data(), s->data.size()).As<Napi::Value>()
+            });
+            delete s;
+        });
+    if (status != napi_ok) {
+        delete seg;
+    }
+}
+
+void Muxer::ReportError(const std::string& message) {
+    auto* msg = new std::string(message);
+    napi_status status = tsfnError_.NonBlockingCall(msg,
+        [](Napi::Env env, Napi::Function fn, std::string* m) {
+            fn.Call({ Napi::String::New(env, *m) });
+            delete m;
+        });
+    if (status != napi_ok) {
+        delete msg;
+    }
+}
+
+#endif // NWC_HAVE_AVFORMAT
@@ -0,0 +1,116 @@
+#ifndef MUXER_H
+#define MUXER_H
+
+#include <napi.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "work_queue.h"
+
+#ifdef NWC_HAVE_AVFORMAT
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+struct MuxJob {
+    int track = 0;
+    AVPacket* packet = nullptr;       // Timestamps in microseconds
+    std::vector<uint8_t> extradata;   // Track's decoder config, if the packet carried one
+    Napi::ThreadSafeFunction onFinalize;  // Finalize marker only
+};
+
+/**
+ * Fragmented MP4 (CMAF) muxer on libavformat's movenc.
+ *
+ * Packets arrive from JS (write) or straight from a VideoEncoderAsync
+ * worker (SubmitPacket) and are muxed on one worker thread. The init
+ * segment (ftyp+moov) is written once every track has produced a packet,
+ * so decoder configs carried by first keyframes make it into moov. A new
+ * fragment (moof+mdat) starts at each keyframe of track 0 once the current
+ * one spans minFragmentDuration.
+ *
+ * Each segment is collected in memory and handed out whole: one write(2)
+ * to the configured fd, or one Buffer to the callback. Either way the
+ * callback reports its kind, start timestamp and duration for playlists.
+ */
+class Muxer : public Napi::ObjectWrap<Muxer> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    Muxer(const Napi::CallbackInfo& info);
+    ~Muxer();
+
+    /**
+     * Queue an encoded packet for track from any thread. The packet is
+     * referenced, not copied; extradata (nullable) is the track's decoder
+     * config. Returns false before configure() or after finalize/close.
+     */
+    bool SubmitPacket(int track, const AVPacket* packet, const uint8_t* extradata, int extradataSize);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    // AVIO buffer; whole segments are coalesced in segment_ regardless
+    static constexpr int kIOBufferSize = 256 * 1024;
+
+    // Packets held waiting for every track's first packet before moov is
+    // written; past this the init segment goes out without the stragglers
+    static constexpr size_t kMaxPendingPackets = 256;
+
+    // JavaScript-facing methods
+    void Configure(const Napi::CallbackInfo& info);
+    void Write(const Napi::CallbackInfo& info);
+    void Finalize(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    void StopWorker();
+    void FreeContext();
+    static void FreeJob(MuxJob& job);
+
+    // Worker thread
+    void WorkerThread();
+    void MuxPacket(MuxJob& job);
+    bool WriteHeader();
+    void CutFragment(int64_t end);
+    void EmitSegment(bool isInit, int64_t timestamp, int64_t duration);
+    void ReportError(const std::string& message);
+
+    static int IOWrite(void* opaque,
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+                       const
+#endif
+                       uint8_t* buf, int size);
+
+    Napi::ThreadSafeFunction tsfnSegment_;
+    Napi::ThreadSafeFunction tsfnError_;
+
+    WorkQueue<MuxJob> jobs_;
+    std::thread worker_;
+    std::atomic<bool> accepting_{false};  // Between configure and finalize/close
+
+    // Worker thread only, once configured
+    AVFormatContext* formatCtx_ = nullptr;
+    std::vector<bool> trackSeen_;
+    std::vector<MuxJob> pending_;   // Before the init segment
+    bool headerWritten_ = false;
+    std::vector<uint8_t> segment_;  // Bytes of the segment being written
+    int64_t fragmentStart_ = 0;
+    int64_t fragmentEnd_ = 0;
+    int fragmentPackets_ = 0;
+
+    // Configuration
+    int fd_ = -1;                   // -1 = hand segments to the callback
+    int64_t minFragmentDuration_ = 0;
+};
+
+#else
+
+// Stub without libavformat: registers nothing
+class Muxer {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) { return exports; }
+};
+
+#endif // NWC_HAVE_AVFORMAT
+
+#endif // MUXER_H
@@ -0,0 +1,79 @@
+#include "scaler.h"
+#include "threading.h"
+
+extern "C" {
+#include <libavutil/opt.h>
+}
+
+FrameScaler::~FrameScaler() {
+    reset();
+}
+
+void FrameScaler::reset() {
+    if (ctx_) {
+        sws_freeContext(ctx_);
+        ctx_ = nullptr;
+    }
+}
+
+int FrameScaler::scale(const AVFrame* src, AVFrame* dst, int flags) {
+    if (!ctx_ ||
+        src->width != srcWidth_ || src->height != srcHeight_ || src->format != srcFormat_ ||
+        dst->width != dstWidth_ || dst->height != dstHeight_ || dst->format != dstFormat_ ||
+        flags != flags_) {
+        reset();
+
+        ctx_ = sws_alloc_context();
+        if (!ctx_) {
+            return AVERROR(ENOMEM);
+        }
+        av_opt_set_int(ctx_, "srcw", src->width, 0);
+        av_opt_set_int(ctx_, "srch", src->height, 0);
+        av_opt_set_int(ctx_, "src_format", src->format, 0);
+        av_opt_set_int(ctx_, "dstw", dst->width, 0);
+        av_opt_set_int(ctx_, "dsth", dst->height, 0);
+        av_opt_set_int(ctx_, "dst_format", dst->format, 0);
+        av_opt_set_int(ctx_, "sws_flags", flags, 0);
+        av_opt_set_int(ctx_, "threads", Threading::swsThreadCount(), 0);
+
+        int ret = sws_init_context(ctx_, nullptr, nullptr);
+        if (ret < 0) {
+            reset();
+            return ret;
+        }
+
+        srcWidth_ = src->width;
+        srcHeight_ = src->height;
+        srcFormat_ = src->format;
+        dstWidth_ = dst->width;
+        dstHeight_ = dst->height;
+        dstFormat_ = dst->format;
+        flags_ = flags;
+    }
+
+    if (!dst->buf[0]) {
+        int ret = av_frame_get_buffer(dst, 0);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    int ret = sws_scale_frame(ctx_, dst, src);
+    if (ret < 0) {
+        return ret;
+    }
+
+    CopyScaledFrameProps(dst, src);
+    return 0;
+}
+
+void CopyScaledFrameProps(AVFrame* dst, const AVFrame* src) {
+    av_frame_copy_props(dst, src);
+    if (dst->width == src->width && dst->height == src->height) {
+        return;
+    }
+    av_frame_remove_side_data(dst, AV_FRAME_DATA_MOTION_VECTORS);
+#if __has_include(<libavutil/video_enc_params.h>)
+    av_frame_remove_side_data(dst, AV_FRAME_DATA_VIDEO_ENC_PARAMS);
+#endif
+}
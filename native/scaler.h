@@ -0,0 +1,51 @@
+#ifndef SCALER_H
+#define SCALER_H
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+/**
+ * Reusable swscale conversion. The context is built with sws_alloc_context
+ * so it can use the thread budget (sws_getContext is single-threaded), and
+ * is rebuilt only when the source or destination geometry/format changes.
+ *
+ * Not thread-safe; give each worker its own scaler.
+ */
+class FrameScaler {
+public:
+    FrameScaler() = default;
+    ~FrameScaler();
+
+    FrameScaler(const FrameScaler&) = delete;
+    FrameScaler& operator=(const FrameScaler&) = delete;
+
+    /**
+     * Convert src into dst. dst->format/width/height select the target;
+     * buffers are allocated if dst has none. Timestamps and color properties
+     * are copied from src (see CopyScaledFrameProps). Returns 0 or a
+     * negative AVERROR.
+     */
+    int scale(const AVFrame* src, AVFrame* dst, int flags = SWS_BILINEAR);
+
+    void reset();
+
+private:
+    SwsContext* ctx_ = nullptr;
+    int srcWidth_ = 0;
+    int srcHeight_ = 0;
+    int srcFormat_ = -1;
+    int dstWidth_ = 0;
+    int dstHeight_ = 0;
+    int dstFormat_ = -1;
+    int flags_ = 0;
+};
+
+/**
+ * av_frame_copy_props for a converted frame. Motion vectors and QP blocks
+ * are in src's pixel coordinates, so they are dropped when the size changed.
+ */
+void CopyScaledFrameProps(AVFrame* dst, const AVFrame* src);
+
+#endif // SCALER_H
@@ -0,0 +1,245 @@
+#include "scene_detector.h"
+#include "frame.h"
+#include <algorithm>
+#include <cmath>
+
+Napi::FunctionReference SceneDetector::constructor;
+
+namespace {
+
+constexpr int kMaxColumns = 128;
+constexpr int kMinBlock = 4;
+
+// One pass over a luma plane: per-row block sums and a histogram of
+// (sample >> shift) >> 2. Each block's row span is contiguous, so its
+// inner sum vectorizes; the histogram is split four ways to break the
+// store-to-load chain on runs of equal samples.
+template <typename T>
+void accumulateLuma(const uint8_t* data, int linesize, int width, int height, int shift,
+                    int block, int columns, uint32_t* sums, uint32_t (*histogram)[64]) {
+    for (int y = 0; y < height; y++) {
+        const T* row = reinterpret_cast<const T*>(data + static_cast<ptrdiff_t>(y) * linesize);
+        uint32_t* blockRow = sums + static_cast<size_t>(y / block) * columns;
+
+        for (int c = 0; c < columns; c++) {
+            int x1 = std::min(width, (c + 1) * block);
+            uint32_t sum = 0;
+            for (int x = c * block; x < x1; x++) {
+                sum += row[x] >> shift;
+            }
+            blockRow[c] += sum;
+        }
+
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            histogram[0][(row[x] >> shift) >> 2]++;
+            histogram[1][(row[x + 1] >> shift) >> 2]++;
+            histogram[2][(row[x + 2] >> shift) >> 2]++;
+            histogram[3][(row[x + 3] >> shift) >> 2]++;
+        }
+        for (; x < width; x++) {
+            histogram[0][(row[x] >> shift) >> 2]++;
+        }
+    }
+}
+
+} // namespace
+
+SceneThresholds ParseSceneThresholds(const Napi::Object& options) {
+    SceneThresholds thresholds;
+    if (options.Has("sceneThreshold") && options.Get("sceneThreshold").IsNumber()) {
+        thresholds.scene = options.Get("sceneThreshold").As<Napi::Number>().DoubleValue();
+    }
+    if (options.Has("histogramThreshold") && options.Get("histogramThreshold").IsNumber()) {
+        thresholds.histogram = options.Get("histogramThreshold").As<Napi::Number>().DoubleValue();
+    }
+    if (options.Has("duplicateThreshold") && options.Get("duplicateThreshold").IsNumber()) {
+        thresholds.duplicate = options.Get("duplicateThreshold").As<Napi::Number>().DoubleValue();
+    }
+    return thresholds;
+}
+
+SceneAnalyzer::~SceneAnalyzer() {
+    av_frame_free(&gray_);
+}
+
+bool SceneAnalyzer::buildSignature(const AVFrame* frame, Signature& signature) {
+    signature.valid = false;
+
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame->format));
+    if (!desc || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL) || frame->width <= 0 || frame->height <= 0) {
+        return false;
+    }
+
+    // Planar and semi-planar YUV/gray keep luma in its own plane, one
+    // native-endian sample per pixel; read it in place
+    const AVComponentDescriptor& luma = desc->comp[0];
+    bool direct = !(desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BAYER |
+                                   AV_PIX_FMT_FLAG_FLOAT | AV_PIX_FMT_FLAG_BE)) &&
+                  luma.plane == 0 && luma.offset == 0 && luma.depth >= 8 && luma.depth <= 16 &&
+                  luma.step == (luma.depth > 8 ? 2 : 1);
+
+    const AVFrame* source = frame;
+    if (!direct) {
+        if (gray_ && (gray_->width != frame->width || gray_->height != frame->height)) {
+            av_frame_free(&gray_);
+        }
+        if (!gray_) {
+            gray_ = av_frame_alloc();
+            if (!gray_) return false;
+            gray_->format = AV_PIX_FMT_GRAY8;
+            gray_->width = frame->width;
+            gray_->height = frame->height;
+        }
+        if (grayScaler_.scale(frame, gray_, SWS_POINT) < 0) {
+            return false;
+        }
+        source = gray_;
+    }
+
+    int width = source->width;
+    int height = source->height;
+    int block = std::max(kMinBlock, (width + kMaxColumns - 1) / kMaxColumns);
+    int columns = (width + block - 1) / block;
+    int rows = (height + block - 1) / block;
+    int shift = direct ? luma.shift + luma.depth - 8 : 0;
+
+    sums_.assign(static_cast<size_t>(columns) * rows, 0);
+    uint32_t histogram[4][kBins] = {};
+    if (direct && luma.depth > 8) {
+        accumulateLuma<uint16_t>(source->data[0], source->linesize[0], width, height, shift,
+                                 block, columns, sums_.data(), histogram);
+    } else {
+        accumulateLuma<uint8_t>(source->data[0], source->linesize[0], width, height, shift,
+                                block, columns, sums_.data(), histogram);
+    }
+
+    signature.width = width;
+    signature.height = height;
+    signature.columns = columns;
+    signature.rows = rows;
+    signature.blocks.resize(sums_.size());
+    for (int r = 0; r < rows; r++) {
+        int blockHeight = std::min(block, height - r * block);
+        for (int c = 0; c < columns; c++) {
+            int blockWidth = std::min(block, width - c * block);
+            size_t i = static_cast<size_t>(r) * columns + c;
+            signature.blocks[i] = static_cast<float>(sums_[i]) / (blockWidth * blockHeight);
+        }
+    }
+
+    float pixels = static_cast<float>(width) * height;
+    for (int b = 0; b < kBins; b++) {
+        signature.histogram[b] = (histogram[0][b] + histogram[1][b] + histogram[2][b] + histogram[3][b]) / pixels;
+    }
+
+    signature.valid = true;
+    return true;
+}
+
+bool SceneAnalyzer::analyze(const AVFrame* frame, SceneScore& score) {
+    if (!buildSignature(frame, current_)) {
+        return false;
+    }
+
+    // A new size can't be compared block for block; treat it as a cut
+    if (!reference_.valid || reference_.width != current_.width || reference_.height != current_.height) {
+        score = SceneScore{1.0, 1.0, 1.0, true, false, true};
+        previousDifference_ = 0;
+        return true;
+    }
+
+    const float* a = reference_.blocks.data();
+    const float* b = current_.blocks.data();
+    size_t count = current_.blocks.size();
+    float total = 0;
+    float largest = 0;
+    for (size_t i = 0; i < count; i++) {
+        float d = std::fabs(a[i] - b[i]);
+        total += d;
+        largest = std::max(largest, d);
+    }
+
+    float histogramL1 = 0;
+    for (int i = 0; i < kBins; i++) {
+        histogramL1 += std::fabs(reference_.histogram[i] - current_.histogram[i]);
+    }
+
+    score.difference = total / count / 255.0;
+    score.blockDifference = largest / 255.0;
+    score.histogramDistance = std::min(1.0, histogramL1 * 0.5);
+    score.first = false;
+
+    double jump = std::min(score.difference, std::fabs(score.difference - previousDifference_));
+    score.sceneChange = jump >= thresholds.scene && score.histogramDistance >= thresholds.histogram;
+    score.duplicate = score.blockDifference <= thresholds.duplicate;
+
+    previousDifference_ = score.difference;
+    return true;
+}
+
+void SceneAnalyzer::commit() {
+    if (!current_.valid) {
+        return;
+    }
+    std::swap(reference_, current_);
+    current_.valid = false;
+}
+
+void SceneAnalyzer::reset() {
+    reference_.valid = false;
+    current_.valid = false;
+    previousDifference_ = 0;
+}
+
+Napi::Object SceneDetector::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "SceneDetector", {
+        InstanceMethod("analyze", &SceneDetector::Analyze),
+        InstanceMethod("reset", &SceneDetector::Reset),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("SceneDetector", func);
+    return exports;
+}
+
+// new SceneDetector({ sceneThreshold?, histogramThreshold?, duplicateThreshold? })
+SceneDetector::SceneDetector(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SceneDetector>(info) {
+    if (info.Length() > 0 && info[0].IsObject()) {
+        analyzer_.thresholds = ParseSceneThresholds(info[0].As<Napi::Object>());
+    }
+}
+
+// analyze(frame) -> { difference, blockDifference, histogramDistance, sceneChange, duplicate }
+Napi::Value SceneDetector::Analyze(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    VideoFrameNative* native = info.Length() > 0 && info[0].IsObject()
+        ? Napi::ObjectWrap<VideoFrameNative>::Unwrap(info[0].As<Napi::Object>()) : nullptr;
+    if (!native || !native->GetFrame()) {
+        Napi::TypeError::New(env, "Frame is closed").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    SceneScore score;
+    if (!analyzer_.analyze(native->GetFrame(), score)) {
+        Napi::Error::New(env, "Frame format can't be analyzed").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    analyzer_.commit();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("difference", Napi::Number::New(env, score.difference));
+    result.Set("blockDifference", Napi::Number::New(env, score.blockDifference));
+    result.Set("histogramDistance", Napi::Number::New(env, score.histogramDistance));
+    result.Set("sceneChange", Napi::Boolean::New(env, score.sceneChange));
+    result.Set("duplicate", Napi::Boolean::New(env, score.duplicate));
+    return result;
+}
+
+void SceneDetector::Reset(const Napi::CallbackInfo& info) {
+    analyzer_.reset();
+}
@@ -0,0 +1,577 @@
+#include "segmented_encoder.h"
+#include "env_state.h"
+#include "frame.h"
+#include "encoder_setup.h"
+#include "hw_accel.h"
+#include "threading.h"
+#include <algorithm>
+
+Napi::FunctionReference VideoSegmentedEncoder::constructor;
+
+Napi::Object VideoSegmentedEncoder::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "VideoSegmentedEncoder", {
+        InstanceMethod("configure", &VideoSegmentedEncoder::Configure),
+        InstanceMethod("encode", &VideoSegmentedEncoder::Encode),
+        InstanceMethod("flush", &VideoSegmentedEncoder::Flush),
+        InstanceMethod("reset", &VideoSegmentedEncoder::Reset),
+        InstanceMethod("close", &VideoSegmentedEncoder::Close),
+        InstanceMethod("getPendingFrames", &VideoSegmentedEncoder::GetPendingFrames),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("VideoSegmentedEncoder", func);
+    return exports;
+}
+
+VideoSegmentedEncoder::VideoSegmentedEncoder(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<VideoSegmentedEncoder>(info)
+    , width_(0)
+    , height_(0)
+    , bitrate_(2000000)
+    , bitrateMode_("variable")
+    , framerate_(30)
+    , profile_(-1)
+    , inputFormat_(AV_PIX_FMT_NONE)
+    , segmentLength_(60)
+    , concurrency_(1)
+    , threadBudget_(0) {
+
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2) {
+        Napi::TypeError::New(env, "Expected 2 callbacks").ThrowAsJavaScriptException();
+        return;
+    }
+
+    tsfnOutput_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[0].As<Napi::Function>(),
+        "VideoSegmentedEncoderOutput",
+        0,
+        1
+    );
+
+    tsfnError_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[1].As<Napi::Function>(),
+        "VideoSegmentedEncoderError",
+        0,
+        1
+    );
+
+    // Idle encoders don't hold the event loop; in-flight jobs do (JobSubmitted)
+    tsfnOutput_.Unref(env);
+    tsfnError_.Unref(env);
+
+    tsfnJobDone_ = Napi::ThreadSafeFunction::New(
+        env,
+        Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+        "VideoSegmentedEncoderJobDone",
+        0,
+        1
+    );
+    tsfnJobDone_.Unref(env);
+
+    if (info.Length() > 2 && info[2].IsFunction()) {
+        onDequeue_ = Napi::Persistent(info[2].As<Napi::Function>());
+    }
+}
+
+VideoSegmentedEncoder::~VideoSegmentedEncoder() {
+    StopWorkers();
+
+    if (!nwc_env_teardown.load()) {
+        if (tsfnOutput_) tsfnOutput_.Release();
+        if (tsfnError_) tsfnError_.Release();
+        if (tsfnJobDone_) tsfnJobDone_.Release();
+    }
+}
+
+// Hold the event loop open while jobs are in flight (JS thread only)
+void VideoSegmentedEncoder::JobSubmitted(Napi::Env env) {
+    if (activeJobs_++ == 0) {
+        tsfnOutput_.Ref(env);
+        Ref();
+    }
+}
+
+void VideoSegmentedEncoder::JobFinished(Napi::Env env) {
+    if (activeJobs_ > 0 && --activeJobs_ == 0) {
+        tsfnOutput_.Unref(env);
+        Unref();
+    }
+}
+
+void VideoSegmentedEncoder::Configure(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!info[0].IsObject()) {
+        Napi::TypeError::New(env, "Config must be an object").ThrowAsJavaScriptException();
+        return;
+    }
+
+    StopWorkers();
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    codecName_ = config.Get("codec").As<Napi::String>().Utf8Value();
+    width_ = config.Get("width").As<Napi::Number>().Int32Value();
+    height_ = config.Get("height").As<Napi::Number>().Int32Value();
+
+    bitrate_ = 2000000;
+    if (config.Has("bitrate") && config.Get("bitrate").IsNumber()) {
+        bitrate_ = config.Get("bitrate").As<Napi::Number>().Int64Value();
+    }
+
+    framerate_ = 30;
+    if (config.Has("framerate") && config.Get("framerate").IsNumber()) {
+        framerate_ = config.Get("framerate").As<Napi::Number>().Int32Value();
+    }
+
+    bitrateMode_ = "variable";
+    if (config.Has("bitrateMode") && config.Get("bitrateMode").IsString()) {
+        bitrateMode_ = config.Get("bitrateMode").As<Napi::String>().Utf8Value();
+    }
+
+    profile_ = -1;
+    if (config.Has("profile") && config.Get("profile").IsNumber()) {
+        profile_ = config.Get("profile").As<Napi::Number>().Int32Value();
+    }
+
+    inputFormat_ = AV_PIX_FMT_NONE;
+    if (config.Has("inputFormat") && config.Get("inputFormat").IsString()) {
+        inputFormat_ = StringToPixelFormat(config.Get("inputFormat").As<Napi::String>().Utf8Value());
+    }
+
+    // Two-second GOPs unless told otherwise
+    segmentLength_ = std::max(1, framerate_ * 2);
+    if (config.Has("segmentLength") && config.Get("segmentLength").IsNumber()) {
+        segmentLength_ = config.Get("segmentLength").As<Napi::Number>().Int32Value();
+    }
+
+    // One context per ~4 cores: x264/SVT-AV1 scale well to about that at
+    // 1080p, past which extra segments in flight win over wider encoders
+    int cores = Threading::budget().effectiveCores;
+    concurrency_ = std::max(1, cores / 4);
+    if (config.Has("concurrency") && config.Get("concurrency").IsNumber()) {
+        concurrency_ = config.Get("concurrency").As<Napi::Number>().Int32Value();
+    }
+
+    if (width_ <= 0 || height_ <= 0 || segmentLength_ <= 0 || concurrency_ <= 0) {
+        Napi::TypeError::New(env, "Invalid width, height, segmentLength or concurrency").ThrowAsJavaScriptException();
+        return;
+    }
+    threadBudget_ = std::max(1, cores / concurrency_);
+
+    // Open one context up front so a bad config throws here, not on a worker
+    std::string error;
+    AVCodecContext* probe = OpenContext(error);
+    if (!probe) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return;
+    }
+    avcodec_free_context(&probe);
+
+    configured_ = true;
+    for (int i = 0; i < concurrency_; i++) {
+        workers_.emplace_back(&VideoSegmentedEncoder::WorkerThread, this);
+    }
+}
+
+AVCodecContext* VideoSegmentedEncoder::OpenContext(std::string& error) {
+    // Software only: identical contexts must produce identical bitstream
+    // headers, and hardware sessions are too scarce to open K of
+    const AVCodec* codec = HWAccel::selectEncoder(codecName_, HWAccel::Preference::PreferSoftware,
+                                                  width_, height_).codec;
+    if (!codec) {
+        codec = avcodec_find_encoder_by_name(codecName_.c_str());
+    }
+    if (!codec) {
+        error = "No suitable encoder found for: " + codecName_;
+        return nullptr;
+    }
+
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    if (!ctx) {
+        error = "Failed to allocate codec context";
+        return nullptr;
+    }
+
+    ctx->width = width_;
+    ctx->height = height_;
+    ctx->time_base = { 1, 1000000 };
+    ctx->framerate = { framerate_, 1 };
+    ctx->gop_size = segmentLength_;  // Segments are cut on forced keyframes
+    ctx->max_b_frames = 0;
+    ctx->pix_fmt = NegotiateEncoderPixelFormat(codec, inputFormat_, profile_);
+
+    EncoderSetup::applyRateControl(ctx, bitrateMode_, bitrate_);
+    EncoderSetup::applyH264Profile(ctx, profile_);
+    EncoderSetup::applyTuning(ctx, "quality", threadBudget_);
+
+    int ret = avcodec_open2(ctx, codec, nullptr);
+    if (ret < 0) {
+        avcodec_free_context(&ctx);
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        error = std::string("Failed to open codec: ") + errBuf;
+        return nullptr;
+    }
+
+    return ctx;
+}
+
+void VideoSegmentedEncoder::WorkerThread() {
+    AVCodecContext* ctx = nullptr;
+    FrameScaler scaler;
+    AVPacket* packet = av_packet_alloc();
+    Segment* segment = nullptr;
+
+    while (segmentQueue_.pop(segment)) {
+        SegmentOutput* out = new SegmentOutput();
+        std::string error;
+
+        if (!ctx) {
+            ctx = OpenContext(error);
+        }
+        if (ctx) {
+            EncodeSegment(ctx, scaler, packet, *segment, *out, error);
+        }
+        if (!error.empty()) {
+            ReportError(error);
+        }
+
+        int64_t index = segment->index;
+        pendingFrames_ -= static_cast<int64_t>(segment->frames.size());
+        FreeSegment(segment);
+        segment = nullptr;
+
+        // Queued ahead of this segment's JobFinished, so a producer waiting
+        // for room is woken before the event loop can go idle
+        tsfnJobDone_.NonBlockingCall([this](Napi::Env, Napi::Function) {
+            if (!onDequeue_.IsEmpty()) {
+                onDequeue_.Call({});
+            }
+        });
+
+        // A failed segment still completes, so later ones aren't held back
+        CompleteSegment(index, out);
+    }
+
+    if (ctx) avcodec_free_context(&ctx);
+    av_packet_free(&packet);
+}
+
+bool VideoSegmentedEncoder::EncodeSegment(AVCodecContext*& ctx, FrameScaler& scaler, AVPacket* packet,
+                                          Segment& segment, SegmentOutput& out, std::string& error) {
+    auto drain = [&]() {
+        while (avcodec_receive_packet(ctx, packet) >= 0) {
+            SegmentChunk chunk;
+            chunk.data.assign(packet->data, packet->data + packet->size);
+            chunk.isKeyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+            chunk.pts = packet->pts;
+            chunk.duration = packet->duration;
+            out.chunks.push_back(std::move(chunk));
+            av_packet_unref(packet);
+        }
+    };
+
+    bool ok = true;
+    for (size_t i = 0; i < segment.frames.size() && ok; i++) {
+        AVFrame* frame = segment.frames[i];
+        AVFrame* converted = nullptr;
+
+        if (frame->format != ctx->pix_fmt || frame->width != ctx->width || frame->height != ctx->height) {
+            converted = av_frame_alloc();
+            if (!converted) {
+                error = "Failed to allocate frame";
+                ok = false;
+                break;
+            }
+            converted->format = ctx->pix_fmt;
+            converted->width = ctx->width;
+            converted->height = ctx->height;
+            int ret = scaler.scale(frame, converted);
+            if (ret < 0) {
+                av_frame_free(&converted);
+                char errBuf[256];
+                av_strerror(ret, errBuf, sizeof(errBuf));
+                error = std::string("Scale error: ") + errBuf;
+                ok = false;
+                break;
+            }
+        }
+
+        AVFrame* input = converted ? converted : frame;
+        if (i == 0) {
+            // Each segment is an independently decodable closed GOP
+            input->pict_type = AV_PICTURE_TYPE_I;
+        }
+
+        int ret = avcodec_send_frame(ctx, input);
+        if (converted) av_frame_free(&converted);
+        if (ret < 0) {
+            char errBuf[256];
+            av_strerror(ret, errBuf, sizeof(errBuf));
+            error = std::string("Encode error: ") + errBuf;
+            ok = false;
+            break;
+        }
+        drain();
+    }
+
+    // Drain the segment's tail so nothing straddles into the next one
+    avcodec_send_frame(ctx, nullptr);
+    drain();
+
+    if (ctx->extradata && ctx->extradata_size > 0) {
+        out.extradata.assign(ctx->extradata, ctx->extradata + ctx->extradata_size);
+    }
+
+    if (ok && (ctx->codec->capabilities & AV_CODEC_CAP_ENCODER_FLUSH)) {
+        // Back out of EOF and reuse the context for the next segment
+        avcodec_flush_buffers(ctx);
+    } else {
+        // Encoders that can't leave EOF (or failed mid-segment) reopen
+        avcodec_free_context(&ctx);
+    }
+    return ok;
+}
+
+void VideoSegmentedEncoder::CompleteSegment(int64_t index, SegmentOutput* out) {
+    std::lock_guard<std::mutex> lock(emitMutex_);
+    completed_[index] = out;
+
+    // Emit every segment that is now contiguous with what's been emitted
+    auto it = completed_.find(nextToEmit_);
+    while (it != completed_.end()) {
+        SegmentOutput* ready = it->second;
+        completed_.erase(it);
+
+        napi_status status = tsfnOutput_.BlockingCall(ready,
+            [](Napi::Env env, Napi::Function fn, SegmentOutput* s) {
+                bool sentExtradata = false;
+                for (SegmentChunk& c : s->chunks) {
+                    Napi::Value extradataValue = env.Undefined();
+                    if (c.isKeyframe && !sentExtradata && !s->extradata.empty()) {
+                        extradataValue = Napi::Buffer<uint8_t>::Copy(env, s->extradata.data(), s->extradata.size());
+                        sentExtradata = true;
+                    }
+
+                    fn.Call({
+                        Napi::Buffer<uint8_t>::Copy(env, c.data.data(), c.data.size()),
+                        Napi::Boolean::New(env, c.isKeyframe),
+                        Napi::Number::New(env, static_cast<double>(c.pts)),
+                        Napi::Number::New(env, static_cast<double>(c.duration)),
+                        extradataValue
+                    });
+                }
+                delete s;
+            });
+        if (status != napi_ok) {
+            delete ready;
+        }
+
+        tsfnJobDone_.NonBlockingCall([this](Napi::Env env, Napi::Function) {
+            JobFinished(env);
+        });
+
+        nextToEmit_++;
+        it = completed_.find(nextToEmit_);
+    }
+
+    // Resolve flushes whose segments are all out
+    for (auto f = flushes_.begin(); f != flushes_.end();) {
+        if (f->target > nextToEmit_) {
+            ++f;
+            continue;
+        }
+        f->callback.NonBlockingCall([](Napi::Env env, Napi::Function fn) {
+            fn.Call({ env.Null() });
+        });
+        f->callback.Release();
+        tsfnJobDone_.NonBlockingCall([this](Napi::Env env, Napi::Function) {
+            JobFinished(env);
+        });
+        f = flushes_.erase(f);
+    }
+}
+
+void VideoSegmentedEncoder::ReportError(const std::string& message) {
+    auto* msg = new std::string(message);
+    napi_status status = tsfnError_.NonBlockingCall(msg,
+        [](Napi::Env env, Napi::Function fn, std::string* m) {
+            fn.Call({ Napi::String::New(env, *m) });
+            delete m;
+        });
+    if (status != napi_ok) {
+        delete msg;
+    }
+}
+
+void VideoSegmentedEncoder::Encode(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!configured_) {
+        Napi::Error::New(env, "Encoder not configured").ThrowAsJavaScriptException();
+        return;
+    }
+
+    VideoFrameNative* frameWrapper = Napi::ObjectWrap<VideoFrameNative>::Unwrap(info[0].As<Napi::Object>());
+    AVFrame* srcFrame = frameWrapper->GetFrame();
+    if (!srcFrame) {
+        Napi::Error::New(env, "Invalid frame").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // A reference, not a copy; the segment holds it until encoded
+    AVFrame* frame = av_frame_clone(srcFrame);
+    if (!frame) {
+        Napi::Error::New(env, "Failed to clone frame").ThrowAsJavaScriptException();
+        return;
+    }
+    frame->pts = info[1].As<Napi::Number>().Int64Value();
+    frame->pict_type = (info.Length() > 2 && info[2].IsBoolean() && info[2].As<Napi::Boolean>().Value())
+        ? AV_PICTURE_TYPE_I
+        : AV_PICTURE_TYPE_NONE;
+
+    if (!current_) {
+        current_ = new Segment();
+        current_->index = segmentsDispatched_;
+        current_->frames.reserve(segmentLength_);
+    }
+    current_->frames.push_back(frame);
+    pendingFrames_++;
+
+    if (static_cast<int>(current_->frames.size()) >= segmentLength_) {
+        DispatchSegment(env);
+    }
+}
+
+void VideoSegmentedEncoder::FreeSegment(Segment* segment) {
+    if (!segment) {
+        return;
+    }
+    for (AVFrame*& frame : segment->frames) {
+        av_frame_free(&frame);
+    }
+    delete segment;
+}
+
+// Hand the segment being filled to the workers (JS thread only)
+void VideoSegmentedEncoder::DispatchSegment(Napi::Env env) {
+    if (!current_) {
+        return;
+    }
+
+    Segment* segment = current_;
+    current_ = nullptr;
+    if (!segmentQueue_.push(segment)) {
+        pendingFrames_ -= static_cast<int64_t>(segment->frames.size());
+        FreeSegment(segment);
+        return;
+    }
+    segmentsDispatched_++;
+    JobSubmitted(env);
+}
+
+// Cuts the current segment short and resolves once everything submitted so
+// far has been emitted
+Napi::Value VideoSegmentedEncoder::Flush(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Function callback = info[0].As<Napi::Function>();
+
+    if (!configured_) {
+        callback.Call({ env.Null() });
+        return env.Undefined();
+    }
+
+    DispatchSegment(env);
+
+    {
+        std::lock_guard<std::mutex> lock(emitMutex_);
+        if (nextToEmit_ < segmentsDispatched_) {
+            PendingFlush flush;
+            flush.target = segmentsDispatched_;
+            flush.callback = Napi::ThreadSafeFunction::New(
+                env,
+                callback,
+                "VideoSegmentedEncoderFlush",
+                0,
+                1
+            );
+            flushes_.push_back(std::move(flush));
+            JobSubmitted(env);
+            return env.Undefined();
+        }
+    }
+
+    callback.Call({ env.Null() });
+    return env.Undefined();
+}
+
+Napi::Value VideoSegmentedEncoder::GetPendingFrames(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), static_cast<double>(pendingFrames_.load()));
+}
+
+// Stop and join every worker, dropping queued segments and unresolved
+// flushes. Safe to call when not configured.
+void VideoSegmentedEncoder::StopWorkers() {
+    configured_ = false;
+
+    segmentQueue_.close();
+    segmentQueue_.drain(FreeSegment);
+    for (std::thread& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    segmentQueue_.drain(FreeSegment);
+    segmentQueue_.reopen();
+
+    FreeSegment(current_);
+    current_ = nullptr;
+
+    std::lock_guard<std::mutex> lock(emitMutex_);
+    for (auto& entry : completed_) {
+        delete entry.second;
+    }
+    completed_.clear();
+    for (PendingFlush& flush : flushes_) {
+        // Dropped by close()/reset(); never resolves
+        if (!nwc_env_teardown.load()) {
+            flush.callback.Release();
+        }
+    }
+    flushes_.clear();
+
+    nextToEmit_ = 0;
+    segmentsDispatched_ = 0;
+    pendingFrames_ = 0;
+}
+
+void VideoSegmentedEncoder::Reset(const Napi::CallbackInfo& info) {
+    StopWorkers();
+
+    if (activeJobs_ > 0) {
+        activeJobs_ = 0;
+        tsfnOutput_.Unref(info.Env());
+        Unref();  // balance the in-flight pin; queued JobFinished sees 0 and skips
+    }
+}
+
+void VideoSegmentedEncoder::Close(const Napi::CallbackInfo& info) {
+    StopWorkers();
+
+    // Workers are joined, so no more calls are queued; release now and null
+    // the handles so the destructor doesn't touch finalized functions
+    if (tsfnOutput_) { tsfnOutput_.Release(); tsfnOutput_ = Napi::ThreadSafeFunction(); }
+    if (tsfnError_) { tsfnError_.Release(); tsfnError_ = Napi::ThreadSafeFunction(); }
+    if (tsfnJobDone_) { tsfnJobDone_.Release(); tsfnJobDone_ = Napi::ThreadSafeFunction(); }
+    if (activeJobs_ > 0) {
+        activeJobs_ = 0;
+        Unref();
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef SEGMENTED_ENCODER_H
+#define SEGMENTED_ENCODER_H
+
+#include <napi.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "scaler.h"
+#include "work_queue.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+/**
+ * GOP-parallel offline encoder.
+ *
+ * The input is cut every segmentLength frames; each segment starts with a
+ * forced keyframe and is encoded as a closed GOP by one of K worker
+ * threads, each with its own codec context. Finished segments are emitted
+ * strictly in input order, so the output is one ordinary chunk stream.
+ * Throughput scales with K instead of with one encoder's internal
+ * threading, at the cost of holding raw frames until their segment is
+ * encoded. Encode() never blocks, so the queue is only bounded by callers
+ * that wait on the dequeue callback (fired as each segment's frames are
+ * released) while getPendingFrames() is at K segments.
+ *
+ * Offline only: output for a segment starts once the whole segment has
+ * been submitted.
+ */
+class VideoSegmentedEncoder : public Napi::ObjectWrap<VideoSegmentedEncoder> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    VideoSegmentedEncoder(const Napi::CallbackInfo& info);
+    ~VideoSegmentedEncoder();
+
+private:
+    static Napi::FunctionReference constructor;
+
+    struct Segment {
+        int64_t index;
+        std::vector<AVFrame*> frames;
+    };
+
+    struct SegmentChunk {
+        std::vector<uint8_t> data;
+        bool isKeyframe;
+        int64_t pts;
+        int64_t duration;
+    };
+
+    struct SegmentOutput {
+        std::vector<SegmentChunk> chunks;
+        std::vector<uint8_t> extradata;  // Sent with the segment's first keyframe
+    };
+
+    struct PendingFlush {
+        int64_t target;  // Resolves once this many segments have been emitted
+        Napi::ThreadSafeFunction callback;
+    };
+
+    // JavaScript-facing methods
+    void Configure(const Napi::CallbackInfo& info);
+    void Encode(const Napi::CallbackInfo& info);
+    Napi::Value Flush(const Napi::CallbackInfo& info);
+    void Reset(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+    Napi::Value GetPendingFrames(const Napi::CallbackInfo& info);
+
+    void DispatchSegment(Napi::Env env);
+    static void FreeSegment(Segment* segment);
+    void StopWorkers();
+
+    // Worker threads
+    AVCodecContext* OpenContext(std::string& error);
+    void WorkerThread();
+    bool EncodeSegment(AVCodecContext*& ctx, FrameScaler& scaler, AVPacket* packet,
+                       Segment& segment, SegmentOutput& out, std::string& error);
+    void CompleteSegment(int64_t index, SegmentOutput* out);
+    void ReportError(const std::string& message);
+
+    Napi::ThreadSafeFunction tsfnOutput_;
+    Napi::ThreadSafeFunction tsfnError_;
+    Napi::ThreadSafeFunction tsfnJobDone_;
+    Napi::FunctionReference onDequeue_;  // Optional; called on the JS thread
+    int activeJobs_ = 0;
+    void JobSubmitted(Napi::Env env);
+    void JobFinished(Napi::Env env);
+    std::atomic<bool> configured_{false};
+
+    WorkQueue<Segment*> segmentQueue_;
+    std::vector<std::thread> workers_;
+    Segment* current_ = nullptr;        // Being filled (JS thread only)
+    int64_t segmentsDispatched_ = 0;    // JS thread only
+    std::atomic<int64_t> pendingFrames_{0};
+
+    // Ordered emission: workers park finished segments here until every
+    // earlier segment has been emitted
+    std::mutex emitMutex_;
+    std::map<int64_t, SegmentOutput*> completed_;
+    int64_t nextToEmit_ = 0;
+    std::vector<PendingFlush> flushes_;
+
+    // Configuration shared by all contexts
+    std::string codecName_;
+    int width_;
+    int height_;
+    int64_t bitrate_;
+    std::string bitrateMode_;
+    int framerate_;
+    int profile_;
+    AVPixelFormat inputFormat_;
+    int segmentLength_;
+    int concurrency_;
+    int threadBudget_;
+};
+
+#endif // SEGMENTED_ENCODER_H
@@ -0,0 +1,170 @@
+#include "sprite_sheet.h"
+#include "frame.h"
+
+Napi::FunctionReference SpriteSheet::constructor;
+
+namespace {
+
+// Fill a frame with black in its own pixel format
+void fillBlack(AVFrame* frame) {
+    ptrdiff_t linesizes[4];
+    for (int i = 0; i < 4; i++) {
+        linesizes[i] = frame->linesize[i];
+    }
+    av_image_fill_black(frame->data, linesizes, static_cast<AVPixelFormat>(frame->format),
+                        AVCOL_RANGE_MPEG, frame->width, frame->height);
+}
+
+} // namespace
+
+Napi::Object SpriteSheet::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "SpriteSheet", {
+        InstanceMethod("draw", &SpriteSheet::Draw),
+        InstanceMethod("toFrame", &SpriteSheet::ToFrame),
+        InstanceMethod("clear", &SpriteSheet::Clear),
+        InstanceMethod("close", &SpriteSheet::Close),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("SpriteSheet", func);
+    return exports;
+}
+
+// new SpriteSheet({ columns, rows, tileWidth, tileHeight, format })
+SpriteSheet::SpriteSheet(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SpriteSheet>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Config must be an object").ThrowAsJavaScriptException();
+        return;
+    }
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    columns_ = config.Get("columns").As<Napi::Number>().Int32Value();
+    rows_ = config.Get("rows").As<Napi::Number>().Int32Value();
+    tileWidth_ = config.Get("tileWidth").As<Napi::Number>().Int32Value();
+    tileHeight_ = config.Get("tileHeight").As<Napi::Number>().Int32Value();
+    AVPixelFormat format = StringToPixelFormat(config.Get("format").As<Napi::String>().Utf8Value());
+
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    if (!desc || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+        Napi::TypeError::New(env, "Unsupported sprite sheet format").ThrowAsJavaScriptException();
+        return;
+    }
+    // Tile origins must land on whole chroma samples
+    if (columns_ <= 0 || rows_ <= 0 || tileWidth_ <= 0 || tileHeight_ <= 0 ||
+        tileWidth_ % (1 << desc->log2_chroma_w) || tileHeight_ % (1 << desc->log2_chroma_h)) {
+        Napi::TypeError::New(env, "Invalid sprite sheet geometry").ThrowAsJavaScriptException();
+        return;
+    }
+
+    sheet_ = av_frame_alloc();
+    sheet_->format = format;
+    sheet_->width = columns_ * tileWidth_;
+    sheet_->height = rows_ * tileHeight_;
+    if (av_frame_get_buffer(sheet_, 0) < 0) {
+        av_frame_free(&sheet_);
+        Napi::Error::New(env, "Failed to allocate sprite sheet").ThrowAsJavaScriptException();
+        return;
+    }
+    fillBlack(sheet_);
+}
+
+SpriteSheet::~SpriteSheet() {
+    if (sheet_) {
+        av_frame_free(&sheet_);
+    }
+}
+
+// draw(nativeFrame, tileIndex): scale the frame into the tile, row-major
+void SpriteSheet::Draw(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!sheet_) {
+        Napi::Error::New(env, "SpriteSheet is closed").ThrowAsJavaScriptException();
+        return;
+    }
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "draw(frame, tileIndex) expects a frame and a number").ThrowAsJavaScriptException();
+        return;
+    }
+
+    VideoFrameNative* source = Napi::ObjectWrap<VideoFrameNative>::Unwrap(info[0].As<Napi::Object>());
+    AVFrame* src = source ? source->GetFrame() : nullptr;
+    if (!src) {
+        Napi::Error::New(env, "Frame is closed").ThrowAsJavaScriptException();
+        return;
+    }
+
+    int index = info[1].As<Napi::Number>().Int32Value();
+    if (index < 0 || index >= columns_ * rows_) {
+        Napi::RangeError::New(env, "Tile index out of range").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // Copy-on-write if a toFrame() snapshot still shares the buffer
+    if (av_frame_make_writable(sheet_) < 0) {
+        Napi::Error::New(env, "Failed to allocate sprite sheet").ThrowAsJavaScriptException();
+        return;
+    }
+
+    // A tile-sized view into the sheet; the scaler writes through it in place
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(sheet_->format));
+    int x = (index % columns_) * tileWidth_;
+    int y = (index / columns_) * tileHeight_;
+
+    AVFrame* tile = av_frame_alloc();
+    tile->format = sheet_->format;
+    tile->width = tileWidth_;
+    tile->height = tileHeight_;
+    tile->buf[0] = av_buffer_ref(sheet_->buf[0]);
+    for (int p = 0; p < 4 && sheet_->data[p]; p++) {
+        bool chroma = (p == 1 || p == 2) && !(desc->flags & AV_PIX_FMT_FLAG_RGB);
+        int planeY = chroma ? y >> desc->log2_chroma_h : y;
+        tile->data[p] = sheet_->data[p] + planeY * sheet_->linesize[p] +
+                        av_image_get_linesize(static_cast<AVPixelFormat>(sheet_->format), x, p);
+        tile->linesize[p] = sheet_->linesize[p];
+    }
+
+    int ret = tile->buf[0] ? scaler_.scale(src, tile) : AVERROR(ENOMEM);
+    av_frame_free(&tile);
+
+    if (ret < 0) {
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        Napi::Error::New(env, std::string("Failed to draw tile: ") + errBuf).ThrowAsJavaScriptException();
+    }
+}
+
+// Snapshot of the sheet as a VideoFrameNative sharing its buffer
+Napi::Value SpriteSheet::ToFrame(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!sheet_) {
+        Napi::Error::New(env, "SpriteSheet is closed").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    AVFrame* frame = av_frame_clone(sheet_);
+    if (!frame) {
+        Napi::Error::New(env, "Failed to reference sprite sheet").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return VideoFrameNative::NewInstance(env, frame);
+}
+
+void SpriteSheet::Clear(const Napi::CallbackInfo& info) {
+    if (sheet_ && av_frame_make_writable(sheet_) >= 0) {
+        fillBlack(sheet_);
+    }
+}
+
+void SpriteSheet::Close(const Napi::CallbackInfo& info) {
+    if (sheet_) {
+        av_frame_free(&sheet_);
+    }
+    scaler_.reset();
+}
@@ -0,0 +1,39 @@
+#ifndef SPRITE_SHEET_H
+#define SPRITE_SHEET_H
+
+#include <napi.h>
+#include "scaler.h"
+
+/**
+ * SpriteSheet - Thumbnail tiles scaled straight into one frame
+ *
+ * Holds a columns x rows grid of tileWidth x tileHeight tiles as a single
+ * AVFrame. draw() scales a frame directly into a tile's region of the
+ * sheet (no intermediate thumbnail frame), reusing one swscale context as
+ * long as the source geometry doesn't change. toFrame() hands out a
+ * reference; the next draw() copies the sheet first if it's still shared.
+ */
+class SpriteSheet : public Napi::ObjectWrap<SpriteSheet> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    SpriteSheet(const Napi::CallbackInfo& info);
+    ~SpriteSheet();
+
+private:
+    static Napi::FunctionReference constructor;
+
+    // JavaScript-facing methods
+    void Draw(const Napi::CallbackInfo& info);
+    Napi::Value ToFrame(const Napi::CallbackInfo& info);
+    void Clear(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    AVFrame* sheet_ = nullptr;
+    FrameScaler scaler_;
+    int columns_ = 0;
+    int rows_ = 0;
+    int tileWidth_ = 0;
+    int tileHeight_ = 0;
+};
+
+#endif // SPRITE_SHEET_H
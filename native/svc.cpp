@@ -1,4 +1,5 @@
 #include "svc.h"
+#include <algorithm>
 #include <regex>
 
 ScalabilityConfig parseScalabilityMode(const std::string& mode) {
@@ -32,9 +33,12 @@ bool isScalabilityModeSupported(const std::string& mode) {
 
     ScalabilityConfig config = parseScalabilityMode(mode);
 
-    // Currently only support temporal-only SVC (L1Tx)
-    // Spatial SVC and simulcast require more complex configuration
-    if (config.spatialLayers > 1 || config.isSimulcast) {
+    // Temporal-only SVC (L1Tx), or simulcast (SxTx) where each stream is
+    // its own codec context. Spatial SVC needs inter-layer prediction.
+    if (config.spatialLayers > 1 && !config.isSimulcast) {
+        return false;
+    }
+    if (config.spatialLayers < 1 || config.spatialLayers > 3) {
         return false;
     }
 
@@ -45,3 +49,193 @@ bool isScalabilityModeSupported(const std::string& mode) {
 
     return true;
 }
+
+std::string unsupportedScalabilityModeMessage(const std::string& mode) {
+    ScalabilityConfig config = parseScalabilityMode(mode);
+    if (config.spatialLayers > 1 && !config.isSimulcast) {
+        // FFmpeg's libvpx/libaom wrappers expose temporal layering only
+        // (ts-parameters); there is no ss_* or AV1 SVC-params passthrough
+        return "Unsupported scalabilityMode: " + mode +
+            ". Spatial SVC is not available through FFmpeg's libvpx/libaom encoders; use S" +
+            std::to_string(config.spatialLayers) + "T" + std::to_string(config.temporalLayers) +
+            " (simulcast) instead.";
+    }
+    return "Unsupported scalabilityMode: " + mode + ". Supported: L1T1-L1T3, S1T1-S3T3.";
+}
+
+std::vector<int64_t> temporalLayerBitrates(int temporalLayers, int64_t totalBitrate) {
+    switch (temporalLayers) {
+        case 2:
+            return { static_cast<int64_t>(totalBitrate * 0.6), totalBitrate };
+        case 3:
+            return { static_cast<int64_t>(totalBitrate * 0.25),
+                     static_cast<int64_t>(totalBitrate * 0.5),
+                     totalBitrate };
+        default:
+            return { totalBitrate };
+    }
+}
+
+int temporalLayerId(int temporalLayers, int64_t frameIndex) {
+    static const int kT2[] = { 0, 1 };
+    static const int kT3[] = { 0, 2, 1, 2 };
+    switch (temporalLayers) {
+        case 2: return kT2[frameIndex % 2];
+        case 3: return kT3[frameIndex % 4];
+        default: return 0;
+    }
+}
+
+namespace {
+
+// MSB-first bit reader over a caller-owned buffer; no allocation
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data_(data), bits_(size * 8) {}
+
+    bool read(int count, uint32_t& out) {
+        if (pos_ + count > bits_) return false;
+        out = 0;
+        for (int i = 0; i < count; i++, pos_++) {
+            out = (out << 1) | ((data_[pos_ >> 3] >> (7 - (pos_ & 7))) & 1);
+        }
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t bits_;
+    size_t pos_ = 0;
+};
+
+// refresh_frame_flags of one VP9 frame (spec 6.2 uncompressed_header), -1
+// if it can't be parsed
+int vp9RefreshFlags(const uint8_t* data, size_t size) {
+    BitReader br(data, size);
+    uint32_t v, profileLow, profileHigh;
+
+    if (!br.read(2, v) || v != 2) return -1;  // frame_marker
+    if (!br.read(1, profileLow) || !br.read(1, profileHigh)) return -1;
+    uint32_t profile = (profileHigh << 1) | profileLow;
+    if (profile == 3 && !br.read(1, v)) return -1;
+
+    uint32_t showExisting, frameType, showFrame, errorResilient;
+    if (!br.read(1, showExisting)) return -1;
+    if (showExisting) return 0;  // Re-shows a buffer, refreshes nothing
+    if (!br.read(1, frameType) || !br.read(1, showFrame) || !br.read(1, errorResilient)) return -1;
+    if (frameType == 0) return 0xFF;  // KEY_FRAME refreshes every slot
+
+    uint32_t intraOnly = 0;
+    if (!showFrame && !br.read(1, intraOnly)) return -1;
+    if (!errorResilient && !br.read(2, v)) return -1;  // reset_frame_context
+
+    if (intraOnly) {
+        if (!br.read(24, v) || v != 0x498342) return -1;  // frame_sync_code
+        if (profile > 0) {
+            // color_config
+            if (profile >= 2 && !br.read(1, v)) return -1;
+            uint32_t colorSpace;
+            if (!br.read(3, colorSpace)) return -1;
+            if (colorSpace != 7) {  // not CS_RGB
+                if (!br.read(1, v)) return -1;
+                if ((profile == 1 || profile == 3) && !br.read(3, v)) return -1;
+            } else if ((profile == 1 || profile == 3) && !br.read(1, v)) {
+                return -1;
+            }
+        }
+    }
+
+    uint32_t refresh;
+    if (!br.read(8, refresh)) return -1;
+    return static_cast<int>(refresh);
+}
+
+int vp9FrameLayer(const uint8_t* data, size_t size, int temporalLayers) {
+    int refresh = vp9RefreshFlags(data, size);
+    if (refresh < 0) return -1;
+    if (temporalLayers <= 1 || (refresh & 0x01)) return 0;
+    if (refresh == 0) return temporalLayers - 1;
+    return 1;
+}
+
+} // namespace
+
+int vp9TemporalLayerId(const uint8_t* data, size_t size, int temporalLayers) {
+    if (!data || size == 0) return -1;
+
+    // Superframe index (Annex B): trailing marker 110mmfff, repeated at the
+    // start of the index
+    uint8_t marker = data[size - 1];
+    if ((marker & 0xe0) == 0xc0) {
+        size_t frames = (marker & 0x7) + 1;
+        size_t mag = ((marker >> 3) & 0x3) + 1;
+        size_t indexSize = 2 + mag * frames;
+        if (size >= indexSize && data[size - indexSize] == marker) {
+            const uint8_t* sizes = data + size - indexSize + 1;
+            size_t payload = size - indexSize;
+            size_t offset = 0;
+            int lowest = -1;
+            for (size_t f = 0; f < frames; f++) {
+                size_t frameSize = 0;
+                for (size_t b = 0; b < mag; b++) {
+                    frameSize |= static_cast<size_t>(sizes[f * mag + b]) << (8 * b);
+                }
+                if (frameSize == 0 || frameSize > payload - offset) return -1;
+                int layer = vp9FrameLayer(data + offset, frameSize, temporalLayers);
+                if (layer < 0) return -1;
+                lowest = lowest < 0 ? layer : std::min(lowest, layer);
+                offset += frameSize;
+            }
+            return lowest;
+        }
+    }
+
+    return vp9FrameLayer(data, size, temporalLayers);
+}
+
+int av1TemporalLayerId(const uint8_t* data, size_t size) {
+    if (!data) return -1;
+
+    // OBU types carrying frame data (AV1 spec 6.2.2)
+    const int kObuFrameHeader = 3;
+    const int kObuTileGroup = 4;
+    const int kObuFrame = 6;
+
+    size_t pos = 0;
+    int lowest = -1;
+    while (pos < size) {
+        uint8_t header = data[pos++];
+        if (header & 0x80) return -1;  // obu_forbidden_bit
+
+        int type = (header >> 3) & 0xF;
+        bool hasExtension = (header & 0x04) != 0;
+        bool hasSize = (header & 0x02) != 0;
+
+        int temporalId = 0;
+        if (hasExtension) {
+            if (pos >= size) return -1;
+            temporalId = data[pos++] >> 5;
+        }
+
+        size_t obuSize = size - pos;
+        if (hasSize) {
+            // leb128
+            obuSize = 0;
+            int i = 0;
+            for (;; i++) {
+                if (i == 8 || pos >= size) return -1;
+                uint8_t byte = data[pos++];
+                obuSize |= static_cast<size_t>(byte & 0x7f) << (7 * i);
+                if (!(byte & 0x80)) break;
+            }
+        }
+        if (obuSize > size - pos) return -1;
+
+        if (hasExtension && (type == kObuFrameHeader || type == kObuTileGroup || type == kObuFrame)) {
+            lowest = lowest < 0 ? temporalId : std::min(lowest, temporalId);
+        }
+        pos += obuSize;
+    }
+
+    return lowest < 0 ? 0 : lowest;
+}
@@ -1,7 +1,10 @@
 #ifndef SVC_H
 #define SVC_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 /**
  * Scalability configuration parsed from WebCodecs scalabilityMode strings.
@@ -32,8 +35,44 @@ ScalabilityConfig parseScalabilityMode(const std::string& mode);
 
 /**
  * Check if a scalability mode is supported.
- * Currently supports L1T1, L1T2, L1T3 for temporal-only SVC.
+ * Supports L1T1-L1T3 (temporal-only SVC) and S1T1-S3T3 (simulcast, which
+ * VideoEncoder runs as one VideoLadderEncoder rendition per stream).
  */
 bool isScalabilityModeSupported(const std::string& mode);
 
+/**
+ * Error text for a mode isScalabilityModeSupported() rejects, naming the
+ * nearest supported alternative.
+ */
+std::string unsupportedScalabilityModeMessage(const std::string& mode);
+
+/**
+ * Cumulative target bitrate for each temporal layer, base first; the last
+ * entry is totalBitrate. L1T2 gives the base layer 60%, L1T3 25% / 50%.
+ */
+std::vector<int64_t> temporalLayerBitrates(int temporalLayers, int64_t totalBitrate);
+
+/**
+ * Temporal layer of the frameIndex-th frame under the fixed patterns
+ * (T2: 0,1  T3: 0,2,1,2) that libvpx is configured with.
+ */
+int temporalLayerId(int temporalLayers, int64_t frameIndex);
+
+/**
+ * Temporal layer of an encoded VP9 frame or superframe, read from the
+ * uncompressed header(s) without decoding. VP9 carries no temporal id, so
+ * it is inferred from refresh_frame_flags the way libvpx's layer patterns
+ * assign them: refreshes the LAST slot (or keyframe) -> 0, refreshes
+ * nothing -> temporalLayers - 1, anything else -> 1. A superframe reports
+ * its lowest layer. -1 if the data isn't a parseable VP9 frame.
+ */
+int vp9TemporalLayerId(const uint8_t* data, size_t size, int temporalLayers);
+
+/**
+ * Temporal layer of an AV1 temporal unit from its OBU extension headers
+ * (lowest temporal_id of any frame/frame-header/tile-group OBU). Streams
+ * without extensions aren't layered and report 0. -1 on malformed OBUs.
+ */
+int av1TemporalLayerId(const uint8_t* data, size_t size);
+
 #endif // SVC_H
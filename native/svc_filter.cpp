@@ -0,0 +1,147 @@
+#include "svc_filter.h"
+
+Napi::FunctionReference SvcLayerFilter::constructor;
+
+Napi::Object SvcLayerFilter::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "SvcLayerFilter", {
+        InstanceAccessor("maxTemporalLayer", &SvcLayerFilter::GetMaxTemporalLayer,
+                         &SvcLayerFilter::SetMaxTemporalLayer),
+        InstanceMethod("temporalLayerOf", &SvcLayerFilter::TemporalLayerOf),
+        InstanceMethod("filter", &SvcLayerFilter::Filter),
+        InstanceMethod("filterBatch", &SvcLayerFilter::FilterBatch),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("SvcLayerFilter", func);
+    return exports;
+}
+
+// new SvcLayerFilter(codec: 'vp9' | 'av1', scalabilityMode: string)
+SvcLayerFilter::SvcLayerFilter(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SvcLayerFilter>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        Napi::TypeError::New(env, "Expected (codec, scalabilityMode)").ThrowAsJavaScriptException();
+        return;
+    }
+
+    std::string codec = info[0].As<Napi::String>().Utf8Value();
+    if (codec == "vp9") {
+        bitstream_ = Bitstream::VP9;
+    } else if (codec == "av1") {
+        bitstream_ = Bitstream::AV1;
+    } else {
+        Napi::Error::New(env, "SvcLayerFilter supports vp9 and av1, got: " + codec)
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    std::string mode = info[1].As<Napi::String>().Utf8Value();
+    if (!isScalabilityModeSupported(mode)) {
+        Napi::Error::New(env, unsupportedScalabilityModeMessage(mode)).ThrowAsJavaScriptException();
+        return;
+    }
+    scalability_ = parseScalabilityMode(mode);
+    maxTemporalLayer_ = scalability_.temporalLayers - 1;
+}
+
+Napi::Value SvcLayerFilter::GetMaxTemporalLayer(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), maxTemporalLayer_);
+}
+
+void SvcLayerFilter::SetMaxTemporalLayer(const Napi::CallbackInfo& info, const Napi::Value& value) {
+    if (!value.IsNumber()) {
+        Napi::TypeError::New(info.Env(), "maxTemporalLayer must be a number").ThrowAsJavaScriptException();
+        return;
+    }
+    int layer = value.As<Napi::Number>().Int32Value();
+    if (layer < 0 || layer >= scalability_.temporalLayers) {
+        Napi::RangeError::New(info.Env(), "maxTemporalLayer must be in [0, " +
+            std::to_string(scalability_.temporalLayers - 1) + "]").ThrowAsJavaScriptException();
+        return;
+    }
+    maxTemporalLayer_ = layer;
+}
+
+int SvcLayerFilter::LayerOf(const uint8_t* data, size_t size) const {
+    if (bitstream_ == Bitstream::VP9) {
+        return vp9TemporalLayerId(data, size, scalability_.temporalLayers);
+    }
+    return av1TemporalLayerId(data, size);
+}
+
+// Only Uint8Array (or Buffer) is read as bytes; a wider typed array would be
+// parsed with the wrong length
+static bool IsByteArray(const Napi::Value& value) {
+    return value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array;
+}
+
+// temporalLayerOf(data: Uint8Array): number, -1 if unparseable
+Napi::Value SvcLayerFilter::TemporalLayerOf(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !IsByteArray(info[0])) {
+        Napi::TypeError::New(env, "Expected Uint8Array").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Uint8Array data = info[0].As<Napi::Uint8Array>();
+    return Napi::Number::New(env, LayerOf(data.Data(), data.ByteLength()));
+}
+
+// filter(data: Uint8Array): boolean. Unparseable chunks are forwarded so a
+// header the parser doesn't understand never stalls the stream.
+Napi::Value SvcLayerFilter::Filter(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !IsByteArray(info[0])) {
+        Napi::TypeError::New(env, "Expected Uint8Array").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Uint8Array data = info[0].As<Napi::Uint8Array>();
+    int layer = LayerOf(data.Data(), data.ByteLength());
+    return Napi::Boolean::New(env, layer <= maxTemporalLayer_);
+}
+
+// filterBatch(chunks: Uint8Array[], layers: Int8Array): number
+// Writes each chunk's temporal layer into layers[i] (-1 if unparseable) and
+// returns how many to forward; chunk i is forwarded when
+// layers[i] <= maxTemporalLayer. One call amortizes the N-API crossing
+// over a whole receive batch.
+Napi::Value SvcLayerFilter::FilterBatch(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsTypedArray() ||
+        info[1].As<Napi::TypedArray>().TypedArrayType() != napi_int8_array) {
+        Napi::TypeError::New(env, "Expected (Uint8Array[], Int8Array)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Array chunks = info[0].As<Napi::Array>();
+    Napi::Int8Array layers = info[1].As<Napi::Int8Array>();
+    uint32_t count = chunks.Length();
+    if (layers.ElementLength() < count) {
+        Napi::RangeError::New(env, "layers is shorter than chunks").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    int8_t* out = layers.Data();
+    uint32_t forwarded = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        Napi::Value chunk = chunks.Get(i);
+        if (!IsByteArray(chunk)) {
+            Napi::TypeError::New(env, "chunks must be Uint8Arrays").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        Napi::Uint8Array data = chunk.As<Napi::Uint8Array>();
+        int layer = LayerOf(data.Data(), data.ByteLength());
+        out[i] = static_cast<int8_t>(layer);
+        if (layer <= maxTemporalLayer_) forwarded++;
+    }
+
+    return Napi::Number::New(env, forwarded);
+}
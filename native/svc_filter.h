@@ -0,0 +1,39 @@
+#ifndef SVC_FILTER_H
+#define SVC_FILTER_H
+
+#include <napi.h>
+#include "svc.h"
+
+/**
+ * SvcLayerFilter - Drops temporal layers from encoded VP9/AV1 chunks
+ *
+ * For SFU-style relays: reads each chunk's temporal layer from its headers
+ * (svc.h) and forwards it only if the layer is at or below the current
+ * maximum, without decoding. Works directly on the caller's buffers and
+ * allocates nothing per chunk.
+ */
+class SvcLayerFilter : public Napi::ObjectWrap<SvcLayerFilter> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    SvcLayerFilter(const Napi::CallbackInfo& info);
+
+private:
+    static Napi::FunctionReference constructor;
+
+    enum class Bitstream { VP9, AV1 };
+
+    // JavaScript-facing methods
+    Napi::Value GetMaxTemporalLayer(const Napi::CallbackInfo& info);
+    void SetMaxTemporalLayer(const Napi::CallbackInfo& info, const Napi::Value& value);
+    Napi::Value TemporalLayerOf(const Napi::CallbackInfo& info);
+    Napi::Value Filter(const Napi::CallbackInfo& info);
+    Napi::Value FilterBatch(const Napi::CallbackInfo& info);
+
+    int LayerOf(const uint8_t* data, size_t size) const;
+
+    Bitstream bitstream_;
+    ScalabilityConfig scalability_;
+    int maxTemporalLayer_;
+};
+
+#endif // SVC_FILTER_H
@@ -0,0 +1,226 @@
+#include "tensor.h"
+#include "frame.h"
+#include "scaler.h"
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+namespace {
+
+// IEEE 754 binary16, round to nearest even
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponent >= 31) {
+        // Overflow or Inf/NaN
+        bool nan = ((bits >> 23) & 0xff) == 0xff && mantissa;
+        return static_cast<uint16_t>(sign | 0x7c00 | (nan ? 0x200 : 0));
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) return static_cast<uint16_t>(sign);  // Underflow to zero
+        // Subnormal
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t midpoint = 1u << (shift - 1);
+        if (rest > midpoint || (rest == midpoint && (half & 1))) half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++;  // May carry into the exponent
+    return static_cast<uint16_t>(half);
+}
+
+struct TensorOptions {
+    int width = 0;
+    int height = 0;
+    bool nchw = true;
+    bool float16 = false;
+    float scale[3];  // 1 / (255 * std)
+    float bias[3];   // -mean / std
+};
+
+// out[i] = src[i] * scale + bias over a run of bytes `stride` apart. The
+// unit-stride case (NCHW planes) is a plain loop the compiler vectorizes.
+template <typename Out, typename Convert>
+void normalizeRun(const uint8_t* src, int count, int stride, float scale, float bias,
+                  Out* out, size_t outStride, Convert convert) {
+    if (stride == 1 && outStride == 1) {
+        for (int i = 0; i < count; i++) {
+            out[i] = convert(src[i] * scale + bias);
+        }
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        out[i * outStride] = convert(src[i * stride] * scale + bias);
+    }
+}
+
+class TensorWorker : public Napi::AsyncWorker {
+public:
+    TensorWorker(Napi::Function callback, std::vector<AVFrame*> frames,
+                 const TensorOptions& options, Napi::TypedArray output)
+        : Napi::AsyncWorker(callback, "toTensor"),
+          frames_(std::move(frames)),
+          options_(options),
+          outputRef_(Napi::Persistent(output)),
+          output_(static_cast<uint8_t*>(output.ArrayBuffer().Data()) + output.ByteOffset()) {}
+
+    ~TensorWorker() override {
+        for (AVFrame*& frame : frames_) {
+            av_frame_free(&frame);
+        }
+    }
+
+    void Execute() override {
+        // NCHW reads planar GBRP straight into channel planes; NHWC reads
+        // packed RGB24 straight into interleaved pixels
+        AVFrame* rgb = av_frame_alloc();
+        if (!rgb) {
+            SetError("Failed to allocate frame");
+            return;
+        }
+        rgb->format = options_.nchw ? AV_PIX_FMT_GBRP : AV_PIX_FMT_RGB24;
+        rgb->width = options_.width;
+        rgb->height = options_.height;
+
+        const size_t pixels = static_cast<size_t>(options_.width) * options_.height;
+        for (size_t n = 0; n < frames_.size(); n++) {
+            int ret = scaler_.scale(frames_[n], rgb);
+            if (ret < 0) {
+                char errBuf[256];
+                av_strerror(ret, errBuf, sizeof(errBuf));
+                SetError(std::string("Failed to convert frame ") + std::to_string(n) + ": " + errBuf);
+                break;
+            }
+
+            size_t base = n * pixels * 3;
+            if (options_.float16) {
+                Write(rgb, reinterpret_cast<uint16_t*>(output_) + base, floatToHalf);
+            } else {
+                Write(rgb, reinterpret_cast<float*>(output_) + base, [](float v) { return v; });
+            }
+        }
+
+        av_frame_free(&rgb);
+    }
+
+    void OnOK() override {
+        Callback().Call({ Env().Null() });
+    }
+
+    void OnError(const Napi::Error& e) override {
+        Callback().Call({ e.Value() });
+    }
+
+private:
+    template <typename Out, typename Convert>
+    void Write(const AVFrame* rgb, Out* out, Convert convert) {
+        const int w = options_.width;
+        const int h = options_.height;
+
+        if (options_.nchw) {
+            // GBRP planes are G, B, R
+            static const int kPlane[3] = { 2, 0, 1 };
+            for (int c = 0; c < 3; c++) {
+                const int p = kPlane[c];
+                Out* plane = out + static_cast<size_t>(c) * w * h;
+                for (int y = 0; y < h; y++) {
+                    normalizeRun(rgb->data[p] + static_cast<size_t>(y) * rgb->linesize[p], w, 1,
+                                 options_.scale[c], options_.bias[c],
+                                 plane + static_cast<size_t>(y) * w, 1, convert);
+                }
+            }
+        } else {
+            for (int y = 0; y < h; y++) {
+                const uint8_t* row = rgb->data[0] + static_cast<size_t>(y) * rgb->linesize[0];
+                Out* outRow = out + static_cast<size_t>(y) * w * 3;
+                for (int c = 0; c < 3; c++) {
+                    normalizeRun(row + c, w, 3, options_.scale[c], options_.bias[c],
+                                 outRow + c, 3, convert);
+                }
+            }
+        }
+    }
+
+    std::vector<AVFrame*> frames_;
+    TensorOptions options_;
+    Napi::Reference<Napi::TypedArray> outputRef_;  // Keeps the buffer alive
+    uint8_t* output_;
+    FrameScaler scaler_;
+};
+
+} // namespace
+
+// toTensor(frames, { width, height, layout, mean, std, dtype }, output, callback(err))
+Napi::Value ToTensor(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 4 || !info[0].IsArray() || !info[1].IsObject() ||
+        !info[2].IsTypedArray() || !info[3].IsFunction()) {
+        Napi::TypeError::New(env, "toTensor(frames, options, output, callback)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object opts = info[1].As<Napi::Object>();
+    TensorOptions options;
+    options.width = opts.Get("width").As<Napi::Number>().Int32Value();
+    options.height = opts.Get("height").As<Napi::Number>().Int32Value();
+    options.nchw = opts.Get("layout").As<Napi::String>().Utf8Value() != "NHWC";
+    options.float16 = opts.Get("dtype").As<Napi::String>().Utf8Value() == "float16";
+
+    Napi::Array mean = opts.Get("mean").As<Napi::Array>();
+    Napi::Array stdev = opts.Get("std").As<Napi::Array>();
+    for (uint32_t c = 0; c < 3; c++) {
+        float m = mean.Get(c).As<Napi::Number>().FloatValue();
+        float s = stdev.Get(c).As<Napi::Number>().FloatValue();
+        if (!(s > 0)) {
+            Napi::RangeError::New(env, "std must be positive").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        options.scale[c] = 1.0f / (255.0f * s);
+        options.bias[c] = -m / s;
+    }
+
+    Napi::TypedArray output = info[2].As<Napi::TypedArray>();
+    napi_typedarray_type expected = options.float16 ? napi_uint16_array : napi_float32_array;
+    if (output.TypedArrayType() != expected) {
+        Napi::TypeError::New(env, options.float16 ? "float16 output must be a Uint16Array"
+                                                  : "float32 output must be a Float32Array").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Array frameArray = info[0].As<Napi::Array>();
+    size_t needed = static_cast<size_t>(frameArray.Length()) * 3 * options.width * options.height;
+    if (output.ElementLength() < needed) {
+        Napi::RangeError::New(env, "Output holds " + std::to_string(output.ElementLength()) +
+                              " elements, batch needs " + std::to_string(needed)).ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    std::vector<AVFrame*> frames;
+    if (!CloneFrames(env, frameArray, frames)) {
+        return env.Undefined();
+    }
+
+    TensorWorker* worker = new TensorWorker(info[3].As<Napi::Function>(), std::move(frames), options, output);
+    worker->Queue();
+    return env.Undefined();
+}
+
+void InitTensor(Napi::Env env, Napi::Object exports) {
+    exports.Set("toTensor", Napi::Function::New(env, ToTensor));
+}
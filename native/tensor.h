@@ -0,0 +1,16 @@
+#ifndef TENSOR_H
+#define TENSOR_H
+
+#include <napi.h>
+
+/**
+ * ML preprocessing: toTensor(frames, options, output, callback)
+ *
+ * Converts a batch of VideoFrameNative frames to RGB, resizes them, and
+ * writes (x / 255 - mean) / std into one caller-provided buffer as float32
+ * or float16, in NCHW or NHWC layout. Runs on the libuv thread pool; the
+ * frames are referenced up front, so closing them meanwhile is safe.
+ */
+void InitTensor(Napi::Env env, Napi::Object exports);
+
+#endif // TENSOR_H
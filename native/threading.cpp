@@ -0,0 +1,183 @@
+#include "threading.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace Threading {
+
+#ifdef __linux__
+
+// Path of our cgroup in the hierarchy that has `controller`, from
+// /proc/self/cgroup ("id:controllers:path"). v2 is the "0::" line.
+static bool findCgroupPath(const std::string& controller, bool v2, std::string& path) {
+    std::ifstream in("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t first = line.find(':');
+        size_t second = line.find(':', first + 1);
+        if (first == std::string::npos || second == std::string::npos) continue;
+
+        std::string controllers = line.substr(first + 1, second - first - 1);
+        if (v2) {
+            if (line.compare(0, first, "0") == 0 && controllers.empty()) {
+                path = line.substr(second + 1);
+                return true;
+            }
+            continue;
+        }
+
+        std::stringstream ss(controllers);
+        std::string name;
+        while (std::getline(ss, name, ',')) {
+            if (name == controller) {
+                path = line.substr(second + 1);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Limits are hierarchical, so walk from our cgroup up to the mount root and
+// keep the tightest quota. Without a cgroup namespace the path from
+// /proc/self/cgroup may not exist under the mount (it's bind-mounted at the
+// container's own cgroup), in which case only the root level is found.
+template <typename ReadQuota>
+static double tightestQuota(const std::string& mount, std::string path, ReadQuota readQuota) {
+    double best = 0;
+    while (true) {
+        double q = readQuota(mount + (path == "/" ? "" : path));
+        if (q > 0 && (best == 0 || q < best)) {
+            best = q;
+        }
+        if (path.empty() || path == "/") break;
+        size_t slash = path.find_last_of('/');
+        path = (slash == 0 || slash == std::string::npos) ? "/" : path.substr(0, slash);
+    }
+    return best;
+}
+
+// cgroup v2: cpu.max is "<quota|max> <period>"
+static double readCpuMax(const std::string& dir) {
+    std::ifstream in(dir + "/cpu.max");
+    std::string quota;
+    long long period = 0;
+    if (!(in >> quota >> period) || quota == "max" || period <= 0) {
+        return 0;
+    }
+    long long q = std::atoll(quota.c_str());
+    return q > 0 ? static_cast<double>(q) / period : 0;
+}
+
+// cgroup v1: cpu.cfs_quota_us (-1 = unlimited) / cpu.cfs_period_us
+static double readCfsQuota(const std::string& dir) {
+    std::ifstream quotaIn(dir + "/cpu.cfs_quota_us");
+    std::ifstream periodIn(dir + "/cpu.cfs_period_us");
+    long long quota = 0, period = 0;
+    if (!(quotaIn >> quota) || !(periodIn >> period) || quota <= 0 || period <= 0) {
+        return 0;
+    }
+    return static_cast<double>(quota) / period;
+}
+
+static void detectCgroupQuota(CpuBudget& b) {
+    std::string path;
+    if (findCgroupPath("", true, path)) {
+        std::ifstream controllers("/sys/fs/cgroup/cgroup.controllers");
+        if (controllers.good()) {
+            b.quotaCores = tightestQuota("/sys/fs/cgroup", path, readCpuMax);
+            if (b.quotaCores > 0) b.cgroupVersion = 2;
+            return;
+        }
+    }
+
+    if (findCgroupPath("cpu", false, path)) {
+        for (const char* mount : {"/sys/fs/cgroup/cpu,cpuacct", "/sys/fs/cgroup/cpu"}) {
+            double q = tightestQuota(mount, path, readCfsQuota);
+            if (q > 0) {
+                b.quotaCores = q;
+                b.cgroupVersion = 1;
+                break;
+            }
+        }
+    }
+}
+
+#endif // __linux__
+
+static CpuBudget detect() {
+    CpuBudget b = {};
+    b.hostCores = std::max(1u, std::thread::hardware_concurrency());
+    b.affinityCores = b.hostCores;
+
+#ifdef __linux__
+    // cpuset limits show up in the affinity mask, which also covers taskset
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        int n = CPU_COUNT(&set);
+        if (n > 0) b.affinityCores = std::min(n, b.hostCores);
+    }
+    detectCgroupQuota(b);
+#endif
+
+    b.effectiveCores = b.affinityCores;
+    if (b.quotaCores > 0) {
+        int quotaCores = std::max(1, static_cast<int>(std::ceil(b.quotaCores)));
+        b.effectiveCores = std::min(b.effectiveCores, quotaCores);
+    }
+
+    // Explicit override for environments we can't see into (e.g. VMs
+    // advertising more vCPUs than they're scheduled)
+    if (const char* env = std::getenv("NODE_WEBCODECS_THREADS")) {
+        int n = std::atoi(env);
+        if (n > 0) {
+            b.overrideCores = n;
+            b.effectiveCores = n;
+        }
+    }
+
+    b.effectiveCores = std::max(1, b.effectiveCores);
+    b.constrained = b.effectiveCores < b.hostCores || b.overrideCores > 0;
+    return b;
+}
+
+const CpuBudget& budget() {
+    static const CpuBudget cached = detect();
+    return cached;
+}
+
+int codecThreadCount() {
+    const CpuBudget& b = budget();
+    return b.constrained ? b.effectiveCores : 0;
+}
+
+int swsThreadCount() {
+    const CpuBudget& b = budget();
+    return b.constrained ? b.effectiveCores : 0;
+}
+
+int realtimeThreadCount(int height) {
+    int bySize = std::max(1, height / 180);
+    return std::max(1, std::min({bySize, budget().effectiveCores, 16}));
+}
+
+int tileColumnsLog2(int width, int threads) {
+    int maxTiles = std::max(1, std::min(threads, width / 256));
+    int log2 = 0;
+    while ((2 << log2) <= maxTiles && log2 < 6) {
+        log2++;
+    }
+    return log2;
+}
+
+} // namespace Threading
@@ -0,0 +1,57 @@
+#ifndef THREADING_H
+#define THREADING_H
+
+/**
+ * Effective CPU budget for codec and swscale thread pools.
+ *
+ * FFmpeg's "0 = auto" sizes pools from the host core count, which in a
+ * container with a CPU quota (e.g. 2 CPUs on a 64-core node) oversubscribes
+ * and triggers CFS throttling. The budget is read once at load from the
+ * affinity mask and cgroup v1/v2 quota, and used wherever we'd otherwise
+ * pass 0.
+ */
+namespace Threading {
+
+struct CpuBudget {
+    int hostCores;          // std::thread::hardware_concurrency()
+    int affinityCores;      // CPUs in our affinity mask (cpuset), or hostCores
+    double quotaCores;      // cgroup CPU quota in cores, 0 if unlimited
+    int cgroupVersion;      // Hierarchy quotaCores came from: 1, 2, or 0 if none
+    int overrideCores;      // NODE_WEBCODECS_THREADS, 0 if unset
+    int effectiveCores;     // What we size thread pools from (>= 1)
+    bool constrained;       // effectiveCores < hostCores, or overridden
+};
+
+/**
+ * Detected budget. Computed on first call (binding Init primes it) and cached.
+ */
+const CpuBudget& budget();
+
+/**
+ * Value for AVCodecContext::thread_count. Returns 0 (FFmpeg auto, which
+ * applies per-codec caps) when unconstrained, else the effective core count.
+ */
+int codecThreadCount();
+
+/**
+ * Value for the swscale "threads" option; same semantics as codecThreadCount().
+ */
+int swsThreadCount();
+
+/**
+ * Threads for latencyMode "realtime". Slice/row/tile threading adds no frame
+ * delay, but every slice costs some bitrate and small frames don't split
+ * well, so allow about one thread per 180 rows (slices and row-mt both
+ * split by rows), capped by the budget.
+ */
+int realtimeThreadCount(int height);
+
+/**
+ * log2 of the tile column count for VP9/AV1: no more tiles than threads,
+ * and no tile narrower than 256 pixels (the VP9 minimum tile width).
+ */
+int tileColumnsLog2(int width, int threads);
+
+} // namespace Threading
+
+#endif // THREADING_H
@@ -0,0 +1,635 @@
+#include "transcoder.h"
+#include "env_state.h"
+#include "frame.h"
+#include "decoder_setup.h"
+#include "encoder_setup.h"
+#include "hw_accel.h"
+#include "threading.h"
+#include <cstring>
+#include <vector>
+
+TranscodeFlush::~TranscodeFlush() {
+    // A flush dropped by close()/reset() never resolves; release its handle
+    // so it stops holding the event loop
+    if (callback && !nwc_env_teardown.load()) {
+        callback.Release();
+    }
+}
+
+namespace {
+
+struct TranscodeChunk {
+    std::vector<uint8_t> data;
+    bool isKeyframe;
+    int64_t pts;
+    int64_t duration;
+    int width;
+    int height;
+    std::vector<uint8_t> extradata;
+    bool hasExtradata;
+};
+
+struct TranscodeProgress {
+    int64_t framesDecoded;
+    int64_t framesEncoded;
+};
+
+} // namespace
+
+Napi::FunctionReference VideoTranscoder::constructor;
+
+Napi::Object VideoTranscoder::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "VideoTranscoder", {
+        InstanceMethod("configure", &VideoTranscoder::Configure),
+        InstanceMethod("transcode", &VideoTranscoder::Transcode),
+        InstanceMethod("flush", &VideoTranscoder::Flush),
+        InstanceMethod("reset", &VideoTranscoder::Reset),
+        InstanceMethod("close", &VideoTranscoder::Close),
+    });
+
+    constructor = Napi::Persistent(func);
+    constructor.SuppressDestruct();
+
+    exports.Set("VideoTranscoder", func);
+    return exports;
+}
+
+VideoTranscoder::VideoTranscoder(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<VideoTranscoder>(info)
+    , inputQueue_()
+    , decodedQueue_(kQueueDepth)
+    , scaledQueue_(kQueueDepth)
+    , targetWidth_(0)
+    , targetHeight_(0)
+    , targetFormat_(AV_PIX_FMT_NONE)
+    , outputWidth_(0)
+    , outputHeight_(0)
+    , bitrate_(2000000)
+    , bitrateMode_("variable")
+    , latencyMode_("quality")
+    , framerate_(30)
+    , profile_(-1) {
+
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 3) {
+        Napi::TypeError::New(env, "Expected 3 callbacks").ThrowAsJavaScriptException();
+        return;
+    }
+
+    tsfnOutput_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[0].As<Napi::Function>(),
+        "VideoTranscoderOutput",
+        0,
+        1
+    );
+
+    tsfnError_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[1].As<Napi::Function>(),
+        "VideoTranscoderError",
+        0,
+        1
+    );
+
+    tsfnProgress_ = Napi::ThreadSafeFunction::New(
+        env,
+        info[2].As<Napi::Function>(),
+        "VideoTranscoderProgress",
+        0,
+        1
+    );
+
+    // Idle transcoders don't hold the event loop; in-flight jobs do (JobSubmitted)
+    tsfnOutput_.Unref(env);
+    tsfnError_.Unref(env);
+    tsfnProgress_.Unref(env);
+
+    tsfnJobDone_ = Napi::ThreadSafeFunction::New(
+        env,
+        Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+        "VideoTranscoderJobDone",
+        0,
+        1
+    );
+    tsfnJobDone_.Unref(env);
+}
+
+VideoTranscoder::~VideoTranscoder() {
+    StopWorkers();
+
+    if (!nwc_env_teardown.load()) {
+        if (tsfnOutput_) tsfnOutput_.Release();
+        if (tsfnError_) tsfnError_.Release();
+        if (tsfnProgress_) tsfnProgress_.Release();
+        if (tsfnJobDone_) tsfnJobDone_.Release();
+    }
+}
+
+// Hold the event loop open while jobs are in flight (JS thread only)
+void VideoTranscoder::JobSubmitted(Napi::Env env) {
+    if (activeJobs_++ == 0) {
+        tsfnOutput_.Ref(env);
+        Ref();
+    }
+}
+
+void VideoTranscoder::JobFinished(Napi::Env env) {
+    if (activeJobs_ > 0 && --activeJobs_ == 0) {
+        tsfnOutput_.Unref(env);
+        Unref();
+    }
+}
+
+// configure({ decoder: { codec, extradata?, width?, height? },
+//             encoder: { codec, width?, height?, bitrate?, framerate?,
+//                        bitrateMode?, latencyMode?, profile? } })
+void VideoTranscoder::Configure(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!info[0].IsObject()) {
+        Napi::TypeError::New(env, "Config must be an object").ThrowAsJavaScriptException();
+        return;
+    }
+
+    StopWorkers();
+
+    Napi::Object config = info[0].As<Napi::Object>();
+    if (!config.Get("decoder").IsObject() || !config.Get("encoder").IsObject()) {
+        Napi::TypeError::New(env, "Config needs decoder and encoder objects").ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Object decoderConfig = config.Get("decoder").As<Napi::Object>();
+    Napi::Object encoderConfig = config.Get("encoder").As<Napi::Object>();
+
+    // Encoder settings; the context itself opens on the first frame
+    std::string encoderName = encoderConfig.Get("codec").As<Napi::String>().Utf8Value();
+
+    outputWidth_ = 0;
+    outputHeight_ = 0;
+    if (encoderConfig.Has("width") && encoderConfig.Get("width").IsNumber()) {
+        outputWidth_ = encoderConfig.Get("width").As<Napi::Number>().Int32Value();
+    }
+    if (encoderConfig.Has("height") && encoderConfig.Get("height").IsNumber()) {
+        outputHeight_ = encoderConfig.Get("height").As<Napi::Number>().Int32Value();
+    }
+
+    bitrate_ = 2000000;
+    if (encoderConfig.Has("bitrate") && encoderConfig.Get("bitrate").IsNumber()) {
+        bitrate_ = encoderConfig.Get("bitrate").As<Napi::Number>().Int64Value();
+    }
+
+    framerate_ = 30;
+    if (encoderConfig.Has("framerate") && encoderConfig.Get("framerate").IsNumber()) {
+        framerate_ = encoderConfig.Get("framerate").As<Napi::Number>().Int32Value();
+    }
+
+    bitrateMode_ = "variable";
+    if (encoderConfig.Has("bitrateMode") && encoderConfig.Get("bitrateMode").IsString()) {
+        bitrateMode_ = encoderConfig.Get("bitrateMode").As<Napi::String>().Utf8Value();
+    }
+
+    latencyMode_ = "quality";
+    if (encoderConfig.Has("latencyMode") && encoderConfig.Get("latencyMode").IsString()) {
+        latencyMode_ = encoderConfig.Get("latencyMode").As<Napi::String>().Utf8Value();
+    }
+
+    profile_ = -1;
+    if (encoderConfig.Has("profile") && encoderConfig.Get("profile").IsNumber()) {
+        profile_ = encoderConfig.Get("profile").As<Napi::Number>().Int32Value();
+    }
+
+    // Decoded frames are in system memory, so only software encoders apply
+    encoder_ = HWAccel::selectEncoder(encoderName, HWAccel::Preference::PreferSoftware,
+                                      outputWidth_, outputHeight_).codec;
+    if (!encoder_) {
+        encoder_ = avcodec_find_encoder_by_name(encoderName.c_str());
+    }
+    if (!encoder_) {
+        Napi::Error::New(env, "No suitable encoder found for: " + encoderName).ThrowAsJavaScriptException();
+        return;
+    }
+
+    // Decoder
+    std::string decoderName = decoderConfig.Get("codec").As<Napi::String>().Utf8Value();
+    const AVCodec* decoder = DecoderSetup::findDecoder(decoderName);
+    if (!decoder) {
+        Napi::Error::New(env, "Codec not found: " + decoderName).ThrowAsJavaScriptException();
+        return;
+    }
+
+    decoderCtx_ = avcodec_alloc_context3(decoder);
+    if (!decoderCtx_) {
+        Napi::Error::New(env, "Failed to allocate codec context").ThrowAsJavaScriptException();
+        return;
+    }
+    if (decoderConfig.Has("width") && decoderConfig.Get("width").IsNumber()) {
+        decoderCtx_->width = decoderConfig.Get("width").As<Napi::Number>().Int32Value();
+    }
+    if (decoderConfig.Has("height") && decoderConfig.Get("height").IsNumber()) {
+        decoderCtx_->height = decoderConfig.Get("height").As<Napi::Number>().Int32Value();
+    }
+    if (decoderConfig.Has("extradata")) {
+        Napi::Buffer<uint8_t> extradata = decoderConfig.Get("extradata").As<Napi::Buffer<uint8_t>>();
+        DecoderSetup::setExtradata(decoderCtx_, extradata.Data(), extradata.Length());
+    }
+    decoderCtx_->thread_count = Threading::codecThreadCount();
+
+    int ret = avcodec_open2(decoderCtx_, decoder, nullptr);
+    if (ret < 0) {
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        avcodec_free_context(&decoderCtx_);
+        Napi::Error::New(env, std::string("Failed to open codec: ") + errBuf).ThrowAsJavaScriptException();
+        return;
+    }
+
+    configured_ = true;
+    decodeThread_ = std::thread(&VideoTranscoder::DecodeThread, this);
+    scaleThread_ = std::thread(&VideoTranscoder::ScaleThread, this);
+    encodeThread_ = std::thread(&VideoTranscoder::EncodeThread, this);
+}
+
+void VideoTranscoder::DecodeThread() {
+    AVFrame* frame = av_frame_alloc();
+
+    auto drain = [&]() {
+        while (avcodec_receive_frame(decoderCtx_, frame) >= 0) {
+            if (frame->pts == AV_NOPTS_VALUE) {
+                frame->pts = frame->best_effort_timestamp;
+            }
+            TranscodeJob out;
+            out.frame = av_frame_clone(frame);
+            av_frame_unref(frame);
+            framesDecoded_++;
+            if (!out.frame || !decodedQueue_.push(out)) {
+                FreeJob(out);
+            }
+        }
+    };
+
+    TranscodeJob job;
+    while (inputQueue_.pop(job)) {
+        if (job.flush) {
+            avcodec_send_packet(decoderCtx_, nullptr);
+            drain();
+            // Back out of EOF so transcoding can continue after flush()
+            avcodec_flush_buffers(decoderCtx_);
+            decodedQueue_.push(job);
+            job = TranscodeJob();
+            continue;
+        }
+
+        int ret = avcodec_send_packet(decoderCtx_, job.packet);
+        FreeJob(job);
+        if (ret < 0) {
+            char errBuf[256];
+            av_strerror(ret, errBuf, sizeof(errBuf));
+            ReportError(std::string("Decode error: ") + errBuf);
+        } else {
+            drain();
+        }
+
+        tsfnJobDone_.NonBlockingCall([this](Napi::Env env, Napi::Function) {
+            JobFinished(env);
+        });
+        job = TranscodeJob();
+    }
+
+    av_frame_free(&frame);
+}
+
+void VideoTranscoder::ScaleThread() {
+    TranscodeJob job;
+    while (decodedQueue_.pop(job)) {
+        if (job.frame) {
+            if (targetFormat_ == AV_PIX_FMT_NONE) {
+                // First frame fixes the output geometry and pixel format
+                targetWidth_ = outputWidth_ > 0 ? outputWidth_ : job.frame->width;
+                targetHeight_ = outputHeight_ > 0 ? outputHeight_ : job.frame->height;
+                targetFormat_ = NegotiateEncoderPixelFormat(
+                    encoder_, static_cast<AVPixelFormat>(job.frame->format), profile_);
+            }
+
+            if (job.frame->width != targetWidth_ || job.frame->height != targetHeight_ ||
+                job.frame->format != targetFormat_) {
+                AVFrame* scaled = av_frame_alloc();
+                int ret = AVERROR(ENOMEM);
+                if (scaled) {
+                    scaled->format = targetFormat_;
+                    scaled->width = targetWidth_;
+                    scaled->height = targetHeight_;
+                    ret = scaler_.scale(job.frame, scaled);
+                }
+                av_frame_free(&job.frame);
+                if (ret < 0) {
+                    av_frame_free(&scaled);
+                    char errBuf[256];
+                    av_strerror(ret, errBuf, sizeof(errBuf));
+                    ReportError(std::string("Scale error: ") + errBuf);
+                    job = TranscodeJob();
+                    continue;
+                }
+                job.frame = scaled;
+            }
+        }
+
+        if (!scaledQueue_.push(job)) {
+            FreeJob(job);
+        }
+        job = TranscodeJob();
+    }
+}
+
+bool VideoTranscoder::OpenEncoder(const AVFrame* frame, std::string& error) {
+    AVCodecContext* ctx = avcodec_alloc_context3(encoder_);
+    if (!ctx) {
+        error = "Failed to allocate codec context";
+        return false;
+    }
+
+    ctx->width = frame->width;
+    ctx->height = frame->height;
+    ctx->pix_fmt = static_cast<AVPixelFormat>(frame->format);
+    ctx->time_base = { 1, 1000000 };
+    ctx->framerate = { framerate_, 1 };
+    ctx->gop_size = framerate_;
+    ctx->max_b_frames = 0;
+    ctx->color_primaries = frame->color_primaries;
+    ctx->color_trc = frame->color_trc;
+    ctx->colorspace = frame->colorspace;
+    ctx->color_range = frame->color_range;
+
+    EncoderSetup::applyRateControl(ctx, bitrateMode_, bitrate_);
+    EncoderSetup::applyH264Profile(ctx, profile_);
+    EncoderSetup::applyTuning(ctx, latencyMode_);
+
+    int ret = avcodec_open2(ctx, encoder_, nullptr);
+    if (ret < 0) {
+        avcodec_free_context(&ctx);
+        char errBuf[256];
+        av_strerror(ret, errBuf, sizeof(errBuf));
+        error = std::string("Failed to open codec: ") + errBuf;
+        return false;
+    }
+
+    encoderCtx_ = ctx;
+    return true;
+}
+
+void VideoTranscoder::EncodeThread() {
+    AVPacket* packet = av_packet_alloc();
+    bool encoderFailed = false;
+
+    TranscodeJob job;
+    while (scaledQueue_.pop(job)) {
+        if (job.flush) {
+            if (encoderCtx_) {
+                avcodec_send_frame(encoderCtx_, nullptr);
+                DrainPackets(packet);
+                if (encoderCtx_->codec->capabilities & AV_CODEC_CAP_ENCODER_FLUSH) {
+                    avcodec_flush_buffers(encoderCtx_);
+                } else {
+                    // Reopened on the next frame
+                    avcodec_free_context(&encoderCtx_);
+                }
+            }
+            ReportProgress();
+
+            job.flush->callback.NonBlockingCall([](Napi::Env env, Napi::Function fn) {
+                fn.Call({ env.Null() });
+            });
+            job.flush->callback.Release();
+            job.flush->callback = Napi::ThreadSafeFunction();
+            tsfnJobDone_.NonBlockingCall([this](Napi::Env env, Napi::Function) {
+                JobFinished(env);
+            });
+            job = TranscodeJob();
+            continue;
+        }
+
+        if (!encoderCtx_ && !encoderFailed) {
+            std::string error;
+            if (!OpenEncoder(job.frame, error)) {
+                // Report once; later frames are dropped until reconfigure
+                ReportError(error);
+                encoderFailed = true;
+            }
+        }
+        if (!encoderCtx_) {
+            FreeJob(job);
+            continue;
+        }
+
+        // Decoder picture types mean nothing to the encoder
+        job.frame->pict_type = AV_PICTURE_TYPE_NONE;
+        int ret = avcodec_send_frame(encoderCtx_, job.frame);
+        FreeJob(job);
+        if (ret < 0) {
+            char errBuf[256];
+            av_strerror(ret, errBuf, sizeof(errBuf));
+            ReportError(std::string("Encode error: ") + errBuf);
+        } else {
+            DrainPackets(packet);
+        }
+        job = TranscodeJob();
+    }
+
+    av_packet_free(&packet);
+    if (encoderCtx_) avcodec_free_context(&encoderCtx_);
+}
+
+void VideoTranscoder::DrainPackets(AVPacket* packet) {
+    while (avcodec_receive_packet(encoderCtx_, packet) >= 0) {
+        TranscodeChunk* chunk = new TranscodeChunk();
+        chunk->data.assign(packet->data, packet->data + packet->size);
+        chunk->isKeyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+        chunk->pts = packet->pts;
+        chunk->duration = packet->duration;
+        chunk->width = encoderCtx_->width;
+        chunk->height = encoderCtx_->height;
+        chunk->hasExtradata = chunk->isKeyframe && encoderCtx_->extradata && encoderCtx_->extradata_size > 0;
+        if (chunk->hasExtradata) {
+            chunk->extradata.assign(encoderCtx_->extradata,
+                                    encoderCtx_->extradata + encoderCtx_->extradata_size);
+        }
+        av_packet_unref(packet);
+
+        napi_status status = tsfnOutput_.BlockingCall(chunk,
+            [](Napi::Env env, Napi::Function fn, TranscodeChunk* c) {
+                Napi::Value extradataValue = env.Undefined();
+                if (c->hasExtradata) {
+                    extradataValue = Napi::Buffer<uint8_t>::Copy(env, c->extradata.data(), c->extradata.size());
+                }
+
+                fn.Call({
+                    Napi::Buffer<uint8_t>::Copy(env, c->data.data(), c->data.size()),
+                    Napi::Boolean::New(env, c->isKeyframe),
+                    Napi::Number::New(env, static_cast<double>(c->pts)),
+                    Napi::Number::New(env, static_cast<double>(c->duration)),
+                    Napi::Number::New(env, c->width),
+                    Napi::Number::New(env, c->height),
+                    extradataValue
+                });
+
+                delete c;
+            });
+        if (status != napi_ok) {
+            delete chunk;
+        }
+
+        if (++framesEncoded_ % kProgressInterval == 0) {
+            ReportProgress();
+        }
+    }
+}
+
+void VideoTranscoder::ReportProgress() {
+    auto* progress = new TranscodeProgress{ framesDecoded_.load(), framesEncoded_.load() };
+    napi_status status = tsfnProgress_.NonBlockingCall(progress,
+        [](Napi::Env env, Napi::Function fn, TranscodeProgress* p) {
+            fn.Call({
+                Napi::Number::New(env, static_cast<double>(p->framesDecoded)),
+                Napi::Number::New(env, static_cast<double>(p->framesEncoded))
+            });
+            delete p;
+        });
+    if (status != napi_ok) {
+        delete progress;
+    }
+}
+
+void VideoTranscoder::ReportError(const std::string& message) {
+    auto* msg = new std::string(message);
+    napi_status status = tsfnError_.NonBlockingCall(msg,
+        [](Napi::Env env, Napi::Function fn, std::string* m) {
+            fn.Call({ Napi::String::New(env, *m) });
+            delete m;
+        });
+    if (status != napi_ok) {
+        delete msg;
+    }
+}
+
+// transcode(data: Buffer, isKeyframe, timestamp, duration)
+void VideoTranscoder::Transcode(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!configured_) {
+        Napi::Error::New(env, "Transcoder not configured").ThrowAsJavaScriptException();
+        return;
+    }
+
+    Napi::Buffer<uint8_t> data = info[0].As<Napi::Buffer<uint8_t>>();
+
+    TranscodeJob job;
+    job.packet = av_packet_alloc();
+    if (!job.packet || av_new_packet(job.packet, static_cast<int>(data.Length())) < 0) {
+        FreeJob(job);
+        Napi::Error::New(env, "Failed to allocate packet").ThrowAsJavaScriptException();
+        return;
+    }
+    memcpy(job.packet->data, data.Data(), data.Length());
+    if (info[1].As<Napi::Boolean>().Value()) {
+        job.packet->flags |= AV_PKT_FLAG_KEY;
+    }
+    job.packet->pts = info[2].As<Napi::Number>().Int64Value();
+    job.packet->dts = job.packet->pts;
+    job.packet->duration = info[3].As<Napi::Number>().Int64Value();
+
+    if (!inputQueue_.push(job)) {
+        FreeJob(job);
+        return;
+    }
+    JobSubmitted(env);
+}
+
+Napi::Value VideoTranscoder::Flush(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Function callback = info[0].As<Napi::Function>();
+
+    if (!configured_) {
+        callback.Call({ env.Null() });
+        return env.Undefined();
+    }
+
+    TranscodeJob job;
+    job.flush = std::make_shared<TranscodeFlush>();
+    job.flush->callback = Napi::ThreadSafeFunction::New(
+        env,
+        callback,
+        "VideoTranscoderFlush",
+        0,
+        1
+    );
+
+    if (inputQueue_.push(job)) {
+        JobSubmitted(env);
+    }
+    return env.Undefined();
+}
+
+void VideoTranscoder::FreeJob(TranscodeJob& job) {
+    if (job.packet) av_packet_free(&job.packet);
+    if (job.frame) av_frame_free(&job.frame);
+    job.flush.reset();
+}
+
+// Stop and join every stage, dropping queued work, and free both contexts.
+// Safe to call when not configured.
+void VideoTranscoder::StopWorkers() {
+    configured_ = false;
+
+    inputQueue_.close();
+    decodedQueue_.close();
+    scaledQueue_.close();
+    inputQueue_.drain(FreeJob);
+    decodedQueue_.drain(FreeJob);
+    scaledQueue_.drain(FreeJob);
+
+    if (decodeThread_.joinable()) decodeThread_.join();
+    if (scaleThread_.joinable()) scaleThread_.join();
+    if (encodeThread_.joinable()) encodeThread_.join();
+
+    inputQueue_.drain(FreeJob);
+    decodedQueue_.drain(FreeJob);
+    scaledQueue_.drain(FreeJob);
+    inputQueue_.reopen();
+    decodedQueue_.reopen();
+    scaledQueue_.reopen();
+
+    if (decoderCtx_) avcodec_free_context(&decoderCtx_);
+    if (encoderCtx_) avcodec_free_context(&encoderCtx_);
+    scaler_.reset();
+    targetWidth_ = 0;
+    targetHeight_ = 0;
+    targetFormat_ = AV_PIX_FMT_NONE;
+    framesDecoded_ = 0;
+    framesEncoded_ = 0;
+}
+
+void VideoTranscoder::Reset(const Napi::CallbackInfo& info) {
+    StopWorkers();
+
+    if (activeJobs_ > 0) {
+        activeJobs_ = 0;
+        tsfnOutput_.Unref(info.Env());
+        Unref();  // balance the in-flight pin; queued JobFinished sees 0 and skips
+    }
+}
+
+void VideoTranscoder::Close(const Napi::CallbackInfo& info) {
+    StopWorkers();
+
+    // Workers are joined, so no more calls are queued; release now and null
+    // the handles so the destructor doesn't touch finalized functions
+    if (tsfnOutput_) { tsfnOutput_.Release(); tsfnOutput_ = Napi::ThreadSafeFunction(); }
+    if (tsfnError_) { tsfnError_.Release(); tsfnError_ = Napi::ThreadSafeFunction(); }
+    if (tsfnProgress_) { tsfnProgress_.Release(); tsfnProgress_ = Napi::ThreadSafeFunction(); }
+    if (tsfnJobDone_) { tsfnJobDone_.Release(); tsfnJobDone_ = Napi::ThreadSafeFunction(); }
+    if (activeJobs_ > 0) {
+        activeJobs_ = 0;
+        Unref();
+    }
+}
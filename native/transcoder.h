@@ -0,0 +1,114 @@
+#ifndef TRANSCODER_H
+#define TRANSCODER_H
+
+#include <napi.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include "scaler.h"
+#include "work_queue.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+// Carried through every stage by a flush marker; the encode stage resolves
+// it once everything ahead of it has been output
+struct TranscodeFlush {
+    ~TranscodeFlush();
+    Napi::ThreadSafeFunction callback;
+};
+
+struct TranscodeJob {
+    AVPacket* packet = nullptr;  // Decode stage input
+    AVFrame* frame = nullptr;    // Scale and encode stage input
+    std::shared_ptr<TranscodeFlush> flush;  // Set on flush markers only
+};
+
+/**
+ * Native transcode pipeline: decode -> scale/convert -> encode.
+ *
+ * Each stage runs on its own thread, joined by bounded queues, so decoded
+ * frames never cross into JavaScript: JS submits encoded chunks and gets
+ * encoded chunks (plus progress counts) back. The scale stage converts to
+ * the encoder's size and pixel format, and passes frames by reference when
+ * they already match. The encoder opens on the first frame, so output
+ * dimensions default to the decoded size.
+ */
+class VideoTranscoder : public Napi::ObjectWrap<VideoTranscoder> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    VideoTranscoder(const Napi::CallbackInfo& info);
+    ~VideoTranscoder();
+
+private:
+    static Napi::FunctionReference constructor;
+
+    // Frames buffered between stages before the producer waits
+    static constexpr size_t kQueueDepth = 8;
+
+    // Encoded frames between progress reports
+    static constexpr int64_t kProgressInterval = 30;
+
+    // JavaScript-facing methods
+    void Configure(const Napi::CallbackInfo& info);
+    void Transcode(const Napi::CallbackInfo& info);
+    Napi::Value Flush(const Napi::CallbackInfo& info);
+    void Reset(const Napi::CallbackInfo& info);
+    void Close(const Napi::CallbackInfo& info);
+
+    void StopWorkers();
+    static void FreeJob(TranscodeJob& job);
+
+    // Worker threads
+    void DecodeThread();
+    void ScaleThread();
+    void EncodeThread();
+    bool OpenEncoder(const AVFrame* frame, std::string& error);
+    void DrainPackets(AVPacket* packet);
+    void ReportProgress();
+    void ReportError(const std::string& message);
+
+    Napi::ThreadSafeFunction tsfnOutput_;
+    Napi::ThreadSafeFunction tsfnError_;
+    Napi::ThreadSafeFunction tsfnProgress_;
+    Napi::ThreadSafeFunction tsfnJobDone_;
+    int activeJobs_ = 0;
+    void JobSubmitted(Napi::Env env);
+    void JobFinished(Napi::Env env);
+    std::atomic<bool> configured_{false};
+
+    WorkQueue<TranscodeJob> inputQueue_;
+    WorkQueue<TranscodeJob> decodedQueue_;
+    WorkQueue<TranscodeJob> scaledQueue_;
+    std::thread decodeThread_;
+    std::thread scaleThread_;
+    std::thread encodeThread_;
+
+    AVCodecContext* decoderCtx_ = nullptr;  // Decode thread
+    AVCodecContext* encoderCtx_ = nullptr;  // Encode thread, opened on first frame
+    const AVCodec* encoder_ = nullptr;
+    FrameScaler scaler_;                    // Scale thread
+
+    // Scale target, fixed by the first decoded frame (scale thread writes,
+    // encode thread reads after the frame crosses the queue)
+    int targetWidth_;
+    int targetHeight_;
+    AVPixelFormat targetFormat_;
+
+    std::atomic<int64_t> framesDecoded_{0};
+    std::atomic<int64_t> framesEncoded_{0};
+
+    // Encoder configuration
+    int outputWidth_;    // 0 = decoded width
+    int outputHeight_;   // 0 = decoded height
+    int64_t bitrate_;
+    std::string bitrateMode_;
+    std::string latencyMode_;
+    int framerate_;
+    int profile_;
+};
+
+#endif // TRANSCODER_H
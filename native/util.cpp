@@ -1,4 +1,5 @@
 #include <napi.h>
+#include "threading.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -24,6 +25,26 @@ Napi::Value GetFFmpegVersion(const Napi::CallbackInfo& info) {
     return result;
 }
 
+// CPU budget used to size codec/swscale thread pools
+Napi::Value GetCpuInfo(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const Threading::CpuBudget& b = Threading::budget();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("hostCores", Napi::Number::New(env, b.hostCores));
+    result.Set("affinityCores", Napi::Number::New(env, b.affinityCores));
+    result.Set("quotaCores", b.quotaCores > 0
+        ? Napi::Value(Napi::Number::New(env, b.quotaCores)) : env.Null());
+    result.Set("cgroupVersion", b.cgroupVersion > 0
+        ? Napi::Value(Napi::Number::New(env, b.cgroupVersion)) : env.Null());
+    result.Set("overrideCores", b.overrideCores > 0
+        ? Napi::Value(Napi::Number::New(env, b.overrideCores)) : env.Null());
+    result.Set("effectiveCores", Napi::Number::New(env, b.effectiveCores));
+    result.Set("constrained", Napi::Boolean::New(env, b.constrained));
+
+    return result;
+}
+
 // List available codecs
 Napi::Value ListCodecs(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -91,4 +112,5 @@ void InitUtil(Napi::Env env, Napi::Object exports) {
     exports.Set("getFFmpegVersion", Napi::Function::New(env, GetFFmpegVersion));
     exports.Set("listCodecs", Napi::Function::New(env, ListCodecs));
     exports.Set("hasCodec", Napi::Function::New(env, HasCodec));
+    exports.Set("getCpuInfo", Napi::Function::New(env, GetCpuInfo));
 }
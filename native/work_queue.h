@@ -0,0 +1,93 @@
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/**
+ * Blocking FIFO between pipeline stages. With a capacity, push() waits for
+ * room, so a slow consumer back-pressures its producer instead of letting
+ * decoded frames pile up. close() wakes everyone: pushes fail, pops drain
+ * what's left and then fail.
+ */
+template <typename T>
+class WorkQueue {
+public:
+    explicit WorkQueue(size_t capacity = 0) : capacity_(capacity) {}
+
+    WorkQueue(const WorkQueue&) = delete;
+    WorkQueue& operator=(const WorkQueue&) = delete;
+
+    // Returns false (leaving item with the caller) once closed
+    bool push(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] {
+            return closed_ || capacity_ == 0 || items_.size() < capacity_;
+        });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // Returns false once closed and empty
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        out = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+    // Reopen after close(); the queue must have been drained
+    void reopen() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = false;
+    }
+
+    // Remove every queued item, handing each to fn (e.g. to free frames)
+    template <typename Fn>
+    void drain(Fn fn) {
+        std::deque<T> items;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            items.swap(items_);
+        }
+        notFull_.notify_all();
+        for (T& item : items) {
+            fn(item);
+        }
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+private:
+    size_t capacity_;
+    bool closed_ = false;
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+};
+
+#endif // WORK_QUEUE_H
@@ -136,7 +136,7 @@ fetch "https://ffmpeg.org/releases/ffmpeg-$FFMPEG_VERSION.tar.xz" "$FFMPEG_SHA25
   --extra-ldflags="-L$PREFIX/lib" \
   --enable-static --disable-shared --enable-pic \
   --disable-programs --disable-doc --disable-debug \
-  --disable-avdevice --disable-avformat --disable-avfilter \
+  --disable-avdevice --disable-avfilter \
   --disable-network --disable-autodetect \
   --disable-everything \
   --enable-zlib \
@@ -147,6 +147,9 @@ fetch "https://ffmpeg.org/releases/ffmpeg-$FFMPEG_VERSION.tar.xz" "$FFMPEG_SHA25
   --enable-decoder=pcm_u8,pcm_s16le,pcm_s24le,pcm_s32le,pcm_f32le,pcm_f64le \
   --enable-encoder=libopenh264,libvpx_vp8,libvpx_vp9,libsvtav1,aac,libopus,libmp3lame,flac \
   --enable-encoder=pcm_u8,pcm_s16le,pcm_s24le,pcm_s32le,pcm_f32le,pcm_f64le \
+  --enable-demuxer=mov,matroska,mpegts,ivf,ogg,mp3,flac,wav \
+  --enable-muxer=mp4 --enable-bsf=aac_adtstoasc,vp9_superframe,h264_mp4toannexb,hevc_mp4toannexb \
+  --enable-parser=h264,hevc,vp8,vp9,av1,aac,opus,mpegaudio,flac,vorbis \
   "${HW_FLAGS[@]}"
 make -j"$JOBS" install
 
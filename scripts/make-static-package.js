@@ -43,7 +43,7 @@ fs.writeFileSync(path.join(outDir, 'THIRD_PARTY_NOTICES.md'), `# Third-party not
 
 This binary statically links the following libraries:
 
-- FFmpeg (libavcodec, libavutil, libswscale, libswresample) — LGPL-2.1-or-later,
+- FFmpeg (libavformat, libavcodec, libavutil, libswscale, libswresample) — LGPL-2.1-or-later,
   built with \`--disable-gpl\` (no GPL components). Source: https://ffmpeg.org
 - openh264 — BSD-2-Clause © Cisco Systems. https://github.com/cisco/openh264
   (compiled from source; H.264 patent licensing is the responsibility of the user)
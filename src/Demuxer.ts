@@ -0,0 +1,236 @@
+/**
+ * Demuxer - Native container demuxing (MP4/MOV, WebM/MKV, MPEG-TS, IVF)
+ *
+ * Not part of the WebCodecs spec. Reads a file path or file descriptor on a
+ * native thread with libavformat and yields decoder configs plus encoded
+ * chunks, replacing a JS container parser for server-side files. With
+ * pipeTo(), a video track's packets go straight into a VideoDecoder's
+ * worker thread and never become JS objects.
+ *
+ * Only available when the addon was built against libavformat;
+ * Demuxer.isSupported() reports whether it was.
+ */
+
+import { EncodedVideoChunk } from './EncodedVideoChunk';
+import { EncodedAudioChunk } from './EncodedAudioChunk';
+import { VideoDecoder, VideoDecoderConfig } from './VideoDecoder';
+import { AudioDecoderConfig } from './AudioDecoder';
+import { getCodecStringForStream } from './codec-registry';
+import { DOMException } from './types';
+import { native } from './native';
+
+interface DemuxerTrackBase {
+  /** Stream index in the container; pass to read() and pipeTo() */
+  index: number;
+
+  /** Duration in microseconds, if the container declares one */
+  duration?: number;
+}
+
+export interface DemuxerVideoTrack extends DemuxerTrackBase {
+  type: 'video';
+
+  /** Ready for VideoDecoder.configure(); null if no decoder here handles it */
+  config: VideoDecoderConfig | null;
+}
+
+export interface DemuxerAudioTrack extends DemuxerTrackBase {
+  type: 'audio';
+
+  /** Ready for AudioDecoder.configure(); null if no decoder here handles it */
+  config: AudioDecoderConfig | null;
+}
+
+export type DemuxerTrack = DemuxerVideoTrack | DemuxerAudioTrack;
+
+/**
+ * One demuxed chunk, tagged with its track
+ */
+export interface DemuxerPacket {
+  trackIndex: number;
+  chunk: EncodedVideoChunk | EncodedAudioChunk;
+}
+
+/**
+ * Reads encoded chunks out of a container file.
+ *
+ * @example
+ * ```ts
+ * const demuxer = new Demuxer();
+ * const tracks = await demuxer.open('/media/input.mp4');
+ * const video = tracks.find((t) => t.type === 'video')!;
+ *
+ * decoder.configure(video.config!);
+ * await demuxer.pipeTo(video.index, decoder);
+ * await decoder.flush();
+ * demuxer.close();
+ * ```
+ */
+export class Demuxer {
+  private _native: any = null;
+  private _tracks: DemuxerTrack[] = [];
+  private _closed: boolean = false;
+
+  static isSupported(): boolean {
+    return !!native?.Demuxer;
+  }
+
+  /** Tracks found by open() */
+  get tracks(): DemuxerTrack[] {
+    return this._tracks;
+  }
+
+  /**
+   * Open a file path or a readable file descriptor. Regular files are read
+   * with pread, leaving a caller's fd offset untouched; pipes are read
+   * sequentially and can't seek.
+   */
+  async open(source: string | number): Promise<DemuxerTrack[]> {
+    if (this._closed) {
+      throw new DOMException('Demuxer is closed', 'InvalidStateError');
+    }
+    if (typeof source !== 'string' && !(Number.isInteger(source) && source >= 0)) {
+      throw new DOMException('source must be a path or file descriptor', 'TypeError');
+    }
+    if (!native?.Demuxer) {
+      throw new DOMException('Native addon was built without libavformat', 'NotSupportedError');
+    }
+
+    if (!this._native) {
+      this._native = new native.Demuxer();
+    }
+
+    const tracks: any[] = await this._call((cb) => this._native.open(source, cb));
+    this._tracks = tracks.map((t) => toTrack(t));
+    return this._tracks;
+  }
+
+  /**
+   * Read up to maxPackets chunks in container order, from every track or
+   * only trackIndex. Resolves to [] at the end of the file.
+   */
+  async read(maxPackets: number = 64, trackIndex?: number): Promise<DemuxerPacket[]> {
+    this._checkOpen();
+    if (!Number.isInteger(maxPackets) || maxPackets < 1) {
+      throw new DOMException(`Invalid maxPackets: ${maxPackets}`, 'TypeError');
+    }
+
+    const packets: any[] = await this._call((cb) =>
+      this._native.read(maxPackets, trackIndex ?? -1, cb)
+    );
+
+    return packets.map((p) => {
+      const init = {
+        type: p.key ? 'key' as const : 'delta' as const,
+        timestamp: p.timestamp,
+        duration: p.duration > 0 ? p.duration : undefined,
+        data: p.data,
+      };
+      const track = this._tracks.find((t) => t.index === p.track);
+      return {
+        trackIndex: p.track,
+        chunk: track?.type === 'audio' ? new EncodedAudioChunk(init) : new EncodedVideoChunk(init),
+      };
+    });
+  }
+
+  /**
+   * Feed every remaining chunk of a video track into a configured decoder
+   * on the native side. Resolves with the number of chunks submitted once
+   * the end of the file is reached; call decoder.flush() to await the
+   * frames. Other tracks' packets are skipped.
+   */
+  async pipeTo(trackIndex: number, decoder: VideoDecoder): Promise<number> {
+    this._checkOpen();
+
+    const track = this._tracks.find((t) => t.index === trackIndex);
+    if (!track || track.type !== 'video') {
+      throw new DOMException(`Not a video track: ${trackIndex}`, 'TypeError');
+    }
+
+    const nativeDecoder = decoder._getAsyncNative();
+    if (!nativeDecoder) {
+      throw new DOMException('Decoder must be configured with useWorkerThread', 'InvalidStateError');
+    }
+
+    return this._call((cb) => this._native.pipeTo(trackIndex, nativeDecoder, cb));
+  }
+
+  /**
+   * Seek every track to the keyframe at or before timestamp (microseconds)
+   */
+  async seek(timestamp: number): Promise<void> {
+    this._checkOpen();
+    await this._call((cb) => this._native.seek(timestamp, cb));
+  }
+
+  close(): void {
+    if (this._closed) return;
+
+    if (this._native) {
+      this._native.close();
+    }
+    this._tracks = [];
+    this._closed = true;
+  }
+
+  private _checkOpen(): void {
+    if (this._closed) {
+      throw new DOMException('Demuxer is closed', 'InvalidStateError');
+    }
+    if (!this._native) {
+      throw new DOMException('Demuxer is not open', 'InvalidStateError');
+    }
+  }
+
+  private _call<T>(start: (cb: (err: Error | null, result: T) => void) => void): Promise<T> {
+    return new Promise((resolve, reject) => {
+      start((err, result) => {
+        if (err) {
+          reject(new DOMException(err.message, 'EncodingError'));
+        } else {
+          resolve(result);
+        }
+      });
+    });
+  }
+}
+
+function toTrack(t: any): DemuxerTrack {
+  const extradata: Uint8Array | undefined = t.extradata ? new Uint8Array(t.extradata) : undefined;
+  const codec = getCodecStringForStream({
+    codecName: t.codecName,
+    profile: t.profile,
+    level: t.level,
+    bitDepth: t.bitDepth,
+    extradata,
+  });
+  const duration = t.duration >= 0 ? t.duration : undefined;
+
+  if (t.type === 'video') {
+    return {
+      type: 'video',
+      index: t.index,
+      duration,
+      config: codec ? {
+        codec,
+        codedWidth: t.width,
+        codedHeight: t.height,
+        // Annex B streams (MPEG-TS) carry parameter sets in-band
+        description: extradata && extradata[0] === 1 ? extradata.buffer as ArrayBuffer : undefined,
+      } : null,
+    };
+  }
+
+  return {
+    type: 'audio',
+    index: t.index,
+    duration,
+    config: codec ? {
+      codec,
+      sampleRate: t.sampleRate,
+      numberOfChannels: t.numberOfChannels,
+      description: extradata ? extradata.buffer as ArrayBuffer : undefined,
+    } : null,
+  };
+}
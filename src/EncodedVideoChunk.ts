@@ -77,4 +77,12 @@ export class EncodedVideoChunk {
 
     dest.set(this._data);
   }
+
+  /**
+   * Internal: the chunk's bytes without a copy. Callers must not modify them.
+   * @internal
+   */
+  _getData(): Uint8Array {
+    return this._data;
+  }
 }
@@ -0,0 +1,94 @@
+/**
+ * FrameCache - Native LRU cache of decoded frames
+ *
+ * Not part of the WebCodecs spec. Attached to a VideoDecoder through the
+ * `frameCache` config option, it keeps the decoder's output frames (as
+ * references to the same buffers) keyed by timestamp, so scrubbing back to a
+ * recently shown frame needs no decoding at all. Bounded by bytes; the least
+ * recently used frames go first.
+ */
+
+import { VideoFrame } from './VideoFrame';
+import { DOMException } from './types';
+import { native } from './native';
+
+export interface FrameCacheInit {
+  /** Upper bound on the bytes of cached frame buffers */
+  maxBytes: number;
+
+  /**
+   * Store frames downscaled to this size, in their own smaller buffers.
+   * Both must be set; by default frames are kept at decoded size.
+   */
+  width?: number;
+  height?: number;
+}
+
+export interface FrameCacheStats {
+  frames: number;
+  bytes: number;
+  maxBytes: number;
+  hits: number;
+  misses: number;
+
+  /** hits / (hits + misses), 0 before any lookup */
+  hitRate: number;
+}
+
+/**
+ * @example
+ * ```ts
+ * const cache = new FrameCache({ maxBytes: 256 * 1024 * 1024 });
+ * decoder.configure({ ...config, frameCache: cache });
+ * await decoder.seek(t, chunks);   // decodes the GOP, caches its frames
+ * await decoder.seek(t2, chunks);  // a neighbour: served from the cache
+ * console.log(cache.stats.hitRate);
+ * ```
+ */
+export class FrameCache {
+  private _native: any;
+
+  constructor(init: FrameCacheInit) {
+    if (!init || !(init.maxBytes > 0)) {
+      throw new DOMException(`Invalid maxBytes: ${init?.maxBytes}`, 'TypeError');
+    }
+    if ((init.width === undefined) !== (init.height === undefined) ||
+        (init.width !== undefined && !(init.width > 0 && init.height! > 0))) {
+      throw new DOMException('width and height must both be positive', 'TypeError');
+    }
+    if (!native?.FrameCache) {
+      throw new DOMException('Native addon not available', 'NotSupportedError');
+    }
+
+    this._native = new native.FrameCache(init);
+  }
+
+  /**
+   * The cached frame at timestamp, or null. The VideoFrame shares the
+   * cache's buffers; close it when done. Counts toward the hit rate.
+   */
+  get(timestamp: number): VideoFrame | null {
+    const nativeFrame = this._native.get(timestamp);
+    return nativeFrame ? VideoFrame._adopt(nativeFrame, timestamp) : null;
+  }
+
+  /** Whether timestamp is cached, without touching recency or the hit rate */
+  has(timestamp: number): boolean {
+    return this._native.has(timestamp);
+  }
+
+  get stats(): FrameCacheStats {
+    const stats = this._native.stats();
+    const lookups = stats.hits + stats.misses;
+    return { ...stats, hitRate: lookups > 0 ? stats.hits / lookups : 0 };
+  }
+
+  clear(): void {
+    this._native.clear();
+  }
+
+  /** @internal Native cache for VideoDecoder.configure() */
+  _getNative(): any {
+    return this._native;
+  }
+}
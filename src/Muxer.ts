@@ -0,0 +1,322 @@
+/**
+ * Muxer - Native fragmented MP4 (CMAF) muxing
+ *
+ * Not part of the WebCodecs spec. Writes encoded chunks into an fMP4 stream
+ * on a native thread with libavformat: one init segment (ftyp+moov), then a
+ * moof+mdat fragment starting at each keyframe of track 0. Each segment is
+ * written in one piece, to a file descriptor or handed to the callback, with
+ * its timestamp and duration for HLS/DASH playlists.
+ *
+ * With attachEncoder(), a VideoEncoder's packets are muxed straight from its
+ * worker thread and never become JS objects.
+ *
+ * Only available when the addon was built against libavformat;
+ * Muxer.isSupported() reports whether it was.
+ */
+
+import { EncodedVideoChunk } from './EncodedVideoChunk';
+import { EncodedAudioChunk } from './EncodedAudioChunk';
+import { VideoEncoder } from './VideoEncoder';
+import { getFFmpegVideoDecoder, getFFmpegAudioDecoder } from './codec-registry';
+import { DOMException } from './types';
+import { native } from './native';
+
+export interface MuxerVideoTrack {
+  type: 'video';
+  codec: string;
+  width: number;
+  height: number;
+
+  /** avcC/hvcC etc.; otherwise taken from the first keyframe's decoderConfig */
+  description?: BufferSource;
+}
+
+export interface MuxerAudioTrack {
+  type: 'audio';
+  codec: string;
+  sampleRate: number;
+  numberOfChannels: number;
+  description?: BufferSource;
+}
+
+export type MuxerTrack = MuxerVideoTrack | MuxerAudioTrack;
+
+export interface MuxerConfig {
+  /** Track 0 sets the fragment boundaries and should be video */
+  tracks: MuxerTrack[];
+
+  /**
+   * Write segments to this file descriptor instead of passing their bytes
+   * to the output callback (which still reports their boundaries)
+   */
+  fd?: number;
+
+  /** Microseconds; shorter GOPs are merged into one fragment. Default 0 */
+  minFragmentDuration?: number;
+}
+
+/**
+ * An init segment or a fragment, in output order
+ */
+export interface MuxerSegment {
+  type: 'init' | 'fragment';
+
+  /** Start of the fragment in microseconds; 0 for the init segment */
+  timestamp: number;
+
+  /** Fragment duration in microseconds (track 0); 0 for the init segment */
+  duration: number;
+
+  byteLength: number;
+
+  /** Segment bytes; absent when writing to an fd */
+  data?: Uint8Array;
+}
+
+export interface MuxerInit {
+  output: (segment: MuxerSegment) => void;
+  error: (error: DOMException) => void;
+}
+
+/**
+ * Fragmented MP4 writer for encoder output.
+ *
+ * @example
+ * ```ts
+ * const muxer = new Muxer({ output: (s) => segments.push(s), error: console.error });
+ * muxer.configure({ tracks: [{ type: 'video', codec: 'avc1.42001f', width: 1280, height: 720 }] });
+ * muxer.attachEncoder(0, encoder);
+ * // ... encoder.encode(frame) ...
+ * await encoder.flush();
+ * await muxer.finalize();
+ * ```
+ */
+export class Muxer {
+  private _native: any = null;
+  private _outputCallback: (segment: MuxerSegment) => void;
+  private _errorCallback: (error: DOMException) => void;
+  private _tracks: MuxerTrack[] = [];
+  private _encoders: Map<number, VideoEncoder> = new Map();
+  private _described: Set<number> = new Set();  // Tracks with a codec description
+  private _state: 'unconfigured' | 'configured' | 'finalized' | 'closed' = 'unconfigured';
+
+  static isSupported(): boolean {
+    return !!native?.Muxer;
+  }
+
+  constructor(init: MuxerInit) {
+    if (!init || typeof init.output !== 'function') {
+      throw new DOMException('output callback is required', 'TypeError');
+    }
+    if (typeof init.error !== 'function') {
+      throw new DOMException('error callback is required', 'TypeError');
+    }
+
+    this._outputCallback = init.output;
+    this._errorCallback = init.error;
+  }
+
+  get state(): string {
+    return this._state;
+  }
+
+  configure(config: MuxerConfig): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Muxer is closed', 'InvalidStateError');
+    }
+    if (!config || !Array.isArray(config.tracks) || config.tracks.length === 0) {
+      throw new DOMException('At least one track is required', 'TypeError');
+    }
+    if (config.fd !== undefined && !(Number.isInteger(config.fd) && config.fd >= 0)) {
+      throw new DOMException(`Invalid fd: ${config.fd}`, 'TypeError');
+    }
+    if (!native?.Muxer) {
+      throw new DOMException('Native addon was built without libavformat', 'NotSupportedError');
+    }
+
+    const tracks = config.tracks.map((track) => {
+      const codec = track.type === 'video'
+        ? getFFmpegVideoDecoder(track.codec)
+        : getFFmpegAudioDecoder(track.codec);
+      if (!codec) {
+        throw new DOMException(`Unsupported codec: ${track.codec}`, 'NotSupportedError');
+      }
+      return {
+        ...track,
+        codec,
+        extradata: track.description ? toBuffer(track.description) : undefined,
+      };
+    });
+
+    if (!this._native) {
+      this._native = new native.Muxer(
+        this._onSegment.bind(this),
+        this._onError.bind(this)
+      );
+    }
+
+    this._detachEncoders();
+    this._native.configure({
+      tracks,
+      fd: config.fd,
+      minFragmentDuration: config.minFragmentDuration,
+    });
+    this._tracks = config.tracks;
+    this._described = new Set(
+      config.tracks.flatMap((track, i) => (track.description ? [i] : []))
+    );
+    this._state = 'configured';
+  }
+
+  /**
+   * Mux one chunk from JS. metadata is the encoder output's; its
+   * decoderConfig.description fills in the track's config if configure()
+   * didn't have it.
+   */
+  addChunk(
+    trackIndex: number,
+    chunk: EncodedVideoChunk | EncodedAudioChunk,
+    metadata?: { decoderConfig?: { description?: BufferSource } }
+  ): void {
+    this._checkConfigured();
+    if (!this._tracks[trackIndex]) {
+      throw new DOMException(`Invalid track: ${trackIndex}`, 'TypeError');
+    }
+
+    const description = metadata?.decoderConfig?.description;
+    if (description) {
+      this._described.add(trackIndex);
+    } else if (!this._described.has(trackIndex) && needsDescription(this._tracks[trackIndex].codec)) {
+      // Annex B chunks come without one; mp4 samples must be length-prefixed
+      throw new DOMException(
+        `Track ${trackIndex} needs an avcC/hvcC description: encode with avc: { format: 'avc' } ` +
+        "or hevc: { format: 'hevc' }, or pass it in configure()",
+        'NotSupportedError'
+      );
+    }
+
+    const data = new Uint8Array(chunk.byteLength);
+    chunk.copyTo(data);
+
+    this._native.write(
+      trackIndex,
+      Buffer.from(data.buffer, data.byteOffset, data.byteLength),
+      chunk.type === 'key',
+      chunk.timestamp,
+      chunk.duration ?? 0,
+      description ? toBuffer(description) : undefined
+    );
+  }
+
+  /**
+   * Mux an encoder's output natively from now on. Its output callback stops
+   * receiving chunks until finalize() or close(). The encoder must be
+   * configured with a single output and useWorkerThread.
+   */
+  attachEncoder(trackIndex: number, encoder: VideoEncoder): void {
+    this._checkConfigured();
+
+    const track = this._tracks[trackIndex];
+    if (!track || track.type !== 'video') {
+      throw new DOMException(`Not a video track: ${trackIndex}`, 'TypeError');
+    }
+
+    const nativeEncoder = encoder._getAsyncNative();
+    if (!nativeEncoder) {
+      throw new DOMException('Encoder must be configured with useWorkerThread', 'InvalidStateError');
+    }
+    // Annex B output opens without a global header: no avcC/hvcC for the moov
+    if (encoder._isAnnexB()) {
+      throw new DOMException(
+        "H.264/HEVC encoders must be configured with avc: { format: 'avc' } or hevc: { format: 'hevc' }",
+        'NotSupportedError'
+      );
+    }
+
+    nativeEncoder.attachMuxer(this._native, trackIndex);
+    this._encoders.set(trackIndex, encoder);
+  }
+
+  /**
+   * Write the last fragment. Flush attached encoders first: packets they
+   * produce after this are dropped. Attached encoders are detached.
+   */
+  async finalize(): Promise<void> {
+    this._checkConfigured();
+    this._state = 'finalized';
+
+    await new Promise<void>((resolve, reject) => {
+      this._native.finalize((err: Error | null) => {
+        if (err) {
+          reject(new DOMException(err.message, 'EncodingError'));
+        } else {
+          resolve();
+        }
+      });
+    });
+    this._detachEncoders();
+  }
+
+  close(): void {
+    if (this._state === 'closed') return;
+
+    this._detachEncoders();
+    if (this._native) {
+      this._native.close();
+    }
+    this._state = 'closed';
+  }
+
+  private _checkConfigured(): void {
+    if (this._state !== 'configured') {
+      throw new DOMException(`Muxer is ${this._state}`, 'InvalidStateError');
+    }
+  }
+
+  private _detachEncoders(): void {
+    for (const encoder of this._encoders.values()) {
+      encoder._getAsyncNative()?.attachMuxer(null, 0);
+    }
+    this._encoders.clear();
+  }
+
+  private _onSegment(
+    type: 'init' | 'fragment',
+    timestamp: number,
+    duration: number,
+    byteLength: number,
+    data?: Buffer
+  ): void {
+    try {
+      this._outputCallback({
+        type,
+        timestamp,
+        duration,
+        byteLength,
+        data: data ? new Uint8Array(data) : undefined,
+      });
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+
+  private _onError(message: string): void {
+    try {
+      this._errorCallback(new DOMException(message, 'EncodingError'));
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+}
+
+function toBuffer(source: BufferSource): Buffer {
+  if (source instanceof ArrayBuffer) {
+    return Buffer.from(source);
+  }
+  return Buffer.from(source.buffer, source.byteOffset, source.byteLength);
+}
+
+// H.264/HEVC in mp4 need an avcC/hvcC and length-prefixed samples
+function needsDescription(codec: string): boolean {
+  return /^(avc[13]|hvc1|hev1)\./.test(codec);
+}
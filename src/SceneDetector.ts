@@ -0,0 +1,98 @@
+/**
+ * SceneDetector - Native scene-change and duplicate-frame detection
+ *
+ * Not part of the WebCodecs spec. Scores each frame against the previous
+ * one from a single native pass over its luma plane (block means plus a
+ * histogram), fast enough to run on every frame at ingest rate: for
+ * chaptering, keyframe placement, or dropping static screen-capture frames.
+ * The same kernel runs inside VideoEncoder through its `sceneDetection`
+ * option.
+ */
+
+import { VideoFrame } from './VideoFrame';
+import { DOMException } from './types';
+import { native } from './native';
+
+export interface SceneDetectorOptions {
+  /**
+   * Mean luma difference (0-1) a frame must jump by to be a scene change.
+   * The jump is measured against the previous frame's own difference, so
+   * sustained fast motion is not a run of cuts. Default 0.1
+   */
+  sceneThreshold?: number;
+
+  /** Luma histogram distance (0-1) a scene change also needs. Default 0.2 */
+  histogramThreshold?: number;
+
+  /**
+   * Largest block difference (0-1) a frame may have and still be a
+   * duplicate. Default 0: every block mean unchanged
+   */
+  duplicateThreshold?: number;
+}
+
+export interface SceneScore {
+  /** Mean absolute difference of the downsampled luma, 0-1 */
+  difference: number;
+  /** Largest difference of any one block, 0-1 */
+  blockDifference: number;
+  /** Half the L1 distance between the luma histograms, 0-1 */
+  histogramDistance: number;
+  sceneChange: boolean;
+  duplicate: boolean;
+}
+
+/**
+ * The first frame, the first after reset(), and the first after a size
+ * change score 1 and report a scene change.
+ *
+ * @example
+ * ```ts
+ * const detector = new SceneDetector();
+ * decoder = new VideoDecoder({
+ *   output: (frame) => {
+ *     if (detector.analyze(frame).sceneChange) chapters.push(frame.timestamp);
+ *     frame.close();
+ *   },
+ *   error: console.error,
+ * });
+ * ```
+ */
+export class SceneDetector {
+  private _native: any;
+
+  constructor(options: SceneDetectorOptions = {}) {
+    validateSceneOptions(options);
+    if (!native?.SceneDetector) {
+      throw new DOMException('Native addon not available', 'NotSupportedError');
+    }
+
+    this._native = new native.SceneDetector(options);
+  }
+
+  /** Score frame against the previously analyzed one, which it then replaces */
+  analyze(frame: VideoFrame): SceneScore {
+    const nativeFrame = frame._getNative();
+    try {
+      return this._native.analyze(nativeFrame);
+    } catch (e: any) {
+      // Hardware-surface frames have no readable luma plane
+      throw new DOMException(e.message, 'NotSupportedError');
+    }
+  }
+
+  /** Forget the previous frame, e.g. after seeking */
+  reset(): void {
+    this._native.reset();
+  }
+}
+
+/** Range checks shared with VideoEncoderConfig.sceneDetection */
+export function validateSceneOptions(options: SceneDetectorOptions): void {
+  for (const key of ['sceneThreshold', 'histogramThreshold', 'duplicateThreshold'] as const) {
+    const value = options[key];
+    if (value !== undefined && !(typeof value === 'number' && value >= 0 && value <= 1)) {
+      throw new DOMException(`Invalid ${key}: ${value}. Must be between 0 and 1.`, 'TypeError');
+    }
+  }
+}
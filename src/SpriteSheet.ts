@@ -0,0 +1,150 @@
+/**
+ * SpriteSheet - Tiles thumbnails into a single frame
+ *
+ * Not part of the WebCodecs spec. Each added frame is downscaled in native
+ * code straight into its tile of one sheet frame, with no intermediate
+ * thumbnail VideoFrame. Combined with VideoDecoder's keyframesOnly option
+ * this builds scrubbing sprites without decoding delta frames.
+ */
+
+import { VideoFrame } from './VideoFrame';
+import { DOMException } from './types';
+import { native } from './native';
+
+export interface SpriteSheetInit {
+  columns: number;
+  rows: number;
+  tileWidth: number;
+  tileHeight: number;
+
+  /** Pixel format of the sheet. Default 'I420' (tile sizes must be even) */
+  format?: string;
+}
+
+/**
+ * Where a frame was drawn on the sheet, in pixels
+ */
+export interface SpriteTile {
+  index: number;
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+  timestamp: number;
+}
+
+/**
+ * @example
+ * ```ts
+ * const sheet = new SpriteSheet({ columns: 10, rows: 10, tileWidth: 160, tileHeight: 90 });
+ * const decoder = new VideoDecoder({
+ *   output: (frame) => { sheet.add(frame); frame.close(); },
+ *   error: console.error,
+ * });
+ * decoder.configure({ ...config, keyframesOnly: true });
+ * // ... decode, flush ...
+ * const image = sheet.toVideoFrame();
+ * ```
+ */
+export class SpriteSheet {
+  private _native: any;
+  private _init: Required<SpriteSheetInit>;
+  private _tiles: SpriteTile[] = [];
+  private _closed: boolean = false;
+
+  constructor(init: SpriteSheetInit) {
+    for (const key of ['columns', 'rows', 'tileWidth', 'tileHeight'] as const) {
+      if (!Number.isInteger(init?.[key]) || init[key] <= 0) {
+        throw new DOMException(`Invalid ${key}: ${init?.[key]}`, 'TypeError');
+      }
+    }
+    if (!native?.SpriteSheet) {
+      throw new DOMException('Native addon not available', 'NotSupportedError');
+    }
+
+    this._init = { format: 'I420', ...init };
+    try {
+      this._native = new native.SpriteSheet(this._init);
+    } catch (e: any) {
+      throw new DOMException(e.message, 'TypeError');
+    }
+  }
+
+  get width(): number {
+    return this._init.columns * this._init.tileWidth;
+  }
+
+  get height(): number {
+    return this._init.rows * this._init.tileHeight;
+  }
+
+  /** Number of tiles */
+  get capacity(): number {
+    return this._init.columns * this._init.rows;
+  }
+
+  /** Tiles drawn so far, in order */
+  get tiles(): readonly SpriteTile[] {
+    return this._tiles;
+  }
+
+  get full(): boolean {
+    return this._tiles.length >= this.capacity;
+  }
+
+  /**
+   * Draw frame into the next free tile (row-major) and return its position.
+   * The frame isn't closed.
+   */
+  add(frame: VideoFrame): SpriteTile {
+    this._checkOpen();
+    if (this.full) {
+      throw new DOMException('SpriteSheet is full', 'InvalidStateError');
+    }
+
+    const index = this._tiles.length;
+    this._native.draw(frame._getNative(), index);
+
+    const tile: SpriteTile = {
+      index,
+      x: (index % this._init.columns) * this._init.tileWidth,
+      y: Math.floor(index / this._init.columns) * this._init.tileHeight,
+      width: this._init.tileWidth,
+      height: this._init.tileHeight,
+      timestamp: frame.timestamp,
+    };
+    this._tiles.push(tile);
+    return tile;
+  }
+
+  /**
+   * Snapshot of the sheet as a VideoFrame. It shares memory with the sheet;
+   * the next add() or clear() copies the sheet first, so the snapshot never
+   * changes. Close it when done.
+   */
+  toVideoFrame(timestamp: number = this._tiles[0]?.timestamp ?? 0): VideoFrame {
+    this._checkOpen();
+    return VideoFrame._adopt(this._native.toFrame(), timestamp);
+  }
+
+  /** Blank every tile and start again from the first */
+  clear(): void {
+    this._checkOpen();
+    this._native.clear();
+    this._tiles = [];
+  }
+
+  close(): void {
+    if (this._closed) return;
+
+    this._native.close();
+    this._tiles = [];
+    this._closed = true;
+  }
+
+  private _checkOpen(): void {
+    if (this._closed) {
+      throw new DOMException('SpriteSheet is closed', 'InvalidStateError');
+    }
+  }
+}
@@ -0,0 +1,126 @@
+/**
+ * SvcLayerFilter - Forwards or drops temporal layers of encoded chunks
+ *
+ * Not part of the WebCodecs spec. Meant for relays (SFUs) that thin a
+ * temporally scalable VP9/AV1 stream per receiver: each chunk's temporal
+ * layer is read from its headers in native code, without decoding and
+ * without allocating.
+ */
+
+import { EncodedVideoChunk } from './EncodedVideoChunk';
+import { parseScalabilityMode } from './codec-registry';
+import { DOMException } from './types';
+import { native } from './native';
+
+export interface SvcLayerFilterInit {
+  /** Codec string of the stream (vp09.* or av01.*) */
+  codec: string;
+
+  /** Scalability mode the stream was encoded with, e.g. 'L1T3' */
+  scalabilityMode: string;
+
+  /** Highest temporal layer to forward. Defaults to all layers. */
+  maxTemporalLayer?: number;
+}
+
+type ChunkData = Uint8Array | EncodedVideoChunk;
+
+/**
+ * Per-receiver temporal layer filter.
+ *
+ * VP9 carries no temporal id in its bitstream, so layers are inferred from
+ * which reference buffers each frame refreshes; this matches streams from
+ * this library's encoders (and libvpx's layer patterns generally). AV1 uses
+ * the OBU extension header's temporal_id. Chunks the parser can't read are
+ * forwarded.
+ *
+ * @example
+ * ```ts
+ * const filter = new SvcLayerFilter({ codec: 'vp09.00.10.08', scalabilityMode: 'L1T3' });
+ * filter.maxTemporalLayer = 1;  // Half frame rate for a congested receiver
+ * if (filter.filter(chunk)) send(chunk);
+ * ```
+ */
+export class SvcLayerFilter {
+  private _native: any;
+  private _temporalLayers: number;
+
+  constructor(init: SvcLayerFilterInit) {
+    let bitstream: string;
+    if (init.codec.startsWith('vp09')) {
+      bitstream = 'vp9';
+    } else if (init.codec.startsWith('av01')) {
+      bitstream = 'av1';
+    } else {
+      throw new DOMException(`SvcLayerFilter supports VP9 and AV1, got: ${init.codec}`, 'NotSupportedError');
+    }
+
+    const mode = parseScalabilityMode(init.scalabilityMode);
+    if (!mode) {
+      throw new DOMException(`Invalid scalabilityMode: ${init.scalabilityMode}`, 'TypeError');
+    }
+
+    if (!native?.SvcLayerFilter) {
+      throw new DOMException('Native addon not available', 'NotSupportedError');
+    }
+
+    try {
+      this._native = new native.SvcLayerFilter(bitstream, init.scalabilityMode);
+    } catch (e: any) {
+      throw new DOMException(e.message, 'NotSupportedError');
+    }
+    this._temporalLayers = mode.temporalLayers;
+
+    if (init.maxTemporalLayer !== undefined) {
+      this.maxTemporalLayer = init.maxTemporalLayer;
+    }
+  }
+
+  /** Number of temporal layers in the stream */
+  get temporalLayers(): number {
+    return this._temporalLayers;
+  }
+
+  /** Highest temporal layer forwarded; change it at any time */
+  get maxTemporalLayer(): number {
+    return this._native.maxTemporalLayer;
+  }
+
+  set maxTemporalLayer(layer: number) {
+    if (!Number.isInteger(layer) || layer < 0 || layer >= this._temporalLayers) {
+      throw new DOMException(
+        `maxTemporalLayer must be an integer in [0, ${this._temporalLayers - 1}]`,
+        'TypeError'
+      );
+    }
+    this._native.maxTemporalLayer = layer;
+  }
+
+  /**
+   * Temporal layer of a chunk, or -1 if its headers can't be parsed
+   */
+  temporalLayerOf(chunk: ChunkData): number {
+    return this._native.temporalLayerOf(SvcLayerFilter._bytes(chunk));
+  }
+
+  /**
+   * True if the chunk should be forwarded
+   */
+  filter(chunk: ChunkData): boolean {
+    return this._native.filter(SvcLayerFilter._bytes(chunk));
+  }
+
+  /**
+   * Classifies a batch in one native call. Writes each chunk's temporal
+   * layer into `layers` (allocated if omitted; -1 = unparseable) and
+   * returns how many chunks to forward. Chunk i is forwarded when
+   * `layers[i] <= maxTemporalLayer`.
+   */
+  filterBatch(chunks: Uint8Array[], layers: Int8Array = new Int8Array(chunks.length)): number {
+    return this._native.filterBatch(chunks, layers);
+  }
+
+  private static _bytes(chunk: ChunkData): Uint8Array {
+    return chunk instanceof EncodedVideoChunk ? chunk._getData() : chunk;
+  }
+}
@@ -0,0 +1,198 @@
+/**
+ * VideoBatchDecoder - GOP-parallel decoding of whole chunk lists
+ *
+ * Not part of the WebCodecs spec. For offline analysis where only
+ * throughput matters: each decode() call splits its chunks at keyframes and
+ * decodes the resulting ranges concurrently on several native codec
+ * contexts. Frames are delivered in order, range by range.
+ *
+ * Output order equals presentation order for closed-GOP streams (all
+ * WebCodecs encoders here produce them). With open GOPs, leading frames
+ * that reference the previous range may be dropped by the decoder.
+ */
+
+import { VideoFrame } from './VideoFrame';
+import { EncodedVideoChunk } from './EncodedVideoChunk';
+import { isVideoCodecSupported, getFFmpegVideoDecoder } from './codec-registry';
+import { CodecState, DOMException, BufferSource } from './types';
+import { native } from './native';
+
+export interface VideoBatchDecoderConfig {
+  codec: string;
+  codedWidth?: number;
+  codedHeight?: number;
+  description?: BufferSource;  // Codec-specific data (e.g., AVCC for H.264)
+
+  /**
+   * Ranges decoded at once, each on its own codec context. Defaults to one
+   * per two cores of the CPU budget.
+   */
+  concurrency?: number;
+
+  /**
+   * Maximum ranges decoded ahead of the one being delivered. Bounds the
+   * decoded frames held in memory while an earlier range finishes.
+   * Defaults to 2 x concurrency.
+   */
+  reorderWindow?: number;
+}
+
+export interface VideoBatchDecoderInit {
+  output: (frame: VideoFrame) => void;
+  error: (error: DOMException) => void;
+}
+
+/**
+ * Decodes lists of chunks in parallel keyframe-delimited ranges.
+ *
+ * @example
+ * ```ts
+ * const decoder = new VideoBatchDecoder({
+ *   output: (frame) => { analyze(frame); frame.close(); },
+ *   error: (err) => console.error(err),
+ * });
+ * decoder.configure({ codec: 'avc1.640028', description: avcC });
+ * await decoder.decode(allChunks);
+ * decoder.close();
+ * ```
+ */
+export class VideoBatchDecoder {
+  private _native: any = null;
+  private _state: CodecState = 'unconfigured';
+  private _outputCallback: (frame: VideoFrame) => void;
+  private _errorCallback: (error: DOMException) => void;
+
+  constructor(init: VideoBatchDecoderInit) {
+    if (!init.output || typeof init.output !== 'function') {
+      throw new TypeError('output callback is required');
+    }
+    if (!init.error || typeof init.error !== 'function') {
+      throw new TypeError('error callback is required');
+    }
+
+    this._outputCallback = init.output;
+    this._errorCallback = init.error;
+  }
+
+  get state(): CodecState {
+    return this._state;
+  }
+
+  configure(config: VideoBatchDecoderConfig): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Decoder is closed', 'InvalidStateError');
+    }
+
+    if (!isVideoCodecSupported(config.codec)) {
+      throw new DOMException(`Unsupported codec: ${config.codec}`, 'NotSupportedError');
+    }
+
+    for (const key of ['concurrency', 'reorderWindow'] as const) {
+      const value = config[key];
+      if (value !== undefined && (!Number.isInteger(value) || value < 1)) {
+        throw new DOMException(`Invalid ${key}: ${value}`, 'TypeError');
+      }
+    }
+
+    if (!native?.VideoBatchDecoder) {
+      throw new DOMException('Native addon not available', 'NotSupportedError');
+    }
+
+    if (!this._native) {
+      this._native = new native.VideoBatchDecoder(
+        this._onFrame.bind(this),
+        this._onError.bind(this)
+      );
+    }
+
+    const codecParams: any = { codec: getFFmpegVideoDecoder(config.codec) };
+    if (config.codedWidth) codecParams.width = config.codedWidth;
+    if (config.codedHeight) codecParams.height = config.codedHeight;
+    if (config.concurrency) codecParams.concurrency = config.concurrency;
+    if (config.reorderWindow) codecParams.reorderWindow = config.reorderWindow;
+
+    if (config.description) {
+      let desc: Uint8Array;
+      if (config.description instanceof ArrayBuffer) {
+        desc = new Uint8Array(config.description);
+      } else {
+        desc = new Uint8Array(
+          (config.description as ArrayBufferView).buffer,
+          (config.description as ArrayBufferView).byteOffset,
+          (config.description as ArrayBufferView).byteLength
+        );
+      }
+      codecParams.extradata = Buffer.from(desc);
+    }
+
+    this._native.configure(codecParams);
+    this._state = 'configured';
+  }
+
+  /**
+   * Decode a list of chunks in decode order. Resolves once every frame
+   * has been output. Chunks before the first keyframe are skipped.
+   */
+  async decode(chunks: EncodedVideoChunk[]): Promise<void> {
+    if (this._state !== 'configured') {
+      throw new DOMException('Decoder is not configured', 'InvalidStateError');
+    }
+
+    const packets = chunks.map((chunk) => {
+      const data = chunk._getData();
+      return {
+        data: Buffer.from(data.buffer, data.byteOffset, data.byteLength),
+        key: chunk.type === 'key',
+        timestamp: chunk.timestamp,
+        duration: chunk.duration ?? 0,
+      };
+    });
+
+    return new Promise((resolve, reject) => {
+      this._native.decode(packets, (err: Error | null) => {
+        if (err) {
+          reject(new DOMException(err.message, 'EncodingError'));
+        } else {
+          resolve();
+        }
+      });
+    });
+  }
+
+  reset(): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Decoder is closed', 'InvalidStateError');
+    }
+
+    if (this._native) {
+      this._native.reset();
+    }
+    this._state = 'unconfigured';
+  }
+
+  close(): void {
+    if (this._state === 'closed') return;
+
+    if (this._native) {
+      this._native.close();
+    }
+    this._state = 'closed';
+  }
+
+  private _onFrame(nativeFrame: any, timestamp: number, duration: number): void {
+    try {
+      const frame = VideoFrame._adopt(nativeFrame, timestamp, duration > 0 ? duration : undefined);
+      this._outputCallback(frame);
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+
+  private _onError(message: string): void {
+    try {
+      this._errorCallback(new DOMException(message, 'EncodingError') as any);
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+}
@@ -3,10 +3,86 @@
  * Implements the W3C WebCodecs VideoDecoder interface
  */
 
-import { VideoFrame } from './VideoFrame';
+import { VideoFrame, VideoPixelFormat } from './VideoFrame';
 import { EncodedVideoChunk } from './EncodedVideoChunk';
 import { isVideoCodecSupported, getFFmpegVideoDecoder, parseAvcCodecString } from './codec-registry';
 import { CodecState, DOMException, BufferSource } from './types';
+import { FrameCache } from './FrameCache';
+
+/**
+ * How much of a picture's reconstruction a decoder may skip, from nothing
+ * ('none') to every picture ('all'). Mirrors FFmpeg's AVDiscard.
+ */
+export type DecoderDiscard = 'none' | 'default' | 'nonref' | 'bidir' | 'nonintra' | 'nonkey' | 'all';
+
+const DISCARD_VALUES: DecoderDiscard[] = ['none', 'default', 'nonref', 'bidir', 'nonintra', 'nonkey', 'all'];
+
+/**
+ * Per-instance decoder tuning (non-standard): trade output quality for
+ * decode speed in previews and analytics. Options the selected decoder
+ * can't honour make configure() throw instead of being ignored.
+ */
+export interface VideoDecoderOptions {
+  /** Decode at 1/2^lowres resolution (0-3). MJPEG and H.263/MPEG-4 family only */
+  lowres?: number;
+  /** Skip the in-loop deblocking filter for these pictures. H.264/HEVC only */
+  skipLoopFilter?: DecoderDiscard;
+  /** Skip the inverse transform for these pictures. H.264/HEVC only */
+  skipIdct?: DecoderDiscard;
+  /** Decoder thread count, 0 = auto. Overrides the CPU-budget default */
+  threads?: number;
+  /** libdav1d frame threads, 0 = auto */
+  frameThreads?: number;
+  /** libdav1d maximum frame delay (1 = no frame threading latency), 0 = auto */
+  maxFrameDelay?: number;
+}
+
+function validateDecoderOptions(options: VideoDecoderOptions): void {
+  if (typeof options !== 'object' || options === null) {
+    throw new DOMException('decoderOptions must be an object', 'TypeError');
+  }
+
+  const ranges: [keyof VideoDecoderOptions, number, number][] = [
+    ['lowres', 0, 3],
+    ['threads', 0, 64],
+    ['frameThreads', 0, 256],
+    ['maxFrameDelay', 0, 256],
+  ];
+  for (const [key, min, max] of ranges) {
+    const value = options[key];
+    if (value !== undefined && (!Number.isInteger(value) || (value as number) < min || (value as number) > max)) {
+      throw new DOMException(`Invalid decoderOptions.${key}: ${value}`, 'TypeError');
+    }
+  }
+
+  for (const key of ['skipLoopFilter', 'skipIdct'] as const) {
+    const value = options[key];
+    if (value !== undefined && !DISCARD_VALUES.includes(value)) {
+      throw new DOMException(`Invalid decoderOptions.${key}: ${value}`, 'TypeError');
+    }
+  }
+}
+
+/**
+ * Thresholds for adaptive frame dropping. Pressure is the larger of
+ * queueDepth and lag ratios; at 1x non-reference frames are skipped, at 2x
+ * everything but keyframes. Full decoding resumes once pressure falls
+ * below 0.5x (from non-key skipping, at the next keyframe).
+ */
+export interface VideoDecoderAdaptiveDrop {
+  /** Chunks waiting behind the one being decoded */
+  queueDepth?: number;
+  /** Microseconds between the newest queued chunk and the last output frame */
+  maxLag?: number;
+}
+
+export interface VideoDecoderDropStats {
+  mode: 'full' | 'nonref' | 'nonkey';
+  /** Chunks decoded or dropped without producing a frame */
+  droppedFrames: number;
+}
+
+const DROP_MODES: VideoDecoderDropStats['mode'][] = ['full', 'nonref', 'nonkey'];
 
 export interface VideoDecoderConfig {
   codec: string;
@@ -23,6 +99,52 @@ export interface VideoDecoderConfig {
   hardwareAcceleration?: 'no-preference' | 'prefer-hardware' | 'prefer-software';
   optimizeForLatency?: boolean;
   description?: BufferSource;  // Codec-specific data (e.g., AVCC for H.264)
+  /**
+   * Decode only keyframes (non-standard), for thumbnails and sprite sheets.
+   * Delta chunks are dropped in decode() without being copied, and the
+   * codec skips non-key pictures, so long-GOP content decodes a small
+   * fraction of its frames. Pair with SpriteSheet to tile the output.
+   */
+  keyframesOnly?: boolean;
+  /**
+   * Cache every decoded frame here (non-standard), including the frames
+   * seek() decodes and discards. seek() checks it before decoding anything.
+   * One cache can serve several decoders. Requires useWorkerThread.
+   */
+  frameCache?: FrameCache;
+  /**
+   * Speed/quality tuning for this instance (non-standard); see
+   * VideoDecoderOptions. Validated in configure().
+   */
+  decoderOptions?: VideoDecoderOptions;
+  /**
+   * Realtime load shedding (non-standard): when the decoder falls behind,
+   * skip non-reference frames, then all delta frames, rather than build
+   * latency. See dropStats. Ignored with keyframesOnly. Requires
+   * useWorkerThread.
+   */
+  adaptiveDrop?: VideoDecoderAdaptiveDrop;
+  /**
+   * Convert every output frame to this pixel format on the decoder's
+   * worker thread (non-standard), e.g. 'RGBA' for consumers that would
+   * otherwise copyTo({ format: 'RGBA' }) each frame on the event loop.
+   * Requires useWorkerThread.
+   */
+  outputFormat?: VideoPixelFormat;
+  /**
+   * Have the codec attach its motion vectors and QP tables to each output
+   * frame (non-standard); read them with frame.codecAnalysis or aggregate
+   * with frame.motionGrid(). H.264 and MPEG decoders export vectors. Frames
+   * resized by outputWidth/outputHeight (or a downscaling frameCache) keep
+   * only pictType, since the vectors and QP blocks would no longer line up.
+   */
+  exportCodecAnalysis?: boolean;
+  /**
+   * Scale every output frame to this size on the worker (non-standard).
+   * Set both or neither. Requires useWorkerThread.
+   */
+  outputWidth?: number;
+  outputHeight?: number;
   /**
    * Use async (non-blocking) decoder. Defaults to true.
    * Set to false to use synchronous decoder (blocks event loop during decoding).
@@ -113,6 +235,19 @@ export class VideoDecoder {
     return this._decodeQueueSize;
   }
 
+  /**
+   * Current adaptiveDrop mode and frames dropped so far (non-standard).
+   * Drops are final for frames the codec skipped; a drained flush() settles
+   * the count for frames still in flight.
+   */
+  get dropStats(): VideoDecoderDropStats {
+    if (!this._useAsync || !this._native?.getDropStats) {
+      return { mode: 'full', droppedFrames: 0 };
+    }
+    const stats = this._native.getDropStats();
+    return { mode: DROP_MODES[stats.level] ?? 'full', droppedFrames: stats.droppedFrames };
+  }
+
   /**
    * Event handler for dequeue events
    */
@@ -191,6 +326,27 @@ export class VideoDecoder {
       throw new DOMException(`Unsupported codec: ${config.codec}`, 'NotSupportedError');
     }
 
+    if (config.decoderOptions !== undefined) {
+      validateDecoderOptions(config.decoderOptions);
+    }
+    if ((config.outputWidth === undefined) !== (config.outputHeight === undefined) ||
+        (config.outputWidth !== undefined &&
+         !(Number.isInteger(config.outputWidth) && config.outputWidth > 0 &&
+           Number.isInteger(config.outputHeight) && config.outputHeight! > 0))) {
+      throw new DOMException('outputWidth and outputHeight must both be positive integers', 'TypeError');
+    }
+    if (config.adaptiveDrop !== undefined) {
+      const { queueDepth, maxLag } = config.adaptiveDrop ?? {};
+      for (const [key, value] of [['queueDepth', queueDepth], ['maxLag', maxLag]] as const) {
+        if (value !== undefined && !(Number.isInteger(value) && value > 0)) {
+          throw new DOMException(`Invalid adaptiveDrop.${key}: ${value}`, 'TypeError');
+        }
+      }
+      if (queueDepth === undefined && maxLag === undefined) {
+        throw new DOMException('adaptiveDrop needs queueDepth or maxLag', 'TypeError');
+      }
+    }
+
     if (!native) {
       throw new DOMException('Native addon not available', 'NotSupportedError');
     }
@@ -199,6 +355,11 @@ export class VideoDecoder {
     // Default to async unless explicitly disabled
     this._useAsync = config.useWorkerThread !== false && !!native.VideoDecoderAsync;
 
+    const convertsOutput = config.outputFormat !== undefined || config.outputWidth !== undefined;
+    if (convertsOutput && !this._useAsync) {
+      throw new DOMException('outputFormat/outputWidth/outputHeight require useWorkerThread', 'NotSupportedError');
+    }
+
     // Create native decoder if not already created
     if (!this._nativeCreated) {
       if (this._useAsync) {
@@ -230,6 +391,15 @@ export class VideoDecoder {
     if (config.codedWidth) codecParams.width = config.codedWidth;
     if (config.codedHeight) codecParams.height = config.codedHeight;
     if (config.optimizeForLatency) codecParams.optimizeForLatency = true;
+    if (config.keyframesOnly) codecParams.keyframesOnly = true;
+    if (config.exportCodecAnalysis) codecParams.exportCodecAnalysis = true;
+    if (config.decoderOptions) codecParams.decoderOptions = { ...config.decoderOptions };
+    if (config.adaptiveDrop) codecParams.adaptiveDrop = { ...config.adaptiveDrop };
+    if (config.outputFormat) codecParams.outputFormat = config.outputFormat;
+    if (config.outputWidth) {
+      codecParams.outputWidth = config.outputWidth;
+      codecParams.outputHeight = config.outputHeight;
+    }
 
     if (config.description) {
       // Convert BufferSource to Buffer
@@ -246,7 +416,18 @@ export class VideoDecoder {
       codecParams.extradata = Buffer.from(desc);
     }
 
-    this._native.configure(codecParams);
+    try {
+      this._native.configure(codecParams);
+    } catch (e: any) {
+      // Options the decoder can't honour; anything else propagates as before
+      if (e?.code === 'ERR_DECODER_OPTIONS') {
+        throw new DOMException(e.message, 'NotSupportedError');
+      }
+      throw e;
+    }
+    if (this._useAsync) {
+      this._native.attachCache(config.frameCache?._getNative() ?? null);
+    }
     this._config = config;
     this._state = 'configured';
   }
@@ -256,6 +437,10 @@ export class VideoDecoder {
       throw new DOMException('Decoder is not configured', 'InvalidStateError');
     }
 
+    if (this._config?.keyframesOnly && chunk.type !== 'key') {
+      return;
+    }
+
     const data = new Uint8Array(chunk.byteLength);
     chunk.copyTo(data);
 
@@ -321,6 +506,69 @@ export class VideoDecoder {
     this._config = null;
   }
 
+  /**
+   * Frame-accurate seek (non-standard). `chunks` is the stream's chunk index
+   * in decode order; only its timestamps and key flags are scanned here.
+   * The chunks from the keyframe at or before `timestamp` up to the next
+   * keyframe are decoded on the worker thread, intermediate frames are
+   * discarded there, and only the frame presented at `timestamp` (the last
+   * one at or before it) reaches the output callback.
+   *
+   * Runs in order with queued decode() calls. The codec is reset afterwards,
+   * so decoding resumes at a keyframe. Resolves false if no frame came out.
+   * With a frameCache holding that frame, nothing is decoded (and the frame
+   * has the cache's size). Requires useWorkerThread.
+   */
+  async seek(timestamp: number, chunks: readonly EncodedVideoChunk[]): Promise<boolean> {
+    if (this._state !== 'configured') {
+      throw new DOMException('Decoder is not configured', 'InvalidStateError');
+    }
+    if (!this._useAsync) {
+      throw new DOMException('seek() requires useWorkerThread', 'NotSupportedError');
+    }
+
+    // Chunk timestamps are presentation times, so the frame shown at
+    // timestamp is the latest chunk at or before it; that's the cache key
+    let start = -1;
+    let shown = -Infinity;
+    for (let i = 0; i < chunks.length; i++) {
+      const t = chunks[i].timestamp;
+      if (t > timestamp) continue;
+      if (chunks[i].type === 'key') start = i;
+      if (t > shown) shown = t;
+    }
+    if (start < 0) {
+      return false;
+    }
+
+    let end = start + 1;
+    while (end < chunks.length && chunks[end].type !== 'key') end++;
+
+    const run = chunks.slice(start, end).map((chunk) => {
+      const data = Buffer.alloc(chunk.byteLength);
+      chunk.copyTo(data);
+      return { data, key: chunk.type === 'key', timestamp: chunk.timestamp, duration: chunk.duration ?? 0 };
+    });
+
+    return new Promise((resolve, reject) => {
+      this._native.seek(shown, run, (err: Error | null, found: boolean) => {
+        if (err) {
+          reject(new DOMException(err.message, 'EncodingError'));
+        } else {
+          resolve(found);
+        }
+      });
+    });
+  }
+
+  /**
+   * @internal Worker-thread native decoder, for native producers such as
+   * Demuxer.pipeTo(); null when not configured or running synchronously
+   */
+  _getAsyncNative(): any | null {
+    return this._state === 'configured' && this._useAsync ? this._native : null;
+  }
+
   private _onFrame(nativeFrame: any, timestamp: number, duration: number): void {
     // Output frames are delivered asynchronously
     // Queue size management and dequeue events are handled in decode()
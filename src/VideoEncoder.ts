@@ -3,11 +3,20 @@
  * Implements the W3C WebCodecs VideoEncoder interface
  */
 
-import { VideoFrame } from './VideoFrame';
+import { VideoFrame, VideoPixelFormat } from './VideoFrame';
 import { EncodedVideoChunk, EncodedVideoChunkType } from './EncodedVideoChunk';
-import { isVideoCodecSupported, getFFmpegVideoCodec, parseAvcCodecString } from './codec-registry';
+import {
+  isVideoCodecSupported,
+  getFFmpegVideoCodec,
+  parseAvcCodecString,
+  parseVp9CodecString,
+  parseAv1CodecString,
+  parseHevcCodecString,
+  parseScalabilityMode,
+} from './codec-registry';
 import { CodecState, DOMException } from './types';
 import { VideoColorSpaceInit } from './VideoColorSpace';
+import { SceneDetectorOptions, validateSceneOptions } from './SceneDetector';
 
 /**
  * Encoder latency mode
@@ -104,6 +113,8 @@ export interface VideoEncoderConfig {
   /**
    * Scalability mode for SVC/temporal layering
    * @example 'L1T2' (1 spatial layer, 2 temporal layers)
+   * @example 'S3T1' (simulcast: 3 independent streams at 1/4, 1/2 and full
+   * size, one encode() call feeding all of them)
    */
   scalabilityMode?: string;
 
@@ -117,6 +128,46 @@ export interface VideoEncoderConfig {
    */
   latencyMode?: LatencyMode;
 
+  /**
+   * Maximum time in milliseconds a frame may wait in the encode queue
+   * (non-standard). Requires `latencyMode: 'realtime'` and the worker-thread
+   * encoder without simulcast; configure() throws NotSupportedError otherwise.
+   *
+   * When the oldest queued frame is older than this, queued frames are
+   * dropped and encoding continues on the freshest one, so a CPU spike
+   * costs frames instead of growing latency. Frames encoded with
+   * `keyFrame: true` are never dropped. Drops are reported via the `drop`
+   * event and `droppedFrameCount`.
+   * @example
+   * ```ts
+   * latencyMode: 'realtime',
+   * latencyBudget: 100  // shed frames queued for more than 100ms
+   * ```
+   */
+  latencyBudget?: number;
+
+  /**
+   * Per-frame scene analysis on the encoder thread (non-standard, worker
+   * thread only). Each frame is scored against the last one encoded, with
+   * the kernel behind SceneDetector, before it is handed to the codec.
+   *
+   * `keyframeOnSceneChange` forces a keyframe at each cut, so seeks and
+   * chapter points land on scene starts. `skipDuplicates` leaves frames
+   * identical to the last encoded one out of the stream; they produce no
+   * chunk, and players keep showing the previous frame until the next
+   * timestamp. Frames encoded with `keyFrame: true` are never skipped.
+   * Counts are in `sceneStats`.
+   * @example
+   * ```ts
+   * // Screen capture: only encode frames that changed
+   * sceneDetection: { skipDuplicates: true, keyframeOnSceneChange: true }
+   * ```
+   */
+  sceneDetection?: SceneDetectorOptions & {
+    keyframeOnSceneChange?: boolean;
+    skipDuplicates?: boolean;
+  };
+
   /**
    * Color space metadata (primaries, transfer, matrix)
    */
@@ -135,6 +186,38 @@ export interface VideoEncoderConfig {
     format?: 'annexb' | 'avc';
   };
 
+  /**
+   * H.265/HEVC specific options
+   */
+  hevc?: {
+    /**
+     * Output format for H.265 bitstream
+     * - `annexb`: Annex B format (start codes)
+     * - `hevc`: length-prefixed NALUs, with an hvcC record as the description
+     * @default 'annexb'
+     */
+    format?: 'annexb' | 'hevc';
+  };
+
+  /**
+   * Pixel format the frames passed to encode() will have (non-standard)
+   *
+   * Software encoders normally take I420, so NV12/I422/I444 input is
+   * converted on every frame. With this hint the encoder is opened in that
+   * format when it and the codec string's profile support it (e.g. NV12 or
+   * I444 with `avc1.F4001F` for libx264), and frames are passed through
+   * without conversion. Frames in other formats are still converted.
+   *
+   * High bit depth codec strings (e.g. `vp09.02.10.10`, `hvc1.2.4.L120.90`)
+   * default to the matching 10/12-bit format.
+   * @example
+   * ```ts
+   * codec: 'avc1.640028',
+   * inputFormat: 'NV12'
+   * ```
+   */
+  inputFormat?: VideoPixelFormat;
+
   /**
    * Use async (non-blocking) encoder via worker thread
    * Set to false to use synchronous encoder (blocks event loop during encoding)
@@ -190,6 +273,11 @@ export interface VideoEncoderOutputMetadata {
   svc?: {
     /** Temporal layer ID (0 = base layer) */
     temporalLayerId: number;
+    /**
+     * Spatial layer / simulcast stream index (0 = lowest resolution).
+     * Non-standard; present for S*T* modes.
+     */
+    spatialLayerId?: number;
   };
 }
 
@@ -291,10 +379,16 @@ export class VideoEncoder {
   private _pendingCallbacks: number = 0;  // Track pending setImmediate callbacks
   private _config: VideoEncoderConfig | null = null;
   private _sentDecoderConfig: boolean = false;
-  private _listeners: Map<string, Set<() => void>> = new Map();
+  private _listeners: Map<string, Set<(detail?: any) => void>> = new Map();
   private _useAsync: boolean = true;
   private _nativeCreated: boolean = false;
+  private _nativeKind: 'async' | 'sync' | 'ladder' | null = null;
+  private _simulcast: {
+    layers: Array<{ width: number; height: number }>;
+    sentDecoderConfig: Set<number>;
+  } | null = null;
   private _ondequeue: ((event: Event) => void) | null = null;
+  private _droppedFrameCount: number = 0;
 
   /**
    * Check if a VideoEncoder configuration is supported
@@ -458,11 +552,30 @@ export class VideoEncoder {
     this._ondequeue = handler;
   }
 
+  /**
+   * Number of frames dropped under `latencyBudget` since the encoder was created
+   */
+  get droppedFrameCount(): number {
+    return this._droppedFrameCount;
+  }
+
+  /**
+   * Scene cuts given a keyframe and duplicate frames skipped under
+   * `sceneDetection` since the encoder was created
+   */
+  get sceneStats(): { sceneChanges: number; duplicatesSkipped: number } {
+    if (this._nativeKind === 'async' && this._native?.getSceneStats) {
+      return this._native.getSceneStats();
+    }
+    return { sceneChanges: 0, duplicatesSkipped: 0 };
+  }
+
   /**
    * Add an event listener
-   * Currently supports 'dequeue' events fired when encode queue decreases
+   * Supports 'dequeue' events fired when encode queue decreases, and 'drop'
+   * events fired with `{ timestamps }` when frames are shed under `latencyBudget`
    *
-   * @param type - Event type ('dequeue')
+   * @param type - Event type ('dequeue' | 'drop')
    * @param listener - Callback to invoke
    * @param options - Event listener options
    *
@@ -473,14 +586,14 @@ export class VideoEncoder {
    * });
    * ```
    */
-  addEventListener(type: string, listener: () => void, options?: { once?: boolean }): void {
+  addEventListener(type: string, listener: (detail?: any) => void, options?: { once?: boolean }): void {
     if (typeof listener !== 'function') return;
 
     const once = !!(options && (options as any).once);
     const wrapper = once
-      ? () => {
+      ? (detail?: any) => {
           this.removeEventListener(type, wrapper);
-          listener();
+          listener(detail);
         }
       : listener;
 
@@ -495,10 +608,10 @@ export class VideoEncoder {
   /**
    * Remove an event listener
    *
-   * @param type - Event type ('dequeue')
+   * @param type - Event type ('dequeue' | 'drop')
    * @param listener - Callback to remove
    */
-  removeEventListener(type: string, listener: () => void): void {
+  removeEventListener(type: string, listener: (detail?: any) => void): void {
     const set = this._listeners.get(type);
     if (!set) return;
 
@@ -511,7 +624,7 @@ export class VideoEncoder {
     }
   }
 
-  private _dispatchEvent(type: string): void {
+  private _dispatchEvent(type: string, detail?: any): void {
     // Call the ondequeue handler if it exists
     if (type === 'dequeue' && this._ondequeue) {
       try {
@@ -526,7 +639,7 @@ export class VideoEncoder {
 
     for (const listener of Array.from(set)) {
       try {
-        listener();
+        listener(detail);
       } catch {
         // Swallow listener errors
       }
@@ -609,6 +722,18 @@ export class VideoEncoder {
       );
     }
 
+    if (config.latencyBudget !== undefined &&
+        !(typeof config.latencyBudget === 'number' && config.latencyBudget > 0 && isFinite(config.latencyBudget))) {
+      throw new DOMException(
+        `Invalid latencyBudget: ${config.latencyBudget}. Must be a positive number of milliseconds.`,
+        'TypeError'
+      );
+    }
+
+    if (config.sceneDetection) {
+      validateSceneOptions(config.sceneDetection);
+    }
+
     if (!native) {
       throw new DOMException('Native addon not available', 'NotSupportedError');
     }
@@ -617,12 +742,55 @@ export class VideoEncoder {
     // Default to async unless explicitly disabled
     this._useAsync = config.useWorkerThread !== false && !!native.VideoEncoderAsync;
 
+    // Simulcast runs one codec context per stream behind a single native
+    // ladder, so frames are converted and downscaled once for all streams
+    const svc = config.scalabilityMode ? parseScalabilityMode(config.scalabilityMode) : null;
+    const simulcast = !!svc && svc.isSimulcast && svc.spatialLayers > 1;
+    if (simulcast && !(this._useAsync && native.VideoLadderEncoder)) {
+      throw new DOMException(
+        `scalabilityMode ${config.scalabilityMode} requires the worker-thread encoder`,
+        'NotSupportedError'
+      );
+    }
+
+    // VideoLadderEncoder only writes Annex B with raw extradata
+    if (simulcast && (config.avc?.format === 'avc' || config.hevc?.format === 'hevc')) {
+      throw new DOMException(
+        `scalabilityMode ${config.scalabilityMode} only produces Annex B output`,
+        'NotSupportedError'
+      );
+    }
+
+    if (config.sceneDetection && (simulcast || !this._useAsync)) {
+      throw new DOMException('sceneDetection requires the worker-thread encoder without simulcast', 'NotSupportedError');
+    }
+
+    if (config.latencyBudget !== undefined &&
+        (config.latencyMode !== 'realtime' || simulcast || !this._useAsync)) {
+      throw new DOMException(
+        "latencyBudget requires latencyMode 'realtime' and the worker-thread encoder without simulcast",
+        'NotSupportedError'
+      );
+    }
+
+    const kind = simulcast ? 'ladder' : this._useAsync ? 'async' : 'sync';
+    if (this._nativeCreated && this._nativeKind !== kind) {
+      this._native.close();
+      this._nativeCreated = false;
+    }
+
     // Create native encoder if not already created, or if switching mode
     if (!this._nativeCreated) {
-      if (this._useAsync) {
+      if (kind === 'ladder') {
+        this._native = new native.VideoLadderEncoder(
+          this._onLayerChunk.bind(this),
+          this._onError.bind(this)
+        );
+      } else if (this._useAsync) {
         this._native = new native.VideoEncoderAsync(
           this._onChunk.bind(this),
-          this._onError.bind(this)
+          this._onError.bind(this),
+          this._onDrop.bind(this)
         );
       } else {
         this._native = new native.VideoEncoderNative(
@@ -631,6 +799,7 @@ export class VideoEncoder {
         );
       }
       this._nativeCreated = true;
+      this._nativeKind = kind;
     }
 
     const ffmpegCodec = getFFmpegVideoCodec(config.codec);
@@ -648,16 +817,65 @@ export class VideoEncoder {
         codecParams.level = avcInfo.level;
       }
       codecParams.avcFormat = config.avc?.format ?? 'annexb';
+    } else {
+      // Profile bounds the pixel formats inputFormat may negotiate
+      const vp9Info = parseVp9CodecString(config.codec);
+      const av1Info = parseAv1CodecString(config.codec);
+      const hevcInfo = parseHevcCodecString(config.codec);
+      const profileInfo = vp9Info ?? av1Info ?? hevcInfo;
+      if (profileInfo) codecParams.profile = profileInfo.profile;
+      if (config.codec.startsWith('hvc1.') || config.codec.startsWith('hev1.')) {
+        // Native side frames H.264 and HEVC alike; 'avc' means length-prefixed
+        codecParams.avcFormat = config.hevc?.format === 'hevc' ? 'avc' : 'annexb';
+      }
+
+      // A high bit depth codec string means a high bit depth stream; without
+      // a hint, open the encoder at that depth rather than 8-bit
+      const bitDepth = vp9Info?.bitDepth ?? av1Info?.bitDepth ?? (hevcInfo?.profile === 2 ? 10 : 8);
+      if (!config.inputFormat && (bitDepth === 10 || bitDepth === 12)) {
+        const chroma = vp9Info?.profile === 3 || av1Info?.profile === 1 ? 'I444' : 'I420';
+        codecParams.inputFormat = `${chroma}P${bitDepth}`;
+      }
     }
 
     if (config.bitrate) codecParams.bitrate = config.bitrate;
     if (config.framerate) codecParams.framerate = config.framerate;
     if (config.bitrateMode) codecParams.bitrateMode = config.bitrateMode;
     if (config.latencyMode) codecParams.latencyMode = config.latencyMode;
+    if (config.latencyBudget) codecParams.latencyBudget = config.latencyBudget;
     if (config.colorSpace) codecParams.colorSpace = config.colorSpace;
     if (config.hardwareAcceleration) codecParams.hardwareAcceleration = config.hardwareAcceleration;
     if (config.alpha) codecParams.alpha = config.alpha;
     if (config.scalabilityMode) codecParams.scalabilityMode = config.scalabilityMode;
+    if (config.inputFormat) codecParams.inputFormat = config.inputFormat;
+    if (config.sceneDetection) codecParams.sceneDetection = config.sceneDetection;
+
+    this._simulcast = null;
+    if (simulcast && svc) {
+      // Stream s is 1/ratio^(n-1-s) of the configured size; bitrate is
+      // split by width so the lower streams stay watchable
+      const n = svc.spatialLayers;
+      const layers = [];
+      for (let s = 0; s < n; s++) {
+        const scale = Math.pow(svc.ratio, n - 1 - s);
+        layers.push({
+          width: Math.max(2, Math.round(config.width / scale / 2) * 2),
+          height: Math.max(2, Math.round(config.height / scale / 2) * 2),
+        });
+      }
+      const totalBitrate = config.bitrate ?? 2_000_000;
+      const widthSum = layers.reduce((sum, l) => sum + l.width, 0);
+
+      codecParams.renditions = layers.map((l) => ({
+        width: l.width,
+        height: l.height,
+        bitrate: Math.round(totalBitrate * l.width / widthSum),
+      }));
+      codecParams.temporalLayers = svc.temporalLayers;
+      delete codecParams.scalabilityMode;
+
+      this._simulcast = { layers, sentDecoderConfig: new Set() };
+    }
 
     this._native.configure(codecParams);
     this._config = config;
@@ -805,6 +1023,7 @@ export class VideoEncoder {
     this._encodeQueueSize = 0;
     this._state = 'unconfigured';
     this._sentDecoderConfig = false;
+    this._simulcast = null;
     this._config = null;
   }
 
@@ -839,7 +1058,35 @@ export class VideoEncoder {
     this._config = null;
   }
 
-  private _onChunk(data: Uint8Array, isKeyframe: boolean, timestamp: number, duration: number, extradata?: Uint8Array): void {
+  /**
+   * @internal Worker-thread native encoder, for native consumers such as
+   * Muxer.attachEncoder(); null when not configured or not single-stream async
+   */
+  _getAsyncNative(): any | null {
+    return this._state === 'configured' && this._nativeKind === 'async' ? this._native : null;
+  }
+
+  /** @internal Whether output is H.264/HEVC in Annex B framing, without an avcC/hvcC */
+  _isAnnexB(): boolean {
+    const codec = this._config?.codec ?? '';
+    if (codec.startsWith('avc1.') || codec.startsWith('avc3.')) {
+      return this._config!.avc?.format !== 'avc';
+    }
+    if (codec.startsWith('hvc1.') || codec.startsWith('hev1.')) {
+      return this._config!.hevc?.format !== 'hevc';
+    }
+    return false;
+  }
+
+  private _onChunk(
+    data: Uint8Array,
+    isKeyframe: boolean,
+    timestamp: number,
+    duration: number,
+    extradata?: Uint8Array,
+    _alphaSideData?: Uint8Array,
+    temporalLayerId?: number
+  ): void {
     // Copy data immediately since native buffer may be recycled
     const dataCopy = new Uint8Array(data);
     const extradataCopy = extradata ? new Uint8Array(extradata) : undefined;
@@ -877,6 +1124,52 @@ export class VideoEncoder {
       this._sentDecoderConfig = true;
     }
 
+    // Present whenever a scalabilityMode is configured
+    if (temporalLayerId !== undefined) {
+      metadata = { ...metadata, svc: { temporalLayerId } };
+    }
+
+    try {
+      this._outputCallback(chunk, metadata);
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+
+  private _onLayerChunk(
+    layer: number,
+    data: Uint8Array,
+    isKeyframe: boolean,
+    timestamp: number,
+    duration: number,
+    extradata: Uint8Array | undefined,
+    temporalLayerId: number
+  ): void {
+    const sim = this._simulcast;
+    if (!sim || !this._config) return;
+
+    const chunk = new EncodedVideoChunk({
+      type: isKeyframe ? 'key' : 'delta',
+      timestamp,
+      duration: duration > 0 ? duration : undefined,
+      data: new Uint8Array(data),
+    });
+
+    const metadata: VideoEncoderOutputMetadata = {
+      svc: { temporalLayerId, spatialLayerId: layer },
+    };
+
+    if (isKeyframe && !sim.sentDecoderConfig.has(layer)) {
+      metadata.decoderConfig = {
+        codec: this._config.codec,
+        codedWidth: sim.layers[layer].width,
+        codedHeight: sim.layers[layer].height,
+        description: extradata ? new Uint8Array(extradata).buffer as ArrayBuffer : undefined,
+        colorSpace: this._config.colorSpace,
+      };
+      sim.sentDecoderConfig.add(layer);
+    }
+
     try {
       this._outputCallback(chunk, metadata);
     } catch (e) {
@@ -884,6 +1177,11 @@ export class VideoEncoder {
     }
   }
 
+  private _onDrop(timestamps: number[]): void {
+    this._droppedFrameCount += timestamps.length;
+    this._dispatchEvent('drop', { timestamps });
+  }
+
   private _onError(message: string): void {
     try {
       this._errorCallback(new DOMException(message, 'EncodingError') as any);
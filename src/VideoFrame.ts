@@ -8,15 +8,123 @@ import { BufferSource, DOMRectReadOnly, DOMException } from './types';
 
 export type VideoPixelFormat =
   | 'I420'
+  | 'I420P10'
+  | 'I420P12'
   | 'I420A'
+  | 'I420AP10'
   | 'I422'
+  | 'I422P10'
+  | 'I422P12'
+  | 'I422A'
+  | 'I422AP10'
+  | 'I422AP12'
   | 'I444'
+  | 'I444P10'
+  | 'I444P12'
+  | 'I444A'
+  | 'I444AP10'
+  | 'I444AP12'
   | 'NV12'
   | 'RGBA'
   | 'RGBX'
   | 'BGRA'
   | 'BGRX';
 
+/**
+ * What the decoder's codec knew about this picture (non-standard), from a
+ * VideoDecoder configured with exportCodecAnalysis. Free to obtain: the
+ * codec computed it while decoding. Coordinates are in decoded pixels.
+ */
+export interface VideoFrameCodecAnalysis {
+  /** 'I', 'P', 'B', 'S' (GMC), ... or '?' if unknown */
+  pictType: string;
+
+  /**
+   * 8 values per vector: source (-1 past, 1 future reference), w, h,
+   * dstX, dstY (block centre), motionX, motionY, motionScale. Motion is in
+   * 1/motionScale pixels. Absent for intra frames and codecs that don't
+   * export vectors (H.264 and the MPEG family do).
+   */
+  motionVectors?: Int16Array;
+
+  /** Frame QP and per-block deltas: 5 values per block: x, y, w, h, deltaQp */
+  qp?: { base: number; blocks: Int16Array };
+}
+
+/**
+ * Motion magnitude grid from VideoFrame.motionGrid()
+ */
+export interface VideoFrameMotionGrid {
+  columns: number;
+  rows: number;
+  blockSize: number;
+  /** Row-major mean motion in pixels per cell; 0 where nothing moved or was intra-coded */
+  magnitudes: Float32Array;
+}
+
+/**
+ * Layout of the planar YUV formats: Y, U, V[, A] planes packed back to back.
+ * High bit depth samples are 16-bit little-endian words (low bits used).
+ */
+interface PlanarFormatInfo {
+  bytesPerSample: 1 | 2;
+  chromaShiftX: number;  // log2 horizontal chroma subsampling
+  chromaShiftY: number;  // log2 vertical chroma subsampling
+  alpha: boolean;
+}
+
+const PLANAR_FORMATS: Partial<Record<VideoPixelFormat, PlanarFormatInfo>> = {
+  I420: { bytesPerSample: 1, chromaShiftX: 1, chromaShiftY: 1, alpha: false },
+  I420P10: { bytesPerSample: 2, chromaShiftX: 1, chromaShiftY: 1, alpha: false },
+  I420P12: { bytesPerSample: 2, chromaShiftX: 1, chromaShiftY: 1, alpha: false },
+  I420A: { bytesPerSample: 1, chromaShiftX: 1, chromaShiftY: 1, alpha: true },
+  I420AP10: { bytesPerSample: 2, chromaShiftX: 1, chromaShiftY: 1, alpha: true },
+  I422: { bytesPerSample: 1, chromaShiftX: 1, chromaShiftY: 0, alpha: false },
+  I422P10: { bytesPerSample: 2, chromaShiftX: 1, chromaShiftY: 0, alpha: false },
+  I422P12: { bytesPerSample: 2, chromaShiftX: 1, chromaShiftY: 0, alpha: false },
+  I422A: { bytesPerSample: 1, chromaShiftX: 1, chromaShiftY: 0, alpha: true },
+  I422AP10: { bytesPerSample: 2, chromaShiftX: 1, chromaShiftY: 0, alpha: true },
+  I422AP12: { bytesPerSample: 2, chromaShiftX: 1, chromaShiftY: 0, alpha: true },
+  I444: { bytesPerSample: 1, chromaShiftX: 0, chromaShiftY: 0, alpha: false },
+  I444P10: { bytesPerSample: 2, chromaShiftX: 0, chromaShiftY: 0, alpha: false },
+  I444P12: { bytesPerSample: 2, chromaShiftX: 0, chromaShiftY: 0, alpha: false },
+  I444A: { bytesPerSample: 1, chromaShiftX: 0, chromaShiftY: 0, alpha: true },
+  I444AP10: { bytesPerSample: 2, chromaShiftX: 0, chromaShiftY: 0, alpha: true },
+  I444AP12: { bytesPerSample: 2, chromaShiftX: 0, chromaShiftY: 0, alpha: true },
+};
+
+function planarGeometry(info: PlanarFormatInfo, width: number, height: number) {
+  const chromaWidth = (width + (1 << info.chromaShiftX) - 1) >> info.chromaShiftX;
+  const chromaHeight = (height + (1 << info.chromaShiftY) - 1) >> info.chromaShiftY;
+  const lumaStride = width * info.bytesPerSample;
+  const chromaStride = chromaWidth * info.bytesPerSample;
+  return {
+    lumaStride,
+    chromaStride,
+    lumaSize: lumaStride * height,
+    chromaSize: chromaStride * chromaHeight,
+  };
+}
+
+function planarSize(info: PlanarFormatInfo, width: number, height: number): number {
+  const { lumaSize, chromaSize } = planarGeometry(info, width, height);
+  return lumaSize * (info.alpha ? 2 : 1) + chromaSize * 2;
+}
+
+function planarLayouts(info: PlanarFormatInfo, width: number, height: number): PlaneLayout[] {
+  const { lumaStride, chromaStride, lumaSize, chromaSize } = planarGeometry(info, width, height);
+
+  const layouts = [
+    { offset: 0, stride: lumaStride },
+    { offset: lumaSize, stride: chromaStride },
+    { offset: lumaSize + chromaSize, stride: chromaStride },
+  ];
+  if (info.alpha) {
+    layouts.push({ offset: lumaSize + 2 * chromaSize, stride: lumaStride });
+  }
+  return layouts;
+}
+
 export interface PlaneLayout {
   offset: number;
   stride: number;
@@ -242,6 +350,33 @@ export class VideoFrame {
     return scaled;
   }
 
+  /**
+   * Codec side data (non-standard): picture type, motion vectors and QP.
+   * Only decoders configured with exportCodecAnalysis attach vectors/QP.
+   */
+  get codecAnalysis(): VideoFrameCodecAnalysis | null {
+    if (this._closed || !this._native?.codecAnalysis) {
+      return null;
+    }
+    return this._native.codecAnalysis();
+  }
+
+  /**
+   * Aggregate this frame's motion vectors into a blockSize grid of mean
+   * motion magnitudes, natively (non-standard). Cheap activity/motion
+   * detection without optical flow. null without motion vectors.
+   */
+  motionGrid(blockSize: number = 16): VideoFrameMotionGrid | null {
+    this._assertNotClosed();
+    if (!Number.isInteger(blockSize) || blockSize <= 0) {
+      throw new DOMException(`Invalid blockSize: ${blockSize}`, 'TypeError');
+    }
+    if (!this._native?.motionGrid) {
+      return null;
+    }
+    return this._native.motionGrid(blockSize);
+  }
+
   /**
    * Get the native frame handle (internal use only)
    */
@@ -265,20 +400,17 @@ export class VideoFrame {
   }
 
   private _calculateFormatSize(format: VideoPixelFormat | null, width: number, height: number): number {
+    const planar = format ? PLANAR_FORMATS[format] : undefined;
+    if (planar) {
+      return planarSize(planar, width, height);
+    }
+
     switch (format) {
       case 'RGBA':
       case 'RGBX':
       case 'BGRA':
       case 'BGRX':
         return width * height * 4;
-      case 'I420':
-        return Math.floor(width * height * 1.5);
-      case 'I420A':
-        return width * height * 2;
-      case 'I422':
-        return width * height * 2;
-      case 'I444':
-        return width * height * 3;
       case 'NV12':
         return Math.floor(width * height * 1.5);
       default:
@@ -348,48 +480,17 @@ export class VideoFrame {
     const height = options?.rect?.height ?? this.codedHeight;
     const targetFormat = options?.format ?? this.format;
 
+    const planar = targetFormat ? PLANAR_FORMATS[targetFormat] : undefined;
+    if (planar) {
+      return planarLayouts(planar, width, height);
+    }
+
     switch (targetFormat) {
       case 'RGBA':
       case 'RGBX':
       case 'BGRA':
       case 'BGRX':
         return [{ offset: 0, stride: width * 4 }];
-      case 'I420': {
-        const ySize = width * height;
-        const uvSize = Math.floor((width / 2) * (height / 2));
-        return [
-          { offset: 0, stride: width },
-          { offset: ySize, stride: Math.floor(width / 2) },
-          { offset: ySize + uvSize, stride: Math.floor(width / 2) },
-        ];
-      }
-      case 'I420A': {
-        const ySize = width * height;
-        const uvSize = Math.floor((width / 2) * (height / 2));
-        return [
-          { offset: 0, stride: width },
-          { offset: ySize, stride: Math.floor(width / 2) },
-          { offset: ySize + uvSize, stride: Math.floor(width / 2) },
-          { offset: ySize + 2 * uvSize, stride: width },
-        ];
-      }
-      case 'I422': {
-        const ySize = width * height;
-        const uvSize = Math.floor((width / 2) * height);
-        return [
-          { offset: 0, stride: width },
-          { offset: ySize, stride: Math.floor(width / 2) },
-          { offset: ySize + uvSize, stride: Math.floor(width / 2) },
-        ];
-      }
-      case 'I444': {
-        const planeSize = width * height;
-        return [
-          { offset: 0, stride: width },
-          { offset: planeSize, stride: width },
-          { offset: planeSize * 2, stride: width },
-        ];
-      }
       case 'NV12': {
         const ySize = width * height;
         return [
@@ -0,0 +1,338 @@
+/**
+ * VideoLadderEncoder - Encodes one input into an ABR ladder of renditions
+ *
+ * Not part of the WebCodecs spec. Equivalent to running one VideoEncoder per
+ * rendition, but each frame crosses into native code once, is downscaled as
+ * a cascade (every rendition scaled from the next larger one rather than
+ * from the source), and all renditions encode in parallel on native threads.
+ */
+
+import { VideoFrame, VideoPixelFormat } from './VideoFrame';
+import { EncodedVideoChunk } from './EncodedVideoChunk';
+import {
+  isVideoCodecSupported,
+  getFFmpegVideoCodec,
+  parseAvcCodecString,
+  parseVp9CodecString,
+  parseAv1CodecString,
+  parseHevcCodecString,
+} from './codec-registry';
+import { CodecState, DOMException } from './types';
+import { BitrateMode, LatencyMode, VideoEncoderEncodeOptions } from './VideoEncoder';
+import { native } from './native';
+
+/**
+ * One output of the ladder
+ */
+export interface VideoLadderRendition {
+  /**
+   * Identifier passed back with every chunk of this rendition.
+   * Defaults to `${height}p`.
+   */
+  id?: string;
+
+  /** Encoded width in pixels */
+  width: number;
+
+  /** Encoded height in pixels */
+  height: number;
+
+  /** Target bitrate in bits per second */
+  bitrate?: number;
+}
+
+/**
+ * VideoLadderEncoder configuration. Everything but `renditions` applies to
+ * every rendition.
+ */
+export interface VideoLadderEncoderConfig {
+  /** Codec string (e.g., 'avc1.42E01E', 'vp09.00.10.08') */
+  codec: string;
+
+  /** Renditions to produce, in any order */
+  renditions: VideoLadderRendition[];
+
+  /** Frame rate in frames per second */
+  framerate?: number;
+
+  /** Bitrate control mode */
+  bitrateMode?: BitrateMode;
+
+  /** Latency mode */
+  latencyMode?: LatencyMode;
+
+  /** Hardware acceleration preference */
+  hardwareAcceleration?: 'no-preference' | 'prefer-hardware' | 'prefer-software';
+
+  /** Pixel format of the frames that will be encoded (see VideoEncoderConfig) */
+  inputFormat?: VideoPixelFormat;
+}
+
+/**
+ * Metadata delivered with each ladder chunk
+ */
+export interface VideoLadderOutputMetadata {
+  /** Rendition this chunk belongs to */
+  renditionId: string;
+
+  /** Decoder configuration, sent with each rendition's first keyframe */
+  decoderConfig?: {
+    codec: string;
+    codedWidth: number;
+    codedHeight: number;
+    description?: ArrayBuffer;
+  };
+}
+
+export interface VideoLadderEncoderInit {
+  output: (chunk: EncodedVideoChunk, metadata: VideoLadderOutputMetadata) => void;
+  error: (error: DOMException) => void;
+}
+
+/**
+ * Encodes each frame once per rendition of an ABR ladder.
+ *
+ * @example
+ * ```ts
+ * const ladder = new VideoLadderEncoder({
+ *   output: (chunk, { renditionId }) => segments[renditionId].push(chunk),
+ *   error: (err) => console.error(err),
+ * });
+ *
+ * ladder.configure({
+ *   codec: 'avc1.42E01F',
+ *   framerate: 30,
+ *   renditions: [
+ *     { width: 1920, height: 1080, bitrate: 5_000_000 },
+ *     { width: 1280, height: 720, bitrate: 2_800_000 },
+ *     { width: 854, height: 480, bitrate: 1_400_000 },
+ *     { width: 640, height: 360, bitrate: 800_000 },
+ *   ],
+ * });
+ *
+ * ladder.encode(frame);
+ * frame.close();
+ * await ladder.flush();
+ * ```
+ */
+export class VideoLadderEncoder {
+  private _native: any = null;
+  private _state: CodecState = 'unconfigured';
+  private _outputCallback: (chunk: EncodedVideoChunk, metadata: VideoLadderOutputMetadata) => void;
+  private _errorCallback: (error: DOMException) => void;
+  private _encodeQueueSize: number = 0;
+  private _config: VideoLadderEncoderConfig | null = null;
+  private _renditionIds: string[] = [];
+  private _sentDecoderConfig: Set<number> = new Set();
+
+  constructor(init: VideoLadderEncoderInit) {
+    if (!init.output || typeof init.output !== 'function') {
+      throw new TypeError('output callback is required');
+    }
+    if (!init.error || typeof init.error !== 'function') {
+      throw new TypeError('error callback is required');
+    }
+
+    this._outputCallback = init.output;
+    this._errorCallback = init.error;
+  }
+
+  get state(): CodecState {
+    return this._state;
+  }
+
+  /**
+   * Number of frames submitted whose renditions have not all been queued
+   */
+  get encodeQueueSize(): number {
+    return this._encodeQueueSize;
+  }
+
+  configure(config: VideoLadderEncoderConfig): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Encoder is closed', 'InvalidStateError');
+    }
+
+    if (!isVideoCodecSupported(config.codec)) {
+      throw new DOMException(`Unsupported codec: ${config.codec}`, 'NotSupportedError');
+    }
+
+    if (!Array.isArray(config.renditions) || config.renditions.length === 0) {
+      throw new DOMException('renditions must be a non-empty array', 'TypeError');
+    }
+
+    const ids = config.renditions.map((r) => r.id ?? `${r.height}p`);
+    for (const r of config.renditions) {
+      if (!(r.width > 0) || !(r.height > 0)) {
+        throw new DOMException(`Invalid rendition dimensions: ${r.width}x${r.height}`, 'TypeError');
+      }
+    }
+    if (new Set(ids).size !== ids.length) {
+      throw new DOMException(`Duplicate rendition id in: ${ids.join(', ')}`, 'TypeError');
+    }
+
+    if (config.latencyMode && !['quality', 'realtime'].includes(config.latencyMode)) {
+      throw new DOMException(
+        `Invalid latencyMode: ${config.latencyMode}. Must be 'quality' or 'realtime'.`,
+        'TypeError'
+      );
+    }
+
+    if (config.bitrateMode && !['constant', 'variable', 'quantizer'].includes(config.bitrateMode)) {
+      throw new DOMException(
+        `Invalid bitrateMode: ${config.bitrateMode}. Must be 'constant', 'variable', or 'quantizer'.`,
+        'TypeError'
+      );
+    }
+
+    // Output is Annex B with raw extradata; length-prefixed framing is only
+    // implemented by VideoEncoder
+    const framing: any = config;
+    if (framing.avc?.format === 'avc' || framing.hevc?.format === 'hevc') {
+      throw new DOMException('VideoLadderEncoder only produces Annex B output', 'NotSupportedError');
+    }
+
+    if (!native?.VideoLadderEncoder) {
+      throw new DOMException('Native addon not available', 'NotSupportedError');
+    }
+
+    if (!this._native) {
+      this._native = new native.VideoLadderEncoder(
+        this._onChunk.bind(this),
+        this._onError.bind(this)
+      );
+    }
+
+    const codecParams: any = {
+      codec: getFFmpegVideoCodec(config.codec),
+      renditions: config.renditions.map((r) => ({
+        width: r.width,
+        height: r.height,
+        bitrate: r.bitrate,
+      })),
+    };
+
+    const profileInfo = parseAvcCodecString(config.codec) ??
+      parseVp9CodecString(config.codec) ??
+      parseAv1CodecString(config.codec) ??
+      parseHevcCodecString(config.codec);
+    if (profileInfo) codecParams.profile = profileInfo.profile;
+
+    if (config.framerate) codecParams.framerate = config.framerate;
+    if (config.bitrateMode) codecParams.bitrateMode = config.bitrateMode;
+    if (config.latencyMode) codecParams.latencyMode = config.latencyMode;
+    if (config.hardwareAcceleration) codecParams.hardwareAcceleration = config.hardwareAcceleration;
+    if (config.inputFormat) codecParams.inputFormat = config.inputFormat;
+
+    this._native.configure(codecParams);
+    this._config = config;
+    this._renditionIds = ids;
+    this._sentDecoderConfig.clear();
+    this._state = 'configured';
+  }
+
+  encode(frame: VideoFrame, options?: VideoEncoderEncodeOptions): void {
+    if (this._state !== 'configured') {
+      throw new DOMException('Encoder is not configured', 'InvalidStateError');
+    }
+
+    const nativeFrame = frame._getNative();
+    if (!nativeFrame) {
+      throw new DOMException('VideoFrame has no native handle', 'InvalidStateError');
+    }
+
+    this._encodeQueueSize++;
+    this._native.encode(nativeFrame, frame.timestamp, options?.keyFrame ?? false);
+
+    setImmediate(() => {
+      this._encodeQueueSize = Math.max(0, this._encodeQueueSize - 1);
+    });
+  }
+
+  /**
+   * Resolves once every rendition has emitted all chunks for frames
+   * submitted before the call
+   */
+  async flush(): Promise<void> {
+    if (this._state !== 'configured') {
+      throw new DOMException('Encoder is not configured', 'InvalidStateError');
+    }
+
+    return new Promise((resolve, reject) => {
+      this._native.flush((err: Error | null) => {
+        if (err) {
+          reject(new DOMException(err.message, 'EncodingError'));
+        } else {
+          resolve();
+        }
+      });
+    });
+  }
+
+  reset(): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Encoder is closed', 'InvalidStateError');
+    }
+
+    if (this._native) {
+      this._native.reset();
+    }
+    this._encodeQueueSize = 0;
+    this._config = null;
+    this._state = 'unconfigured';
+  }
+
+  close(): void {
+    if (this._state === 'closed') return;
+
+    if (this._native) {
+      this._native.close();
+    }
+    this._encodeQueueSize = 0;
+    this._config = null;
+    this._state = 'closed';
+  }
+
+  private _onChunk(
+    rendition: number,
+    data: Uint8Array,
+    isKeyframe: boolean,
+    timestamp: number,
+    duration: number,
+    extradata?: Uint8Array
+  ): void {
+    const chunk = new EncodedVideoChunk({
+      type: isKeyframe ? 'key' : 'delta',
+      timestamp,
+      duration: duration > 0 ? duration : undefined,
+      data: new Uint8Array(data),
+    });
+
+    const metadata: VideoLadderOutputMetadata = { renditionId: this._renditionIds[rendition] };
+
+    if (isKeyframe && this._config && !this._sentDecoderConfig.has(rendition)) {
+      const r = this._config.renditions[rendition];
+      metadata.decoderConfig = {
+        codec: this._config.codec,
+        codedWidth: r.width,
+        codedHeight: r.height,
+        description: extradata ? new Uint8Array(extradata).buffer as ArrayBuffer : undefined,
+      };
+      this._sentDecoderConfig.add(rendition);
+    }
+
+    try {
+      this._outputCallback(chunk, metadata);
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+
+  private _onError(message: string): void {
+    try {
+      this._errorCallback(new DOMException(message, 'EncodingError') as any);
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+}
@@ -0,0 +1,391 @@
+/**
+ * VideoSegmentedEncoder - GOP-parallel offline encoding
+ *
+ * Not part of the WebCodecs spec. Cuts the input into fixed-length segments,
+ * each starting on a keyframe, and encodes several segments at once on
+ * independent native codec contexts. Chunks come out as one stream in input
+ * order, the same as a single VideoEncoder would produce, but throughput
+ * scales with `concurrency` rather than with one encoder's threading.
+ *
+ * For files, not live streams: a segment's chunks are only emitted after all
+ * of its frames have been submitted and it has been fully encoded.
+ */
+
+import { VideoFrame, VideoPixelFormat } from './VideoFrame';
+import { EncodedVideoChunk } from './EncodedVideoChunk';
+import {
+  isVideoCodecSupported,
+  getFFmpegVideoCodec,
+  parseAvcCodecString,
+  parseVp9CodecString,
+  parseAv1CodecString,
+  parseHevcCodecString,
+} from './codec-registry';
+import { CodecState, DOMException } from './types';
+import { BitrateMode, VideoEncoderEncodeOptions, VideoEncoderOutputMetadata } from './VideoEncoder';
+import { native } from './native';
+
+export interface VideoSegmentedEncoderConfig {
+  /** Codec string (e.g., 'avc1.640028', 'av01.0.08M.08') */
+  codec: string;
+
+  /** Encoded width in pixels */
+  width: number;
+
+  /** Encoded height in pixels */
+  height: number;
+
+  /** Target bitrate in bits per second */
+  bitrate?: number;
+
+  /** Frame rate in frames per second */
+  framerate?: number;
+
+  /** Bitrate control mode */
+  bitrateMode?: BitrateMode;
+
+  /** Pixel format of the frames that will be encoded (see VideoEncoderConfig) */
+  inputFormat?: VideoPixelFormat;
+
+  /**
+   * Frames per segment, i.e. the keyframe interval. Defaults to two
+   * seconds of frames.
+   */
+  segmentLength?: number;
+
+  /**
+   * Segments encoded at once, each on its own codec context. Defaults to
+   * one per four cores of the CPU budget. encode() does not block: raw
+   * frames are held until their segment is encoded, so to keep memory at
+   * about this many segments wait for 'dequeue' while `encodeQueueSize`
+   * is at `concurrency * segmentLength`.
+   */
+  concurrency?: number;
+}
+
+export interface VideoSegmentedEncoderInit {
+  output: (chunk: EncodedVideoChunk, metadata?: VideoEncoderOutputMetadata) => void;
+  error: (error: DOMException) => void;
+}
+
+/**
+ * Encodes a file's frames in parallel segments.
+ *
+ * @example
+ * ```ts
+ * const encoder = new VideoSegmentedEncoder({
+ *   output: (chunk, metadata) => muxer.addVideoChunk(chunk, metadata),
+ *   error: (err) => console.error(err),
+ * });
+ *
+ * encoder.configure({ codec: 'avc1.640028', width: 1920, height: 1080, framerate: 30 });
+ * for await (const frame of frames) {
+ *   encoder.encode(frame);
+ *   frame.close();
+ * }
+ * await encoder.flush();
+ * ```
+ */
+export class VideoSegmentedEncoder {
+  private _native: any = null;
+  private _state: CodecState = 'unconfigured';
+  private _outputCallback: (chunk: EncodedVideoChunk, metadata?: VideoEncoderOutputMetadata) => void;
+  private _errorCallback: (error: DOMException) => void;
+  private _config: VideoSegmentedEncoderConfig | null = null;
+  private _lastDescription: Uint8Array | null = null;
+  private _sentDecoderConfig: boolean = false;
+  private _listeners: Map<string, Set<() => void>> = new Map();
+  private _ondequeue: ((event: Event) => void) | null = null;
+
+  constructor(init: VideoSegmentedEncoderInit) {
+    if (!init.output || typeof init.output !== 'function') {
+      throw new TypeError('output callback is required');
+    }
+    if (!init.error || typeof init.error !== 'function') {
+      throw new TypeError('error callback is required');
+    }
+
+    this._outputCallback = init.output;
+    this._errorCallback = init.error;
+  }
+
+  get state(): CodecState {
+    return this._state;
+  }
+
+  /**
+   * Frames submitted but not yet encoded. Segments hold raw frames, so
+   * producers should wait for 'dequeue' before submitting more.
+   *
+   * @example Hold at most `concurrency` segments
+   * ```ts
+   * while (encoder.encodeQueueSize >= concurrency * segmentLength) {
+   *   await new Promise((resolve) => encoder.addEventListener('dequeue', resolve, { once: true }));
+   * }
+   * encoder.encode(frame);
+   * ```
+   */
+  get encodeQueueSize(): number {
+    return this._native ? this._native.getPendingFrames() : 0;
+  }
+
+  /**
+   * Event handler for dequeue events, fired as each segment's raw frames
+   * are released
+   */
+  get ondequeue(): ((event: Event) => void) | null {
+    return this._ondequeue;
+  }
+
+  set ondequeue(handler: ((event: Event) => void) | null) {
+    this._ondequeue = handler;
+  }
+
+  /**
+   * Minimal EventTarget-style API for 'dequeue' events, mirroring VideoEncoder.
+   */
+  addEventListener(type: string, listener: () => void, options?: { once?: boolean }): void {
+    if (typeof listener !== 'function') return;
+
+    const once = !!(options && (options as any).once);
+    const wrapper = once
+      ? () => {
+          this.removeEventListener(type, wrapper);
+          listener();
+        }
+      : listener;
+
+    let set = this._listeners.get(type);
+    if (!set) {
+      set = new Set();
+      this._listeners.set(type, set);
+    }
+    set.add(wrapper);
+  }
+
+  removeEventListener(type: string, listener: () => void): void {
+    const set = this._listeners.get(type);
+    if (!set) return;
+
+    if (set.has(listener)) {
+      set.delete(listener);
+    }
+
+    if (set.size === 0) {
+      this._listeners.delete(type);
+    }
+  }
+
+  private _dispatchEvent(type: string): void {
+    // Call the ondequeue handler if it exists
+    if (type === 'dequeue' && this._ondequeue) {
+      try {
+        this._ondequeue(new Event('dequeue'));
+      } catch {
+        // Swallow handler errors
+      }
+    }
+
+    const set = this._listeners.get(type);
+    if (!set) return;
+
+    for (const listener of Array.from(set)) {
+      try {
+        listener();
+      } catch {
+        // Swallow listener errors
+      }
+    }
+  }
+
+  configure(config: VideoSegmentedEncoderConfig): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Encoder is closed', 'InvalidStateError');
+    }
+
+    if (!isVideoCodecSupported(config.codec)) {
+      throw new DOMException(`Unsupported codec: ${config.codec}`, 'NotSupportedError');
+    }
+
+    if (!(config.width > 0) || !(config.height > 0)) {
+      throw new DOMException(`Invalid dimensions: ${config.width}x${config.height}`, 'TypeError');
+    }
+
+    if (config.segmentLength !== undefined &&
+        (!Number.isInteger(config.segmentLength) || config.segmentLength < 1)) {
+      throw new DOMException(`Invalid segmentLength: ${config.segmentLength}`, 'TypeError');
+    }
+
+    if (config.concurrency !== undefined &&
+        (!Number.isInteger(config.concurrency) || config.concurrency < 1)) {
+      throw new DOMException(`Invalid concurrency: ${config.concurrency}`, 'TypeError');
+    }
+
+    if (config.bitrateMode && !['constant', 'variable', 'quantizer'].includes(config.bitrateMode)) {
+      throw new DOMException(
+        `Invalid bitrateMode: ${config.bitrateMode}. Must be 'constant', 'variable', or 'quantizer'.`,
+        'TypeError'
+      );
+    }
+
+    // Output is Annex B with raw extradata; length-prefixed framing is only
+    // implemented by VideoEncoder
+    const framing: any = config;
+    if (framing.avc?.format === 'avc' || framing.hevc?.format === 'hevc') {
+      throw new DOMException('VideoSegmentedEncoder only produces Annex B output', 'NotSupportedError');
+    }
+
+    if (!native?.VideoSegmentedEncoder) {
+      throw new DOMException('Native addon not available', 'NotSupportedError');
+    }
+
+    if (!this._native) {
+      this._native = new native.VideoSegmentedEncoder(
+        this._onChunk.bind(this),
+        this._onError.bind(this),
+        () => this._dispatchEvent('dequeue')
+      );
+    }
+
+    const codecParams: any = {
+      codec: getFFmpegVideoCodec(config.codec),
+      width: config.width,
+      height: config.height,
+    };
+
+    const profileInfo = parseAvcCodecString(config.codec) ??
+      parseVp9CodecString(config.codec) ??
+      parseAv1CodecString(config.codec) ??
+      parseHevcCodecString(config.codec);
+    if (profileInfo) codecParams.profile = profileInfo.profile;
+
+    if (config.bitrate) codecParams.bitrate = config.bitrate;
+    if (config.framerate) codecParams.framerate = config.framerate;
+    if (config.bitrateMode) codecParams.bitrateMode = config.bitrateMode;
+    if (config.inputFormat) codecParams.inputFormat = config.inputFormat;
+    if (config.segmentLength) codecParams.segmentLength = config.segmentLength;
+    if (config.concurrency) codecParams.concurrency = config.concurrency;
+
+    this._native.configure(codecParams);
+    this._config = config;
+    this._lastDescription = null;
+    this._sentDecoderConfig = false;
+    this._state = 'configured';
+  }
+
+  /**
+   * Queue a frame. `keyFrame: true` forces an extra keyframe inside the
+   * current segment; segment boundaries are always keyframes.
+   */
+  encode(frame: VideoFrame, options?: VideoEncoderEncodeOptions): void {
+    if (this._state !== 'configured') {
+      throw new DOMException('Encoder is not configured', 'InvalidStateError');
+    }
+
+    const nativeFrame = frame._getNative();
+    if (!nativeFrame) {
+      throw new DOMException('VideoFrame has no native handle', 'InvalidStateError');
+    }
+
+    this._native.encode(nativeFrame, frame.timestamp, options?.keyFrame ?? false);
+  }
+
+  /**
+   * Ends the current segment early and resolves once every chunk for
+   * frames submitted before the call has been output
+   */
+  async flush(): Promise<void> {
+    if (this._state !== 'configured') {
+      throw new DOMException('Encoder is not configured', 'InvalidStateError');
+    }
+
+    return new Promise((resolve, reject) => {
+      this._native.flush((err: Error | null) => {
+        if (err) {
+          reject(new DOMException(err.message, 'EncodingError'));
+        } else {
+          resolve();
+        }
+      });
+    });
+  }
+
+  reset(): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Encoder is closed', 'InvalidStateError');
+    }
+
+    if (this._native) {
+      this._native.reset();
+    }
+    this._config = null;
+    this._state = 'unconfigured';
+  }
+
+  close(): void {
+    if (this._state === 'closed') return;
+
+    if (this._native) {
+      this._native.close();
+    }
+    this._config = null;
+    this._state = 'closed';
+  }
+
+  private _onChunk(
+    data: Uint8Array,
+    isKeyframe: boolean,
+    timestamp: number,
+    duration: number,
+    extradata?: Uint8Array
+  ): void {
+    const chunk = new EncodedVideoChunk({
+      type: isKeyframe ? 'key' : 'delta',
+      timestamp,
+      duration: duration > 0 ? duration : undefined,
+      data: new Uint8Array(data),
+    });
+
+    // Every segment's contexts are configured identically, so they should
+    // agree on extradata; if one doesn't, re-announce on that keyframe
+    let metadata: VideoEncoderOutputMetadata | undefined;
+    if (isKeyframe && this._config) {
+      const description = extradata ? new Uint8Array(extradata) : null;
+      if (!this._sentDecoderConfig || !sameBytes(description, this._lastDescription)) {
+        metadata = {
+          decoderConfig: {
+            codec: this._config.codec,
+            codedWidth: this._config.width,
+            codedHeight: this._config.height,
+            description: description ? description.buffer as ArrayBuffer : undefined,
+          },
+        };
+        this._lastDescription = description;
+        this._sentDecoderConfig = true;
+      }
+    }
+
+    try {
+      this._outputCallback(chunk, metadata);
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+
+  private _onError(message: string): void {
+    try {
+      this._errorCallback(new DOMException(message, 'EncodingError') as any);
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+}
+
+function sameBytes(a: Uint8Array | null, b: Uint8Array | null): boolean {
+  if (a === b) return true;
+  if (!a || !b || a.length !== b.length) return false;
+  for (let i = 0; i < a.length; i++) {
+    if (a[i] !== b[i]) return false;
+  }
+  return true;
+}
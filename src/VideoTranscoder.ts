@@ -0,0 +1,321 @@
+/**
+ * VideoTranscoder - Native decode -> scale -> encode pipeline
+ *
+ * Not part of the WebCodecs spec. Equivalent to wiring a VideoDecoder's
+ * output into a VideoEncoder, but decoded frames never cross into
+ * JavaScript: decoding, scaling/pixel-format conversion and encoding each
+ * run on their own native thread, joined by bounded queues, and only
+ * encoded chunks come back.
+ */
+
+import { EncodedVideoChunk } from './EncodedVideoChunk';
+import {
+  isVideoCodecSupported,
+  getFFmpegVideoCodec,
+  getFFmpegVideoDecoder,
+  parseAvcCodecString,
+  parseVp9CodecString,
+  parseAv1CodecString,
+  parseHevcCodecString,
+} from './codec-registry';
+import { CodecState, DOMException, BufferSource } from './types';
+import { BitrateMode, LatencyMode, VideoEncoderOutputMetadata } from './VideoEncoder';
+import { native } from './native';
+
+export interface VideoTranscoderConfig {
+  /** Input stream, as for VideoDecoder.configure() */
+  decoder: {
+    codec: string;
+    codedWidth?: number;
+    codedHeight?: number;
+    description?: BufferSource;
+  };
+
+  /** Output stream. width/height default to the decoded size. */
+  encoder: {
+    codec: string;
+    width?: number;
+    height?: number;
+    bitrate?: number;
+    framerate?: number;
+    bitrateMode?: BitrateMode;
+    latencyMode?: LatencyMode;
+  };
+}
+
+export interface VideoTranscoderProgress {
+  /** Frames decoded since configure() */
+  framesDecoded: number;
+
+  /** Chunks encoded since configure() */
+  framesEncoded: number;
+}
+
+export interface VideoTranscoderInit {
+  output: (chunk: EncodedVideoChunk, metadata?: VideoEncoderOutputMetadata) => void;
+  error: (error: DOMException) => void;
+
+  /** Called every 30 encoded frames and on each flush() */
+  progress?: (progress: VideoTranscoderProgress) => void;
+}
+
+/**
+ * Transcodes encoded chunks without surfacing decoded frames.
+ *
+ * @example
+ * ```ts
+ * const transcoder = new VideoTranscoder({
+ *   output: (chunk, metadata) => muxer.addVideoChunk(chunk, metadata),
+ *   error: (err) => console.error(err),
+ *   progress: ({ framesEncoded }) => console.log(framesEncoded),
+ * });
+ *
+ * transcoder.configure({
+ *   decoder: { codec: 'avc1.640028', description: avcC },
+ *   encoder: { codec: 'vp09.00.10.08', width: 1280, height: 720, bitrate: 2_000_000 },
+ * });
+ *
+ * for (const chunk of chunks) transcoder.transcode(chunk);
+ * await transcoder.flush();
+ * ```
+ */
+export class VideoTranscoder {
+  private _native: any = null;
+  private _state: CodecState = 'unconfigured';
+  private _outputCallback: (chunk: EncodedVideoChunk, metadata?: VideoEncoderOutputMetadata) => void;
+  private _errorCallback: (error: DOMException) => void;
+  private _progressCallback: ((progress: VideoTranscoderProgress) => void) | null;
+  private _config: VideoTranscoderConfig | null = null;
+  private _lastDescription: Uint8Array | null = null;
+  private _sentDecoderConfig: boolean = false;
+
+  constructor(init: VideoTranscoderInit) {
+    if (!init.output || typeof init.output !== 'function') {
+      throw new TypeError('output callback is required');
+    }
+    if (!init.error || typeof init.error !== 'function') {
+      throw new TypeError('error callback is required');
+    }
+
+    this._outputCallback = init.output;
+    this._errorCallback = init.error;
+    this._progressCallback = typeof init.progress === 'function' ? init.progress : null;
+  }
+
+  get state(): CodecState {
+    return this._state;
+  }
+
+  configure(config: VideoTranscoderConfig): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Transcoder is closed', 'InvalidStateError');
+    }
+
+    if (!config.decoder || !config.encoder) {
+      throw new DOMException('decoder and encoder configs are required', 'TypeError');
+    }
+
+    for (const codec of [config.decoder.codec, config.encoder.codec]) {
+      if (!isVideoCodecSupported(codec)) {
+        throw new DOMException(`Unsupported codec: ${codec}`, 'NotSupportedError');
+      }
+    }
+
+    const { width, height } = config.encoder;
+    if ((width !== undefined && !(width > 0)) || (height !== undefined && !(height > 0))) {
+      throw new DOMException(`Invalid output dimensions: ${width}x${height}`, 'TypeError');
+    }
+
+    if (config.encoder.latencyMode && !['quality', 'realtime'].includes(config.encoder.latencyMode)) {
+      throw new DOMException(
+        `Invalid latencyMode: ${config.encoder.latencyMode}. Must be 'quality' or 'realtime'.`,
+        'TypeError'
+      );
+    }
+
+    if (config.encoder.bitrateMode &&
+        !['constant', 'variable', 'quantizer'].includes(config.encoder.bitrateMode)) {
+      throw new DOMException(
+        `Invalid bitrateMode: ${config.encoder.bitrateMode}. Must be 'constant', 'variable', or 'quantizer'.`,
+        'TypeError'
+      );
+    }
+
+    // Output is Annex B with raw extradata; length-prefixed framing is only
+    // implemented by VideoEncoder
+    const framing: any = config.encoder;
+    if (framing.avc?.format === 'avc' || framing.hevc?.format === 'hevc') {
+      throw new DOMException('VideoTranscoder only produces Annex B output', 'NotSupportedError');
+    }
+
+    if (!native?.VideoTranscoder) {
+      throw new DOMException('Native addon not available', 'NotSupportedError');
+    }
+
+    if (!this._native) {
+      this._native = new native.VideoTranscoder(
+        this._onChunk.bind(this),
+        this._onError.bind(this),
+        this._onProgress.bind(this)
+      );
+    }
+
+    const decoderParams: any = { codec: getFFmpegVideoDecoder(config.decoder.codec) };
+    if (config.decoder.codedWidth) decoderParams.width = config.decoder.codedWidth;
+    if (config.decoder.codedHeight) decoderParams.height = config.decoder.codedHeight;
+    if (config.decoder.description) {
+      const description = config.decoder.description;
+      const desc = description instanceof ArrayBuffer
+        ? new Uint8Array(description)
+        : new Uint8Array(description.buffer, description.byteOffset, description.byteLength);
+      decoderParams.extradata = Buffer.from(desc);
+    }
+
+    const encoderParams: any = { codec: getFFmpegVideoCodec(config.encoder.codec) };
+    if (width) encoderParams.width = width;
+    if (height) encoderParams.height = height;
+    if (config.encoder.bitrate) encoderParams.bitrate = config.encoder.bitrate;
+    if (config.encoder.framerate) encoderParams.framerate = config.encoder.framerate;
+    if (config.encoder.bitrateMode) encoderParams.bitrateMode = config.encoder.bitrateMode;
+    if (config.encoder.latencyMode) encoderParams.latencyMode = config.encoder.latencyMode;
+
+    const profileInfo = parseAvcCodecString(config.encoder.codec) ??
+      parseVp9CodecString(config.encoder.codec) ??
+      parseAv1CodecString(config.encoder.codec) ??
+      parseHevcCodecString(config.encoder.codec);
+    if (profileInfo) encoderParams.profile = profileInfo.profile;
+
+    this._native.configure({ decoder: decoderParams, encoder: encoderParams });
+    this._config = config;
+    this._lastDescription = null;
+    this._sentDecoderConfig = false;
+    this._state = 'configured';
+  }
+
+  /**
+   * Queue one chunk of the input stream, in decode order
+   */
+  transcode(chunk: EncodedVideoChunk): void {
+    if (this._state !== 'configured') {
+      throw new DOMException('Transcoder is not configured', 'InvalidStateError');
+    }
+
+    const data = chunk._getData();
+    this._native.transcode(
+      Buffer.from(data.buffer, data.byteOffset, data.byteLength),
+      chunk.type === 'key',
+      chunk.timestamp,
+      chunk.duration ?? 0
+    );
+  }
+
+  /**
+   * Resolves once every chunk submitted before the call has been decoded,
+   * re-encoded and output
+   */
+  async flush(): Promise<void> {
+    if (this._state !== 'configured') {
+      throw new DOMException('Transcoder is not configured', 'InvalidStateError');
+    }
+
+    return new Promise((resolve, reject) => {
+      this._native.flush((err: Error | null) => {
+        if (err) {
+          reject(new DOMException(err.message, 'EncodingError'));
+        } else {
+          resolve();
+        }
+      });
+    });
+  }
+
+  reset(): void {
+    if (this._state === 'closed') {
+      throw new DOMException('Transcoder is closed', 'InvalidStateError');
+    }
+
+    if (this._native) {
+      this._native.reset();
+    }
+    this._config = null;
+    this._state = 'unconfigured';
+  }
+
+  close(): void {
+    if (this._state === 'closed') return;
+
+    if (this._native) {
+      this._native.close();
+    }
+    this._config = null;
+    this._state = 'closed';
+  }
+
+  private _onChunk(
+    data: Uint8Array,
+    isKeyframe: boolean,
+    timestamp: number,
+    duration: number,
+    codedWidth: number,
+    codedHeight: number,
+    extradata?: Uint8Array
+  ): void {
+    const chunk = new EncodedVideoChunk({
+      type: isKeyframe ? 'key' : 'delta',
+      timestamp,
+      duration: duration > 0 ? duration : undefined,
+      data: new Uint8Array(data),
+    });
+
+    // Encoders without flush support reopen after each flush(); re-announce
+    // only if that changed the extradata
+    let metadata: VideoEncoderOutputMetadata | undefined;
+    if (isKeyframe && this._config) {
+      const description = extradata ? new Uint8Array(extradata) : null;
+      if (!this._sentDecoderConfig || !sameBytes(description, this._lastDescription)) {
+        metadata = {
+          decoderConfig: {
+            codec: this._config.encoder.codec,
+            codedWidth,
+            codedHeight,
+            description: description ? description.buffer as ArrayBuffer : undefined,
+          },
+        };
+        this._lastDescription = description;
+        this._sentDecoderConfig = true;
+      }
+    }
+
+    try {
+      this._outputCallback(chunk, metadata);
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+
+  private _onError(message: string): void {
+    try {
+      this._errorCallback(new DOMException(message, 'EncodingError') as any);
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+
+  private _onProgress(framesDecoded: number, framesEncoded: number): void {
+    if (!this._progressCallback) return;
+    try {
+      this._progressCallback({ framesDecoded, framesEncoded });
+    } catch (e) {
+      // Don't propagate callback errors
+    }
+  }
+}
+
+function sameBytes(a: Uint8Array | null, b: Uint8Array | null): boolean {
+  if (a === b) return true;
+  if (!a || !b || a.length !== b.length) return false;
+  for (let i = 0; i < a.length; i++) {
+    if (a[i] !== b[i]) return false;
+  }
+  return true;
+}
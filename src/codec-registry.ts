@@ -58,6 +58,105 @@ export function parseVp9CodecString(codec: string): {
   };
 }
 
+/**
+ * Parse AV1 codec string format: av01.P.LLT.DD
+ * P = seq_profile (0 = Main, 1 = High, 2 = Professional), LL = level, T = tier, DD = bit depth
+ */
+export function parseAv1CodecString(codec: string): {
+  profile: number;
+  level: number;
+  bitDepth: number;
+} | null {
+  const match = codec.match(/^av01\.(\d)\.(\d{2})[MH]\.(\d{2})/);
+  if (!match) return null;
+
+  return {
+    profile: parseInt(match[1], 10),
+    level: parseInt(match[2], 10),
+    bitDepth: parseInt(match[3], 10),
+  };
+}
+
+/**
+ * Parse HEVC codec string format: hvc1.[A-C]P.C.TLL...
+ * P = general_profile_idc (1 = Main, 2 = Main 10, 4 = Range extensions)
+ */
+export function parseHevcCodecString(codec: string): { profile: number } | null {
+  const match = codec.match(/^(?:hvc1|hev1)\.[A-C]?(\d+)\./);
+  if (!match) return null;
+
+  return { profile: parseInt(match[1], 10) };
+}
+
+/**
+ * WebCodecs codec string for a demuxed stream, from its FFmpeg codec name
+ * and codec parameters (see Demuxer). Returns null for codecs the
+ * decoders here don't take.
+ */
+export function getCodecStringForStream(stream: {
+  codecName: string;
+  profile: number;
+  level: number;
+  bitDepth?: number;
+  extradata?: Uint8Array;
+}): string | null {
+  const hex = (n: number) => (n & 0xff).toString(16).padStart(2, '0').toUpperCase();
+  const dec = (n: number) => String(n).padStart(2, '0');
+  const { profile, level, extradata } = stream;
+  const bitDepth = stream.bitDepth ?? 8;
+
+  switch (stream.codecName) {
+    case 'h264':
+      // avcC carries profile, constraint flags and level verbatim
+      if (extradata && extradata[0] === 1 && extradata.length >= 4) {
+        return `avc1.${hex(extradata[1])}${hex(extradata[2])}${hex(extradata[3])}`;
+      }
+      return `avc1.${hex(profile > 0 ? profile : 0x42)}00${hex(level > 0 ? level : 0x1f)}`;
+    case 'hevc': {
+      // hvc1 = parameter sets in hvcC; hev1 = in-band (Annex B)
+      const tag = extradata && extradata[0] === 1 ? 'hvc1' : 'hev1';
+      return `${tag}.${profile > 0 ? profile : 1}.6.L${level > 0 ? level : 93}.B0`;
+    }
+    case 'vp8':
+      return 'vp8';
+    case 'vp9':
+      return `vp09.${dec(Math.max(profile, 0))}.${dec(level > 0 ? level : 10)}.${dec(bitDepth)}`;
+    case 'av1':
+      return `av01.${Math.max(profile, 0)}.${dec(level >= 0 ? level : 8)}M.${dec(bitDepth)}`;
+    case 'aac':
+      // FFmpeg's AAC profiles are the audio object type minus one
+      return `mp4a.40.${profile >= 0 ? profile + 1 : 2}`;
+    case 'opus':
+    case 'mp3':
+    case 'flac':
+    case 'vorbis':
+      return stream.codecName;
+    default:
+      return null;
+  }
+}
+
+/**
+ * Parse a WebCodecs scalabilityMode: [L|S]<spatial>T<temporal>[h][_KEY][_SHIFT]
+ * Mirrors parseScalabilityMode in native/svc.cpp.
+ */
+export function parseScalabilityMode(mode: string): {
+  spatialLayers: number;
+  temporalLayers: number;
+  isSimulcast: boolean;
+  ratio: number;
+} | null {
+  const match = mode.match(/^([LS])(\d)T(\d)(h)?(_KEY)?(_SHIFT)?$/);
+  if (!match) return null;
+
+  return {
+    spatialLayers: parseInt(match[2], 10),
+    temporalLayers: parseInt(match[3], 10),
+    isSimulcast: match[1] === 'S',
+    ratio: match[4] ? 1.5 : 2,
+  };
+}
+
 /**
  * Video codec registry
  */
@@ -6,7 +6,7 @@
  */
 
 // Core frame types
-export { VideoFrame, VideoFrameInit, VideoFrameBufferInit, VideoPixelFormat, PlaneLayout, VideoFrameCopyToOptions } from './VideoFrame';
+export { VideoFrame, VideoFrameInit, VideoFrameBufferInit, VideoPixelFormat, PlaneLayout, VideoFrameCopyToOptions, VideoFrameCodecAnalysis, VideoFrameMotionGrid } from './VideoFrame';
 export { AudioData, AudioDataInit, AudioDataCopyToOptions, AudioSampleFormat } from './AudioData';
 
 // Encoded chunk types
@@ -32,13 +32,96 @@ export {
   AlphaOption,
 } from './VideoEncoder';
 
+export {
+  VideoLadderEncoder,
+  VideoLadderEncoderConfig,
+  VideoLadderEncoderInit,
+  VideoLadderOutputMetadata,
+  VideoLadderRendition,
+} from './VideoLadderEncoder';
+
+export {
+  VideoSegmentedEncoder,
+  VideoSegmentedEncoderConfig,
+  VideoSegmentedEncoderInit,
+} from './VideoSegmentedEncoder';
+
+export { SvcLayerFilter, SvcLayerFilterInit } from './SvcLayerFilter';
+
 export {
   VideoDecoder,
   VideoDecoderConfig,
   VideoDecoderInit,
   VideoDecoderSupport,
+  VideoDecoderOptions,
+  DecoderDiscard,
+  VideoDecoderAdaptiveDrop,
+  VideoDecoderDropStats,
 } from './VideoDecoder';
 
+export {
+  VideoBatchDecoder,
+  VideoBatchDecoderConfig,
+  VideoBatchDecoderInit,
+} from './VideoBatchDecoder';
+
+export {
+  VideoTranscoder,
+  VideoTranscoderConfig,
+  VideoTranscoderInit,
+  VideoTranscoderProgress,
+} from './VideoTranscoder';
+
+export {
+  Demuxer,
+  DemuxerTrack,
+  DemuxerVideoTrack,
+  DemuxerAudioTrack,
+  DemuxerPacket,
+} from './Demuxer';
+
+export {
+  Muxer,
+  MuxerConfig,
+  MuxerInit,
+  MuxerTrack,
+  MuxerVideoTrack,
+  MuxerAudioTrack,
+  MuxerSegment,
+} from './Muxer';
+
+export {
+  SpriteSheet,
+  SpriteSheetInit,
+  SpriteTile,
+} from './SpriteSheet';
+
+export {
+  FrameCache,
+  FrameCacheInit,
+  FrameCacheStats,
+} from './FrameCache';
+
+export {
+  SceneDetector,
+  SceneDetectorOptions,
+  SceneScore,
+} from './SceneDetector';
+
+export {
+  toTensor,
+  TensorOptions,
+} from './tensor';
+
+export {
+  compareFrames,
+  StreamQuality,
+  QualityOptions,
+  PlaneQuality,
+  FrameQuality,
+  StreamQualitySummary,
+} from './metrics';
+
 // Audio encoder/decoder
 export {
   AudioEncoder,
@@ -108,6 +191,29 @@ export function hasCodec(codecName: string, type: 'encoder' | 'decoder'): boolea
   return false;
 }
 
+/**
+ * CPU budget the native layer sizes codec and swscale thread pools from.
+ *
+ * `effectiveCores` is the smaller of the affinity mask (cpuset/taskset) and the
+ * cgroup CPU quota rounded up, or `NODE_WEBCODECS_THREADS` when set. When it
+ * is below `hostCores` (`constrained`), codecs get exactly that many threads
+ * instead of FFmpeg's host-core auto-detection.
+ */
+export function getCpuInfo(): {
+  hostCores: number;
+  affinityCores: number;
+  quotaCores: number | null;
+  cgroupVersion: 1 | 2 | null;
+  overrideCores: number | null;
+  effectiveCores: number;
+  constrained: boolean;
+} | null {
+  if (_native && _native.getCpuInfo) {
+    return _native.getCpuInfo();
+  }
+  return null;
+}
+
 /**
  * Check if native addon is available
  */
@@ -0,0 +1,181 @@
+/**
+ * Frame quality metrics - PSNR, SSIM and MS-SSIM between VideoFrames
+ *
+ * Not part of the WebCodecs spec. Computed natively on the libuv thread pool
+ * straight from the frames' planes, for validating encoder settings against
+ * their sources. compareFrames() scores pairs; StreamQuality accumulates
+ * scores over a whole stream.
+ */
+
+import { VideoFrame } from './VideoFrame';
+import { DOMException } from './types';
+import { native } from './native';
+
+export interface QualityOptions {
+  /** Per-plane and frame SSIM. Default true */
+  ssim?: boolean;
+  /** Luma (first plane) MS-SSIM over 5 scales; costs about 1.3x SSIM. Default false */
+  msssim?: boolean;
+}
+
+export interface PlaneQuality {
+  mse: number;
+  /** dB; Infinity for identical planes */
+  psnr: number;
+  ssim?: number;
+  pixels: number;
+}
+
+export interface FrameQuality {
+  /** In plane order: Y, U, V[, A] for YUV; G, B, R for RGB */
+  planes: PlaneQuality[];
+  /** Over all planes, weighted by pixel count */
+  psnr: number;
+  ssim?: number;
+  msssim?: number;
+  /** Largest sample value PSNR was computed against (255 for 8-bit) */
+  peak: number;
+}
+
+export interface StreamQualitySummary {
+  frames: number;
+  /** PSNR of the mean squared error over the stream, per plane and overall */
+  psnr: number;
+  planePsnr: number[];
+  /** Mean of per-frame values */
+  meanPsnr: number;
+  ssim?: number;
+  msssim?: number;
+  /** Worst frame, to catch a single broken one */
+  minPsnr: number;
+  minSsim?: number;
+}
+
+/**
+ * Score distorted frames against references, pairwise. A distorted frame in
+ * another size or pixel format is converted to its reference's first.
+ * Frames may be closed as soon as this returns.
+ *
+ * @example
+ * ```ts
+ * const [q] = await compareFrames(source, decoded, { msssim: true });
+ * console.log(q.psnr, q.ssim, q.msssim);
+ * ```
+ */
+export function compareFrames(
+  reference: VideoFrame | VideoFrame[],
+  distorted: VideoFrame | VideoFrame[],
+  options: QualityOptions = {}
+): Promise<FrameQuality[]> {
+  const references = Array.isArray(reference) ? reference : [reference];
+  const distorteds = Array.isArray(distorted) ? distorted : [distorted];
+  if (references.length !== distorteds.length) {
+    return Promise.reject(new DOMException('reference and distorted must have the same length', 'TypeError'));
+  }
+  if (!native?.compareFrames) {
+    return Promise.reject(new DOMException('Native addon not available', 'NotSupportedError'));
+  }
+
+  return new Promise((resolve, reject) => {
+    try {
+      native.compareFrames(
+        references.map((frame) => frame._getNative()),
+        distorteds.map((frame) => frame._getNative()),
+        { ssim: options.ssim ?? true, msssim: options.msssim ?? false },
+        (err: Error | null, results: FrameQuality[]) => {
+          if (err) {
+            reject(new DOMException(err.message, 'EncodingError'));
+          } else {
+            resolve(results);
+          }
+        }
+      );
+    } catch (e: any) {
+      // Closed frames
+      reject(new DOMException(e.message, e.name === 'TypeError' ? 'TypeError' : 'InvalidStateError'));
+    }
+  });
+}
+
+/**
+ * Aggregate quality over a stream. Stream PSNR comes from the summed
+ * squared error, not the mean of per-frame PSNRs (which identical frames
+ * would make infinite); both are reported.
+ *
+ * @example
+ * ```ts
+ * const quality = new StreamQuality({ msssim: true });
+ * // for each decoded frame and its source:
+ * await quality.add(source, decoded);
+ * console.log(quality.summary);
+ * ```
+ */
+export class StreamQuality {
+  private _options: QualityOptions;
+  private _frames = 0;
+  private _squared: number[] = [];
+  private _pixels: number[] = [];
+  private _psnrSum = 0;
+  private _ssimSum = 0;
+  private _msssimSum = 0;
+  private _minPsnr = Infinity;
+  private _minSsim = Infinity;
+  private _peak = 255;
+
+  constructor(options: QualityOptions = {}) {
+    this._options = options;
+  }
+
+  /** Score one pair (or batch of pairs) and fold it into the summary */
+  async add(reference: VideoFrame | VideoFrame[], distorted: VideoFrame | VideoFrame[]): Promise<FrameQuality[]> {
+    const results = await compareFrames(reference, distorted, this._options);
+    for (const result of results) {
+      this.addResult(result);
+    }
+    return results;
+  }
+
+  /** Fold in a result from compareFrames() */
+  addResult(result: FrameQuality): void {
+    this._frames++;
+    this._peak = result.peak;
+    result.planes.forEach((plane, i) => {
+      this._squared[i] = (this._squared[i] ?? 0) + plane.mse * plane.pixels;
+      this._pixels[i] = (this._pixels[i] ?? 0) + plane.pixels;
+    });
+    this._psnrSum += result.psnr;
+    this._minPsnr = Math.min(this._minPsnr, result.psnr);
+    if (result.ssim !== undefined) {
+      this._ssimSum += result.ssim;
+      this._minSsim = Math.min(this._minSsim, result.ssim);
+    }
+    if (result.msssim !== undefined) {
+      this._msssimSum += result.msssim;
+    }
+  }
+
+  get summary(): StreamQualitySummary {
+    const peak = this._peak;
+    // Same formula as native: 10 log10(peak^2 / mse), mse = squared / pixels
+    const psnr = (squared: number, pixels: number) =>
+      squared > 0 ? 10 * Math.log10((peak * peak * pixels) / squared) : Infinity;
+
+    const totalSquared = this._squared.reduce((a, b) => a + b, 0);
+    const totalPixels = this._pixels.reduce((a, b) => a + b, 0);
+    const summary: StreamQualitySummary = {
+      frames: this._frames,
+      psnr: this._frames ? psnr(totalSquared, totalPixels) : NaN,
+      planePsnr: this._squared.map((squared, i) => psnr(squared, this._pixels[i])),
+      meanPsnr: this._frames ? this._psnrSum / this._frames : NaN,
+      minPsnr: this._frames ? this._minPsnr : NaN,
+    };
+    if (this._options.ssim ?? true) {
+      summary.ssim = this._frames ? this._ssimSum / this._frames : NaN;
+      summary.minSsim = this._frames ? this._minSsim : NaN;
+    }
+    if (this._options.msssim) {
+      summary.msssim = this._frames ? this._msssimSum / this._frames : NaN;
+    }
+    return summary;
+  }
+}
@@ -0,0 +1,100 @@
+/**
+ * toTensor - Batched ML preprocessing of VideoFrames
+ *
+ * Not part of the WebCodecs spec. Converts decoded frames to RGB, resizes
+ * them and normalizes with a per-channel mean/std in one native pass on the
+ * libuv thread pool, writing the whole batch into a single tensor buffer.
+ * Replaces a copyTo({ format: 'RGBA' }) plus a JS loop per frame.
+ */
+
+import { VideoFrame } from './VideoFrame';
+import { DOMException } from './types';
+import { native } from './native';
+
+export interface TensorOptions {
+  /** Model input size; frames are stretched to it */
+  width: number;
+  height: number;
+
+  /** 'NCHW' (default) or 'NHWC' */
+  layout?: 'NCHW' | 'NHWC';
+
+  /** Per-channel RGB mean and std on 0-1 values. Default: ImageNet */
+  mean?: [number, number, number];
+  std?: [number, number, number];
+
+  /**
+   * 'float32' (default) writes a Float32Array; 'float16' writes IEEE
+   * half-precision bit patterns into a Uint16Array.
+   */
+  dtype?: 'float32' | 'float16';
+}
+
+const IMAGENET_MEAN: [number, number, number] = [0.485, 0.456, 0.406];
+const IMAGENET_STD: [number, number, number] = [0.229, 0.224, 0.225];
+
+/**
+ * Write frames as a [N, 3, H, W] (or [N, H, W, 3]) tensor of
+ * (x / 255 - mean) / std. Frames stay open and may be closed as soon as
+ * this returns. output is allocated if not given; a given one must hold
+ * at least N * 3 * H * W elements.
+ *
+ * @example
+ * ```ts
+ * const input = new Float32Array(8 * 3 * 224 * 224);
+ * await toTensor(frames, { width: 224, height: 224 }, input);
+ * frames.forEach((f) => f.close());
+ * session.run({ input: new ort.Tensor('float32', input, [8, 3, 224, 224]) });
+ * ```
+ */
+export function toTensor(
+  frames: VideoFrame[],
+  options: TensorOptions,
+  output?: Float32Array | Uint16Array
+): Promise<Float32Array | Uint16Array> {
+  const { width, height } = options ?? ({} as TensorOptions);
+  if (!Number.isInteger(width) || width <= 0 || !Number.isInteger(height) || height <= 0) {
+    return Promise.reject(new DOMException(`Invalid tensor size: ${width}x${height}`, 'TypeError'));
+  }
+
+  const layout = options.layout ?? 'NCHW';
+  const dtype = options.dtype ?? 'float32';
+  const mean = options.mean ?? IMAGENET_MEAN;
+  const std = options.std ?? IMAGENET_STD;
+  if (layout !== 'NCHW' && layout !== 'NHWC') {
+    return Promise.reject(new DOMException(`Invalid layout: ${layout}`, 'TypeError'));
+  }
+  if (dtype !== 'float32' && dtype !== 'float16') {
+    return Promise.reject(new DOMException(`Invalid dtype: ${dtype}`, 'TypeError'));
+  }
+  if (mean.length !== 3 || std.length !== 3 || std.some((s) => !(s > 0))) {
+    return Promise.reject(new DOMException('mean and std need 3 values, std positive', 'TypeError'));
+  }
+
+  if (!native?.toTensor) {
+    return Promise.reject(new DOMException('Native addon not available', 'NotSupportedError'));
+  }
+
+  const length = frames.length * 3 * width * height;
+  const tensor = output ?? (dtype === 'float16' ? new Uint16Array(length) : new Float32Array(length));
+
+  return new Promise((resolve, reject) => {
+    try {
+      native.toTensor(
+        frames.map((frame) => frame._getNative()),
+        { width, height, layout, dtype, mean, std },
+        tensor,
+        (err: Error | null) => {
+          if (err) {
+            reject(new DOMException(err.message, 'EncodingError'));
+          } else {
+            resolve(tensor);
+          }
+        }
+      );
+    } catch (e: any) {
+      // Closed frames, or an output too small for the batch
+      reject(new DOMException(e.message, 'TypeError'));
+    }
+  });
+}
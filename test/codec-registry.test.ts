@@ -6,6 +6,10 @@ import {
   parseAvcCodecString,
   parseAacCodecString,
   parseVp9CodecString,
+  parseAv1CodecString,
+  parseHevcCodecString,
+  parseScalabilityMode,
+  getCodecStringForStream,
   isVideoCodecSupported,
   isAudioCodecSupported,
   getFFmpegVideoCodec,
@@ -95,6 +99,64 @@ describe('Codec Registry', () => {
     });
   });
 
+  describe('parseAv1CodecString', () => {
+    it('should parse AV1 profile, level and bit depth', () => {
+      const result = parseAv1CodecString('av01.1.08M.10');
+      expect(result).not.toBeNull();
+      expect(result!.profile).toBe(1); // High
+      expect(result!.level).toBe(8);
+      expect(result!.bitDepth).toBe(10);
+    });
+
+    it('should return null for incomplete AV1 strings', () => {
+      expect(parseAv1CodecString('av01')).toBeNull();
+    });
+  });
+
+  describe('parseHevcCodecString', () => {
+    it('should parse general_profile_idc with and without profile space', () => {
+      expect(parseHevcCodecString('hvc1.1.6.L93.B0')!.profile).toBe(1);
+      expect(parseHevcCodecString('hev1.A4.10.L120.90')!.profile).toBe(4);
+    });
+
+    it('should return null for non-HEVC strings', () => {
+      expect(parseHevcCodecString('avc1.42E01E')).toBeNull();
+    });
+  });
+
+  describe('parseScalabilityMode', () => {
+    it('should parse simulcast modes and the 1.5x ratio suffix', () => {
+      expect(parseScalabilityMode('S3T2')).toEqual({
+        spatialLayers: 3,
+        temporalLayers: 2,
+        isSimulcast: true,
+        ratio: 2,
+      });
+      expect(parseScalabilityMode('L2T1h')!.ratio).toBe(1.5);
+    });
+
+    it('should return null for malformed modes', () => {
+      expect(parseScalabilityMode('X1T1')).toBeNull();
+    });
+  });
+
+  describe('getCodecStringForStream', () => {
+    it('should take H.264 profile and level from avcC', () => {
+      const avcC = new Uint8Array([1, 0x64, 0x00, 0x28, 0xff]);
+      expect(getCodecStringForStream({ codecName: 'h264', profile: 100, level: 40, extradata: avcC }))
+        .toBe('avc1.640028');
+    });
+
+    it('should build VP9, AV1 and AAC strings from codec parameters', () => {
+      expect(getCodecStringForStream({ codecName: 'vp9', profile: 2, level: 31, bitDepth: 10 }))
+        .toBe('vp09.02.31.10');
+      expect(getCodecStringForStream({ codecName: 'av1', profile: 0, level: 8, bitDepth: 8 }))
+        .toBe('av01.0.08M.08');
+      expect(getCodecStringForStream({ codecName: 'aac', profile: 1, level: -99 })).toBe('mp4a.40.2');
+      expect(getCodecStringForStream({ codecName: 'mpeg2video', profile: 4, level: 8 })).toBeNull();
+    });
+  });
+
   describe('isVideoCodecSupported', () => {
     it('should support H.264 codecs', () => {
       expect(isVideoCodecSupported('avc1.42E01E')).toBe(true);
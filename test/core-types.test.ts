@@ -104,6 +104,23 @@ describe('VideoFrame', () => {
       expect(frame.allocationSize()).toBe(Math.floor(width * height * 1.5));
       frame.close();
     });
+
+    it('should use 16-bit samples for I420P10', () => {
+      const width = 320;
+      const height = 240;
+      const data = new Uint16Array(width * height * 1.5);
+
+      const frame = new VideoFrame(data, {
+        format: 'I420P10',
+        codedWidth: width,
+        codedHeight: height,
+        timestamp: 0,
+      });
+
+      expect(frame.format).toBe('I420P10');
+      expect(frame.allocationSize()).toBe(width * height * 3);
+      frame.close();
+    });
   });
 
   describe('clone', () => {
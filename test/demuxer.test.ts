@@ -0,0 +1,105 @@
+/**
+ * Tests for Demuxer
+ */
+
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { Demuxer } from '../src/Demuxer';
+import { VideoDecoder } from '../src/VideoDecoder';
+import { VideoEncoder } from '../src/VideoEncoder';
+import { VideoFrame } from '../src/VideoFrame';
+import { EncodedVideoChunk } from '../src/EncodedVideoChunk';
+
+// Builds without libavformat have no Demuxer
+const describeIfSupported = Demuxer.isSupported() ? describe : describe.skip;
+
+// Encode VP8 frames and wrap them in an IVF file (timebase 1/30)
+async function writeIvf(file: string, frameCount: number): Promise<void> {
+  const chunks: EncodedVideoChunk[] = [];
+  const encoder = new VideoEncoder({
+    output: (chunk) => chunks.push(chunk),
+    error: (err) => { throw err; },
+  });
+  encoder.configure({ codec: 'vp8', width: 160, height: 120, framerate: 30 });
+
+  for (let i = 0; i < frameCount; i++) {
+    const buffer = Buffer.alloc(160 * 120 * 3 / 2, (i * 16) & 0xff);
+    const frame = new VideoFrame(buffer, { format: 'I420', codedWidth: 160, codedHeight: 120, timestamp: i * 33333 });
+    encoder.encode(frame, { keyFrame: i === 0 });
+    frame.close();
+  }
+  await encoder.flush();
+  encoder.close();
+
+  const header = Buffer.alloc(32);
+  header.write('DKIF', 0);
+  header.writeUInt16LE(0, 4);
+  header.writeUInt16LE(32, 6);
+  header.write('VP80', 8);
+  header.writeUInt16LE(160, 12);
+  header.writeUInt16LE(120, 14);
+  header.writeUInt32LE(30, 16);
+  header.writeUInt32LE(1, 20);
+  header.writeUInt32LE(chunks.length, 24);
+
+  const parts = [header];
+  chunks.forEach((chunk, i) => {
+    const data = Buffer.alloc(chunk.byteLength);
+    chunk.copyTo(data);
+    const frameHeader = Buffer.alloc(12);
+    frameHeader.writeUInt32LE(data.length, 0);
+    frameHeader.writeBigUInt64LE(BigInt(i), 4);
+    parts.push(frameHeader, data);
+  });
+  fs.writeFileSync(file, Buffer.concat(parts));
+}
+
+describeIfSupported('Demuxer', () => {
+  const file = path.join(os.tmpdir(), `nwc-demuxer-${process.pid}.ivf`);
+
+  beforeAll(async () => {
+    await writeIvf(file, 6);
+  });
+
+  afterAll(() => {
+    fs.rmSync(file, { force: true });
+  });
+
+  it('should report the track and read chunks from a file descriptor', async () => {
+    const fd = fs.openSync(file, 'r');
+    const demuxer = new Demuxer();
+
+    const tracks = await demuxer.open(fd);
+    expect(tracks).toHaveLength(1);
+    expect(tracks[0].type).toBe('video');
+    expect(tracks[0].config).toMatchObject({ codec: 'vp8', codedWidth: 160, codedHeight: 120 });
+
+    const packets = await demuxer.read(100);
+    expect(packets.map((p) => p.chunk.timestamp)).toEqual([0, 33333, 66667, 100000, 133333, 166667]);
+    expect(packets[0].chunk.type).toBe('key');
+    expect(await demuxer.read(100)).toEqual([]);
+
+    demuxer.close();
+    fs.closeSync(fd);
+  });
+
+  it('should pipe a video track into a decoder natively', async () => {
+    const demuxer = new Demuxer();
+    const [track] = await demuxer.open(file);
+
+    let frames = 0;
+    const decoder = new VideoDecoder({
+      output: (frame) => { frames++; frame.close(); },
+      error: (err) => { throw err; },
+    });
+    decoder.configure(track.config as any);
+
+    expect(await demuxer.pipeTo(track.index, decoder)).toBe(6);
+    await decoder.flush();
+    expect(frames).toBe(6);
+
+    decoder.close();
+    demuxer.close();
+  });
+});
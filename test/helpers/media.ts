@@ -0,0 +1,62 @@
+/**
+ * Frame and chunk factories shared by the encoder/decoder tests
+ */
+
+import { VideoFrame } from '../../src/VideoFrame';
+import { EncodedVideoChunk } from '../../src/EncodedVideoChunk';
+import { VideoSegmentedEncoder } from '../../src/VideoSegmentedEncoder';
+
+export const FRAME_DURATION = 33333;
+
+export function createI420Frame(width: number, height: number, timestamp: number, luma = 128): VideoFrame {
+  const buffer = Buffer.alloc(width * height * 3 / 2, 128);
+  buffer.fill(luma, 0, width * height);
+  return new VideoFrame(buffer, {
+    format: 'I420',
+    codedWidth: width,
+    codedHeight: height,
+    timestamp,
+  });
+}
+
+/** Flat luma of source frame i; 9 levels apart, so it survives a lossy round trip */
+export function frameLuma(i: number): number {
+  return 16 + (i * 9) % 220;
+}
+
+/** Source frame i: flat frameLuma(i) at timestamp i * FRAME_DURATION */
+export function sourceFrame(i: number, width = 320, height = 240): VideoFrame {
+  return createI420Frame(width, height, i * FRAME_DURATION, frameLuma(i));
+}
+
+/** H.264 (Annex B) of frameCount source frames with a keyframe every gopLength */
+export async function encodeH264Gops(
+  frameCount: number,
+  gopLength: number,
+  width = 320,
+  height = 240
+): Promise<EncodedVideoChunk[]> {
+  const chunks: EncodedVideoChunk[] = [];
+  const encoder = new VideoSegmentedEncoder({
+    output: (chunk) => chunks.push(chunk),
+    error: (err) => { throw err; },
+  });
+  encoder.configure({ codec: 'avc1.42001f', width, height, segmentLength: gopLength });
+
+  for (let i = 0; i < frameCount; i++) {
+    const frame = sourceFrame(i, width, height);
+    encoder.encode(frame);
+    frame.close();
+  }
+  await encoder.flush();
+  encoder.close();
+  return chunks;
+}
+
+/** Top-left luma sample; closes the frame */
+export async function readLuma(frame: VideoFrame): Promise<number> {
+  const data = new Uint8Array(frame.allocationSize());
+  await frame.copyTo(data);
+  frame.close();
+  return data[0];
+}
@@ -0,0 +1,82 @@
+/**
+ * Tests for frame quality metrics
+ */
+
+import { compareFrames, StreamQuality } from '../src/metrics';
+import { VideoFrame } from '../src/VideoFrame';
+
+const WIDTH = 256;
+const HEIGHT = 256;
+
+// Textured I420 frame; noise adds +-amplitude to luma in a fixed pattern
+function texturedFrame(noise: number, width = WIDTH, height = HEIGHT): VideoFrame {
+  const buffer = Buffer.alloc(width * height * 3 / 2, 128);
+  for (let y = 0; y < height; y++) {
+    for (let x = 0; x < width; x++) {
+      const base = 64 + ((x * 3 + y * 5) % 128);
+      buffer[y * width + x] = base + ((x ^ y) & 1 ? noise : -noise);
+    }
+  }
+  return new VideoFrame(buffer, { format: 'I420', codedWidth: width, codedHeight: height, timestamp: 0 });
+}
+
+describe('compareFrames', () => {
+  it('should score identical frames as perfect', async () => {
+    const a = texturedFrame(0);
+    const b = texturedFrame(0);
+    const [q] = await compareFrames(a, b, { msssim: true });
+    a.close();
+    b.close();
+
+    expect(q.psnr).toBe(Infinity);
+    expect(q.planes).toHaveLength(3);
+    expect(q.planes[0]).toMatchObject({ mse: 0, pixels: WIDTH * HEIGHT });
+    expect(q.ssim).toBeCloseTo(1, 6);
+    expect(q.msssim).toBeCloseTo(1, 6);
+  });
+
+  it('should report lower quality for more distortion', async () => {
+    const source = texturedFrame(0);
+    const light = texturedFrame(2);
+    const heavy = texturedFrame(12);
+    const [lightQ, heavyQ] = await compareFrames([source, source], [light, heavy], { msssim: true });
+    [source, light, heavy].forEach((f) => f.close());
+
+    // Luma only is distorted: MSE is exactly noise^2
+    expect(lightQ.planes[0].mse).toBeCloseTo(4, 6);
+    expect(lightQ.planes[1].psnr).toBe(Infinity);
+    expect(lightQ.planes[0].psnr).toBeCloseTo(10 * Math.log10(255 * 255 / 4), 6);
+    expect(heavyQ.psnr).toBeLessThan(lightQ.psnr);
+    expect(heavyQ.ssim!).toBeLessThan(lightQ.ssim!);
+    expect(heavyQ.msssim!).toBeLessThan(lightQ.msssim!);
+    expect(lightQ.ssim!).toBeLessThan(1);
+  });
+
+  it('should scale a distorted frame of another size to the reference', async () => {
+    const source = texturedFrame(0);
+    const small = texturedFrame(0, 128, 128);
+    const [q] = await compareFrames(source, small, { ssim: false });
+    source.close();
+    small.close();
+
+    expect(q.psnr).toBeGreaterThan(10);
+    expect(q.ssim).toBeUndefined();
+  });
+
+  it('should aggregate a stream from summed squared error', async () => {
+    const quality = new StreamQuality();
+    const source = texturedFrame(0);
+    const identical = texturedFrame(0);
+    const noisy = texturedFrame(4);
+    await quality.add(source, identical);
+    await quality.add(source, noisy);
+    [source, identical, noisy].forEach((f) => f.close());
+
+    const summary = quality.summary;
+    expect(summary.frames).toBe(2);
+    // Mean per-frame PSNR is infinite; the stream figure is not
+    expect(summary.meanPsnr).toBe(Infinity);
+    expect(summary.planePsnr[0]).toBeCloseTo(10 * Math.log10(255 * 255 / 8), 6);
+    expect(summary.minSsim!).toBeLessThan(1);
+  });
+});
@@ -0,0 +1,134 @@
+/**
+ * Tests for Muxer
+ */
+
+import * as fs from 'fs';
+import * as os from 'os';
+import * as path from 'path';
+import { Muxer, MuxerSegment } from '../src/Muxer';
+import { VideoEncoder } from '../src/VideoEncoder';
+import { VideoFrame } from '../src/VideoFrame';
+import { EncodedVideoChunk } from '../src/EncodedVideoChunk';
+
+// Builds without libavformat have no Muxer
+const describeIfSupported = Muxer.isSupported() ? describe : describe.skip;
+
+function encodeFrames(encoder: VideoEncoder, count: number, gop: number): void {
+  for (let i = 0; i < count; i++) {
+    const buffer = Buffer.alloc(160 * 120 * 3 / 2, (i * 16) & 0xff);
+    const frame = new VideoFrame(buffer, { format: 'I420', codedWidth: 160, codedHeight: 120, timestamp: i * 33333 });
+    encoder.encode(frame, { keyFrame: i % gop === 0 });
+    frame.close();
+  }
+}
+
+function boxType(data: Uint8Array, offset: number): string {
+  return Buffer.from(data.subarray(offset + 4, offset + 8)).toString('ascii');
+}
+
+function containsBox(data: Uint8Array, type: string): boolean {
+  return Buffer.from(data).includes(Buffer.from(type, 'ascii'));
+}
+
+describeIfSupported('Muxer', () => {
+  it('should mux an attached encoder into an init segment and keyframe-aligned fragments', async () => {
+    const segments: MuxerSegment[] = [];
+    const chunks: EncodedVideoChunk[] = [];
+    const muxer = new Muxer({ output: (s) => segments.push(s), error: (err) => { throw err; } });
+    const encoder = new VideoEncoder({ output: (chunk) => chunks.push(chunk), error: (err) => { throw err; } });
+
+    encoder.configure({ codec: 'vp09.00.10.08', width: 160, height: 120, framerate: 30 });
+    muxer.configure({ tracks: [{ type: 'video', codec: 'vp09.00.10.08', width: 160, height: 120 }] });
+    muxer.attachEncoder(0, encoder);
+
+    encodeFrames(encoder, 6, 3);
+    await encoder.flush();
+    await muxer.finalize();
+    encoder.close();
+    muxer.close();
+
+    // Packets went to the muxer, not the output callback
+    expect(chunks).toHaveLength(0);
+
+    expect(segments.map((s) => s.type)).toEqual(['init', 'fragment', 'fragment']);
+    expect(boxType(segments[0].data!, 0)).toBe('ftyp');
+    expect(boxType(segments[1].data!, 0)).toBe('moof');
+    expect(segments.slice(1).map((s) => s.timestamp)).toEqual([0, 99999]);
+    expect(segments[1].duration).toBe(99999);
+    segments.forEach((s) => expect(s.byteLength).toBe(s.data!.length));
+  });
+
+  it('should write segments to a file descriptor from addChunk', async () => {
+    const chunks: { chunk: EncodedVideoChunk; metadata?: any }[] = [];
+    const encoder = new VideoEncoder({
+      output: (chunk, metadata) => chunks.push({ chunk, metadata }),
+      error: (err) => { throw err; },
+    });
+    encoder.configure({ codec: 'vp09.00.10.08', width: 160, height: 120, framerate: 30 });
+    encodeFrames(encoder, 4, 4);
+    await encoder.flush();
+    encoder.close();
+
+    const file = path.join(os.tmpdir(), `nwc-muxer-${process.pid}.mp4`);
+    const fd = fs.openSync(file, 'w');
+    const segments: MuxerSegment[] = [];
+    const muxer = new Muxer({ output: (s) => segments.push(s), error: (err) => { throw err; } });
+
+    try {
+      muxer.configure({ tracks: [{ type: 'video', codec: 'vp09.00.10.08', width: 160, height: 120 }], fd });
+      chunks.forEach(({ chunk, metadata }) => muxer.addChunk(0, chunk, metadata));
+      await muxer.finalize();
+      muxer.close();
+      fs.closeSync(fd);
+
+      expect(segments.map((s) => s.type)).toEqual(['init', 'fragment']);
+      expect(segments.every((s) => s.data === undefined)).toBe(true);
+
+      const written = fs.readFileSync(file);
+      expect(written.length).toBe(segments[0].byteLength + segments[1].byteLength);
+      expect(boxType(written, 0)).toBe('ftyp');
+    } finally {
+      fs.rmSync(file, { force: true });
+    }
+  });
+
+  it('should write an avcC for an attached H.264 encoder', async () => {
+    const segments: MuxerSegment[] = [];
+    const muxer = new Muxer({ output: (s) => segments.push(s), error: (err) => { throw err; } });
+    const encoder = new VideoEncoder({ output: () => {}, error: (err) => { throw err; } });
+
+    encoder.configure({ codec: 'avc1.42001f', width: 160, height: 120, framerate: 30, avc: { format: 'avc' } });
+    muxer.configure({ tracks: [{ type: 'video', codec: 'avc1.42001f', width: 160, height: 120 }] });
+    muxer.attachEncoder(0, encoder);
+
+    encodeFrames(encoder, 3, 3);
+    await encoder.flush();
+    await muxer.finalize();
+    encoder.close();
+    muxer.close();
+
+    expect(segments[0].type).toBe('init');
+    expect(containsBox(segments[0].data!, 'avcC')).toBe(true);
+    expect(segments.filter((s) => s.type === 'fragment')).toHaveLength(1);
+  });
+
+  it('should refuse Annex B H.264 from an encoder or addChunk', async () => {
+    const chunks: { chunk: EncodedVideoChunk; metadata?: any }[] = [];
+    const encoder = new VideoEncoder({
+      output: (chunk, metadata) => chunks.push({ chunk, metadata }),
+      error: (err) => { throw err; },
+    });
+    encoder.configure({ codec: 'avc1.42001f', width: 160, height: 120, framerate: 30 });
+
+    const muxer = new Muxer({ output: () => {}, error: (err) => { throw err; } });
+    muxer.configure({ tracks: [{ type: 'video', codec: 'avc1.42001f', width: 160, height: 120 }] });
+    expect(() => muxer.attachEncoder(0, encoder)).toThrow(/format: 'avc'/);
+
+    encodeFrames(encoder, 1, 1);
+    await encoder.flush();
+    encoder.close();
+
+    expect(() => muxer.addChunk(0, chunks[0].chunk, chunks[0].metadata)).toThrow(/avcC/);
+    muxer.close();
+  });
+});
@@ -0,0 +1,94 @@
+/**
+ * Tests for SceneDetector
+ */
+
+import { SceneDetector } from '../src/SceneDetector';
+import { VideoFrame } from '../src/VideoFrame';
+
+const WIDTH = 160;
+const HEIGHT = 120;
+
+// 'a' is a wrapping diagonal ramp (shift moves it right); 'b' a brighter,
+// differently distributed one, as after a cut
+function lumaFrame(scene: 'a' | 'b', shift = 0, timestamp = 0): VideoFrame {
+  const buffer = Buffer.alloc(WIDTH * HEIGHT * 3 / 2, 128);
+  for (let y = 0; y < HEIGHT; y++) {
+    for (let x = 0; x < WIDTH; x++) {
+      buffer[y * WIDTH + x] = scene === 'a'
+        ? 16 + (((x + shift) * 2 + y) % 200)
+        : 220 - ((x + y * 2) % 60);
+    }
+  }
+  return new VideoFrame(buffer, { format: 'I420', codedWidth: WIDTH, codedHeight: HEIGHT, timestamp });
+}
+
+function rgbaFrame(value: number): VideoFrame {
+  const buffer = Buffer.alloc(WIDTH * HEIGHT * 4, 255);
+  for (let i = 0; i < WIDTH * HEIGHT; i++) {
+    buffer[i * 4] = (i * 7 + value) & 0xff;
+  }
+  return new VideoFrame(buffer, { format: 'RGBA', codedWidth: WIDTH, codedHeight: HEIGHT, timestamp: 0 });
+}
+
+function analyze(detector: SceneDetector, frame: VideoFrame) {
+  const score = detector.analyze(frame);
+  frame.close();
+  return score;
+}
+
+describe('SceneDetector', () => {
+  it('should report the first frame as a scene change', () => {
+    const detector = new SceneDetector();
+    expect(analyze(detector, lumaFrame('a'))).toEqual({
+      difference: 1, blockDifference: 1, histogramDistance: 1, sceneChange: true, duplicate: false,
+    });
+  });
+
+  it('should tell duplicates, motion and cuts apart', () => {
+    const detector = new SceneDetector();
+    analyze(detector, lumaFrame('a'));
+
+    const same = analyze(detector, lumaFrame('a'));
+    expect(same).toMatchObject({ difference: 0, blockDifference: 0, sceneChange: false, duplicate: true });
+
+    const moved = analyze(detector, lumaFrame('a', 1));
+    expect(moved.duplicate).toBe(false);
+    expect(moved.sceneChange).toBe(false);
+    expect(moved.difference).toBeLessThan(0.05);
+    expect(moved.histogramDistance).toBeLessThan(0.05);
+
+    const cut = analyze(detector, lumaFrame('b'));
+    expect(cut.sceneChange).toBe(true);
+    expect(cut.difference).toBeGreaterThan(0.2);
+    expect(cut.histogramDistance).toBeGreaterThan(0.5);
+  });
+
+  it('should honor duplicateThreshold', () => {
+    const detector = new SceneDetector({ duplicateThreshold: 0.5 });
+    analyze(detector, lumaFrame('a'));
+    expect(analyze(detector, lumaFrame('a', 1)).duplicate).toBe(true);
+  });
+
+  it('should analyze RGB frames through their luma', () => {
+    const detector = new SceneDetector();
+    analyze(detector, rgbaFrame(0));
+    expect(analyze(detector, rgbaFrame(0)).duplicate).toBe(true);
+    expect(analyze(detector, rgbaFrame(100)).duplicate).toBe(false);
+  });
+
+  it('should start over after reset()', () => {
+    const detector = new SceneDetector();
+    analyze(detector, lumaFrame('a'));
+    detector.reset();
+    expect(analyze(detector, lumaFrame('a')).sceneChange).toBe(true);
+  });
+
+  it('should reject out-of-range thresholds and closed frames', () => {
+    expect(() => new SceneDetector({ sceneThreshold: 2 })).toThrow(/sceneThreshold/);
+
+    const detector = new SceneDetector();
+    const frame = lumaFrame('a');
+    frame.close();
+    expect(() => detector.analyze(frame)).toThrow();
+  });
+});
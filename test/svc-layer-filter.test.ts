@@ -0,0 +1,54 @@
+/**
+ * Tests for SvcLayerFilter
+ */
+
+import { SvcLayerFilter } from '../src/SvcLayerFilter';
+
+// VP9 inter-frame uncompressed headers (profile 0, shown) that differ only
+// in refresh_frame_flags
+const VP9_REFRESH_LAST = new Uint8Array([0x86, 0x00, 0x40, 0x00]);   // TL0
+const VP9_REFRESH_GOLDEN = new Uint8Array([0x86, 0x00, 0x80, 0x00]); // TL1
+const VP9_REFRESH_NONE = new Uint8Array([0x86, 0x00, 0x00, 0x00]);   // TL2
+
+describe('SvcLayerFilter', () => {
+  it('should classify VP9 frames by the buffers they refresh', () => {
+    const filter = new SvcLayerFilter({ codec: 'vp09.00.10.08', scalabilityMode: 'L1T3' });
+
+    expect(filter.temporalLayerOf(VP9_REFRESH_LAST)).toBe(0);
+    expect(filter.temporalLayerOf(VP9_REFRESH_GOLDEN)).toBe(1);
+    expect(filter.temporalLayerOf(VP9_REFRESH_NONE)).toBe(2);
+
+    filter.maxTemporalLayer = 1;
+    expect(filter.filter(VP9_REFRESH_GOLDEN)).toBe(true);
+    expect(filter.filter(VP9_REFRESH_NONE)).toBe(false);
+
+    const layers = new Int8Array(3);
+    const forwarded = filter.filterBatch([VP9_REFRESH_LAST, VP9_REFRESH_NONE, VP9_REFRESH_GOLDEN], layers);
+    expect(forwarded).toBe(2);
+    expect(Array.from(layers)).toEqual([0, 2, 1]);
+  });
+
+  it('should read AV1 temporal ids from OBU extension headers', () => {
+    const filter = new SvcLayerFilter({
+      codec: 'av01.0.04M.08',
+      scalabilityMode: 'L1T3',
+      maxTemporalLayer: 0,
+    });
+
+    // Temporal delimiter, then OBU_FRAME with temporal_id 2
+    const unit = new Uint8Array([0x12, 0x00, 0x36, 0x40, 0x01, 0x00]);
+    expect(filter.temporalLayerOf(unit)).toBe(2);
+    expect(filter.filter(unit)).toBe(false);
+
+    expect(() => { filter.maxTemporalLayer = 3; }).toThrow(/maxTemporalLayer/);
+  });
+
+  it('should reject typed arrays that are not bytes', () => {
+    const filter = new SvcLayerFilter({ codec: 'vp09.00.10.08', scalabilityMode: 'L1T3' });
+    const wide = new Uint16Array([0x8200, 0x0049]);
+
+    expect(() => filter.temporalLayerOf(wide as any)).toThrow(/Uint8Array/);
+    expect(() => filter.filter(new Float32Array(4) as any)).toThrow(/Uint8Array/);
+    expect(() => filter.filterBatch([wide as any], new Int8Array(1))).toThrow(/Uint8Array/);
+  });
+});
@@ -0,0 +1,52 @@
+/**
+ * Tests for toTensor
+ */
+
+import { toTensor } from '../src/tensor';
+import { VideoFrame } from '../src/VideoFrame';
+
+// Solid-color I420 frame; limited-range Y 235 / UV 128 is white
+function solidFrame(y: number, timestamp: number): VideoFrame {
+  const buffer = Buffer.alloc(64 * 48 * 3 / 2, 128);
+  buffer.fill(y, 0, 64 * 48);
+  return new VideoFrame(buffer, { format: 'I420', codedWidth: 64, codedHeight: 48, timestamp });
+}
+
+describe('toTensor', () => {
+  it('should write a normalized NCHW float32 batch', async () => {
+    const frames = [solidFrame(16, 0), solidFrame(235, 33333)];
+    const tensor = await toTensor(frames, { width: 8, height: 4, mean: [0.5, 0.5, 0.5], std: [0.5, 0.5, 0.5] });
+    frames.forEach((f) => f.close());
+
+    expect(tensor).toBeInstanceOf(Float32Array);
+    expect(tensor.length).toBe(2 * 3 * 8 * 4);
+    // Black maps to -1, white to +1
+    const plane = 8 * 4;
+    expect(tensor[0]).toBeCloseTo(-1, 1);
+    expect(tensor[3 * plane - 1]).toBeCloseTo(-1, 1);
+    expect(tensor[3 * plane]).toBeCloseTo(1, 1);
+    expect(tensor[6 * plane - 1]).toBeCloseTo(1, 1);
+  });
+
+  it('should write float16 into a caller-provided buffer', async () => {
+    const frame = solidFrame(235, 0);
+    const output = new Uint16Array(3 * 2 * 2 + 4);
+    const tensor = await toTensor([frame], { width: 2, height: 2, layout: 'NHWC', mean: [0, 0, 0], std: [1, 1, 1], dtype: 'float16' }, output);
+    frame.close();
+
+    expect(tensor).toBe(output);
+    // Within a few 8-bit steps of 1.0 (0x3c00)
+    for (const half of output.subarray(0, 12)) {
+      expect(half).toBeGreaterThanOrEqual(0x3bf0);
+      expect(half).toBeLessThanOrEqual(0x3c00);
+    }
+    expect(Array.from(output.subarray(12))).toEqual([0, 0, 0, 0]);
+  });
+
+  it('should reject an output too small for the batch', async () => {
+    const frame = solidFrame(128, 0);
+    await expect(toTensor([frame], { width: 4, height: 4 }, new Float32Array(10)))
+      .rejects.toMatchObject({ name: 'TypeError' });
+    frame.close();
+  });
+});
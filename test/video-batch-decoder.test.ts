@@ -0,0 +1,43 @@
+/**
+ * Tests for VideoBatchDecoder
+ */
+
+import { VideoBatchDecoder } from '../src/VideoBatchDecoder';
+import { FRAME_DURATION, encodeH264Gops, frameLuma, readLuma } from './helpers/media';
+
+describe('VideoBatchDecoder', () => {
+  it('should reject an invalid reorderWindow', () => {
+    const decoder = new VideoBatchDecoder({ output: () => {}, error: () => {} });
+
+    expect(() => decoder.configure({ codec: 'avc1.42001f', reorderWindow: 0 })).toThrow(/reorderWindow/);
+
+    decoder.close();
+  });
+
+  it('should output in order across decode() calls in flight with a small reorderWindow', async () => {
+    const chunks = await encodeH264Gops(16, 2);
+
+    const timestamps: number[] = [];
+    const lumas: Promise<number>[] = [];
+    const decoder = new VideoBatchDecoder({
+      output: (frame) => {
+        timestamps.push(frame.timestamp);
+        lumas.push(readLuma(frame));
+      },
+      error: (err) => { throw err; },
+    });
+    decoder.configure({ codec: 'avc1.42001f', concurrency: 3, reorderWindow: 1 });
+
+    // Eight 2-frame ranges over three contexts, split across three batches
+    await Promise.all([
+      decoder.decode(chunks.slice(0, 6)),
+      decoder.decode(chunks.slice(6, 10)),
+      decoder.decode(chunks.slice(10)),
+    ]);
+    decoder.close();
+
+    expect(timestamps).toEqual(Array.from({ length: 16 }, (_, i) => i * FRAME_DURATION));
+    const decoded = await Promise.all(lumas);
+    decoded.forEach((luma, i) => expect(Math.abs(luma - frameLuma(i))).toBeLessThanOrEqual(3));
+  });
+});
@@ -5,6 +5,26 @@
 import { VideoDecoder, VideoDecoderConfig } from '../src/VideoDecoder';
 import { VideoFrame } from '../src/VideoFrame';
 import { EncodedVideoChunk } from '../src/EncodedVideoChunk';
+import { VideoEncoder } from '../src/VideoEncoder';
+import { SpriteSheet } from '../src/SpriteSheet';
+import { FrameCache } from '../src/FrameCache';
+
+// VP8 at 160x120, a keyframe every gop frames, timestamps i * 33333
+async function encodeVp8(count: number, gop: number): Promise<EncodedVideoChunk[]> {
+  const chunks: EncodedVideoChunk[] = [];
+  const encoder = new VideoEncoder({ output: (chunk) => chunks.push(chunk), error: (err) => { throw err; } });
+  encoder.configure({ codec: 'vp8', width: 160, height: 120, framerate: 30 });
+  for (let i = 0; i < count; i++) {
+    const frame = new VideoFrame(Buffer.alloc(160 * 120 * 3 / 2, i * 20), {
+      format: 'I420', codedWidth: 160, codedHeight: 120, timestamp: i * 33333,
+    });
+    encoder.encode(frame, { keyFrame: i % gop === 0 });
+    frame.close();
+  }
+  await encoder.flush();
+  encoder.close();
+  return chunks;
+}
 
 describe('VideoDecoder', () => {
   describe('isConfigSupported', () => {
@@ -120,4 +140,280 @@ describe('VideoDecoder', () => {
       }).toThrow();
     });
   });
+
+  describe('decoderOptions', () => {
+    it('should reject invalid values and options the codec cannot honour', () => {
+      const decoder = new VideoDecoder({ output: (frame) => frame.close(), error: () => {} });
+
+      expect(() => decoder.configure({ codec: 'vp8', decoderOptions: { lowres: 4 } }))
+        .toThrow(expect.objectContaining({ name: 'TypeError' }));
+      expect(() => decoder.configure({ codec: 'vp8', decoderOptions: { skipIdct: 'most' as any } }))
+        .toThrow(expect.objectContaining({ name: 'TypeError' }));
+      // VP8 has no loop-filter skip hook
+      expect(() => decoder.configure({ codec: 'vp8', decoderOptions: { skipLoopFilter: 'all' } }))
+        .toThrow(expect.objectContaining({ name: 'NotSupportedError' }));
+      decoder.close();
+    });
+
+    it('should decode with an explicit thread count', async () => {
+      const chunks = await encodeVp8(6, 3);
+      let outputs = 0;
+      const decoder = new VideoDecoder({
+        output: (frame) => { outputs++; frame.close(); },
+        error: (err) => { throw err; },
+      });
+      decoder.configure({ codec: 'vp8', codedWidth: 160, codedHeight: 120, decoderOptions: { threads: 1, lowres: 0 } });
+      for (const chunk of chunks) decoder.decode(chunk);
+      await decoder.flush();
+      decoder.close();
+
+      expect(outputs).toBe(6);
+    });
+  });
+
+  describe('adaptiveDrop', () => {
+    it('should drop down to keyframes when the decoder falls behind', async () => {
+      const chunks = await encodeVp8(30, 10);
+      const timestamps: number[] = [];
+      const decoder = new VideoDecoder({
+        output: (frame) => { timestamps.push(frame.timestamp); frame.close(); },
+        error: (err) => { throw err; },
+      });
+      // Each chunk is a frame interval (33333us) past the last output, so
+      // lag alone is at least 2x maxLag whatever the decode speed: every
+      // delta frame is dropped and only the keyframes come out
+      decoder.configure({ codec: 'vp8', codedWidth: 160, codedHeight: 120, adaptiveDrop: { maxLag: 10000 } });
+
+      for (const chunk of chunks) decoder.decode(chunk);
+      await decoder.flush();
+      const stats = decoder.dropStats;
+      decoder.close();
+
+      const keyframes = chunks.filter((c) => c.type === 'key').map((c) => c.timestamp);
+      expect(keyframes.slice(0, 3)).toEqual([0, 10 * 33333, 20 * 33333]);
+      expect(timestamps).toEqual(keyframes);
+      expect(stats.droppedFrames).toBe(30 - keyframes.length);
+    });
+
+    it('should reject thresholds that are not positive integers', () => {
+      const decoder = new VideoDecoder({ output: (frame) => frame.close(), error: () => {} });
+      expect(() => decoder.configure({ codec: 'vp8', adaptiveDrop: { queueDepth: 0 } }))
+        .toThrow(expect.objectContaining({ name: 'TypeError' }));
+      expect(() => decoder.configure({ codec: 'vp8', adaptiveDrop: {} }))
+        .toThrow(expect.objectContaining({ name: 'TypeError' }));
+      decoder.close();
+    });
+  });
+
+  describe('output conversion', () => {
+    it('should deliver frames already converted and scaled by the worker', async () => {
+      const chunks = await encodeVp8(3, 3);
+      const frames: { format: string | null; width: number; height: number; bytes: number }[] = [];
+      const decoder = new VideoDecoder({
+        output: (frame) => {
+          frames.push({
+            format: frame.format,
+            width: frame.codedWidth,
+            height: frame.codedHeight,
+            bytes: frame.allocationSize(),
+          });
+          frame.close();
+        },
+        error: (err) => { throw err; },
+      });
+      decoder.configure({
+        codec: 'vp8', codedWidth: 160, codedHeight: 120,
+        outputFormat: 'RGBA', outputWidth: 64, outputHeight: 48,
+      });
+      for (const chunk of chunks) decoder.decode(chunk);
+      await decoder.flush();
+      decoder.close();
+
+      expect(frames).toHaveLength(3);
+      for (const frame of frames) {
+        expect(frame).toEqual({ format: 'RGBA', width: 64, height: 48, bytes: 64 * 48 * 4 });
+      }
+    });
+
+    it('should require both output dimensions', () => {
+      const decoder = new VideoDecoder({ output: (frame) => frame.close(), error: () => {} });
+      expect(() => decoder.configure({ codec: 'vp8', outputWidth: 64 }))
+        .toThrow(expect.objectContaining({ name: 'TypeError' }));
+      decoder.close();
+    });
+  });
+
+  describe('exportCodecAnalysis', () => {
+    // Vertical bars sliding right 4px per frame
+    async function encodeSlidingBars(): Promise<EncodedVideoChunk[]> {
+      const chunks: EncodedVideoChunk[] = [];
+      const encoder = new VideoEncoder({ output: (chunk) => chunks.push(chunk), error: (err) => { throw err; } });
+      encoder.configure({ codec: 'avc1.42001e', width: 160, height: 128, framerate: 30, avc: { format: 'annexb' } });
+      for (let i = 0; i < 4; i++) {
+        const buffer = Buffer.alloc(160 * 128 * 3 / 2, 128);
+        for (let y = 0; y < 128; y++) {
+          for (let x = 0; x < 160; x++) buffer[y * 160 + x] = ((x - i * 4 + 160) % 32) < 16 ? 40 : 200;
+        }
+        const frame = new VideoFrame(buffer, { format: 'I420', codedWidth: 160, codedHeight: 128, timestamp: i * 33333 });
+        encoder.encode(frame, { keyFrame: i === 0 });
+        frame.close();
+      }
+      await encoder.flush();
+      encoder.close();
+      return chunks;
+    }
+
+    it('should attach H.264 motion vectors and aggregate them into a grid', async () => {
+      const chunks = await encodeSlidingBars();
+
+      const analyses: { pictType: string; vectors: number; maxMotion: number }[] = [];
+      const decoder = new VideoDecoder({
+        output: (frame) => {
+          const analysis = frame.codecAnalysis!;
+          const grid = frame.motionGrid(16);
+          analyses.push({
+            pictType: analysis.pictType,
+            vectors: (analysis.motionVectors?.length ?? 0) / 8,
+            maxMotion: grid ? Math.max(...grid.magnitudes) : 0,
+          });
+          frame.close();
+        },
+        error: (err) => { throw err; },
+      });
+      decoder.configure({ codec: 'avc1.42001e', codedWidth: 160, codedHeight: 128, exportCodecAnalysis: true });
+      for (const chunk of chunks) decoder.decode(chunk);
+      await decoder.flush();
+      decoder.close();
+
+      expect(analyses).toHaveLength(4);
+      expect(analyses[0]).toEqual({ pictType: 'I', vectors: 0, maxMotion: 0 });
+      for (const analysis of analyses.slice(1)) {
+        expect(analysis.pictType).toBe('P');
+        expect(analysis.vectors).toBeGreaterThan(0);
+        expect(analysis.maxMotion).toBeGreaterThan(0);
+      }
+    });
+
+    it('should drop vectors and QP from frames resized by outputWidth/outputHeight', async () => {
+      const chunks = await encodeSlidingBars();
+
+      const analyses: { pictType: string; hasVectors: boolean; hasQp: boolean; grid: unknown }[] = [];
+      const decoder = new VideoDecoder({
+        output: (frame) => {
+          const analysis = frame.codecAnalysis!;
+          analyses.push({
+            pictType: analysis.pictType,
+            hasVectors: analysis.motionVectors !== undefined,
+            hasQp: analysis.qp !== undefined,
+            grid: frame.motionGrid(16),
+          });
+          frame.close();
+        },
+        error: (err) => { throw err; },
+      });
+      decoder.configure({
+        codec: 'avc1.42001e', codedWidth: 160, codedHeight: 128, exportCodecAnalysis: true,
+        outputWidth: 80, outputHeight: 64,
+      });
+      for (const chunk of chunks) decoder.decode(chunk);
+      await decoder.flush();
+      decoder.close();
+
+      expect(analyses.map((a) => a.pictType)).toEqual(['I', 'P', 'P', 'P']);
+      for (const analysis of analyses) {
+        expect(analysis).toMatchObject({ hasVectors: false, hasQp: false, grid: null });
+      }
+    });
+  });
+
+  describe('keyframesOnly', () => {
+    it('should output only keyframes, tiled into a sprite sheet', async () => {
+      const chunks = await encodeVp8(9, 3);
+
+      const sheet = new SpriteSheet({ columns: 2, rows: 2, tileWidth: 80, tileHeight: 60 });
+      const decoder = new VideoDecoder({
+        output: (frame) => { sheet.add(frame); frame.close(); },
+        error: (err) => { throw err; },
+      });
+      decoder.configure({ codec: 'vp8', codedWidth: 160, codedHeight: 120, keyframesOnly: true });
+      chunks.forEach((chunk) => decoder.decode(chunk));
+      await decoder.flush();
+      decoder.close();
+
+      expect(sheet.tiles.map((t) => t.timestamp)).toEqual([0, 99999, 199998]);
+      expect(sheet.tiles[2]).toMatchObject({ x: 0, y: 60, width: 80, height: 60 });
+
+      const image = sheet.toVideoFrame();
+      expect(image.codedWidth).toBe(160);
+      expect(image.codedHeight).toBe(120);
+      image.close();
+      sheet.close();
+    });
+  });
+
+  describe('seek', () => {
+    it('should output only the frame at the target timestamp', async () => {
+      const chunks = await encodeVp8(9, 4);
+      const timestamps: number[] = [];
+      const decoder = new VideoDecoder({
+        output: (frame) => { timestamps.push(frame.timestamp); frame.close(); },
+        error: (err) => { throw err; },
+      });
+      decoder.configure({ codec: 'vp8', codedWidth: 160, codedHeight: 120 });
+
+      // Frame 6 decodes from the keyframe at 4; between two frames picks the earlier
+      await expect(decoder.seek(6 * 33333, chunks)).resolves.toBe(true);
+      await expect(decoder.seek(2 * 33333 + 100, chunks)).resolves.toBe(true);
+      decoder.close();
+
+      expect(timestamps).toEqual([6 * 33333, 2 * 33333]);
+    });
+
+    it('should serve frames decoded by an earlier seek from the frame cache', async () => {
+      const chunks = await encodeVp8(9, 4);
+      const cache = new FrameCache({ maxBytes: 16 * 1024 * 1024, width: 80, height: 60 });
+      const frames: { timestamp: number; width: number }[] = [];
+      const decoder = new VideoDecoder({
+        output: (frame) => { frames.push({ timestamp: frame.timestamp, width: frame.codedWidth }); frame.close(); },
+        error: (err) => { throw err; },
+      });
+      decoder.configure({ codec: 'vp8', codedWidth: 160, codedHeight: 120, frameCache: cache });
+
+      await decoder.seek(6 * 33333, chunks);  // Miss: decodes 4..6
+      await decoder.seek(5 * 33333, chunks);  // Hit
+      decoder.close();
+
+      expect(frames).toEqual([{ timestamp: 6 * 33333, width: 160 }, { timestamp: 5 * 33333, width: 80 }]);
+      expect(cache.stats).toMatchObject({ hits: 1, misses: 1, hitRate: 0.5 });
+      expect(cache.stats.bytes).toBeGreaterThan(0);
+      expect(cache.has(4 * 33333)).toBe(true);
+    });
+
+    it('should cache frames from decode() under their own timestamps with frame threading', async () => {
+      // Frame i is a flat i * 20; threaded output trails input by several packets
+      const chunks = await encodeVp8(8, 8);
+      const cache = new FrameCache({ maxBytes: 16 * 1024 * 1024 });
+      const decoder = new VideoDecoder({
+        output: (frame) => frame.close(),
+        error: (err) => { throw err; },
+      });
+      decoder.configure({
+        codec: 'vp8', codedWidth: 160, codedHeight: 120, frameCache: cache, decoderOptions: { threads: 4 },
+      });
+      for (const chunk of chunks) {
+        decoder.decode(chunk);
+      }
+      await decoder.flush();
+      decoder.close();
+
+      for (let i = 0; i < 8; i++) {
+        const frame = cache.get(i * 33333);
+        expect(frame).not.toBeNull();
+        const data = Buffer.alloc(frame!.allocationSize());
+        await frame!.copyTo(data);
+        frame!.close();
+        expect(Math.abs(data[0] - i * 20)).toBeLessThanOrEqual(4);
+      }
+    });
+  });
 });
@@ -125,6 +125,69 @@ describe('VideoEncoder', () => {
       await expect(encoder.flush()).rejects.toThrow();
     });
 
+    it('should reject a non-positive latencyBudget', () => {
+      expect(() => {
+        encoder.configure({
+          codec: 'avc1.42E01E',
+          width: 640,
+          height: 480,
+          latencyMode: 'realtime',
+          latencyBudget: 0,
+        });
+      }).toThrow(/latencyBudget/);
+    });
+
+    it('should require the worker thread for simulcast', () => {
+      expect(() => {
+        encoder.configure({
+          codec: 'avc1.42E01E',
+          width: 640,
+          height: 480,
+          scalabilityMode: 'S2T1',
+          useWorkerThread: false,
+        });
+      }).toThrow(/worker-thread/);
+    });
+
+    it('should refuse length-prefixed output for simulcast', () => {
+      expect(() => {
+        encoder.configure({
+          codec: 'avc1.42E01E',
+          width: 640,
+          height: 480,
+          scalabilityMode: 'S2T1',
+          avc: { format: 'avc' },
+        });
+      }).toThrow(/Annex B/);
+    });
+
+    it('should point spatial SVC modes at simulcast', () => {
+      expect(() => {
+        encoder.configure({
+          codec: 'vp09.00.10.08',
+          width: 640,
+          height: 480,
+          scalabilityMode: 'L2T2',
+        });
+      }).toThrow(/S2T2/);
+    });
+
+    it('should require the worker thread for sceneDetection', () => {
+      expect(() => {
+        encoder.configure({
+          codec: 'avc1.42E01E',
+          width: 640,
+          height: 480,
+          sceneDetection: { skipDuplicates: true },
+          useWorkerThread: false,
+        });
+      }).toThrow(/sceneDetection/);
+    });
+
+    it('should start with no dropped frames', () => {
+      expect(encoder.droppedFrameCount).toBe(0);
+    });
+
     it('should throw if configure called after close', () => {
       encoder.close();
 
@@ -137,4 +200,191 @@ describe('VideoEncoder', () => {
       }).toThrow();
     });
   });
+
+  describe('avc format', () => {
+    it('should emit length-prefixed NAL units with an avcC description', async () => {
+      const config: VideoEncoderConfig = {
+        codec: 'avc1.42E01E',
+        width: 160,
+        height: 120,
+        avc: { format: 'avc' },
+      };
+      if (!(await VideoEncoder.isConfigSupported(config)).supported) return;
+
+      const outputs: { chunk: EncodedVideoChunk; metadata?: any }[] = [];
+      const encoder = new VideoEncoder({
+        output: (chunk, metadata) => outputs.push({ chunk, metadata }),
+        error: (err) => { throw err; },
+      });
+      encoder.configure(config);
+
+      for (let i = 0; i < 3; i++) {
+        const frame = new VideoFrame(Buffer.alloc(160 * 120 * 3 / 2, i * 40), {
+          format: 'I420', codedWidth: 160, codedHeight: 120, timestamp: i * 33333,
+        });
+        encoder.encode(frame, { keyFrame: i === 0 });
+        frame.close();
+      }
+      await encoder.flush();
+      encoder.close();
+
+      const description = new Uint8Array(outputs[0].metadata.decoderConfig.description);
+      expect(description[0]).toBe(1);     // configurationVersion
+      expect(description[1]).toBe(0x42);  // Baseline
+      expect(description[4]).toBe(0xff);  // 4-byte lengths
+
+      // NAL lengths walk each chunk exactly to its end
+      for (const { chunk } of outputs) {
+        const data = Buffer.alloc(chunk.byteLength);
+        chunk.copyTo(data);
+        let offset = 0;
+        while (offset < data.length) {
+          offset += 4 + data.readUInt32BE(offset);
+        }
+        expect(offset).toBe(data.length);
+      }
+    });
+
+    it('should attach the description to a keyframe drained by flush()', async () => {
+      // One frame at VGA: x264's lookahead holds it until the encoder is drained
+      const config: VideoEncoderConfig = {
+        codec: 'avc1.42E01E',
+        width: 640,
+        height: 480,
+        avc: { format: 'avc' },
+      };
+      if (!(await VideoEncoder.isConfigSupported(config)).supported) return;
+
+      const outputs: { chunk: EncodedVideoChunk; metadata?: any }[] = [];
+      const encoder = new VideoEncoder({
+        output: (chunk, metadata) => outputs.push({ chunk, metadata }),
+        error: (err) => { throw err; },
+      });
+      encoder.configure(config);
+
+      const frame = new VideoFrame(Buffer.alloc(640 * 480 * 3 / 2, 100), {
+        format: 'I420', codedWidth: 640, codedHeight: 480, timestamp: 0,
+      });
+      encoder.encode(frame, { keyFrame: true });
+      frame.close();
+      await new Promise((resolve) => setTimeout(resolve, 50));
+      expect(outputs).toHaveLength(0);
+
+      await encoder.flush();
+      encoder.close();
+
+      expect(outputs).toHaveLength(1);
+      expect(outputs[0].chunk.type).toBe('key');
+      const description = new Uint8Array(outputs[0].metadata.decoderConfig.description);
+      expect(description[0]).toBe(1);
+      expect(description[4]).toBe(0xff);
+    });
+  });
+
+  describe('sceneDetection', () => {
+    // Wrapping ramp for scene 0, a brighter and differently spread one for scene 1
+    function sceneFrame(scene: number, timestamp: number): VideoFrame {
+      const buffer = Buffer.alloc(160 * 120 * 3 / 2, 128);
+      for (let y = 0; y < 120; y++) {
+        for (let x = 0; x < 160; x++) {
+          buffer[y * 160 + x] = scene === 0 ? 16 + ((x * 2 + y) % 200) : 220 - ((x + y * 2) % 60);
+        }
+      }
+      return new VideoFrame(buffer, { format: 'I420', codedWidth: 160, codedHeight: 120, timestamp });
+    }
+
+    it('should skip duplicates and key the frames after cuts', async () => {
+      const config: VideoEncoderConfig = {
+        codec: 'avc1.42E01E',
+        width: 160,
+        height: 120,
+        sceneDetection: { skipDuplicates: true, keyframeOnSceneChange: true },
+      };
+      if (!(await VideoEncoder.isConfigSupported(config)).supported) return;
+
+      const chunks: EncodedVideoChunk[] = [];
+      const encoder = new VideoEncoder({
+        output: (chunk) => chunks.push(chunk),
+        error: (err) => { throw err; },
+      });
+      encoder.configure(config);
+
+      const scenes = [0, 0, 1, 1, 1, 0];
+      scenes.forEach((scene, i) => {
+        const frame = sceneFrame(scene, i * 33333);
+        encoder.encode(frame, { keyFrame: i === 0 });
+        frame.close();
+      });
+      await encoder.flush();
+
+      expect(chunks.map((c) => c.timestamp)).toEqual([0, 2 * 33333, 5 * 33333]);
+      expect(chunks.map((c) => c.type)).toEqual(['key', 'key', 'key']);
+      expect(encoder.sceneStats).toEqual({ sceneChanges: 2, duplicatesSkipped: 3 });
+      encoder.close();
+    });
+  });
+
+  describe('latencyBudget', () => {
+    it('should reject latencyBudget outside realtime mode', () => {
+      const encoder = new VideoEncoder({ output: () => {}, error: () => {} });
+      expect(() => encoder.configure({
+        codec: 'avc1.42E01E',
+        width: 640,
+        height: 480,
+        latencyMode: 'quality',
+        latencyBudget: 50,
+      })).toThrow(expect.objectContaining({ name: 'NotSupportedError' }));
+      encoder.close();
+    });
+
+    it('should shed stale frames but keep forced keyframes and the freshest frame', async () => {
+      const config: VideoEncoderConfig = {
+        codec: 'avc1.42E01E',
+        width: 640,
+        height: 480,
+        framerate: 30,
+        latencyMode: 'realtime',
+        latencyBudget: 1,
+      };
+      if (!(await VideoEncoder.isConfigSupported(config)).supported) return;
+
+      // Built up front so the whole batch lands in the queue within
+      // microseconds; encoding 40 VGA frames takes far longer than 1ms, so
+      // the frames behind the first one go stale
+      const count = 40;
+      const forcedKeys = [10 * 33333, 25 * 33333];
+      const frames = Array.from({ length: count }, (_, i) => {
+        const buffer = Buffer.alloc(640 * 480 * 3 / 2, 128);
+        buffer.fill((i * 37) & 0xff, 0, 640 * 480);
+        return new VideoFrame(buffer, { format: 'I420', codedWidth: 640, codedHeight: 480, timestamp: i * 33333 });
+      });
+
+      const chunks: EncodedVideoChunk[] = [];
+      const dropped: number[] = [];
+      const encoder = new VideoEncoder({
+        output: (chunk) => chunks.push(chunk),
+        error: (err) => { throw err; },
+      });
+      encoder.addEventListener('drop', (detail) => dropped.push(...detail.timestamps));
+      encoder.configure(config);
+
+      frames.forEach((frame) => {
+        encoder.encode(frame, { keyFrame: forcedKeys.includes(frame.timestamp) });
+        frame.close();
+      });
+      await encoder.flush();
+      encoder.close();
+
+      const encoded = chunks.map((c) => c.timestamp);
+      expect(dropped.length).toBeGreaterThan(0);
+      expect(encoder.droppedFrameCount).toBe(dropped.length);
+      expect([...encoded, ...dropped].sort((a, b) => a - b))
+        .toEqual(Array.from({ length: count }, (_, i) => i * 33333));
+      for (const timestamp of forcedKeys) {
+        expect(dropped).not.toContain(timestamp);
+        expect(chunks.find((c) => c.timestamp === timestamp)?.type).toBe('key');
+      }
+      expect(encoded[encoded.length - 1]).toBe((count - 1) * 33333);
+    });
+  });
 });
@@ -0,0 +1,59 @@
+/**
+ * Tests for VideoLadderEncoder
+ */
+
+import { VideoLadderEncoder, VideoLadderOutputMetadata } from '../src/VideoLadderEncoder';
+import { EncodedVideoChunk } from '../src/EncodedVideoChunk';
+import { FRAME_DURATION, createI420Frame } from './helpers/media';
+
+describe('VideoLadderEncoder', () => {
+  it('should reject duplicate rendition ids', () => {
+    const ladder = new VideoLadderEncoder({ output: () => {}, error: () => {} });
+
+    expect(() => ladder.configure({
+      codec: 'avc1.42001f',
+      renditions: [
+        { id: 'hd', width: 1280, height: 720 },
+        { id: 'hd', width: 640, height: 360 },
+      ],
+    })).toThrow(/Duplicate rendition id/);
+
+    ladder.close();
+  });
+
+  it('should emit every frame once per rendition with aligned keyframes', async () => {
+    const outputs: Array<{ chunk: EncodedVideoChunk; metadata: VideoLadderOutputMetadata }> = [];
+    const ladder = new VideoLadderEncoder({
+      output: (chunk, metadata) => outputs.push({ chunk, metadata }),
+      error: (err) => { throw err; },
+    });
+
+    ladder.configure({
+      codec: 'avc1.42001f',
+      framerate: 30,
+      renditions: [
+        { width: 320, height: 180, bitrate: 300_000 },
+        { width: 640, height: 360, bitrate: 800_000 },
+        { width: 160, height: 90, bitrate: 100_000 },
+      ],
+    });
+
+    // A keyframe request applies to every rendition, so ABR switches line up
+    for (let i = 0; i < 6; i++) {
+      const frame = createI420Frame(640, 360, i * FRAME_DURATION);
+      ladder.encode(frame, { keyFrame: i === 0 || i === 3 });
+      frame.close();
+    }
+    await ladder.flush();
+    ladder.close();
+
+    const sizes: Record<string, number> = { '360p': 640, '180p': 320, '90p': 160 };
+    for (const [id, width] of Object.entries(sizes)) {
+      const chunks = outputs.filter((o) => o.metadata.renditionId === id);
+      expect(chunks.map((o) => o.chunk.timestamp)).toEqual(Array.from({ length: 6 }, (_, i) => i * FRAME_DURATION));
+      expect(chunks.filter((o) => o.chunk.type === 'key').map((o) => o.chunk.timestamp))
+        .toEqual([0, 3 * FRAME_DURATION]);
+      expect(chunks[0].metadata.decoderConfig?.codedWidth).toBe(width);
+    }
+  });
+});
@@ -0,0 +1,103 @@
+/**
+ * Tests for VideoSegmentedEncoder
+ */
+
+import { VideoSegmentedEncoder } from '../src/VideoSegmentedEncoder';
+import { VideoDecoder } from '../src/VideoDecoder';
+import { EncodedVideoChunk } from '../src/EncodedVideoChunk';
+import { FRAME_DURATION, frameLuma, readLuma, sourceFrame } from './helpers/media';
+
+describe('VideoSegmentedEncoder', () => {
+  it('should reject an invalid segmentLength', () => {
+    const encoder = new VideoSegmentedEncoder({ output: () => {}, error: () => {} });
+
+    expect(() => encoder.configure({
+      codec: 'avc1.42001f',
+      width: 320,
+      height: 240,
+      segmentLength: 0,
+    })).toThrow(/segmentLength/);
+
+    encoder.close();
+  });
+
+  it('should keep frame order across segment boundaries with more segments than workers', async () => {
+    const chunks: EncodedVideoChunk[] = [];
+    let decoderConfigs = 0;
+    const encoder = new VideoSegmentedEncoder({
+      output: (chunk, metadata) => {
+        chunks.push(chunk);
+        if (metadata?.decoderConfig) decoderConfigs++;
+      },
+      error: (err) => { throw err; },
+    });
+
+    // 13 frames: four full segments of 3 racing on 3 contexts, plus a
+    // partial one cut by flush()
+    encoder.configure({
+      codec: 'avc1.42001f',
+      width: 320,
+      height: 240,
+      framerate: 30,
+      segmentLength: 3,
+      concurrency: 3,
+    });
+    for (let i = 0; i < 13; i++) {
+      const frame = sourceFrame(i);
+      encoder.encode(frame);
+      frame.close();
+    }
+    await encoder.flush();
+    encoder.close();
+
+    expect(chunks.map((c) => c.timestamp)).toEqual(Array.from({ length: 13 }, (_, i) => i * FRAME_DURATION));
+    expect(chunks.map((c) => c.type === 'key')).toEqual(Array.from({ length: 13 }, (_, i) => i % 3 === 0));
+    expect(decoderConfigs).toBeGreaterThanOrEqual(1);
+
+    // Timestamps could be relabelled; the pictures themselves must be in order
+    const lumas: Promise<number>[] = [];
+    const decoder = new VideoDecoder({
+      output: (frame) => lumas.push(readLuma(frame)),
+      error: (err) => { throw err; },
+    });
+    decoder.configure({ codec: 'avc1.42001f', codedWidth: 320, codedHeight: 240 });
+    chunks.forEach((chunk) => decoder.decode(chunk));
+    await decoder.flush();
+    decoder.close();
+
+    const decoded = await Promise.all(lumas);
+    expect(decoded).toHaveLength(13);
+    decoded.forEach((luma, i) => expect(Math.abs(luma - frameLuma(i))).toBeLessThanOrEqual(3));
+  });
+
+  it('should hold at most concurrency segments for a producer that waits on dequeue', async () => {
+    const segmentLength = 3;
+    const concurrency = 2;
+    const bound = segmentLength * concurrency;
+    let outputs = 0;
+    const encoder = new VideoSegmentedEncoder({
+      output: () => { outputs++; },
+      error: (err) => { throw err; },
+    });
+    encoder.configure({ codec: 'avc1.42001f', width: 320, height: 240, segmentLength, concurrency });
+
+    // Eight segments, four times what the workers can take at once. A
+    // producer that never got a dequeue would hang here.
+    let maxQueued = 0;
+    for (let i = 0; i < 24; i++) {
+      while (encoder.encodeQueueSize >= bound) {
+        await new Promise<void>((resolve) => encoder.addEventListener('dequeue', resolve, { once: true }));
+      }
+      const frame = sourceFrame(i);
+      encoder.encode(frame);
+      frame.close();
+      maxQueued = Math.max(maxQueued, encoder.encodeQueueSize);
+    }
+    await encoder.flush();
+    expect(encoder.encodeQueueSize).toBe(0);
+    encoder.close();
+
+    expect(maxQueued).toBeLessThanOrEqual(bound);
+    expect(outputs).toBe(24);
+  });
+});
@@ -0,0 +1,60 @@
+/**
+ * Tests for VideoTranscoder
+ */
+
+import { VideoTranscoder } from '../src/VideoTranscoder';
+import { EncodedVideoChunk } from '../src/EncodedVideoChunk';
+import { FRAME_DURATION, encodeH264Gops } from './helpers/media';
+
+describe('VideoTranscoder', () => {
+  it('should reject invalid output dimensions', () => {
+    const transcoder = new VideoTranscoder({ output: () => {}, error: () => {} });
+
+    expect(() => transcoder.configure({
+      decoder: { codec: 'avc1.42001f' },
+      encoder: { codec: 'avc1.42001f', width: 0, height: 120 },
+    })).toThrow(/dimensions/);
+
+    transcoder.close();
+  });
+
+  it('should refuse length-prefixed output it cannot produce', () => {
+    const transcoder = new VideoTranscoder({ output: () => {}, error: () => {} });
+
+    expect(() => transcoder.configure({
+      decoder: { codec: 'avc1.42001f' },
+      encoder: { codec: 'avc1.42001f', avc: { format: 'avc' } } as any,
+    })).toThrow(/Annex B/);
+
+    transcoder.close();
+  });
+
+  it('should transcode to a smaller size in order', async () => {
+    const source = await encodeH264Gops(8, 8);
+
+    const chunks: EncodedVideoChunk[] = [];
+    let codedWidth = 0;
+    let lastProgress = { framesDecoded: 0, framesEncoded: 0 };
+    const transcoder = new VideoTranscoder({
+      output: (chunk, metadata) => {
+        chunks.push(chunk);
+        if (metadata?.decoderConfig) codedWidth = metadata.decoderConfig.codedWidth;
+      },
+      error: (err) => { throw err; },
+      progress: (progress) => { lastProgress = progress; },
+    });
+    transcoder.configure({
+      decoder: { codec: 'avc1.42001f' },
+      encoder: { codec: 'avc1.42001f', width: 160, height: 120, bitrate: 200_000 },
+    });
+
+    for (const chunk of source) transcoder.transcode(chunk);
+    await transcoder.flush();
+    transcoder.close();
+
+    expect(chunks.map((c) => c.timestamp)).toEqual(Array.from({ length: 8 }, (_, i) => i * FRAME_DURATION));
+    expect(chunks[0].type).toBe('key');
+    expect(codedWidth).toBe(160);
+    expect(lastProgress).toEqual({ framesDecoded: 8, framesEncoded: 8 });
+  });
+});